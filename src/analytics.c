@@ -10,13 +10,18 @@
 #include <string.h>
 #include <time.h>
 
+#include "db.h"
+#include "latency.h"
 #include "platform.h"
+#include "review_store.h"
 #include "sessions.h"
 
 #ifndef HR_ANALYTICS_SECONDS_PER_DAY
 #define HR_ANALYTICS_SECONDS_PER_DAY 86400
 #endif
 
+#define HR_ANALYTICS_MINUTES_PER_DAY 1440
+
 typedef struct HrAnalyticsRetentionBucketSpec {
     double min_days;
     double max_days;
@@ -30,13 +35,68 @@ static const HrAnalyticsRetentionBucketSpec kRetentionBuckets[HR_ANALYTICS_RETEN
     {30.0, DBL_MAX},
 };
 
+/* Upper ease-factor bounds of every band but the last. */
+static const double kEaseBandUpper[HR_ANALYTICS_EASE_BANDS - 1U] = {1.8, 2.3, 2.8};
+
+/* Range analytics_interval_modifier() may scale intervals by. */
+#define HR_ANALYTICS_MIN_INTERVAL_MODIFIER 0.5
+#define HR_ANALYTICS_MAX_INTERVAL_MODIFIER 2.0
+
+/* Guards ancestor walks against a parent cycle in a damaged topic tree. */
+#define HR_ANALYTICS_MAX_TOPIC_DEPTH 64U
+
+/* Review counters of one topic; the same shape holds a subtree rollup. */
+typedef struct HrAnalyticsTopicCounters {
+    uint32_t rating_counts[HR_ANALYTICS_RATING_BUCKETS];
+    uint32_t retention_total[HR_ANALYTICS_RETENTION_BUCKETS];
+    uint32_t retention_successful[HR_ANALYTICS_RETENTION_BUCKETS];
+    HrLatencyHistogram answer_ms;        /* Timed reviews only. */
+    HrLatencyHistogram interval_minutes; /* Every review. */
+    HrForgettingBins curve;              /* Repeat reviews only. */
+} HrAnalyticsTopicCounters;
+
+typedef struct HrAnalyticsTopicEntry {
+    char topic_id[HR_ANALYTICS_MAX_TOPIC_ID];  /* Empty for an unused slot. */
+    char parent_id[HR_ANALYTICS_MAX_TOPIC_ID]; /* Empty for a root. */
+    char title[HR_ANALYTICS_MAX_TOPIC_TITLE];
+    HrAnalyticsTopicCounters *own;    /* Allocated with the topic's first review. */
+    HrAnalyticsTopicCounters *rollup; /* Own plus descendants; leaves have none and roll up to @c own. */
+} HrAnalyticsTopicEntry;
+
 struct AnalyticsHandle {
     bool enabled;
     HrAnalyticsDashboard dashboard;
     double interval_sum_minutes;
     time_t last_activity_day;
+    HrLatencyHistogram input_latency;
+    HrLatencyHistogram answer_ms;
+    HrLatencyHistogram interval_minutes;
+    HrLatencyHistogram frame_micros;
+    HrLatencyHistogram recent_frame_micros;      /* The frames in frame_window only. */
+    uint32_t frame_window[HR_ANALYTICS_FRAME_WINDOW]; /* Ring of recent frame times (us). */
+    size_t frame_window_count;
+    size_t frame_window_next;
+    HrAnalyticsTopicEntry *topics; /* Open-addressed on the topic id; capacity is a power of two. */
+    size_t topic_capacity;
+    size_t topic_count;
+    bool rollups_valid; /* Cleared when the tree changes; reviews keep valid rollups current. */
+    HrAnalyticsHeatmapSample *heatmap_ring; /* heatmap_capacity days, slot = day number mod capacity. */
+    size_t heatmap_capacity;
+    HrForgettingBins curve_bins;                           /* Every repeat review. */
+    HrForgettingBins ease_bins[HR_ANALYTICS_EASE_BANDS];
+    uint32_t curves_dirty; /* Bit 0: overall curve; bit 1 + band: that ease band. */
+    struct HrReviewStore *review_store; /* Only with HrAnalyticsConfig::columnar_cache. */
 };
 
+static void reset_frame_stats(struct AnalyticsHandle *handle)
+{
+    memset(&handle->dashboard.frames, 0, sizeof(handle->dashboard.frames));
+    latency_histogram_reset(&handle->frame_micros);
+    latency_histogram_reset(&handle->recent_frame_micros);
+    handle->frame_window_count = 0U;
+    handle->frame_window_next = 0U;
+}
+
 static void analytics_reset(struct AnalyticsHandle *handle)
 {
     if (handle == NULL) {
@@ -44,6 +104,11 @@ static void analytics_reset(struct AnalyticsHandle *handle)
     }
 
     memset(&handle->dashboard, 0, sizeof(handle->dashboard));
+    if (handle->heatmap_ring != NULL) {
+        memset(handle->heatmap_ring, 0, handle->heatmap_capacity * sizeof(*handle->heatmap_ring));
+    }
+    handle->dashboard.heatmap = handle->heatmap_ring;
+    handle->dashboard.heatmap_capacity = handle->heatmap_capacity;
     handle->dashboard.retention_count = HR_ANALYTICS_RETENTION_BUCKETS;
     for (size_t i = 0; i < HR_ANALYTICS_RETENTION_BUCKETS; ++i) {
         handle->dashboard.retention[i].min_interval_days = kRetentionBuckets[i].min_days;
@@ -51,6 +116,328 @@ static void analytics_reset(struct AnalyticsHandle *handle)
     }
     handle->interval_sum_minutes = 0.0;
     handle->last_activity_day = 0;
+    latency_histogram_reset(&handle->input_latency);
+    latency_histogram_reset(&handle->answer_ms);
+    latency_histogram_reset(&handle->interval_minutes);
+    reset_frame_stats(handle);
+    /* The topic tree outlives a reset; only the counters go. */
+    for (size_t i = 0; i < handle->topic_capacity; ++i) {
+        HrAnalyticsTopicEntry *entry = &handle->topics[i];
+        if (entry->own != NULL) {
+            memset(entry->own, 0, sizeof(*entry->own));
+        }
+        if (entry->rollup != NULL) {
+            memset(entry->rollup, 0, sizeof(*entry->rollup));
+        }
+    }
+    handle->rollups_valid = true;
+    memset(&handle->curve_bins, 0, sizeof(handle->curve_bins));
+    memset(handle->ease_bins, 0, sizeof(handle->ease_bins));
+    handle->curves_dirty = 0U;
+    review_store_clear(handle->review_store);
+}
+
+static void summarize_quantiles(const HrLatencyHistogram *histogram, double scale, HrAnalyticsQuantiles *out)
+{
+    out->samples = histogram->samples;
+    out->p50 = (double)latency_histogram_percentile(histogram, 0.50) * scale;
+    out->p90 = (double)latency_histogram_percentile(histogram, 0.90) * scale;
+    out->p99 = (double)latency_histogram_percentile(histogram, 0.99) * scale;
+    out->max = (double)histogram->max * scale;
+}
+
+/* Percentiles walk a few hundred buckets, so they are refreshed once per event rather than per row. */
+static void refresh_review_quantiles(struct AnalyticsHandle *handle)
+{
+    summarize_quantiles(&handle->answer_ms, 1.0, &handle->dashboard.answer_time);
+    summarize_quantiles(&handle->interval_minutes, 1.0 / (double)HR_ANALYTICS_MINUTES_PER_DAY,
+                        &handle->dashboard.scheduled_interval);
+}
+
+/*
+ * Adds or takes back one repeat review in the overall and ease-band curve
+ * bins. First reviews (no previous interval) say nothing about forgetting
+ * and are skipped.
+ */
+static void curves_apply(struct AnalyticsHandle *handle,
+                         double previous_interval_days,
+                         double previous_ease_factor,
+                         bool success,
+                         bool add)
+{
+    if (!(previous_interval_days > 0.0)) {
+        return;
+    }
+    const size_t band = analytics_ease_band(previous_ease_factor);
+    if (add) {
+        forgetting_bins_record(&handle->curve_bins, previous_interval_days, success);
+        forgetting_bins_record(&handle->ease_bins[band], previous_interval_days, success);
+    } else {
+        forgetting_bins_remove(&handle->curve_bins, previous_interval_days, success);
+        forgetting_bins_remove(&handle->ease_bins[band], previous_interval_days, success);
+    }
+    handle->curves_dirty |= 1U | (2U << band);
+}
+
+/* Refits the curves whose bins changed since the last call; each fit is O(bins). */
+static void refresh_forgetting_curves(struct AnalyticsHandle *handle)
+{
+    if (handle->curves_dirty & 1U) {
+        forgetting_fit(&handle->curve_bins, &handle->dashboard.forgetting_curve);
+    }
+    for (size_t band = 0; band < HR_ANALYTICS_EASE_BANDS; ++band) {
+        if (handle->curves_dirty & (2U << band)) {
+            forgetting_fit(&handle->ease_bins[band], &handle->dashboard.ease_curves[band]);
+        }
+    }
+    handle->curves_dirty = 0U;
+}
+
+static uint64_t topic_hash(const char *topic_id)
+{
+    uint64_t hash = 1469598103934665603ULL; /* FNV-1a */
+    for (const unsigned char *p = (const unsigned char *)topic_id; *p != '\0'; ++p) {
+        hash ^= (uint64_t)*p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static HrAnalyticsTopicEntry *topic_probe(HrAnalyticsTopicEntry *table, size_t capacity, const char *topic_id)
+{
+    size_t index = (size_t)topic_hash(topic_id) & (capacity - 1U);
+    while (table[index].topic_id[0] != '\0' && strcmp(table[index].topic_id, topic_id) != 0) {
+        index = (index + 1U) & (capacity - 1U);
+    }
+    return &table[index];
+}
+
+static HrAnalyticsTopicEntry *find_topic(const struct AnalyticsHandle *handle, const char *topic_id)
+{
+    if (handle->topics == NULL || topic_id == NULL || topic_id[0] == '\0') {
+        return NULL;
+    }
+    HrAnalyticsTopicEntry *entry = topic_probe(handle->topics, handle->topic_capacity, topic_id);
+    return (entry->topic_id[0] != '\0') ? entry : NULL;
+}
+
+/* Returns the entry for @p topic_id, adding it (and growing the table) when new. */
+static HrAnalyticsTopicEntry *ensure_topic(struct AnalyticsHandle *handle, const char *topic_id)
+{
+    if (topic_id == NULL || topic_id[0] == '\0' || strlen(topic_id) >= HR_ANALYTICS_MAX_TOPIC_ID) {
+        return NULL;
+    }
+
+    HrAnalyticsTopicEntry *existing = find_topic(handle, topic_id);
+    if (existing != NULL) {
+        return existing;
+    }
+
+    if ((handle->topic_count + 1U) * 4U > handle->topic_capacity * 3U) {
+        const size_t capacity = (handle->topic_capacity == 0U) ? 16U : handle->topic_capacity * 2U;
+        HrAnalyticsTopicEntry *table = (HrAnalyticsTopicEntry *)calloc(capacity, sizeof(*table));
+        if (table == NULL) {
+            return NULL;
+        }
+        for (size_t i = 0; i < handle->topic_capacity; ++i) {
+            if (handle->topics[i].topic_id[0] != '\0') {
+                *topic_probe(table, capacity, handle->topics[i].topic_id) = handle->topics[i];
+            }
+        }
+        free(handle->topics);
+        handle->topics = table;
+        handle->topic_capacity = capacity;
+    }
+
+    HrAnalyticsTopicEntry *entry = topic_probe(handle->topics, handle->topic_capacity, topic_id);
+    strcpy(entry->topic_id, topic_id);
+    handle->topic_count++;
+    return entry;
+}
+
+static void free_topics(struct AnalyticsHandle *handle)
+{
+    for (size_t i = 0; i < handle->topic_capacity; ++i) {
+        free(handle->topics[i].own);
+        free(handle->topics[i].rollup);
+    }
+    free(handle->topics);
+    handle->topics = NULL;
+    handle->topic_capacity = 0U;
+    handle->topic_count = 0U;
+}
+
+static HrAnalyticsTopicEntry *topic_parent(const struct AnalyticsHandle *handle, const HrAnalyticsTopicEntry *entry)
+{
+    return (entry->parent_id[0] != '\0') ? find_topic(handle, entry->parent_id) : NULL;
+}
+
+static uint64_t counters_total(const HrAnalyticsTopicCounters *counters)
+{
+    uint64_t total = 0U;
+    for (size_t i = 0; i < HR_ANALYTICS_RATING_BUCKETS; ++i) {
+        total += counters->rating_counts[i];
+    }
+    return total;
+}
+
+static uint64_t counters_successful(const HrAnalyticsTopicCounters *counters)
+{
+    uint64_t successful = 0U;
+    for (size_t i = SRS_RESPONSE_GOOD; i <= SRS_RESPONSE_CRAM; ++i) {
+        successful += counters->rating_counts[i];
+    }
+    return successful;
+}
+
+static void counters_merge(HrAnalyticsTopicCounters *target, const HrAnalyticsTopicCounters *source)
+{
+    for (size_t i = 0; i < HR_ANALYTICS_RATING_BUCKETS; ++i) {
+        target->rating_counts[i] += source->rating_counts[i];
+    }
+    for (size_t i = 0; i < HR_ANALYTICS_RETENTION_BUCKETS; ++i) {
+        target->retention_total[i] += source->retention_total[i];
+        target->retention_successful[i] += source->retention_successful[i];
+    }
+    latency_histogram_merge(&target->answer_ms, &source->answer_ms);
+    latency_histogram_merge(&target->interval_minutes, &source->interval_minutes);
+    forgetting_bins_merge(&target->curve, &source->curve);
+}
+
+/* One review as the topic counters see it. */
+typedef struct HrAnalyticsTopicSample {
+    SRSReviewRating rating;
+    size_t retention_bucket;
+    uint64_t interval_value;
+    uint32_t answer_ms;
+    double elapsed_days; /* Previous interval; 0 for a first review, which no curve sees. */
+} HrAnalyticsTopicSample;
+
+static void counters_apply(HrAnalyticsTopicCounters *counters, const HrAnalyticsTopicSample *sample, bool add)
+{
+    const bool success = sample->rating >= SRS_RESPONSE_GOOD && sample->rating <= SRS_RESPONSE_CRAM;
+    uint32_t *rating = &counters->rating_counts[sample->rating];
+    uint32_t *total = &counters->retention_total[sample->retention_bucket];
+    uint32_t *successful = &counters->retention_successful[sample->retention_bucket];
+    if (add) {
+        (*rating)++;
+        (*total)++;
+        *successful += success ? 1U : 0U;
+        latency_histogram_record(&counters->interval_minutes, sample->interval_value);
+        if (sample->answer_ms > 0U) {
+            latency_histogram_record(&counters->answer_ms, sample->answer_ms);
+        }
+        if (sample->elapsed_days > 0.0) {
+            forgetting_bins_record(&counters->curve, sample->elapsed_days, success);
+        }
+        return;
+    }
+
+    if (*rating == 0U || *total == 0U) {
+        return;
+    }
+    (*rating)--;
+    (*total)--;
+    if (success && *successful > 0U) {
+        (*successful)--;
+    }
+    latency_histogram_remove(&counters->interval_minutes, sample->interval_value);
+    if (sample->answer_ms > 0U) {
+        latency_histogram_remove(&counters->answer_ms, sample->answer_ms);
+    }
+    if (sample->elapsed_days > 0.0) {
+        forgetting_bins_remove(&counters->curve, sample->elapsed_days, success);
+    }
+}
+
+/*
+ * Adds or takes back one review of @p topic_id. Valid rollups are patched
+ * along the ancestor chain, so only a tree change forces a rebuild.
+ */
+static void topic_apply_review(struct AnalyticsHandle *handle,
+                               const char *topic_id,
+                               const HrAnalyticsTopicSample *sample,
+                               bool add)
+{
+    if (sample->rating < SRS_RESPONSE_FAIL || sample->rating > SRS_RESPONSE_CRAM) {
+        return;
+    }
+    HrAnalyticsTopicEntry *entry = add ? ensure_topic(handle, topic_id) : find_topic(handle, topic_id);
+    if (entry == NULL) {
+        return;
+    }
+    if (entry->own == NULL) {
+        if (!add) {
+            return;
+        }
+        entry->own = (HrAnalyticsTopicCounters *)calloc(1U, sizeof(*entry->own));
+        if (entry->own == NULL) {
+            return;
+        }
+    }
+
+    counters_apply(entry->own, sample, add);
+    if (!handle->rollups_valid) {
+        return;
+    }
+    for (size_t depth = 0; entry != NULL && depth < HR_ANALYTICS_MAX_TOPIC_DEPTH; ++depth) {
+        if (entry->rollup != NULL) {
+            counters_apply(entry->rollup, sample, add);
+        }
+        entry = topic_parent(handle, entry);
+    }
+}
+
+static void rebuild_topic_rollups(struct AnalyticsHandle *handle)
+{
+    for (size_t i = 0; i < handle->topic_capacity; ++i) {
+        if (handle->topics[i].rollup != NULL) {
+            memset(handle->topics[i].rollup, 0, sizeof(*handle->topics[i].rollup));
+        }
+    }
+    for (size_t i = 0; i < handle->topic_capacity; ++i) {
+        const HrAnalyticsTopicEntry *source = &handle->topics[i];
+        if (source->own == NULL || counters_total(source->own) == 0U) {
+            continue;
+        }
+        HrAnalyticsTopicEntry *entry = &handle->topics[i];
+        for (size_t depth = 0; entry != NULL && depth < HR_ANALYTICS_MAX_TOPIC_DEPTH; ++depth) {
+            if (entry->rollup != NULL) {
+                counters_merge(entry->rollup, source->own);
+            }
+            entry = topic_parent(handle, entry);
+        }
+    }
+    handle->rollups_valid = true;
+}
+
+static const HrAnalyticsTopicCounters *topic_counters(struct AnalyticsHandle *handle,
+                                                      const HrAnalyticsTopicEntry *entry,
+                                                      bool include_subtopics)
+{
+    static const HrAnalyticsTopicCounters kNoReviews;
+    if (!include_subtopics || entry->rollup == NULL) {
+        return (entry->own != NULL) ? entry->own : &kNoReviews;
+    }
+    if (!handle->rollups_valid) {
+        rebuild_topic_rollups(handle);
+    }
+    return entry->rollup;
+}
+
+/* Intervals are sketched in whole minutes. */
+static uint64_t interval_sketch_value(double minutes)
+{
+    return (minutes > 0.0 && !isnan(minutes)) ? (uint64_t)llround(minutes) : 0U;
+}
+
+/* Rounds an interval to whole days for the review store; negative or NaN gives 0. */
+static uint32_t whole_days(double days)
+{
+    if (!(days > 0.0)) {
+        return 0U;
+    }
+    return (days >= (double)UINT32_MAX) ? UINT32_MAX : (uint32_t)llround(days);
 }
 
 static time_t truncate_to_day(time_t timestamp)
@@ -74,6 +461,58 @@ static time_t truncate_to_day(time_t timestamp)
     return timestamp - seconds;
 }
 
+static size_t heatmap_slot(size_t capacity, time_t day_start)
+{
+    return (size_t)((uint64_t)(day_start / HR_ANALYTICS_SECONDS_PER_DAY) % capacity);
+}
+
+/* Whether @p day_start falls in the capacity days ending at the newest recorded day. */
+static bool heatmap_in_window(const HrAnalyticsDashboard *dashboard, time_t day_start)
+{
+    if (dashboard->heatmap_latest_day <= 0 || day_start > dashboard->heatmap_latest_day) {
+        return false;
+    }
+    const time_t age_days = (dashboard->heatmap_latest_day - day_start) / HR_ANALYTICS_SECONDS_PER_DAY;
+    return (size_t)age_days < dashboard->heatmap_capacity;
+}
+
+/* Moves the window forward to end at @p day_start, retiring the days that fall out of it. */
+static void advance_heatmap(struct AnalyticsHandle *handle, time_t day_start)
+{
+    HrAnalyticsDashboard *dashboard = &handle->dashboard;
+    const time_t previous = dashboard->heatmap_latest_day;
+    dashboard->heatmap_latest_day = day_start;
+    if (previous <= 0) {
+        return;
+    }
+
+    const size_t capacity = handle->heatmap_capacity;
+    const time_t shift_days = (day_start - previous) / HR_ANALYTICS_SECONDS_PER_DAY;
+    if ((uint64_t)shift_days >= (uint64_t)capacity) {
+        dashboard->heatmap_count = 0U;
+        return;
+    }
+
+    /* Slots are not cleared; a stale slot is recognised by its day not matching. */
+    const time_t oldest = previous - (time_t)(capacity - 1U) * HR_ANALYTICS_SECONDS_PER_DAY;
+    for (time_t i = 0; i < shift_days; ++i) {
+        const time_t retired = oldest + i * HR_ANALYTICS_SECONDS_PER_DAY;
+        if (handle->heatmap_ring[heatmap_slot(handle->heatmap_capacity, retired)].day_start_utc == retired &&
+            dashboard->heatmap_count > 0U) {
+            dashboard->heatmap_count--;
+        }
+    }
+}
+
+static HrAnalyticsHeatmapSample *find_heatmap_sample(struct AnalyticsHandle *handle, time_t day_start)
+{
+    if (handle == NULL || day_start <= 0 || !heatmap_in_window(&handle->dashboard, day_start)) {
+        return NULL;
+    }
+    HrAnalyticsHeatmapSample *sample = &handle->heatmap_ring[heatmap_slot(handle->heatmap_capacity, day_start)];
+    return (sample->day_start_utc == day_start) ? sample : NULL;
+}
+
 static HrAnalyticsHeatmapSample *ensure_heatmap_sample(struct AnalyticsHandle *handle, time_t day_start)
 {
     if (handle == NULL || day_start <= 0) {
@@ -81,52 +520,61 @@ static HrAnalyticsHeatmapSample *ensure_heatmap_sample(struct AnalyticsHandle *h
     }
 
     HrAnalyticsDashboard *dashboard = &handle->dashboard;
+    if (dashboard->heatmap_latest_day <= 0 || day_start > dashboard->heatmap_latest_day) {
+        advance_heatmap(handle, day_start);
+    } else if (!heatmap_in_window(dashboard, day_start)) {
+        return NULL;
+    }
 
-    for (size_t i = 0; i < dashboard->heatmap_count; ++i) {
-        if (dashboard->heatmap[i].day_start_utc == day_start) {
-            return &dashboard->heatmap[i];
-        }
+    HrAnalyticsHeatmapSample *sample = &handle->heatmap_ring[heatmap_slot(handle->heatmap_capacity, day_start)];
+    if (sample->day_start_utc != day_start) {
+        sample->day_start_utc = day_start;
+        sample->total_reviews = 0U;
+        sample->successful_reviews = 0U;
+        dashboard->heatmap_count++;
     }
+    return sample;
+}
 
-    if (dashboard->heatmap_count > 0) {
-        HrAnalyticsHeatmapSample *latest = &dashboard->heatmap[dashboard->heatmap_count - 1U];
-        if (day_start == latest->day_start_utc) {
-            return latest;
-        }
-        if (day_start < latest->day_start_utc) {
-            if (dashboard->heatmap_count == HR_ANALYTICS_MAX_HEATMAP_SAMPLES) {
-                return NULL;
-            }
-            size_t insert_index = dashboard->heatmap_count;
-            while (insert_index > 0U && dashboard->heatmap[insert_index - 1U].day_start_utc > day_start) {
-                insert_index--;
-            }
-            if (insert_index < dashboard->heatmap_count) {
-                memmove(&dashboard->heatmap[insert_index + 1U],
-                        &dashboard->heatmap[insert_index],
-                        (dashboard->heatmap_count - insert_index) * sizeof(HrAnalyticsHeatmapSample));
-            }
-            HrAnalyticsHeatmapSample *sample = &dashboard->heatmap[insert_index];
-            sample->day_start_utc = day_start;
-            sample->total_reviews = 0U;
-            sample->successful_reviews = 0U;
-            dashboard->heatmap_count++;
-            return sample;
-        }
+/*
+ * Replaces the ring with one of @p days slots, carrying over the days that
+ * still fit behind the newest one.
+ */
+static bool resize_heatmap(struct AnalyticsHandle *handle, unsigned int days)
+{
+    size_t capacity = (days == 0U) ? HR_ANALYTICS_DEFAULT_HEATMAP_DAYS : (size_t)days;
+    if (capacity > HR_ANALYTICS_MAX_HEATMAP_DAYS) {
+        capacity = HR_ANALYTICS_MAX_HEATMAP_DAYS;
+    }
+    if (capacity == handle->heatmap_capacity) {
+        return true;
     }
 
-    if (dashboard->heatmap_count == HR_ANALYTICS_MAX_HEATMAP_SAMPLES) {
-        memmove(&dashboard->heatmap[0],
-                &dashboard->heatmap[1],
-                (HR_ANALYTICS_MAX_HEATMAP_SAMPLES - 1U) * sizeof(HrAnalyticsHeatmapSample));
-        dashboard->heatmap_count--;
+    HrAnalyticsHeatmapSample *ring = (HrAnalyticsHeatmapSample *)calloc(capacity, sizeof(*ring));
+    if (ring == NULL) {
+        return false;
     }
 
-    HrAnalyticsHeatmapSample *sample = &dashboard->heatmap[dashboard->heatmap_count++];
-    sample->day_start_utc = day_start;
-    sample->total_reviews = 0U;
-    sample->successful_reviews = 0U;
-    return sample;
+    HrAnalyticsHeatmapSample *old_ring = handle->heatmap_ring;
+    const size_t old_capacity = handle->heatmap_capacity;
+    HrAnalyticsDashboard *dashboard = &handle->dashboard;
+    handle->heatmap_ring = ring;
+    handle->heatmap_capacity = capacity;
+    dashboard->heatmap = ring;
+    dashboard->heatmap_capacity = capacity;
+    dashboard->heatmap_count = 0U;
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+        const HrAnalyticsHeatmapSample *sample = &old_ring[i];
+        if (sample->day_start_utc > 0 && heatmap_in_window(dashboard, sample->day_start_utc) &&
+            old_capacity > (size_t)((dashboard->heatmap_latest_day - sample->day_start_utc) /
+                                    HR_ANALYTICS_SECONDS_PER_DAY)) {
+            ring[heatmap_slot(handle->heatmap_capacity, sample->day_start_utc)] = *sample;
+            dashboard->heatmap_count++;
+        }
+    }
+    free(old_ring);
+    return true;
 }
 
 static void update_streaks(struct AnalyticsHandle *handle, time_t day_start)
@@ -220,6 +668,13 @@ struct AnalyticsHandle *analytics_create(const HrAnalyticsConfig *config)
     }
 
     handle->enabled = config != NULL ? config->enabled : true;
+    if (!resize_heatmap(handle, config != NULL ? config->heatmap_days : 0U)) {
+        free(handle);
+        return NULL;
+    }
+    if (config != NULL && config->columnar_cache) {
+        handle->review_store = review_store_create();
+    }
     analytics_reset(handle);
     return handle;
 }
@@ -231,6 +686,9 @@ void analytics_shutdown(struct AnalyticsHandle *handle)
     }
 
     analytics_reset(handle);
+    free_topics(handle);
+    free(handle->heatmap_ring);
+    review_store_destroy(handle->review_store);
     free(handle);
 }
 
@@ -242,6 +700,17 @@ void analytics_apply_config(struct AnalyticsHandle *handle, const HrAnalyticsCon
 
     bool enabled = config != NULL ? config->enabled : true;
     analytics_set_enabled(handle, enabled);
+    /* On allocation failure the current ring stays in place. */
+    (void)resize_heatmap(handle, config != NULL ? config->heatmap_days : 0U);
+
+    /* A store enabled here starts empty; the next analytics_hydrate() fills it. */
+    const bool columnar = config != NULL && config->columnar_cache;
+    if (columnar && handle->review_store == NULL) {
+        handle->review_store = review_store_create();
+    } else if (!columnar && handle->review_store != NULL) {
+        review_store_destroy(handle->review_store);
+        handle->review_store = NULL;
+    }
 }
 
 void analytics_set_enabled(struct AnalyticsHandle *handle, bool enabled)
@@ -263,6 +732,38 @@ bool analytics_is_enabled(const struct AnalyticsHandle *handle)
     return handle != NULL && handle->enabled;
 }
 
+static void record_long_frame(HrAnalyticsFrameStats *frames, uint64_t frame_index, uint64_t micros,
+                              const uint64_t phase_micros[HR_FRAME_PHASE_COUNT])
+{
+    HrAnalyticsLongFrame entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.frame_index = frame_index;
+    entry.duration_ms = (double)micros / 1000.0;
+
+    /* A phase is blamed only when it covers a real share of the frame; otherwise the time went to
+     * unmeasured work such as painting or waiting on the event loop. */
+    entry.phase = HR_FRAME_PHASE_COUNT;
+    uint64_t dominant = micros / 4U;
+    for (size_t i = 0; i < HR_FRAME_PHASE_COUNT; ++i) {
+        entry.phase_ms[i] = (double)phase_micros[i] / 1000.0;
+        if (phase_micros[i] >= dominant && phase_micros[i] > 0U) {
+            dominant = phase_micros[i];
+            entry.phase = (HrFramePhase)i;
+        }
+    }
+
+    frames->long_frames++;
+    frames->long_frames_by_phase[entry.phase]++;
+    if (frames->recent_long_count < HR_ANALYTICS_LONG_FRAME_LOG) {
+        frames->recent_long[(frames->recent_long_start + frames->recent_long_count) % HR_ANALYTICS_LONG_FRAME_LOG] =
+            entry;
+        frames->recent_long_count++;
+    } else {
+        frames->recent_long[frames->recent_long_start] = entry;
+        frames->recent_long_start = (frames->recent_long_start + 1U) % HR_ANALYTICS_LONG_FRAME_LOG;
+    }
+}
+
 void analytics_record_frame(struct AnalyticsHandle *handle, const struct HrPlatformFrame *frame)
 {
     if (handle == NULL || frame == NULL || !handle->enabled) {
@@ -273,6 +774,36 @@ void analytics_record_frame(struct AnalyticsHandle *handle, const struct HrPlatf
     frames->frames_tracked++;
     frames->total_time_seconds += frame->delta_time;
     frames->last_frame_index = frame->index;
+    if (!(frame->delta_time > 0.0)) {
+        return;
+    }
+
+    /* Clamped to about an hour so the window can keep 32-bit samples. */
+    const uint64_t micros = (uint64_t)llround(fmin(frame->delta_time * 1.0e6, 4.0e9));
+    latency_histogram_record(&handle->frame_micros, micros);
+
+    /* Rolling window: the evicted frame leaves the window histogram as the new one enters. */
+    if (handle->frame_window_count == HR_ANALYTICS_FRAME_WINDOW) {
+        latency_histogram_remove(&handle->recent_frame_micros, handle->frame_window[handle->frame_window_next]);
+    } else {
+        handle->frame_window_count++;
+    }
+    handle->frame_window[handle->frame_window_next] = (uint32_t)micros;
+    handle->frame_window_next = (handle->frame_window_next + 1U) % HR_ANALYTICS_FRAME_WINDOW;
+    latency_histogram_record(&handle->recent_frame_micros, micros);
+
+    if (micros >= (uint64_t)HR_ANALYTICS_LONG_FRAME_MS * 1000U) {
+        record_long_frame(frames, frame->index, micros, frame->phase_micros);
+    }
+
+    summarize_quantiles(&handle->frame_micros, 1.0 / 1000.0, &frames->frame_time);
+    summarize_quantiles(&handle->recent_frame_micros, 1.0 / 1000.0, &frames->recent_frame_time);
+    /* The window's maximum is its own, not the lifetime maximum the histogram keeps. */
+    uint32_t window_max = 0U;
+    for (size_t i = 0; i < handle->frame_window_count; ++i) {
+        window_max = (handle->frame_window[i] > window_max) ? handle->frame_window[i] : window_max;
+    }
+    frames->recent_frame_time.max = (double)window_max / 1000.0;
 }
 
 void analytics_flush(struct AnalyticsHandle *handle)
@@ -281,38 +812,120 @@ void analytics_flush(struct AnalyticsHandle *handle)
         return;
     }
 
-    handle->dashboard.frames.frames_tracked = 0U;
-    handle->dashboard.frames.total_time_seconds = 0.0;
-    handle->dashboard.frames.last_frame_index = 0U;
+    reset_frame_stats(handle);
 }
 
-void analytics_record_review(struct AnalyticsHandle *handle, const struct SessionReviewEvent *event)
+/*
+ * Backs an undone review out of the totals it added to. Streaks, retention
+ * and the recent-interval window are not reversible from the event alone and
+ * are left as they are.
+ */
+static void analytics_retract_review(struct AnalyticsHandle *handle, const struct SessionReviewEvent *event)
 {
-    if (handle == NULL || event == NULL || !handle->enabled) {
+    HrAnalyticsReviewSummary *reviews = &handle->dashboard.reviews;
+    if (reviews->total_reviews == 0U) {
         return;
     }
+    reviews->total_reviews--;
+
+    SRSReviewRating rating = event->result.rating;
+    if (rating >= SRS_RESPONSE_FAIL && rating <= SRS_RESPONSE_CRAM && reviews->rating_counts[rating] > 0U) {
+        reviews->rating_counts[rating]--;
+    }
+
+    double interval_minutes = event->result.interval_minutes;
+    if (interval_minutes > 0.0 && !isnan(interval_minutes)) {
+        handle->interval_sum_minutes -= (double)(float)interval_minutes;
+        if (handle->interval_sum_minutes < 0.0) {
+            handle->interval_sum_minutes = 0.0;
+        }
+    }
+    reviews->average_interval_minutes = (reviews->total_reviews > 0U)
+                                            ? handle->interval_sum_minutes / (double)reviews->total_reviews
+                                            : 0.0;
+
+    /* Bucket counts come back out exactly; only the maxima stay where they were. */
+    const uint64_t interval_value = interval_sketch_value((double)(float)interval_minutes);
+    latency_histogram_remove(&handle->interval_minutes, interval_value);
+    if (event->answer_ms > 0U) {
+        latency_histogram_remove(&handle->answer_ms, event->answer_ms);
+    }
+    const HrAnalyticsTopicSample topic_sample = {
+        rating,
+        retention_bucket_index(event->result.previous_interval_days),
+        interval_value,
+        event->answer_ms,
+        event->result.previous_interval_days,
+    };
+    topic_apply_review(handle, event->context.topic.topic_id, &topic_sample, false);
+    curves_apply(handle,
+                 event->result.previous_interval_days,
+                 event->result.previous_ease_factor,
+                 rating >= SRS_RESPONSE_GOOD && rating <= SRS_RESPONSE_CRAM,
+                 false);
+    refresh_review_quantiles(handle);
+    refresh_forgetting_curves(handle);
 
+    time_t timestamp = (event->result.review_time > 0) ? event->result.review_time : event->context.now;
+    if (timestamp <= 0) {
+        return;
+    }
+    review_store_retract(handle->review_store, event->card_id, (int64_t)timestamp);
+    HrAnalyticsHeatmapSample *sample = find_heatmap_sample(handle, truncate_to_day(timestamp));
+    if (sample != NULL && sample->total_reviews > 0U) {
+        sample->total_reviews--;
+        if (rating >= SRS_RESPONSE_GOOD && rating <= SRS_RESPONSE_CRAM && sample->successful_reviews > 0U) {
+            sample->successful_reviews--;
+        }
+    }
+}
+
+/*
+ * Folds one review into every dashboard aggregate. Shared by live events and
+ * hydration so both paths produce the same totals.
+ */
+static void analytics_accumulate(struct AnalyticsHandle *handle,
+                                 time_t timestamp,
+                                 SRSReviewRating rating,
+                                 double scheduled_minutes,
+                                 double previous_interval_days,
+                                 double previous_ease_factor,
+                                 uint32_t answer_ms,
+                                 const char *topic_id)
+{
     HrAnalyticsReviewSummary *reviews = &handle->dashboard.reviews;
 
     reviews->total_reviews++;
 
-    SRSReviewRating rating = event->result.rating;
     if (rating >= SRS_RESPONSE_FAIL && rating <= SRS_RESPONSE_CRAM) {
         reviews->rating_counts[rating]++;
     }
 
-    float interval_minutes = (float)event->result.interval_minutes;
+    float interval_minutes = (float)scheduled_minutes;
     if (interval_minutes < 0.0f || isnan(interval_minutes)) {
         interval_minutes = 0.0f;
     }
 
     if (reviews->recent_count == HR_ANALYTICS_MAX_RECENT_INTERVALS) {
-        memmove(&reviews->recent_intervals[0],
-                &reviews->recent_intervals[1],
-                (HR_ANALYTICS_MAX_RECENT_INTERVALS - 1U) * sizeof(float));
-        reviews->recent_count--;
+        reviews->recent_intervals[reviews->recent_start] = interval_minutes;
+        reviews->recent_start = (reviews->recent_start + 1U) % HR_ANALYTICS_MAX_RECENT_INTERVALS;
+    } else {
+        reviews->recent_intervals[reviews->recent_count++] = interval_minutes;
+    }
+
+    const uint64_t interval_value = interval_sketch_value((double)interval_minutes);
+    latency_histogram_record(&handle->interval_minutes, interval_value);
+    if (answer_ms > 0U) {
+        latency_histogram_record(&handle->answer_ms, answer_ms);
     }
-    reviews->recent_intervals[reviews->recent_count++] = interval_minutes;
+    const HrAnalyticsTopicSample topic_sample = {
+        rating,
+        retention_bucket_index(previous_interval_days),
+        interval_value,
+        answer_ms,
+        previous_interval_days,
+    };
+    topic_apply_review(handle, topic_id, &topic_sample, true);
 
     handle->interval_sum_minutes += (double)interval_minutes;
     if (reviews->total_reviews > 0U) {
@@ -323,14 +936,6 @@ void analytics_record_review(struct AnalyticsHandle *handle, const struct Sessio
 
     bool success = rating >= SRS_RESPONSE_GOOD && rating <= SRS_RESPONSE_CRAM;
 
-    time_t timestamp = event->result.review_time;
-    if (timestamp <= 0) {
-        timestamp = event->context.now;
-    }
-    if (timestamp <= 0) {
-        timestamp = time(NULL);
-    }
-
     time_t day_start = truncate_to_day(timestamp);
     HrAnalyticsHeatmapSample *sample = ensure_heatmap_sample(handle, day_start);
     if (sample != NULL) {
@@ -341,7 +946,58 @@ void analytics_record_review(struct AnalyticsHandle *handle, const struct Sessio
     }
 
     update_streaks(handle, day_start);
-    update_retention(handle, event->result.previous_interval_days, success);
+    update_retention(handle, previous_interval_days, success);
+    curves_apply(handle, previous_interval_days, previous_ease_factor, success, true);
+}
+
+void analytics_record_review(struct AnalyticsHandle *handle, const struct SessionReviewEvent *event)
+{
+    if (handle == NULL || event == NULL || !handle->enabled) {
+        return;
+    }
+
+    /* Simulated (exam) reviews never reach the study statistics; exams keep their own tables. */
+    if (event->simulated) {
+        return;
+    }
+
+    if (event->undone) {
+        analytics_retract_review(handle, event);
+        return;
+    }
+
+    time_t timestamp = event->result.review_time;
+    if (timestamp <= 0) {
+        timestamp = event->context.now;
+    }
+    if (timestamp <= 0) {
+        timestamp = time(NULL);
+    }
+
+    analytics_accumulate(handle,
+                         timestamp,
+                         event->result.rating,
+                         event->result.interval_minutes,
+                         event->result.previous_interval_days,
+                         event->result.previous_ease_factor,
+                         event->answer_ms,
+                         event->context.topic.topic_id);
+    refresh_review_quantiles(handle);
+    refresh_forgetting_curves(handle);
+
+    if (handle->review_store != NULL) {
+        /* Whole days, as the review log stores them, so live rows match hydrated ones. */
+        const HrReviewRow row = {
+            event->card_id,
+            (int64_t)timestamp,
+            (int)event->result.rating,
+            event->answer_ms,
+            whole_days(event->result.interval_minutes / (double)HR_ANALYTICS_MINUTES_PER_DAY),
+            whole_days(event->result.previous_interval_days),
+            event->context.topic.topic_id,
+        };
+        review_store_append(handle->review_store, &row);
+    }
 }
 
 void analytics_record_session_event(const struct SessionReviewEvent *event, void *user_data)
@@ -352,6 +1008,380 @@ void analytics_record_session_event(const struct SessionReviewEvent *event, void
     analytics_record_review((struct AnalyticsHandle *)user_data, event);
 }
 
+/* Card id -> ease after its latest logged review; only lives for one hydration. */
+typedef struct HrAnalyticsCardEase {
+    uint64_t card_id; /* 0 marks an unused slot. */
+    double ease_factor;
+} HrAnalyticsCardEase;
+
+typedef struct HrAnalyticsEaseTable {
+    HrAnalyticsCardEase *slots; /* Open-addressed; capacity is a power of two. */
+    size_t capacity;
+    size_t count;
+} HrAnalyticsEaseTable;
+
+static HrAnalyticsCardEase *ease_table_probe(HrAnalyticsCardEase *slots, size_t capacity, uint64_t card_id)
+{
+    uint64_t hash = card_id * 0x9E3779B97F4A7C15ULL;
+    size_t index = (size_t)(hash ^ (hash >> 32U)) & (capacity - 1U);
+    while (slots[index].card_id != 0U && slots[index].card_id != card_id) {
+        index = (index + 1U) & (capacity - 1U);
+    }
+    return &slots[index];
+}
+
+/* Returns the ease slot of @p card_id (0 when new), or NULL when it cannot be added. */
+static double *ease_table_slot(HrAnalyticsEaseTable *table, uint64_t card_id)
+{
+    if (card_id == 0U) {
+        return NULL;
+    }
+    if ((table->count + 1U) * 4U > table->capacity * 3U) {
+        const size_t capacity = (table->capacity == 0U) ? 1024U : table->capacity * 2U;
+        HrAnalyticsCardEase *slots = (HrAnalyticsCardEase *)calloc(capacity, sizeof(*slots));
+        if (slots == NULL) {
+            return NULL;
+        }
+        for (size_t i = 0; i < table->capacity; ++i) {
+            if (table->slots[i].card_id != 0U) {
+                *ease_table_probe(slots, capacity, table->slots[i].card_id) = table->slots[i];
+            }
+        }
+        free(table->slots);
+        table->slots = slots;
+        table->capacity = capacity;
+    }
+
+    HrAnalyticsCardEase *slot = ease_table_probe(table->slots, table->capacity, card_id);
+    if (slot->card_id == 0U) {
+        slot->card_id = card_id;
+        slot->ease_factor = 0.0;
+        table->count++;
+    }
+    return &slot->ease_factor;
+}
+
+bool analytics_hydrate(struct AnalyticsHandle *handle, struct DatabaseHandle *database)
+{
+    if (handle == NULL || database == NULL) {
+        return false;
+    }
+    if (!handle->enabled) {
+        return true;
+    }
+
+    analytics_reset(handle);
+    if (!analytics_load_topics(handle, database)) {
+        return false;
+    }
+
+    sqlite3_stmt *statement = NULL;
+    if (db_review_prepare_select_log(database, &statement) != SQLITE_OK) {
+        return false;
+    }
+
+    HrAnalyticsEaseTable eases = {NULL, 0U, 0U};
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
+        const time_t reviewed_at = (time_t)sqlite3_column_int64(statement, 0);
+        const int rating = sqlite3_column_int(statement, 1);
+        const double scheduled_days = (double)sqlite3_column_int(statement, 2);
+        const double actual_days = (double)sqlite3_column_int(statement, 3);
+        const int duration_ms = sqlite3_column_int(statement, 4);
+        const char *topic_id = (const char *)sqlite3_column_text(statement, 5);
+        const uint64_t card_id = (uint64_t)sqlite3_column_int64(statement, 6);
+        const double logged_ease = (double)sqlite3_column_int(statement, 7) / 100.0;
+        if (reviewed_at <= 0 || rating < SRS_RESPONSE_FAIL || rating > SRS_RESPONSE_CRAM) {
+            continue;
+        }
+        /* The log keeps the ease after each review; the one a review started from is the card's last. */
+        double previous_ease = logged_ease;
+        double *card_ease = ease_table_slot(&eases, card_id);
+        if (card_ease != NULL) {
+            if (*card_ease > 0.0) {
+                previous_ease = *card_ease;
+            }
+            *card_ease = logged_ease;
+        }
+        if (handle->review_store != NULL) {
+            const HrReviewRow row = {
+                card_id,
+                (int64_t)reviewed_at,
+                rating,
+                (duration_ms > 0) ? (uint32_t)duration_ms : 0U,
+                whole_days(scheduled_days),
+                whole_days(actual_days),
+                topic_id,
+            };
+            review_store_append(handle->review_store, &row);
+        }
+        analytics_accumulate(handle,
+                             reviewed_at,
+                             (SRSReviewRating)rating,
+                             scheduled_days * (double)HR_ANALYTICS_MINUTES_PER_DAY,
+                             actual_days,
+                             previous_ease,
+                             (duration_ms > 0) ? (uint32_t)duration_ms : 0U,
+                             topic_id);
+    }
+    sqlite3_finalize(statement);
+    free(eases.slots);
+
+    if (rc != SQLITE_DONE) {
+        analytics_reset(handle);
+        return false;
+    }
+    refresh_review_quantiles(handle);
+    refresh_forgetting_curves(handle);
+    return true;
+}
+
+void analytics_record_input_latency(struct AnalyticsHandle *handle, uint64_t micros)
+{
+    if (handle == NULL || !handle->enabled) {
+        return;
+    }
+
+    latency_histogram_record(&handle->input_latency, micros);
+    summarize_quantiles(&handle->input_latency, 1.0 / 1000.0, &handle->dashboard.input_latency);
+}
+
+void analytics_set_topic(struct AnalyticsHandle *handle, const char *topic_id, const char *parent_id, const char *title)
+{
+    if (handle == NULL) {
+        return;
+    }
+
+    HrAnalyticsTopicEntry *entry = ensure_topic(handle, topic_id);
+    if (entry == NULL) {
+        return;
+    }
+    if (title != NULL) {
+        strncpy(entry->title, title, sizeof(entry->title) - 1U);
+        entry->title[sizeof(entry->title) - 1U] = '\0';
+    }
+
+    const char *parent = (parent_id != NULL && strcmp(parent_id, topic_id) != 0) ? parent_id : "";
+    if (strcmp(entry->parent_id, parent) == 0) {
+        return;
+    }
+
+    HrAnalyticsTopicEntry *parent_entry = NULL;
+    if (parent[0] != '\0') {
+        parent_entry = ensure_topic(handle, parent);
+        if (parent_entry == NULL) {
+            return;
+        }
+        /* ensure_topic() may have moved the table. */
+        entry = find_topic(handle, topic_id);
+        if (parent_entry->rollup == NULL) {
+            parent_entry->rollup = (HrAnalyticsTopicCounters *)calloc(1U, sizeof(*parent_entry->rollup));
+            if (parent_entry->rollup == NULL) {
+                return;
+            }
+        }
+    }
+    strcpy(entry->parent_id, parent);
+    handle->rollups_valid = false;
+}
+
+bool analytics_load_topics(struct AnalyticsHandle *handle, struct DatabaseHandle *database)
+{
+    if (handle == NULL || database == NULL) {
+        return false;
+    }
+
+    sqlite3_stmt *statement = NULL;
+    if (db_topic_prepare_select_tree(database, &statement) != SQLITE_OK) {
+        return false;
+    }
+
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
+        analytics_set_topic(handle,
+                            (const char *)sqlite3_column_text(statement, 0),
+                            (const char *)sqlite3_column_text(statement, 1),
+                            (const char *)sqlite3_column_text(statement, 2));
+    }
+    sqlite3_finalize(statement);
+    return rc == SQLITE_DONE;
+}
+
+static void fill_topic_summary(const HrAnalyticsTopicEntry *entry,
+                               const HrAnalyticsTopicCounters *counters,
+                               bool include_subtopics,
+                               HrAnalyticsTopicSummary *out)
+{
+    memset(out, 0, sizeof(*out));
+    memcpy(out->topic_id, entry->topic_id, sizeof(out->topic_id));
+    memcpy(out->title, entry->title, sizeof(out->title));
+    out->includes_subtopics = include_subtopics && entry->rollup != NULL;
+    out->total_reviews = counters_total(counters);
+    out->successful_reviews = counters_successful(counters);
+    out->success_rate = (out->total_reviews > 0U) ? (double)out->successful_reviews / (double)out->total_reviews
+                                                  : 0.0;
+    memcpy(out->rating_counts, counters->rating_counts, sizeof(out->rating_counts));
+    for (size_t i = 0; i < HR_ANALYTICS_RETENTION_BUCKETS; ++i) {
+        HrAnalyticsRetentionSample *bucket = &out->retention[i];
+        bucket->min_interval_days = kRetentionBuckets[i].min_days;
+        bucket->max_interval_days = kRetentionBuckets[i].max_days;
+        bucket->total_reviews = counters->retention_total[i];
+        bucket->successful_reviews = counters->retention_successful[i];
+        bucket->success_rate = (bucket->total_reviews > 0U)
+                                   ? (double)bucket->successful_reviews / (double)bucket->total_reviews
+                                   : 0.0;
+    }
+    summarize_quantiles(&counters->answer_ms, 1.0, &out->answer_time);
+    summarize_quantiles(&counters->interval_minutes, 1.0 / (double)HR_ANALYTICS_MINUTES_PER_DAY,
+                        &out->scheduled_interval);
+    forgetting_fit(&counters->curve, &out->forgetting_curve);
+}
+
+bool analytics_topic_summary(struct AnalyticsHandle *handle,
+                             const char *topic_id,
+                             bool include_subtopics,
+                             HrAnalyticsTopicSummary *out_summary)
+{
+    if (handle == NULL || out_summary == NULL) {
+        return false;
+    }
+
+    const HrAnalyticsTopicEntry *entry = find_topic(handle, topic_id);
+    if (entry == NULL) {
+        return false;
+    }
+    fill_topic_summary(entry, topic_counters(handle, entry, include_subtopics), include_subtopics, out_summary);
+    return true;
+}
+
+size_t analytics_weakest_topics(struct AnalyticsHandle *handle,
+                                size_t min_reviews,
+                                HrAnalyticsTopicSummary *out_summaries,
+                                size_t max_summaries)
+{
+    if (handle == NULL || out_summaries == NULL || max_summaries == 0U) {
+        return 0U;
+    }
+
+    /* Keep the weakest few in order as the table is scanned; the output array doubles as scratch. */
+    size_t found = 0U;
+    for (size_t i = 0; i < handle->topic_capacity; ++i) {
+        const HrAnalyticsTopicEntry *entry = &handle->topics[i];
+        if (entry->topic_id[0] == '\0') {
+            continue;
+        }
+        const HrAnalyticsTopicCounters *counters = topic_counters(handle, entry, true);
+        const uint64_t total = counters_total(counters);
+        if (total == 0U || total < (uint64_t)min_reviews) {
+            continue;
+        }
+        const double rate = (double)counters_successful(counters) / (double)total;
+
+        size_t position = found;
+        while (position > 0U && (out_summaries[position - 1U].success_rate > rate ||
+                                 (out_summaries[position - 1U].success_rate == rate &&
+                                  out_summaries[position - 1U].total_reviews < total))) {
+            --position;
+        }
+        if (position >= max_summaries) {
+            continue;
+        }
+        const size_t kept = (found < max_summaries) ? found : max_summaries - 1U;
+        memmove(&out_summaries[position + 1U], &out_summaries[position], (kept - position) * sizeof(*out_summaries));
+        /* Only the ranking keys for now; the full summary is filled once the winners are known. */
+        memcpy(out_summaries[position].topic_id, entry->topic_id, sizeof(entry->topic_id));
+        out_summaries[position].success_rate = rate;
+        out_summaries[position].total_reviews = total;
+        if (found < max_summaries) {
+            ++found;
+        }
+    }
+
+    for (size_t i = 0; i < found; ++i) {
+        const HrAnalyticsTopicEntry *entry = find_topic(handle, out_summaries[i].topic_id);
+        fill_topic_summary(entry, topic_counters(handle, entry, true), true, &out_summaries[i]);
+    }
+    return found;
+}
+
+double analytics_topic_weight(const char *topic_id, void *user_data)
+{
+    struct AnalyticsHandle *handle = (struct AnalyticsHandle *)user_data;
+    const HrAnalyticsTopicEntry *entry = (handle != NULL) ? find_topic(handle, topic_id) : NULL;
+    if (entry == NULL) {
+        return 1.0;
+    }
+
+    const HrAnalyticsTopicCounters *counters = topic_counters(handle, entry, true);
+    const uint64_t total = counters_total(counters);
+    if (total < HR_ANALYTICS_TOPIC_WEIGHT_MIN_REVIEWS) {
+        return 1.0;
+    }
+    return 2.0 - (double)counters_successful(counters) / (double)total;
+}
+
+size_t analytics_ease_band(double ease_factor)
+{
+    for (size_t band = 0; band < HR_ANALYTICS_EASE_BANDS - 1U; ++band) {
+        if (ease_factor < kEaseBandUpper[band]) {
+            return band;
+        }
+    }
+    return HR_ANALYTICS_EASE_BANDS - 1U;
+}
+
+double analytics_interval_modifier(const struct AnalyticsHandle *handle, double ease_factor)
+{
+    if (handle == NULL || !handle->enabled) {
+        return 1.0;
+    }
+
+    const HrForgettingCurve *curve = &handle->dashboard.ease_curves[analytics_ease_band(ease_factor)];
+    if (curve->model == HR_FORGETTING_NONE || curve->samples < HR_ANALYTICS_CALIBRATION_MIN_REVIEWS) {
+        curve = &handle->dashboard.forgetting_curve;
+    }
+    if (curve->model == HR_FORGETTING_NONE || curve->samples < HR_ANALYTICS_CALIBRATION_MIN_REVIEWS) {
+        return 1.0;
+    }
+
+    /* Retention the cohort actually reached at its typical interval, against the target. */
+    const double retention = forgetting_curve_retention(curve, curve->mean_elapsed_days);
+    if (!(retention > 0.0 && retention < 1.0)) {
+        return 1.0;
+    }
+    const double modifier = log(SRS_TARGET_RECALL) / log(retention);
+    if (modifier < HR_ANALYTICS_MIN_INTERVAL_MODIFIER) {
+        return HR_ANALYTICS_MIN_INTERVAL_MODIFIER;
+    }
+    return (modifier > HR_ANALYTICS_MAX_INTERVAL_MODIFIER) ? HR_ANALYTICS_MAX_INTERVAL_MODIFIER : modifier;
+}
+
+double analytics_calibrate_interval(const SRSState *state, double proposed_interval_days, void *user_data)
+{
+    if (state == NULL || user_data == NULL) {
+        return proposed_interval_days;
+    }
+    return proposed_interval_days * analytics_interval_modifier((const struct AnalyticsHandle *)user_data,
+                                                                state->ease_factor);
+}
+
+const struct HrReviewStore *analytics_review_store(const struct AnalyticsHandle *handle)
+{
+    return (handle != NULL) ? handle->review_store : NULL;
+}
+
+const HrAnalyticsHeatmapSample *analytics_heatmap_day(const HrAnalyticsDashboard *dashboard, time_t day_start)
+{
+    if (dashboard == NULL || dashboard->heatmap == NULL || dashboard->heatmap_capacity == 0U || day_start <= 0 ||
+        !heatmap_in_window(dashboard, day_start)) {
+        return NULL;
+    }
+
+    const size_t slot = heatmap_slot(dashboard->heatmap_capacity, day_start);
+    const HrAnalyticsHeatmapSample *sample = &dashboard->heatmap[slot];
+    return (sample->day_start_utc == day_start) ? sample : NULL;
+}
+
 const HrAnalyticsDashboard *analytics_dashboard(const struct AnalyticsHandle *handle)
 {
     if (handle == NULL) {
@@ -16,9 +16,13 @@ extern "C" {
 #include <time.h>
 
 #include "cfg.h"
+#include "forgetting.h"
+#include "frame_profile.h"
 #include "srs.h"
 
+struct DatabaseHandle;
 struct HrPlatformFrame;
+struct HrReviewStore;
 struct SessionReviewEvent;
 
 /** Number of rating buckets captured for review analytics. */
@@ -27,17 +31,68 @@ struct SessionReviewEvent;
 /** Number of samples retained when plotting recent review intervals. */
 #define HR_ANALYTICS_MAX_RECENT_INTERVALS 64U
 
-/** Maximum number of daily buckets captured for the heatmap view. */
-#define HR_ANALYTICS_MAX_HEATMAP_SAMPLES 365U
+/** Days kept by the activity heatmap when the configuration does not say. */
+#define HR_ANALYTICS_DEFAULT_HEATMAP_DAYS 365U
+
+/** Upper bound on the configurable heatmap length (about a century). */
+#define HR_ANALYTICS_MAX_HEATMAP_DAYS 36525U
 
 /** Number of buckets used when computing retention/forgetting curves. */
 #define HR_ANALYTICS_RETENTION_BUCKETS 5U
 
-/** Tracks basic frame timing statistics for performance dashboards. */
+/** Ease-factor cohorts with their own forgetting curve: below 1.8, 1.8-2.3, 2.3-2.8, and above. */
+#define HR_ANALYTICS_EASE_BANDS 4U
+
+/** Reviews a cohort needs before its curve calibrates scheduled intervals. */
+#define HR_ANALYTICS_CALIBRATION_MIN_REVIEWS 200U
+
+/** Frames at least this long (ms) are counted and logged as long frames. */
+#define HR_ANALYTICS_LONG_FRAME_MS 50U
+
+/** Frames covered by the rolling frame-time percentiles (about ten seconds at 60 FPS). */
+#define HR_ANALYTICS_FRAME_WINDOW 600U
+
+/** Most recent long frames kept for inspection. */
+#define HR_ANALYTICS_LONG_FRAME_LOG 16U
+
+/** Reviews a topic needs before analytics_topic_weight() moves off 1.0. */
+#define HR_ANALYTICS_TOPIC_WEIGHT_MIN_REVIEWS 20U
+
+/** Longest topic identifier tracked per topic, including the terminator. */
+#define HR_ANALYTICS_MAX_TOPIC_ID 64U
+
+/** Topic titles are kept (truncated) to this many bytes for display. */
+#define HR_ANALYTICS_MAX_TOPIC_TITLE 96U
+
+/** Percentiles of a sketched distribution; the unit is given where it is used. */
+typedef struct HrAnalyticsQuantiles {
+    uint64_t samples; /**< Values sketched. */
+    double p50;
+    double p90;
+    double p99;
+    double max;
+} HrAnalyticsQuantiles;
+
+/** A frame of at least HR_ANALYTICS_LONG_FRAME_MS and where its time went. */
+typedef struct HrAnalyticsLongFrame {
+    uint64_t frame_index;
+    double duration_ms;
+    HrFramePhase phase;                       /**< Phase that took the most time; HR_FRAME_PHASE_COUNT when none took a quarter of the frame. */
+    double phase_ms[HR_FRAME_PHASE_COUNT];    /**< Time measured in each phase. */
+} HrAnalyticsLongFrame;
+
+/** Tracks frame timing statistics for performance dashboards. */
 typedef struct HrAnalyticsFrameStats {
     uint64_t frames_tracked;      /**< Total frames sampled while analytics was enabled. */
     double total_time_seconds;    /**< Wall-clock time corresponding to the sampled frames. */
     uint64_t last_frame_index;    /**< Index of the last processed frame. */
+    HrAnalyticsQuantiles frame_time;                        /**< Every sampled frame (ms). */
+    HrAnalyticsQuantiles recent_frame_time;                 /**< Last HR_ANALYTICS_FRAME_WINDOW frames (ms). */
+    uint64_t long_frames;                                   /**< Frames of at least HR_ANALYTICS_LONG_FRAME_MS. */
+    uint64_t long_frames_by_phase[HR_FRAME_PHASE_COUNT + 1U]; /**< By HrAnalyticsLongFrame::phase. */
+    HrAnalyticsLongFrame recent_long[HR_ANALYTICS_LONG_FRAME_LOG]; /**< Ring of the latest long frames. */
+    size_t recent_long_count;                               /**< Active length of @p recent_long. */
+    size_t recent_long_start;                               /**< Index of the oldest entry in the ring. */
 } HrAnalyticsFrameStats;
 
 /** Aggregates review activity metrics used by multiple dashboards. */
@@ -45,8 +100,9 @@ typedef struct HrAnalyticsReviewSummary {
     size_t total_reviews;                                      /**< Total number of reviews captured. */
     size_t rating_counts[HR_ANALYTICS_RATING_BUCKETS];         /**< Distribution of responses. */
     double average_interval_minutes;                           /**< Mean interval scheduled by the SRS. */
-    float recent_intervals[HR_ANALYTICS_MAX_RECENT_INTERVALS]; /**< Sliding window of recent intervals. */
+    float recent_intervals[HR_ANALYTICS_MAX_RECENT_INTERVALS]; /**< Ring of recent intervals (minutes). */
     size_t recent_count;                                       /**< Active length of @p recent_intervals. */
+    size_t recent_start;                                       /**< Index of the oldest entry in the ring. */
 } HrAnalyticsReviewSummary;
 
 /** Represents a single day inside the activity heatmap. */
@@ -73,15 +129,37 @@ typedef struct HrAnalyticsRetentionSample {
     uint32_t successful_reviews; /**< Successful reviews contributing to @p success_rate. */
 } HrAnalyticsRetentionSample;
 
+/** Review statistics of one topic, optionally rolled up over its subtopics. */
+typedef struct HrAnalyticsTopicSummary {
+    char topic_id[HR_ANALYTICS_MAX_TOPIC_ID];
+    char title[HR_ANALYTICS_MAX_TOPIC_TITLE];
+    bool includes_subtopics;                                    /**< True when descendants are counted in. */
+    uint64_t total_reviews;
+    uint64_t successful_reviews;                                /**< Reviews rated GOOD/EASY/CRAM. */
+    double success_rate;
+    uint32_t rating_counts[HR_ANALYTICS_RATING_BUCKETS];
+    HrAnalyticsRetentionSample retention[HR_ANALYTICS_RETENTION_BUCKETS];
+    HrAnalyticsQuantiles answer_time;                           /**< Timed reviews (ms). */
+    HrAnalyticsQuantiles scheduled_interval;                    /**< Days. */
+    HrForgettingCurve forgetting_curve;                         /**< Fitted over the same reviews. */
+} HrAnalyticsTopicSummary;
+
 /** Aggregate view combining all analytics surfaces exposed to the UI. */
 typedef struct HrAnalyticsDashboard {
     HrAnalyticsFrameStats frames;                                        /**< Frame timing metrics. */
     HrAnalyticsReviewSummary reviews;                                    /**< Review activity summary. */
     HrAnalyticsStreakMetrics streaks;                                    /**< Streak information. */
-    HrAnalyticsHeatmapSample heatmap[HR_ANALYTICS_MAX_HEATMAP_SAMPLES];  /**< Heatmap day buckets. */
-    size_t heatmap_count;                                                /**< Active heatmap entries. */
+    const HrAnalyticsHeatmapSample *heatmap;                             /**< Day ring; read through analytics_heatmap_day(). */
+    size_t heatmap_capacity;                                             /**< Days the ring covers. */
+    size_t heatmap_count;                                                /**< Days with activity inside the window. */
+    time_t heatmap_latest_day;                                           /**< Newest day in the window (0 when empty). */
     HrAnalyticsRetentionSample retention[HR_ANALYTICS_RETENTION_BUCKETS];/**< Retention curve buckets. */
     size_t retention_count;                                              /**< Active retention buckets. */
+    HrAnalyticsQuantiles input_latency;                                  /**< Review keypress to next card painted (ms). */
+    HrAnalyticsQuantiles answer_time;                                    /**< Time taken to answer timed reviews (ms). */
+    HrAnalyticsQuantiles scheduled_interval;                             /**< Intervals the scheduler assigned (days). */
+    HrForgettingCurve forgetting_curve;                                  /**< Fitted over every repeat review. */
+    HrForgettingCurve ease_curves[HR_ANALYTICS_EASE_BANDS];              /**< Per ease band, by the ease reviews started from. */
 } HrAnalyticsDashboard;
 
 struct AnalyticsHandle;
@@ -101,7 +179,12 @@ void analytics_set_enabled(struct AnalyticsHandle *handle, bool enabled);
 /** Returns whether analytics capture is currently enabled. */
 bool analytics_is_enabled(const struct AnalyticsHandle *handle);
 
-/** Records frame timing metrics for performance analytics. */
+/**
+ * Records frame timing metrics for performance analytics. Frames of
+ * HR_ANALYTICS_LONG_FRAME_MS or more are attributed to the phase that
+ * dominated them, using the phase totals platform_begin_frame() took over
+ * the same interval as the frame's delta_time.
+ */
 void analytics_record_frame(struct AnalyticsHandle *handle, const struct HrPlatformFrame *frame);
 
 /** Resets transient frame statistics accumulated during the main loop. */
@@ -113,6 +196,91 @@ void analytics_record_review(struct AnalyticsHandle *handle, const struct Sessio
 /** Convenience wrapper matching the session_manager analytics callback signature. */
 void analytics_record_session_event(const struct SessionReviewEvent *event, void *user_data);
 
+/**
+ * Rebuilds the dashboard from the persisted review log in one pass over the
+ * reviews table, replacing whatever was recorded so far. Call once at
+ * startup, before live events are delivered; analytics_record_review() keeps
+ * it current from then on. Intervals come back at the log's whole-day
+ * precision. Returns false (leaving the dashboard empty) on a database error.
+ */
+bool analytics_hydrate(struct AnalyticsHandle *handle, struct DatabaseHandle *database);
+
+/**
+ * Places @p topic_id under @p parent_id (NULL or empty for a root) and sets
+ * its display title (NULL keeps the current one). Invalidates the cached
+ * subtree rollups when the tree changes.
+ */
+void analytics_set_topic(struct AnalyticsHandle *handle, const char *topic_id, const char *parent_id, const char *title);
+
+/** Loads the whole topic tree from the topics table through analytics_set_topic(). */
+bool analytics_load_topics(struct AnalyticsHandle *handle, struct DatabaseHandle *database);
+
+/**
+ * Fills @p out_summary for one topic, counting its subtopics too when
+ * @p include_subtopics is set. Subtree rollups are cached; reviews keep them
+ * current and only a tree change makes the next query rebuild them. Returns
+ * false for an unknown topic.
+ */
+bool analytics_topic_summary(struct AnalyticsHandle *handle,
+                             const char *topic_id,
+                             bool include_subtopics,
+                             HrAnalyticsTopicSummary *out_summary);
+
+/**
+ * Writes up to @p max_summaries topics with the lowest subtree success rate,
+ * weakest first, skipping topics with fewer than @p min_reviews reviews.
+ * Returns the number written. One pass over the topic table, no SQL.
+ */
+size_t analytics_weakest_topics(struct AnalyticsHandle *handle,
+                                size_t min_reviews,
+                                HrAnalyticsTopicSummary *out_summaries,
+                                size_t max_summaries);
+
+/**
+ * Topic weight for the study planner (an HrPlannerTopicWeightFn taking the
+ * analytics handle as @p user_data): 2 minus the topic's subtree success rate,
+ * so the weakest topics count up to twice as much. Topics with fewer than
+ * HR_ANALYTICS_TOPIC_WEIGHT_MIN_REVIEWS reviews, and unknown ones, weigh 1.0.
+ */
+double analytics_topic_weight(const char *topic_id, void *user_data);
+
+/** Returns the ease band (index into HrAnalyticsDashboard::ease_curves) of @p ease_factor. */
+size_t analytics_ease_band(double ease_factor);
+
+/**
+ * Returns the factor that would bring reviews of the @p ease_factor band to
+ * SRS_TARGET_RECALL: ln(target) / ln(predicted retention at the band's mean
+ * interval), clamped to 0.5..2. Falls back to the overall curve when the band
+ * has fewer than HR_ANALYTICS_CALIBRATION_MIN_REVIEWS, and to 1 when that
+ * has too few as well.
+ */
+double analytics_interval_modifier(const struct AnalyticsHandle *handle, double ease_factor);
+
+/**
+ * srs_interval_calibration_hook that scales @p proposed_interval_days by
+ * analytics_interval_modifier() for the card's ease. @p user_data is the
+ * analytics handle; call from the thread that delivers review events.
+ */
+double analytics_calibrate_interval(const SRSState *state, double proposed_interval_days, void *user_data);
+
+/** Records one review keypress-to-next-card-painted latency sample. */
+void analytics_record_input_latency(struct AnalyticsHandle *handle, uint64_t micros);
+
+/**
+ * Returns the heatmap entry for the UTC day starting at @p day_start, or NULL
+ * when nothing was recorded that day or it has left the window (the
+ * heatmap_capacity days ending at heatmap_latest_day). O(1).
+ */
+const HrAnalyticsHeatmapSample *analytics_heatmap_day(const HrAnalyticsDashboard *dashboard, time_t day_start);
+
+/**
+ * Returns the column store of the review log for review_store_count() and
+ * review_store_group() queries, or NULL unless HrAnalyticsConfig enables
+ * @c columnar_cache. analytics_hydrate() fills it alongside the dashboard
+ * and review events keep it current. Same threading rules as the dashboard.
+ */
+const struct HrReviewStore *analytics_review_store(const struct AnalyticsHandle *handle);
+
 /** Returns an immutable snapshot of the aggregated analytics dashboard. */
 const HrAnalyticsDashboard *analytics_dashboard(const struct AnalyticsHandle *handle);
 
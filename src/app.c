@@ -11,6 +11,7 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 
 #if defined(_WIN32)
 #include <direct.h>
@@ -23,10 +24,18 @@
 #include "analytics.h"
 #include "cfg.h"
 #include "db.h"
+#include "event_bus.h"
+#include "media.h"
+#include "metrics_export.h"
+#include "planner.h"
 #include "platform.h"
+#include "prefetch.h"
+#include "session_registry.h"
 #include "sessions.h"
+#include "span_trace.h"
 #include "srs.h"
 #include "theme.h"
+#include "trace_ring.h"
 #include "ui.h"
 
 // Define color constants for Qt backend compatibility
@@ -40,14 +49,61 @@
 #define PATH_MAX 4096
 #endif
 
+/** Number of future days tracked by the due-date load balancer. */
+#define APP_LOAD_BALANCER_HORIZON_DAYS 400U
+
 struct SrsHandle {
     double time_accumulator;
     uint64_t updates_processed;
+    SRSLoadBalancer *load_balancer;
 };
 
-static struct SrsHandle *srs_initialize(void)
+static void srs_seed_load_balancer(SRSLoadBalancer *balancer, DatabaseHandle *database)
+{
+    if (balancer == NULL || database == NULL) {
+        return;
+    }
+
+    const time_t now = time(NULL);
+    srs_load_balancer_reset(balancer, now);
+
+    /* Cards due earlier today are still in today's slot and come out of it when graded. */
+    const sqlite3_int64 day_start = ((sqlite3_int64)now / 86400) * 86400;
+    HrDueHistogramQuery query = {
+        .start_at = day_start,
+        .end_at = day_start + (sqlite3_int64)APP_LOAD_BALANCER_HORIZON_DAYS * 86400,
+    };
+
+    sqlite3_stmt *stmt = NULL;
+    if (db_card_prepare_due_histogram(database, &stmt) != SQLITE_OK) {
+        return;
+    }
+
+    if (db_card_bind_due_histogram(stmt, &query) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const sqlite3_int64 day = sqlite3_column_int64(stmt, 0);
+            const sqlite3_int64 count = sqlite3_column_int64(stmt, 1);
+            if (count > 0) {
+                srs_load_balancer_add(balancer,
+                                      (time_t)(day * 86400),
+                                      count > (sqlite3_int64)UINT32_MAX ? UINT32_MAX : (uint32_t)count);
+            }
+        }
+    }
+
+    sqlite3_finalize(stmt);
+}
+
+static struct SrsHandle *srs_initialize(DatabaseHandle *database)
 {
-    return calloc(1U, sizeof(struct SrsHandle));
+    struct SrsHandle *srs = calloc(1U, sizeof(struct SrsHandle));
+    if (srs == NULL) {
+        return NULL;
+    }
+
+    srs->load_balancer = srs_load_balancer_create(APP_LOAD_BALANCER_HORIZON_DAYS);
+    srs_seed_load_balancer(srs->load_balancer, database);
+    return srs;
 }
 
 static bool srs_update(struct SrsHandle *srs, const HrPlatformFrame *frame)
@@ -58,11 +114,18 @@ static bool srs_update(struct SrsHandle *srs, const HrPlatformFrame *frame)
 
     srs->time_accumulator += frame->delta_time;
     srs->updates_processed++;
+    /* Past midnight UTC the window slides, so the horizon keeps reaching as far ahead. */
+    srs_load_balancer_roll(srs->load_balancer, time(NULL));
     return true;
 }
 
 static void srs_shutdown(struct SrsHandle *srs)
 {
+    if (srs == NULL) {
+        return;
+    }
+
+    srs_load_balancer_destroy(srs->load_balancer);
     free(srs);
 }
 
@@ -205,6 +268,33 @@ static bool app_write_autosave_snapshot(AppContext *app,
     return rc >= 0;
 }
 
+/* Runs on the event bus thread; only the snapshot file and directory flag are touched there. */
+static bool app_autosave_writer(const SessionReviewEvent *event,
+                                const SRSPersistedState *persisted,
+                                void *user_data)
+{
+    return app_write_autosave_snapshot((AppContext *)user_data, event, persisted);
+}
+
+/* Delivered from app_update() on the UI thread once the bus has tried the write. */
+static void app_autosave_ack(uint64_t ticket, uint64_t card_id, bool durable, void *user_data)
+{
+    AppContext *app = (AppContext *)user_data;
+    (void)card_id;
+    if (app == NULL) {
+        return;
+    }
+
+    app->autosave.snapshots_acknowledged = ticket;
+    if (!durable) {
+        app_push_toast(app,
+                       "Failed to persist autosave snapshot",
+                       HR_THEME_COLOR_DANGER,
+                       RED,
+                       4.0f);
+    }
+}
+
 static bool app_session_autosave_callback(const SessionReviewEvent *event,
                                           const SRSPersistedState *persisted,
                                           void *user_data)
@@ -218,15 +308,155 @@ static bool app_session_autosave_callback(const SessionReviewEvent *event,
         return true;
     }
 
-    if (!app_write_autosave_snapshot(app, event, persisted)) {
-        app_push_toast(app,
-                       "Failed to persist autosave snapshot",
-                       HR_THEME_COLOR_DANGER,
-                       RED,
-                       4.0f);
+    /* The review row is already committed; the JSON snapshot is written behind the grade. */
+    return event_bus_autosave_session_event(event, persisted, app->events);
+}
+
+/* Card review_state values written back by study sessions (0 = new). */
+#define APP_CARD_STATE_LEARNING 1
+#define APP_CARD_STATE_REVIEW 2
+
+typedef struct AppReviewWrite {
+    DatabaseHandle *database;
+    const HrCardScheduleRecord *schedule;
+    const HrReviewRecord *review; /* Row to insert, or NULL when reverting. */
+    sqlite3_int64 review_id;      /* Row written, or row to delete when reverting. */
+} AppReviewWrite;
+
+static int app_round_to_int(double value)
+{
+    if (!(value > 0.0)) {
+        return 0;
+    }
+    return (value >= (double)INT_MAX) ? INT_MAX : (int)(value + 0.5);
+}
+
+static void app_schedule_from_persisted(uint64_t card_id,
+                                        const SRSPersistedState *persisted,
+                                        sqlite3_int64 now,
+                                        HrCardScheduleRecord *out_record)
+{
+    memset(out_record, 0, sizeof(*out_record));
+    out_record->id = (sqlite3_int64)card_id;
+    out_record->updated_at = now;
+    out_record->due_at = (sqlite3_int64)persisted->due_unix;
+    out_record->interval = app_round_to_int(persisted->interval_days);
+    out_record->ease_factor = app_round_to_int(persisted->ease_factor * 100.0);
+    if (persisted->last_review_unix == 0) {
+        out_record->review_state = 0;
+    } else {
+        out_record->review_state = (persisted->interval_days < 1.0) ? APP_CARD_STATE_LEARNING
+                                                                    : APP_CARD_STATE_REVIEW;
+    }
+}
+
+static int app_review_write_txn(sqlite3 *db, void *user_data)
+{
+    (void)db;
+    AppReviewWrite *write = (AppReviewWrite *)user_data;
+
+    sqlite3_stmt *stmt = NULL;
+    int rc = db_card_prepare_update_schedule(write->database, &stmt);
+    if (rc == SQLITE_OK) {
+        rc = db_card_bind_update_schedule(stmt, write->schedule);
+    }
+    if (rc == SQLITE_OK) {
+        rc = (sqlite3_step(stmt) == SQLITE_DONE) ? SQLITE_OK : SQLITE_ERROR;
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+
+    stmt = NULL;
+    if (write->review != NULL) {
+        rc = db_review_prepare_bulk_insert(write->database, &stmt);
+        if (rc == SQLITE_OK) {
+            rc = db_review_bind_bulk_insert(stmt, write->review);
+        }
+    } else {
+        rc = db_review_prepare_delete(write->database, &stmt);
+        if (rc == SQLITE_OK) {
+            rc = db_review_bind_delete(stmt, write->review_id);
+        }
+    }
+    if (rc == SQLITE_OK) {
+        rc = (sqlite3_step(stmt) == SQLITE_DONE) ? SQLITE_OK : SQLITE_ERROR;
+    }
+    sqlite3_finalize(stmt);
+
+    if (rc == SQLITE_OK && write->review != NULL) {
+        write->review_id = sqlite3_last_insert_rowid(db_connection(write->database));
+    }
+    return rc;
+}
+
+/* Logs a graded review and stores the card's new schedule in one transaction. */
+static bool app_session_record_callback(const SessionReviewEvent *event,
+                                        const SRSPersistedState *persisted,
+                                        int64_t *out_review_id,
+                                        void *user_data)
+{
+    AppContext *app = (AppContext *)user_data;
+    if (app == NULL || app->database == NULL || event == NULL || persisted == NULL) {
+        return false;
+    }
+
+    const sqlite3_int64 reviewed_at = (event->result.review_time != 0) ? (sqlite3_int64)event->result.review_time
+                                                                        : (sqlite3_int64)event->context.now;
+
+    HrCardScheduleRecord schedule;
+    app_schedule_from_persisted(event->card_id, persisted, reviewed_at, &schedule);
+
+    HrReviewRecord review;
+    memset(&review, 0, sizeof(review));
+    review.card_id = (sqlite3_int64)event->card_id;
+    review.reviewed_at = reviewed_at;
+    review.rating = (int)event->result.rating;
+    review.duration_ms = (event->answer_ms > (uint32_t)INT_MAX) ? INT_MAX : (int)event->answer_ms;
+    /* Scheduled = interval just assigned; actual = interval the card was reviewed at. */
+    review.scheduled_interval = app_round_to_int(event->result.interval_days);
+    review.actual_interval = app_round_to_int(event->result.previous_interval_days);
+    review.ease_factor = app_round_to_int(event->result.applied_ease_factor * 100.0);
+    /* The state the card was reviewed in, so daily activity counts first reviews as new (state 0). */
+    if (event->first_review) {
+        review.review_state = 0;
+    } else {
+        review.review_state = (event->result.previous_interval_days < 1.0) ? APP_CARD_STATE_LEARNING
+                                                                           : APP_CARD_STATE_REVIEW;
+    }
+
+    AppReviewWrite write = {app->database, &schedule, &review, 0};
+    if (db_run_in_transaction(app->database, app_review_write_txn, &write) != SQLITE_OK) {
+        app_push_toast(app, "Failed to save review", HR_THEME_COLOR_DANGER, RED, 4.0f);
+        return false;
+    }
+
+    if (out_review_id != NULL) {
+        *out_review_id = (int64_t)write.review_id;
+    }
+    return true;
+}
+
+/* Removes an undone review and restores the card's previous schedule in one transaction. */
+static bool app_session_revert_callback(uint64_t card_id,
+                                        int64_t review_id,
+                                        const SRSPersistedState *restored,
+                                        void *user_data)
+{
+    AppContext *app = (AppContext *)user_data;
+    if (app == NULL || app->database == NULL || restored == NULL) {
         return false;
     }
 
+    HrCardScheduleRecord schedule;
+    app_schedule_from_persisted(card_id, restored, (sqlite3_int64)time(NULL), &schedule);
+
+    AppReviewWrite write = {app->database, &schedule, NULL, (sqlite3_int64)review_id};
+    if (db_run_in_transaction(app->database, app_review_write_txn, &write) != SQLITE_OK) {
+        app_push_toast(app, "Failed to undo review", HR_THEME_COLOR_DANGER, RED, 4.0f);
+        return false;
+    }
     return true;
 }
 
@@ -269,6 +499,251 @@ static void app_update_autosave_timer(AppContext *app, double delta_time)
     app->autosave.last_backup_failed = false;
 }
 
+static void app_submit_metrics(AppContext *app)
+{
+    HrMetricsSources sources = {
+        .analytics = app->analytics,
+        .media = app->media,
+        .prefetcher = app->prefetcher,
+        .events = app->events,
+    };
+    HrMetricsSnapshot snapshot;
+    metrics_snapshot_capture(&snapshot, &sources);
+    metrics_exporter_submit(app->metrics, &snapshot);
+}
+
+static void app_update_metrics_timer(AppContext *app, double delta_time)
+{
+    if (app == NULL || app->metrics == NULL || app->metrics_timer.interval_seconds <= 0.0) {
+        return;
+    }
+
+    app->metrics_timer.elapsed_seconds += delta_time;
+    if (app->metrics_timer.elapsed_seconds < app->metrics_timer.interval_seconds) {
+        return;
+    }
+
+    /* Capture only copies counters; formatting and file I/O happen on the exporter's thread. */
+    app->metrics_timer.elapsed_seconds = 0.0;
+    app_submit_metrics(app);
+}
+
+static void app_start_metrics_export(AppContext *app, const HrConfig *config_data)
+{
+    app->metrics_timer.interval_seconds = 0.0;
+    app->metrics_timer.elapsed_seconds = 0.0;
+    if (config_data == NULL || config_data->analytics.export_seconds == 0U) {
+        return;
+    }
+
+    HrMetricsExportConfig export_config = {
+        .directory = config_data->paths.metrics_dir,
+        .formats = metrics_parse_formats(config_data->analytics.export_format),
+        .max_bytes = (uint64_t)config_data->analytics.export_max_kb * 1024U,
+        .keep_files = config_data->analytics.export_keep_files,
+    };
+    if (export_config.formats == 0U) {
+        fprintf(stderr, "Unknown metrics export format '%s'\n", config_data->analytics.export_format);
+        return;
+    }
+
+    /* Export is for outside tooling; the app runs the same without it. */
+    app->metrics = metrics_exporter_create(&export_config);
+    if (app->metrics == NULL) {
+        fprintf(stderr, "Failed to start metrics export to %s\n", config_data->paths.metrics_dir);
+        return;
+    }
+    app->metrics_timer.interval_seconds = (double)config_data->analytics.export_seconds;
+}
+
+/* Checkpoint slot of the primary session and how long grades are batched before a write. */
+#define APP_CHECKPOINT_SLOT 0
+#define APP_CHECKPOINT_INTERVAL_SECONDS 2.0
+
+static int app_checkpoint_write_txn(sqlite3 *db, void *user_data)
+{
+    (void)db;
+    AppContext *app = (AppContext *)user_data;
+    sqlite3_stmt *stmt = NULL;
+    int rc;
+
+    if (session_manager_current(app->sessions) == NULL) {
+        /* Finished or never started: nothing left to resume. */
+        rc = db_checkpoint_prepare_delete(app->database, &stmt);
+        if (rc == SQLITE_OK) {
+            rc = db_checkpoint_bind_slot(stmt, APP_CHECKPOINT_SLOT);
+        }
+        if (rc == SQLITE_OK) {
+            rc = (sqlite3_step(stmt) == SQLITE_DONE) ? SQLITE_OK : SQLITE_ERROR;
+        }
+        sqlite3_finalize(stmt);
+        return rc;
+    }
+
+    void *payload = NULL;
+    size_t payload_size = 0u;
+    if (!session_manager_checkpoint(app->sessions, &payload, &payload_size)) {
+        return SQLITE_NOMEM;
+    }
+
+    HrSessionCheckpointRecord record;
+    memset(&record, 0, sizeof(record));
+    record.slot = APP_CHECKPOINT_SLOT;
+    record.mode = (int)session_manager_mode(app->sessions);
+    record.remaining = (sqlite3_int64)session_manager_remaining(app->sessions);
+    record.saved_at = (sqlite3_int64)time(NULL);
+    record.payload = payload;
+    record.payload_size = payload_size;
+
+    rc = db_checkpoint_prepare_upsert(app->database, &stmt);
+    if (rc == SQLITE_OK) {
+        rc = db_checkpoint_bind_upsert(stmt, &record);
+    }
+    if (rc == SQLITE_OK) {
+        rc = (sqlite3_step(stmt) == SQLITE_DONE) ? SQLITE_OK : SQLITE_ERROR;
+    }
+    sqlite3_finalize(stmt);
+    free(payload);
+    return rc;
+}
+
+/* Writes (or clears) the primary session checkpoint when the queue changed. */
+static void app_save_checkpoint(AppContext *app)
+{
+    if (app == NULL || app->database == NULL || app->sessions == NULL || !app->checkpoint.dirty) {
+        return;
+    }
+
+    app->checkpoint.elapsed_seconds = 0.0;
+    int rc = db_run_in_transaction(app->database, app_checkpoint_write_txn, app);
+    if (rc != SQLITE_OK) {
+        if (!app->checkpoint.last_write_failed) {
+            char message[128];
+            snprintf(message, sizeof(message), "Session checkpoint failed (rc=%d)", rc);
+            app_push_toast(app, message, HR_THEME_COLOR_DANGER, RED, 4.0f);
+        }
+        app->checkpoint.last_write_failed = true;
+        return;
+    }
+
+    app->checkpoint.dirty = false;
+    app->checkpoint.last_write_failed = false;
+}
+
+static void app_update_checkpoint_timer(AppContext *app, double delta_time)
+{
+    if (app == NULL || !app->checkpoint.dirty) {
+        return;
+    }
+
+    app->checkpoint.elapsed_seconds += delta_time;
+    if (app->checkpoint.elapsed_seconds >= APP_CHECKPOINT_INTERVAL_SECONDS) {
+        app_save_checkpoint(app);
+    }
+}
+
+/*
+ * Streamed checkpoints carry the planner cursor's position, so the session
+ * carries on past the cards it had loaded. The session owns the reopened
+ * cursor and closes it when it ends.
+ */
+static bool app_resume_session(AppContext *app, const void *payload, size_t payload_size)
+{
+    const void *state = NULL;
+    size_t state_size = 0u;
+    if (app->planner != NULL && session_checkpoint_source_state(payload, payload_size, &state, &state_size)) {
+        struct HrPlannerCursor *cursor = planner_cursor_restore(app->planner, state, state_size);
+        if (cursor != NULL) {
+            SessionCardSource source = {0};
+            source.fetch = planner_cursor_fetch;
+            source.user_data = cursor;
+            source.page_size = SESSION_DEFAULT_PAGE_SIZE;
+            source.save = planner_cursor_save;
+            source.close = planner_cursor_close_source;
+            if (session_manager_resume_stream(app->sessions, payload, payload_size, &source)) {
+                return true;
+            }
+            planner_cursor_close(cursor);
+        }
+    }
+    /* Without a usable cursor only the cards loaded at the checkpoint come back. */
+    return session_manager_resume(app->sessions, payload, payload_size);
+}
+
+/* Restores the session that was in progress when the app last stopped. */
+static void app_resume_checkpoint(AppContext *app)
+{
+    sqlite3_stmt *stmt = NULL;
+    int rc = db_checkpoint_prepare_select(app->database, &stmt);
+    if (rc == SQLITE_OK) {
+        rc = db_checkpoint_bind_slot(stmt, APP_CHECKPOINT_SLOT);
+    }
+    if (rc == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        const void *payload = sqlite3_column_blob(stmt, 3);
+        const int payload_size = sqlite3_column_bytes(stmt, 3);
+        if (payload != NULL && payload_size > 0 &&
+            app_resume_session(app, payload, (size_t)payload_size) &&
+            session_manager_current(app->sessions) != NULL) {
+            char message[128];
+            snprintf(message,
+                     sizeof(message),
+                     "Resumed study session (%zu cards left)",
+                     session_manager_remaining(app->sessions));
+            app_push_toast(app, message, HR_THEME_COLOR_SUCCESS, GREEN, 2.5f);
+        }
+    }
+    sqlite3_finalize(stmt);
+    app->checkpoint.resumed = true;
+}
+
+/** Writes the review trace next to the cache so it survives the process for offline reading. */
+static void app_dump_trace(AppContext *app)
+{
+    const HrConfig *config = cfg_data(app->config);
+    if (app->trace == NULL || config == NULL || trace_ring_total(app->trace) == 0U) {
+        return;
+    }
+
+    char path[PATH_MAX];
+    int written = snprintf(path, sizeof(path), "%s/review.trace", config->paths.cache_dir);
+    if (written < 0 || (size_t)written >= sizeof(path) || !ensure_directory_exists(config->paths.cache_dir)) {
+        return;
+    }
+    if (!trace_ring_dump(app->trace, path)) {
+        fprintf(stderr, "Failed to write review trace to %s\n", path);
+    }
+}
+
+/** Writes the recorded spans as cache_dir/spans.json, which chrome://tracing and Perfetto open directly. */
+static void app_export_spans(AppContext *app)
+{
+    const HrConfig *config = cfg_data(app->config);
+    if (config == NULL || !config->analytics.trace_spans || !span_trace_enabled()) {
+        return;
+    }
+
+    char path[PATH_MAX];
+    int written = snprintf(path, sizeof(path), "%s/spans.json", config->paths.cache_dir);
+    if (written < 0 || (size_t)written >= sizeof(path) || !ensure_directory_exists(config->paths.cache_dir)) {
+        return;
+    }
+    if (!span_trace_export(path)) {
+        fprintf(stderr, "Failed to write span trace to %s\n", path);
+    }
+}
+
+/* Keeps planner quotas current and marks the session checkpoint for the next batched write. */
+static void app_session_event_callback(const SessionReviewEvent *event, void *user_data)
+{
+    AppContext *app = (AppContext *)user_data;
+    if (app == NULL || event == NULL) {
+        return;
+    }
+
+    planner_record_session_event(event, app->planner);
+    app->checkpoint.dirty = true;
+}
+
 static void theme_usage_callback(const HrThemePalette *palette, void *user_data)
 {
     AppContext *app = (AppContext *)user_data;
@@ -295,6 +770,16 @@ AppContext *app_create(void)
         return NULL;
     }
 
+    /* Started before the first worker thread so every thread's spans are kept. */
+    const HrConfig *startup_config = cfg_data(app->config);
+    if (startup_config != NULL && startup_config->analytics.trace_spans) {
+        if (span_trace_start(0U)) {
+            span_trace_name_thread("ui");
+        } else {
+            fprintf(stderr, "Failed to start span tracing\n");
+        }
+    }
+
     app->platform = platform_create(NULL);
     if (app->platform == NULL) {
         app_destroy(app);
@@ -307,18 +792,12 @@ AppContext *app_create(void)
         return NULL;
     }
 
-    app->srs = srs_initialize();
+    app->srs = srs_initialize(app->database);
     if (app->srs == NULL) {
         app_destroy(app);
         return NULL;
     }
 
-    app->sessions = session_manager_create();
-    if (app->sessions == NULL) {
-        app_destroy(app);
-        return NULL;
-    }
-
     app->themes = theme_manager_create();
     if (app->themes == NULL) {
         app_destroy(app);
@@ -347,6 +826,13 @@ AppContext *app_create(void)
     UiConfig ui_config = {
         .enable_devtools = false,
     };
+    if (config_data != NULL) {
+        ui_config.study_hotkeys[UI_STUDY_ACTION_REVEAL] = config_data->ui.hotkey_reveal;
+        ui_config.study_hotkeys[UI_STUDY_ACTION_AGAIN] = config_data->ui.hotkey_again;
+        ui_config.study_hotkeys[UI_STUDY_ACTION_HARD] = config_data->ui.hotkey_hard;
+        ui_config.study_hotkeys[UI_STUDY_ACTION_GOOD] = config_data->ui.hotkey_good;
+        ui_config.study_hotkeys[UI_STUDY_ACTION_EASY] = config_data->ui.hotkey_easy;
+    }
     app->ui = ui_create(&ui_config);
     if (app->ui == NULL) {
         app_destroy(app);
@@ -375,18 +861,110 @@ AppContext *app_create(void)
         return NULL;
     }
 
+    /* Lifetime history first; the bus is not running yet, so no live review can be counted twice. */
+    if (!analytics_hydrate(app->analytics, app->database)) {
+        fprintf(stderr, "Failed to load review history into analytics\n");
+    }
+
     ui_attach_analytics(app->ui, app->analytics);
 
+    /* Analytics is read by the UI thread, so it is fed from app_update() rather than the bus thread. */
+    app->events = event_bus_create(HR_EVENT_BUS_DEFAULT_CAPACITY);
+    if (app->events == NULL ||
+        !event_bus_subscribe(app->events, HR_EVENT_DELIVER_PUMP, analytics_record_session_event, app->analytics) ||
+        !event_bus_set_durable_writer(app->events, app_autosave_writer, app, app_autosave_ack, app) ||
+        !event_bus_start(app->events)) {
+        app_destroy(app);
+        return NULL;
+    }
+
+    /* Scheduler defaults, with the load-balancer fuzz taken from the settings file. */
+    SRSConfig srs_config;
+    srs_default_config(&srs_config);
+    if (config_data != NULL) {
+        srs_config.fuzz_ratio = (double)config_data->srs.fuzz_percent / 100.0;
+        srs_config.fuzz_max_days = (double)config_data->srs.fuzz_max_days;
+    }
+
+    app->planner = planner_create(app->database,
+                                  config_data != NULL ? &config_data->srs : NULL,
+                                  &srs_config);
+    if (app->planner == NULL) {
+        app_destroy(app);
+        return NULL;
+    }
+    /* Weaker topics get more of the backlog and the exam papers; analytics is updated on this thread. */
+    planner_set_topic_weights(app->planner, analytics_topic_weight, app->analytics);
+
+    app->media = media_cache_create(NULL);
+    if (app->media == NULL) {
+        app_destroy(app);
+        return NULL;
+    }
+
+    app->prefetcher = prefetcher_create(app->database, app->media, HR_PREFETCH_DEFAULT_DEPTH);
+    if (app->prefetcher == NULL) {
+        app_destroy(app);
+        return NULL;
+    }
+
     SessionCallbacks session_callbacks;
     memset(&session_callbacks, 0, sizeof(session_callbacks));
-    session_callbacks.analytics_event = analytics_record_session_event;
-    session_callbacks.analytics_user_data = app->analytics;
+    session_callbacks.analytics_event = event_bus_publish_session_event;
+    session_callbacks.analytics_user_data = app->events;
     session_callbacks.autosave_event = app_session_autosave_callback;
     session_callbacks.autosave_user_data = app;
+    session_callbacks.record_event = app_session_record_callback;
+    session_callbacks.record_user_data = app;
+    session_callbacks.revert_event = app_session_revert_callback;
+    session_callbacks.revert_user_data = app;
+    session_callbacks.session_event = app_session_event_callback;
+    session_callbacks.session_user_data = app;
+
+    app->session_registry = session_registry_create(&session_callbacks);
+    if (app->session_registry == NULL) {
+        app_destroy(app);
+        return NULL;
+    }
+
+    /* Always on: the ring is allocated once, so long sessions do not grow memory. */
+    app->trace = trace_ring_create(HR_TRACE_RING_DEFAULT_CAPACITY);
+    if (app->trace == NULL) {
+        app_destroy(app);
+        return NULL;
+    }
+    session_registry_set_trace_ring(app->session_registry, app->trace);
+
+    /*
+     * The primary study session, and the only one the app opens: the study
+     * screen drives a single session. The registry still arbitrates its cards,
+     * so a second view can open its own session later without double-serving.
+     */
+    app->sessions = session_registry_open(app->session_registry);
+    if (app->sessions == NULL) {
+        app_destroy(app);
+        return NULL;
+    }
+    session_manager_set_config(app->sessions, &srs_config);
+    session_manager_set_load_balancer(app->sessions, app->srs->load_balancer);
+    if (analytics_config.calibrate_intervals) {
+        /* Grading and the analytics pump share the UI thread, so the hook reads settled curves. */
+        SRSCalibrationHooks calibration;
+        memset(&calibration, 0, sizeof(calibration));
+        calibration.interval_hook = analytics_calibrate_interval;
+        calibration.interval_hook_user_data = app->analytics;
+        session_manager_set_calibration(app->sessions, &calibration);
+    }
+    session_registry_callbacks(app->session_registry, app->sessions, &session_callbacks);
 
     ui_attach_theme_manager(app->ui, app->themes);
     ui_attach_session_manager(app->ui, app->sessions, &session_callbacks);
     ui_attach_database(app->ui, app->database);
+    ui_attach_planner(app->ui, app->planner);
+    ui_attach_prefetcher(app->ui, app->prefetcher);
+
+    app_resume_checkpoint(app);
+    app_start_metrics_export(app, config_data);
 
     float base_font_size = 20.0f;
     if (config_data != NULL && config_data->ui.font_size_pt > 0U) {
@@ -398,6 +976,22 @@ AppContext *app_create(void)
     return app;
 }
 
+void app_update(AppContext *app, double delta_time)
+{
+    if (app == NULL) {
+        return;
+    }
+
+    event_bus_pump(app->events, 0U);
+    app_update_autosave_timer(app, delta_time);
+    app_update_checkpoint_timer(app, delta_time);
+    app_update_metrics_timer(app, delta_time);
+#if HYPERRECALL_ENABLE_DEVTOOLS
+    /* No-op unless a profiled statement crossed the slow threshold since the last frame. */
+    db_profile_flush_slow_log(app->database);
+#endif
+}
+
 int app_run(AppContext *app)
 {
     if (app == NULL || app->config == NULL || app->platform == NULL || app->database == NULL ||
@@ -426,7 +1020,7 @@ int app_run(AppContext *app)
         }
 
         analytics_record_frame(app->analytics, &frame_info);
-        app_update_autosave_timer(app, frame_info.delta_time);
+        app_update(app, frame_info.delta_time);
 
         platform_end_frame(app->platform);
 
@@ -436,6 +1030,8 @@ int app_run(AppContext *app)
         }
     }
 
+    /* Every queued review reaches analytics and every snapshot is written before returning. */
+    event_bus_flush(app->events);
     analytics_flush(app->analytics);
     app->running = false;
     return result;
@@ -447,15 +1043,54 @@ void app_destroy(AppContext *app)
         return;
     }
 
+    /* A last snapshot while every source is still alive; destroying the exporter writes it. */
+    if (app->metrics != NULL) {
+        app_submit_metrics(app);
+        metrics_exporter_destroy(app->metrics);
+        app->metrics = NULL;
+    }
+
+    /* Drains into analytics and the autosave writer, so it stops before either goes away. */
+    event_bus_destroy(app->events);
+    app->events = NULL;
+
+    /*
+     * Record exactly where the learner stopped, even if nothing changed since the
+     * last batch. Done here rather than in app_run() because the Qt shell never
+     * calls it; skipped when app_create() failed before the stored checkpoint
+     * was read, which would otherwise be overwritten.
+     */
+    if (app->checkpoint.resumed) {
+        app->checkpoint.dirty = true;
+        app_save_checkpoint(app);
+    }
+
     analytics_shutdown(app->analytics);
     app->analytics = NULL;
 
     ui_destroy(app->ui);
     app->ui = NULL;
 
-    session_manager_destroy(app->sessions);
+    /* Closes the primary session along with any others still open. */
+    session_registry_destroy(app->session_registry);
+    app->session_registry = NULL;
     app->sessions = NULL;
 
+    /* The registry is gone, so nothing records into the ring while it is written. */
+    app_dump_trace(app);
+    trace_ring_destroy(app->trace);
+    app->trace = NULL;
+
+    planner_destroy(app->planner);
+    app->planner = NULL;
+
+    /* The worker may still hold media handles, so it stops before the cache goes. */
+    prefetcher_destroy(app->prefetcher);
+    app->prefetcher = NULL;
+
+    media_cache_destroy(app->media);
+    app->media = NULL;
+
     if (app->themes != NULL) {
         theme_manager_write_preferences(app->themes);
         theme_manager_destroy(app->themes);
@@ -471,6 +1106,12 @@ void app_destroy(AppContext *app)
     platform_destroy(app->platform);
     app->platform = NULL;
 
+    /* Every worker has been joined, so the rings are complete and nothing records into them anymore. */
+    if (app->config != NULL) {
+        app_export_spans(app);
+    }
+    span_trace_shutdown();
+
     cfg_unload(app->config);
     app->config = NULL;
 
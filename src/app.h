@@ -12,6 +12,7 @@ extern "C" {
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 struct ConfigHandle;
 struct PlatformHandle;
@@ -21,6 +22,12 @@ struct SessionManager;
 struct UiContext;
 struct AnalyticsHandle;
 struct HrThemeManager;
+struct HrStudyPlanner;
+struct HrMediaCache;
+struct HrPrefetcher;
+struct HrSessionRegistry;
+struct HrTraceRing;
+struct HrEventBus;
 
 /**
  * @brief Tracks autosave scheduling and bookkeeping for database snapshots.
@@ -32,8 +39,27 @@ typedef struct AppAutosaveState {
     bool directory_ready;      /**< True once the autosave directory has been prepared. */
     bool last_backup_failed;   /**< Tracks whether the previous autosave attempt failed. */
     size_t backups_completed;  /**< Number of successful autosave backups performed. */
+    uint64_t snapshots_acknowledged; /**< Last per-review snapshot ticket written or failed. */
 } AppAutosaveState;
 
+/**
+ * @brief Tracks batched checkpoint writes for the primary study session.
+ */
+typedef struct AppCheckpointState {
+    bool dirty;                /**< The queue changed since the last checkpoint write. */
+    double elapsed_seconds;    /**< Seconds the pending change has waited for a write. */
+    bool last_write_failed;    /**< Suppresses repeated failure toasts. */
+    bool resumed;              /**< The stored checkpoint was read, so writes may now replace it. */
+} AppCheckpointState;
+
+/**
+ * @brief Tracks the cadence of metrics snapshots handed to the exporter.
+ */
+typedef struct AppMetricsState {
+    double interval_seconds;   /**< Seconds between snapshots (0 when export is off). */
+    double elapsed_seconds;    /**< Seconds since the last snapshot. */
+} AppMetricsState;
+
 /**
  * @brief Aggregates subsystem handles required to drive the application.
  */
@@ -42,11 +68,20 @@ typedef struct AppContext {
     struct PlatformHandle *platform;  /**< Platform/windowing state. */
     struct DatabaseHandle *database;  /**< Database connection handle. */
     struct SrsHandle *srs;            /**< Spaced repetition scheduler state. */
-    struct SessionManager *sessions;  /**< Study session orchestration. */
+    struct SessionManager *sessions;  /**< Primary study session (owned by @p session_registry). */
+    struct HrSessionRegistry *session_registry; /**< Concurrent sessions sharing card ownership. */
+    struct HrTraceRing *trace;        /**< Bounded review trace, dumped on shutdown. */
+    struct HrEventBus *events;        /**< Carries review events and autosaves off the grading path. */
     struct UiContext *ui;             /**< UI rendering subsystem. */
     struct AnalyticsHandle *analytics;/**< Analytics collection and export. */
     struct HrThemeManager *themes;    /**< Theme palette manager. */
+    struct HrStudyPlanner *planner;   /**< Quota-aware study queue builder. */
+    struct HrMediaCache *media;       /**< Shared texture/audio cache. */
+    struct HrPrefetcher *prefetcher;  /**< Warms upcoming card bodies and media. */
+    struct HrMetricsExporter *metrics;/**< Writes health snapshots for external scrapers (NULL when off). */
     AppAutosaveState autosave;        /**< Autosave scheduling/bookkeeping state. */
+    AppCheckpointState checkpoint;    /**< Session checkpoint batching state. */
+    AppMetricsState metrics_timer;    /**< Metrics snapshot scheduling state. */
     bool running;                     /**< Tracks whether the main loop is active. */
 } AppContext;
 
@@ -66,6 +101,18 @@ AppContext *app_create(void);
  */
 int app_run(AppContext *app);
 
+/**
+ * @brief Runs per-frame housekeeping for front ends that drive their own loop.
+ *
+ * Delivers queued review events to analytics, reports autosave
+ * acknowledgements and advances the backup, checkpoint and metrics timers. app_run()
+ * calls it every frame.
+ *
+ * @param app        The application context.
+ * @param delta_time Seconds since the previous call.
+ */
+void app_update(AppContext *app, double delta_time);
+
 /**
  * @brief Releases all resources owned by the application.
  *
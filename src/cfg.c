@@ -36,6 +36,7 @@ struct ConfigParseState {
     bool backup_dir_set;
     bool window_state_path_set;
     bool autosave_dir_set;
+    bool metrics_dir_set;
     bool settings_path_set;
 };
 
@@ -238,6 +239,7 @@ static void set_default_paths(HrConfig *config)
     join_path(config->paths.window_state_path, sizeof(config->paths.window_state_path), config->paths.config_dir,
               "/window_state.json");
     join_path(config->paths.autosave_dir, sizeof(config->paths.autosave_dir), config->paths.data_dir, "/autosave");
+    join_path(config->paths.metrics_dir, sizeof(config->paths.metrics_dir), config->paths.data_dir, "/metrics");
 }
 
 static void set_default_values(HrConfig *config)
@@ -248,9 +250,24 @@ static void set_default_values(HrConfig *config)
     config->ui.scale_percent = 100U;
     config->ui.font_size_pt = 14U;
     copy_string(config->ui.theme_palette, sizeof(config->ui.theme_palette), "default");
+    copy_string(config->ui.hotkey_reveal, sizeof(config->ui.hotkey_reveal), "Space");
+    copy_string(config->ui.hotkey_again, sizeof(config->ui.hotkey_again), "1");
+    copy_string(config->ui.hotkey_hard, sizeof(config->ui.hotkey_hard), "2");
+    copy_string(config->ui.hotkey_good, sizeof(config->ui.hotkey_good), "3");
+    copy_string(config->ui.hotkey_easy, sizeof(config->ui.hotkey_easy), "4");
     config->analytics.enabled = true;
+    config->analytics.heatmap_days = 365U;
+    config->analytics.columnar_cache = false;
+    config->analytics.calibrate_intervals = false;
+    config->analytics.export_seconds = 0U;
+    copy_string(config->analytics.export_format, sizeof(config->analytics.export_format), "ndjson");
+    config->analytics.export_max_kb = 1024U;
+    config->analytics.export_keep_files = 4U;
+    config->analytics.trace_spans = false;
     config->srs.daily_new_cards = 20U;
     config->srs.daily_review_limit = 200U;
+    config->srs.fuzz_percent = 15U;
+    config->srs.fuzz_max_days = 7U;
 
     config->study.exam_date[0] = '\0';
     config->study.saved_filters[0] = '\0';
@@ -260,6 +277,8 @@ static void set_default_values(HrConfig *config)
     config->database.backup.enable_auto = true;
     config->database.backup.keep_days = 30U;
     config->database.backup.max_files = 10U;
+    config->database.profile_statements = false;
+    config->database.slow_query_ms = 100U;
 }
 
 static void finalize_paths(HrConfig *config)
@@ -300,6 +319,25 @@ static void finalize_paths(HrConfig *config)
     if (config->paths.autosave_dir[0] == '\0') {
         join_path(config->paths.autosave_dir, sizeof(config->paths.autosave_dir), config->paths.data_dir, "/autosave");
     }
+
+    if (config->paths.metrics_dir[0] == '\0') {
+        join_path(config->paths.metrics_dir, sizeof(config->paths.metrics_dir), config->paths.data_dir, "/metrics");
+    }
+}
+
+static void parse_bool(bool *target, const char *value)
+{
+    if (target == NULL || value == NULL) {
+        return;
+    }
+
+    if (ascii_casecmp(value, "1") == 0 || ascii_casecmp(value, "true") == 0 || ascii_casecmp(value, "yes") == 0 ||
+        ascii_casecmp(value, "on") == 0) {
+        *target = true;
+    } else if (ascii_casecmp(value, "0") == 0 || ascii_casecmp(value, "false") == 0 || ascii_casecmp(value, "no") == 0 ||
+               ascii_casecmp(value, "off") == 0) {
+        *target = false;
+    }
 }
 
 static void apply_environment_overrides(HrConfig *config, const char *explicit_path)
@@ -340,6 +378,16 @@ static void apply_environment_overrides(HrConfig *config, const char *explicit_p
         config->database.backup.max_files = (unsigned int)strtoul(max_files, NULL, 10);
     }
 
+    const char *profile_statements = getenv("HYPERRECALL_DB_PROFILE");
+    if (profile_statements != NULL && profile_statements[0] != '\0') {
+        parse_bool(&config->database.profile_statements, profile_statements);
+    }
+
+    const char *slow_query_ms = getenv("HYPERRECALL_SLOW_QUERY_MS");
+    if (slow_query_ms != NULL && slow_query_ms[0] != '\0') {
+        config->database.slow_query_ms = (unsigned int)strtoul(slow_query_ms, NULL, 10);
+    }
+
     const char *theme_palette = getenv("HYPERRECALL_THEME");
     if (theme_palette != NULL && theme_palette[0] != '\0') {
         copy_string(config->ui.theme_palette, sizeof(config->ui.theme_palette), theme_palette);
@@ -374,6 +422,21 @@ static void apply_environment_overrides(HrConfig *config, const char *explicit_p
     if (autosave_dir != NULL && autosave_dir[0] != '\0') {
         copy_path(config->paths.autosave_dir, sizeof(config->paths.autosave_dir), autosave_dir);
     }
+
+    const char *metrics_dir = getenv("HYPERRECALL_METRICS_DIR");
+    if (metrics_dir != NULL && metrics_dir[0] != '\0') {
+        copy_path(config->paths.metrics_dir, sizeof(config->paths.metrics_dir), metrics_dir);
+    }
+
+    const char *export_seconds = getenv("HYPERRECALL_METRICS_SECONDS");
+    if (export_seconds != NULL && export_seconds[0] != '\0') {
+        config->analytics.export_seconds = (unsigned int)strtoul(export_seconds, NULL, 10);
+    }
+
+    const char *trace_spans = getenv("HYPERRECALL_TRACE_SPANS");
+    if (trace_spans != NULL && trace_spans[0] != '\0') {
+        parse_bool(&config->analytics.trace_spans, trace_spans);
+    }
 }
 
 static void trim(char *value)
@@ -397,21 +460,6 @@ static void trim(char *value)
     }
 }
 
-static void parse_bool(bool *target, const char *value)
-{
-    if (target == NULL || value == NULL) {
-        return;
-    }
-
-    if (ascii_casecmp(value, "1") == 0 || ascii_casecmp(value, "true") == 0 || ascii_casecmp(value, "yes") == 0 ||
-        ascii_casecmp(value, "on") == 0) {
-        *target = true;
-    } else if (ascii_casecmp(value, "0") == 0 || ascii_casecmp(value, "false") == 0 || ascii_casecmp(value, "no") == 0 ||
-               ascii_casecmp(value, "off") == 0) {
-        *target = false;
-    }
-}
-
 static void parse_unsigned(unsigned int *target, const char *value)
 {
     if (target == NULL || value == NULL) {
@@ -439,22 +487,56 @@ static void parse_config_line(HrConfig *config, char *line, struct ConfigParseSt
 
     if (ascii_casecmp(key, "analytics_enabled") == 0) {
         parse_bool(&config->analytics.enabled, value);
+    } else if (ascii_casecmp(key, "analytics_heatmap_days") == 0) {
+        parse_unsigned(&config->analytics.heatmap_days, value);
+    } else if (ascii_casecmp(key, "analytics_columnar_cache") == 0) {
+        parse_bool(&config->analytics.columnar_cache, value);
+    } else if (ascii_casecmp(key, "analytics_calibrate_intervals") == 0) {
+        parse_bool(&config->analytics.calibrate_intervals, value);
+    } else if (ascii_casecmp(key, "analytics_export_seconds") == 0) {
+        parse_unsigned(&config->analytics.export_seconds, value);
+    } else if (ascii_casecmp(key, "analytics_export_format") == 0) {
+        copy_string(config->analytics.export_format, sizeof(config->analytics.export_format), value);
+    } else if (ascii_casecmp(key, "analytics_export_max_kb") == 0) {
+        parse_unsigned(&config->analytics.export_max_kb, value);
+    } else if (ascii_casecmp(key, "analytics_export_keep_files") == 0) {
+        parse_unsigned(&config->analytics.export_keep_files, value);
+    } else if (ascii_casecmp(key, "analytics_trace_spans") == 0) {
+        parse_bool(&config->analytics.trace_spans, value);
     } else if (ascii_casecmp(key, "ui_scale_percent") == 0) {
         parse_unsigned(&config->ui.scale_percent, value);
     } else if (ascii_casecmp(key, "ui_font_size_pt") == 0) {
         parse_unsigned(&config->ui.font_size_pt, value);
     } else if (ascii_casecmp(key, "ui_theme_palette") == 0) {
         copy_string(config->ui.theme_palette, sizeof(config->ui.theme_palette), value);
+    } else if (ascii_casecmp(key, "ui_hotkey_reveal") == 0) {
+        copy_string(config->ui.hotkey_reveal, sizeof(config->ui.hotkey_reveal), value);
+    } else if (ascii_casecmp(key, "ui_hotkey_again") == 0) {
+        copy_string(config->ui.hotkey_again, sizeof(config->ui.hotkey_again), value);
+    } else if (ascii_casecmp(key, "ui_hotkey_hard") == 0) {
+        copy_string(config->ui.hotkey_hard, sizeof(config->ui.hotkey_hard), value);
+    } else if (ascii_casecmp(key, "ui_hotkey_good") == 0) {
+        copy_string(config->ui.hotkey_good, sizeof(config->ui.hotkey_good), value);
+    } else if (ascii_casecmp(key, "ui_hotkey_easy") == 0) {
+        copy_string(config->ui.hotkey_easy, sizeof(config->ui.hotkey_easy), value);
     } else if (ascii_casecmp(key, "srs_daily_new_cards") == 0) {
         parse_unsigned(&config->srs.daily_new_cards, value);
     } else if (ascii_casecmp(key, "srs_daily_review_limit") == 0) {
         parse_unsigned(&config->srs.daily_review_limit, value);
+    } else if (ascii_casecmp(key, "srs_fuzz_percent") == 0) {
+        parse_unsigned(&config->srs.fuzz_percent, value);
+    } else if (ascii_casecmp(key, "srs_fuzz_max_days") == 0) {
+        parse_unsigned(&config->srs.fuzz_max_days, value);
     } else if (ascii_casecmp(key, "db_auto_backup") == 0) {
         parse_bool(&config->database.backup.enable_auto, value);
     } else if (ascii_casecmp(key, "db_backup_keep_days") == 0) {
         parse_unsigned(&config->database.backup.keep_days, value);
     } else if (ascii_casecmp(key, "db_backup_max_files") == 0) {
         parse_unsigned(&config->database.backup.max_files, value);
+    } else if (ascii_casecmp(key, "db_profile_statements") == 0) {
+        parse_bool(&config->database.profile_statements, value);
+    } else if (ascii_casecmp(key, "db_slow_query_ms") == 0) {
+        parse_unsigned(&config->database.slow_query_ms, value);
     } else if (ascii_casecmp(key, "db_path") == 0) {
         copy_path(config->database.path, sizeof(config->database.path), value);
         if (state != NULL) {
@@ -490,6 +572,11 @@ static void parse_config_line(HrConfig *config, char *line, struct ConfigParseSt
         if (state != NULL) {
             state->autosave_dir_set = true;
         }
+    } else if (ascii_casecmp(key, "metrics_dir") == 0) {
+        copy_path(config->paths.metrics_dir, sizeof(config->paths.metrics_dir), value);
+        if (state != NULL) {
+            state->metrics_dir_set = true;
+        }
     } else if (ascii_casecmp(key, "study_exam_date") == 0) {
         copy_string(config->study.exam_date, sizeof(config->study.exam_date), value);
     } else if (ascii_casecmp(key, "study_saved_filters") == 0) {
@@ -520,6 +607,9 @@ static void harmonize_derived_paths(HrConfig *config, const struct ConfigParseSt
         if (!state->autosave_dir_set) {
             config->paths.autosave_dir[0] = '\0';
         }
+        if (!state->metrics_dir_set) {
+            config->paths.metrics_dir[0] = '\0';
+        }
     }
 
     if (state->config_dir_set) {
@@ -655,14 +745,31 @@ static int write_to_disk(const HrConfig *config, const char *settings_path)
     fprintf(file, "# Generated on %ld\n\n", (long)time(NULL));
 
     fprintf(file, "analytics_enabled=%s\n", config->analytics.enabled ? "true" : "false");
+    fprintf(file, "analytics_heatmap_days=%u\n", config->analytics.heatmap_days);
+    fprintf(file, "analytics_columnar_cache=%s\n", config->analytics.columnar_cache ? "true" : "false");
+    fprintf(file, "analytics_calibrate_intervals=%s\n", config->analytics.calibrate_intervals ? "true" : "false");
+    fprintf(file, "analytics_export_seconds=%u\n", config->analytics.export_seconds);
+    fprintf(file, "analytics_export_format=%s\n", config->analytics.export_format);
+    fprintf(file, "analytics_export_max_kb=%u\n", config->analytics.export_max_kb);
+    fprintf(file, "analytics_export_keep_files=%u\n", config->analytics.export_keep_files);
+    fprintf(file, "analytics_trace_spans=%s\n", config->analytics.trace_spans ? "true" : "false");
     fprintf(file, "ui_scale_percent=%u\n", config->ui.scale_percent);
     fprintf(file, "ui_font_size_pt=%u\n", config->ui.font_size_pt);
     fprintf(file, "ui_theme_palette=%s\n", config->ui.theme_palette);
+    fprintf(file, "ui_hotkey_reveal=%s\n", config->ui.hotkey_reveal);
+    fprintf(file, "ui_hotkey_again=%s\n", config->ui.hotkey_again);
+    fprintf(file, "ui_hotkey_hard=%s\n", config->ui.hotkey_hard);
+    fprintf(file, "ui_hotkey_good=%s\n", config->ui.hotkey_good);
+    fprintf(file, "ui_hotkey_easy=%s\n", config->ui.hotkey_easy);
     fprintf(file, "srs_daily_new_cards=%u\n", config->srs.daily_new_cards);
     fprintf(file, "srs_daily_review_limit=%u\n", config->srs.daily_review_limit);
+    fprintf(file, "srs_fuzz_percent=%u\n", config->srs.fuzz_percent);
+    fprintf(file, "srs_fuzz_max_days=%u\n", config->srs.fuzz_max_days);
     fprintf(file, "db_auto_backup=%s\n", config->database.backup.enable_auto ? "true" : "false");
     fprintf(file, "db_backup_keep_days=%u\n", config->database.backup.keep_days);
     fprintf(file, "db_backup_max_files=%u\n", config->database.backup.max_files);
+    fprintf(file, "db_profile_statements=%s\n", config->database.profile_statements ? "true" : "false");
+    fprintf(file, "db_slow_query_ms=%u\n", config->database.slow_query_ms);
     fprintf(file, "db_path=%s\n", config->database.path);
     fprintf(file, "db_backup_dir=%s\n", config->database.backup_dir);
     fprintf(file, "data_dir=%s\n", config->paths.data_dir);
@@ -670,6 +777,7 @@ static int write_to_disk(const HrConfig *config, const char *settings_path)
     fprintf(file, "cache_dir=%s\n", config->paths.cache_dir);
     fprintf(file, "window_state_path=%s\n", config->paths.window_state_path);
     fprintf(file, "autosave_dir=%s\n", config->paths.autosave_dir);
+    fprintf(file, "metrics_dir=%s\n", config->paths.metrics_dir);
     fprintf(file, "study_exam_date=%s\n", config->study.exam_date);
     fprintf(file, "study_saved_filters=%s\n", config->study.saved_filters);
     fprintf(file, "workspace_autosave_minutes=%u\n", config->workspace.autosave_minutes);
@@ -35,6 +35,8 @@ typedef struct HrDatabaseConfig {
     char path[PATH_MAX];        /**< Absolute path to the primary database file. */
     char backup_dir[PATH_MAX];  /**< Directory where automatic backups are stored. */
     HrBackupPolicy backup;      /**< Backup retention policy. */
+    bool profile_statements;    /**< Profile every statement (devtools builds only). */
+    unsigned int slow_query_ms; /**< Statements at least this slow go to cache_dir/slow_queries.log (0 = off). */
 } HrDatabaseConfig;
 
 /**
@@ -44,6 +46,11 @@ typedef struct HrUiConfig {
     unsigned int scale_percent;      /**< Interface scale multiplier (percentage). */
     unsigned int font_size_pt;       /**< Base font size in points for body text. */
     char theme_palette[64];          /**< Active theme palette identifier. */
+    char hotkey_reveal[32];          /**< Key sequence revealing the answer in rapid review. */
+    char hotkey_again[32];           /**< Key sequences grading the card on screen. */
+    char hotkey_hard[32];
+    char hotkey_good[32];
+    char hotkey_easy[32];
 } HrUiConfig;
 
 /**
@@ -65,7 +72,15 @@ typedef struct HrWorkspaceConfig {
  * @brief Configuration for analytics capture.
  */
 typedef struct HrAnalyticsConfig {
-    bool enabled; /**< Whether analytics events should be recorded. */
+    bool enabled;              /**< Whether analytics events should be recorded. */
+    unsigned int heatmap_days; /**< Days of history kept by the activity heatmap. */
+    bool columnar_cache;       /**< Keep a column store of the review log for ad-hoc queries. */
+    bool calibrate_intervals;  /**< Scale scheduled intervals by the fitted forgetting curves. */
+    unsigned int export_seconds;     /**< Seconds between metrics snapshots written to metrics_dir (0 = off). */
+    char export_format[16];          /**< "ndjson", "prometheus" or "both". */
+    unsigned int export_max_kb;      /**< NDJSON size that triggers a rotation (0 = never rotate). */
+    unsigned int export_keep_files;  /**< Rotated NDJSON files kept. */
+    bool trace_spans;                /**< Record hot-path spans and write cache_dir/spans.json on exit. */
 } HrAnalyticsConfig;
 
 /**
@@ -74,6 +89,8 @@ typedef struct HrAnalyticsConfig {
 typedef struct HrSrsConfig {
     unsigned int daily_new_cards;     /**< Maximum new cards introduced per day. */
     unsigned int daily_review_limit;  /**< Maximum review cards processed per day. */
+    unsigned int fuzz_percent;        /**< Share of an interval the load balancer may shift a due date by. */
+    unsigned int fuzz_max_days;       /**< Longest load-balancer shift in days. */
 } HrSrsConfig;
 
 /**
@@ -86,6 +103,7 @@ typedef struct HrPathConfig {
     char settings_path[PATH_MAX];/**< Fully qualified path to the settings file. */
     char window_state_path[PATH_MAX]; /**< Path to the persisted window geometry file. */
     char autosave_dir[PATH_MAX];      /**< Directory where autosave snapshots are stored. */
+    char metrics_dir[PATH_MAX];       /**< Directory where metrics snapshots are exported. */
 } HrPathConfig;
 
 /**
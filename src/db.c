@@ -5,8 +5,11 @@
 #include "db.h"
 
 #include "cfg.h"
+#include "frame_profile.h"
+#include "span_trace.h"
 
 #include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -38,6 +41,7 @@ struct DatabaseHandle {
     char database_path[PATH_MAX];
     char backup_dir[PATH_MAX];
     HrBackupPolicy backup_policy;
+    struct HrSqlProfiler *profiler; /* Non-NULL while statements are profiled (devtools builds only). */
 };
 
 struct Migration {
@@ -109,6 +113,47 @@ static const struct Migration kMigrations[] = {
         "\nCREATE INDEX IF NOT EXISTS idx_reviews_card_time ON reviews(card_id, reviewed_at);"
         "\nCREATE INDEX IF NOT EXISTS idx_reviews_timestamp ON reviews(reviewed_at);"
     },
+    {
+        3U,
+        "CREATE INDEX IF NOT EXISTS idx_cards_new ON cards(review_state, suspended, id);"
+    },
+    {
+        4U,
+        "CREATE TABLE IF NOT EXISTS session_checkpoints ("
+        " slot INTEGER PRIMARY KEY,"
+        " mode INTEGER NOT NULL,"
+        " remaining INTEGER NOT NULL,"
+        " saved_at INTEGER NOT NULL,"
+        " payload BLOB NOT NULL"
+        ");"
+    },
+    {
+        5U,
+        "CREATE TABLE IF NOT EXISTS exam_sessions ("
+        " id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        " started_at INTEGER NOT NULL,"
+        " finished_at INTEGER NOT NULL,"
+        " card_count INTEGER NOT NULL,"
+        " section_count INTEGER NOT NULL,"
+        " answered INTEGER NOT NULL,"
+        " correct INTEGER NOT NULL,"
+        " timed_out INTEGER NOT NULL,"
+        " score REAL NOT NULL,"
+        " readiness REAL NOT NULL,"
+        " median_latency_ms INTEGER NOT NULL"
+        ");"
+        "\nCREATE TABLE IF NOT EXISTS exam_answers ("
+        " exam_id INTEGER NOT NULL REFERENCES exam_sessions(id) ON DELETE CASCADE,"
+        " position INTEGER NOT NULL,"
+        " card_id INTEGER NOT NULL REFERENCES cards(id) ON DELETE CASCADE,"
+        " section INTEGER NOT NULL,"
+        " rating INTEGER NOT NULL,"
+        " duration_ms INTEGER NOT NULL,"
+        " timed_out INTEGER NOT NULL,"
+        " PRIMARY KEY (exam_id, position)"
+        ");"
+        "\nCREATE INDEX IF NOT EXISTS idx_exam_answers_card ON exam_answers(card_id);"
+    },
 };
 
 static int ensure_directory(const char *path)
@@ -228,6 +273,7 @@ static int fetch_schema_version(sqlite3 *db, unsigned int *version)
         if (text != NULL) {
             *version = (unsigned int)strtoul((const char *)text, NULL, 10);
         }
+        rc = SQLITE_OK;
     } else if (rc == SQLITE_DONE) {
         *version = 0U;
         rc = SQLITE_OK;
@@ -511,6 +557,29 @@ static int create_backup_file(DatabaseHandle *handle, const char *tag)
     return rc;
 }
 
+#if HYPERRECALL_ENABLE_DEVTOOLS
+/* Attaches the statement profiler; the slow-query log lives next to the other diagnostics in cache_dir. */
+static void start_profiling(DatabaseHandle *handle, const HrConfig *cfg)
+{
+    char log_path[PATH_MAX];
+    int written = snprintf(log_path, sizeof(log_path), "%s/slow_queries.log", cfg->paths.cache_dir);
+    const bool log_ready = written >= 0 && (size_t)written < sizeof(log_path) && ensure_directory(cfg->paths.cache_dir) == 0;
+
+    const HrSqlProfileConfig profile_config = {
+        .slow_query_ms = cfg->database.slow_query_ms,
+        .slow_log_path = log_ready ? log_path : NULL,
+    };
+    handle->profiler = sql_profiler_create(&profile_config);
+    if (handle->profiler != NULL && !sql_profiler_attach(handle->profiler, handle->connection)) {
+        sql_profiler_destroy(handle->profiler);
+        handle->profiler = NULL;
+    }
+    if (handle->profiler == NULL) {
+        fprintf(stderr, "Failed to start statement profiling\n");
+    }
+}
+#endif /* HYPERRECALL_ENABLE_DEVTOOLS */
+
 DatabaseHandle *db_open(const struct ConfigHandle *config)
 {
     if (config == NULL) {
@@ -567,6 +636,12 @@ DatabaseHandle *db_open(const struct ConfigHandle *config)
         (void)create_backup_file(handle, "auto");
     }
 
+#if HYPERRECALL_ENABLE_DEVTOOLS
+    if (cfg->database.profile_statements) {
+        start_profiling(handle, cfg);
+    }
+#endif
+
     return handle;
 }
 
@@ -576,6 +651,13 @@ void db_close(DatabaseHandle *handle)
         return;
     }
 
+    if (handle->profiler != NULL) {
+        (void)sql_profiler_write_slow_log(handle->profiler, handle->connection);
+        sql_profiler_detach(handle->connection);
+        sql_profiler_destroy(handle->profiler);
+        handle->profiler = NULL;
+    }
+
     if (handle->connection != NULL) {
         sqlite3_close(handle->connection);
         handle->connection = NULL;
@@ -607,7 +689,12 @@ int db_exec(DatabaseHandle *handle, const char *sql)
     if (handle == NULL) {
         return SQLITE_MISUSE;
     }
-    return exec_simple(handle->connection, sql);
+    HR_SPAN_BEGIN(span, "db.exec");
+    const uint64_t started = frame_profile_begin();
+    const int rc = exec_simple(handle->connection, sql);
+    frame_profile_end(HR_FRAME_PHASE_DB, started);
+    HR_SPAN_END(span);
+    return rc;
 }
 
 int db_begin(DatabaseHandle *handle)
@@ -631,20 +718,20 @@ int db_run_in_transaction(DatabaseHandle *handle, HrDbTxnCallback callback, void
         return SQLITE_MISUSE;
     }
 
+    /* The callback's statements and the commit count as database time of the current frame. */
+    HR_SPAN_BEGIN(span, "db.transaction");
+    const uint64_t started = frame_profile_begin();
     int rc = db_begin(handle);
-    if (rc != SQLITE_OK) {
-        return rc;
-    }
-
-    rc = callback(handle->connection, user_data);
     if (rc == SQLITE_OK) {
-        int commit_rc = db_commit(handle);
-        if (commit_rc != SQLITE_OK) {
-            return commit_rc;
+        rc = callback(handle->connection, user_data);
+        if (rc == SQLITE_OK) {
+            rc = db_commit(handle);
+        } else {
+            (void)db_rollback(handle);
         }
-    } else {
-        (void)db_rollback(handle);
     }
+    frame_profile_end(HR_FRAME_PHASE_DB, started);
+    HR_SPAN_END(span);
 
     return rc;
 }
@@ -655,8 +742,58 @@ int db_create_backup(DatabaseHandle *handle, const char *tag)
         return -EINVAL;
     }
 
-    return create_backup_file(handle, tag);
+    HR_SPAN_BEGIN(span, "db.backup");
+    const uint64_t started = frame_profile_begin();
+    const int rc = create_backup_file(handle, tag);
+    frame_profile_end(HR_FRAME_PHASE_DB, started);
+    HR_SPAN_END(span);
+    return rc;
+}
+
+#if HYPERRECALL_ENABLE_DEVTOOLS
+bool db_profile_enabled(const DatabaseHandle *handle)
+{
+    return handle != NULL && handle->profiler != NULL;
+}
+
+size_t db_profile_statements(DatabaseHandle *handle, HrSqlStatementStats *out, size_t capacity)
+{
+    return handle != NULL ? sql_profiler_snapshot(handle->profiler, out, capacity) : 0U;
+}
+
+void db_profile_get_stats(DatabaseHandle *handle, HrSqlProfileStats *out_stats)
+{
+    sql_profiler_get_stats(handle != NULL ? handle->profiler : NULL, out_stats);
+}
+
+void db_profile_reset(DatabaseHandle *handle)
+{
+    if (handle != NULL) {
+        sql_profiler_reset(handle->profiler);
+    }
+}
+
+void db_profile_set_slow_threshold(DatabaseHandle *handle, unsigned int slow_query_ms)
+{
+    if (handle != NULL) {
+        sql_profiler_set_slow_threshold(handle->profiler, slow_query_ms);
+    }
+}
+
+size_t db_profile_flush_slow_log(DatabaseHandle *handle)
+{
+    if (handle == NULL || !sql_profiler_has_slow(handle->profiler)) {
+        return 0U;
+    }
+    /* The EXPLAIN statements run on this connection, so they count as database time. */
+    HR_SPAN_BEGIN(span, "db.slow_log");
+    const uint64_t started = frame_profile_begin();
+    const size_t written = sql_profiler_write_slow_log(handle->profiler, handle->connection);
+    frame_profile_end(HR_FRAME_PHASE_DB, started);
+    HR_SPAN_END(span);
+    return written;
 }
+#endif /* HYPERRECALL_ENABLE_DEVTOOLS */
 
 int db_topic_prepare_insert(DatabaseHandle *handle, sqlite3_stmt **statement)
 {
@@ -756,6 +893,13 @@ int db_topic_bind_delete(sqlite3_stmt *statement, sqlite3_int64 topic_id)
     return sqlite3_bind_int64(statement, 1, topic_id);
 }
 
+int db_topic_prepare_select_tree(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "SELECT t.uuid, p.uuid, t.title FROM topics t LEFT JOIN topics p ON p.id = t.parent_id;";
+    return db_prepare(handle, statement, sql);
+}
+
 int db_topic_prepare_select_by_uuid(DatabaseHandle *handle, sqlite3_stmt **statement)
 {
     static const char *sql =
@@ -898,6 +1042,43 @@ int db_card_bind_update(sqlite3_stmt *statement, const HrCardRecord *record)
     return rc;
 }
 
+int db_card_prepare_update_schedule(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "UPDATE cards SET updated_at=?2, due_at=?3, interval=?4, ease_factor=?5, review_state=?6 WHERE id=?1;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_card_bind_update_schedule(sqlite3_stmt *statement, const HrCardScheduleRecord *record)
+{
+    if (statement == NULL || record == NULL || record->id <= 0) {
+        return SQLITE_MISUSE;
+    }
+
+    int rc = sqlite3_bind_int64(statement, 1, record->id);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    rc = sqlite3_bind_int64(statement, 2, record->updated_at);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    rc = sqlite3_bind_int64(statement, 3, record->due_at);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    rc = sqlite3_bind_int(statement, 4, record->interval);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    rc = sqlite3_bind_int(statement, 5, record->ease_factor);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    rc = sqlite3_bind_int(statement, 6, record->review_state);
+    return rc;
+}
+
 int db_card_prepare_delete(DatabaseHandle *handle, sqlite3_stmt **statement)
 {
     static const char *sql = "DELETE FROM cards WHERE id=?1;";
@@ -934,6 +1115,346 @@ int db_card_bind_select_due(sqlite3_stmt *statement, const HrCardDueQuery *query
     return rc;
 }
 
+int db_card_prepare_due_histogram(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "SELECT due_at / 86400 AS day, COUNT(*) AS due_count FROM cards "
+        "WHERE suspended=0 AND due_at >= ?1 AND due_at < ?2 GROUP BY day ORDER BY day;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_card_bind_due_histogram(sqlite3_stmt *statement, const HrDueHistogramQuery *query)
+{
+    if (statement == NULL || query == NULL || query->end_at <= query->start_at) {
+        return SQLITE_MISUSE;
+    }
+
+    int rc = sqlite3_bind_int64(statement, 1, query->start_at);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    rc = sqlite3_bind_int64(statement, 2, query->end_at);
+    return rc;
+}
+
+int db_card_prepare_select_scheduled(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "SELECT c.id, c.due_at, c.interval, c.ease_factor, c.review_state, t.uuid FROM cards c "
+        "JOIN topics t ON t.id = c.topic_id "
+        "WHERE c.suspended=0 AND c.review_state<>0 AND c.due_at > 0 AND c.due_at <= ?1 "
+        "ORDER BY c.due_at ASC, c.id ASC LIMIT ?2;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_card_prepare_select_new(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "SELECT c.id, c.due_at, c.interval, c.ease_factor, c.review_state, t.uuid FROM cards c "
+        "JOIN topics t ON t.id = c.topic_id "
+        "WHERE c.review_state=0 AND c.suspended=0 ORDER BY c.id ASC LIMIT ?2;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_card_bind_select_scheduled(sqlite3_stmt *statement, const HrCardDueQuery *query)
+{
+    if (statement == NULL || query == NULL || query->limit < 0) {
+        return SQLITE_MISUSE;
+    }
+
+    /* New-card selection leaves ?1 unused; binding an unused slot is harmless. */
+    int rc = sqlite3_bind_int64(statement, 1, query->latest_due_at);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    rc = sqlite3_bind_int(statement, 2, query->limit);
+    return rc;
+}
+
+int db_card_prepare_select_scheduled_page(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    /* Keyset pagination: each page resumes after the last (due_at, id) served, walking idx_cards_due. */
+    static const char *sql =
+        "SELECT c.id, c.due_at, c.interval, c.ease_factor, c.review_state, t.uuid FROM cards c "
+        "JOIN topics t ON t.id = c.topic_id "
+        "WHERE c.suspended=0 AND c.review_state<>0 AND c.due_at > 0 AND c.due_at <= ?1 "
+        "AND (c.due_at > ?2 OR (c.due_at = ?2 AND c.id > ?3)) "
+        "ORDER BY c.due_at ASC, c.id ASC LIMIT ?4;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_card_prepare_select_new_page(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "SELECT c.id, c.due_at, c.interval, c.ease_factor, c.review_state, t.uuid FROM cards c "
+        "JOIN topics t ON t.id = c.topic_id "
+        "WHERE c.review_state=0 AND c.suspended=0 AND c.id > ?3 ORDER BY c.id ASC LIMIT ?4;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_card_bind_select_page(sqlite3_stmt *statement, const HrCardPageQuery *query)
+{
+    if (statement == NULL || query == NULL || query->limit < 0) {
+        return SQLITE_MISUSE;
+    }
+
+    /* New-card pages leave ?1 and ?2 unused; binding an unused slot is harmless. */
+    int rc = sqlite3_bind_int64(statement, 1, query->latest_due_at);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    rc = sqlite3_bind_int64(statement, 2, query->after_due_at);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    rc = sqlite3_bind_int64(statement, 3, query->after_id);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    rc = sqlite3_bind_int(statement, 4, query->limit);
+    return rc;
+}
+
+int db_card_prepare_select_body(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql = "SELECT prompt, response, mnemonic FROM cards WHERE id=?1;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_card_bind_select_body(sqlite3_stmt *statement, sqlite3_int64 card_id)
+{
+    if (statement == NULL) {
+        return SQLITE_MISUSE;
+    }
+    return sqlite3_bind_int64(statement, 1, card_id);
+}
+
+int db_card_prepare_select_exam_pool(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    /* Column 6 is the size of the card's topic, so samplers can weight topics rather than cards. */
+    static const char *sql =
+        "SELECT c.id, c.due_at, c.interval, c.ease_factor, c.review_state, t.uuid, s.topic_cards FROM cards c "
+        "JOIN topics t ON t.id = c.topic_id "
+        "JOIN (SELECT topic_id, COUNT(*) AS topic_cards FROM cards WHERE suspended=0 GROUP BY topic_id) s "
+        "ON s.topic_id = c.topic_id "
+        "WHERE c.suspended=0;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_card_prepare_select_overdue(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    /* Unordered on purpose: callers rank rows themselves while streaming. */
+    static const char *sql =
+        "SELECT c.id, c.due_at, c.interval, c.ease_factor, c.review_state, t.uuid FROM cards c "
+        "JOIN topics t ON t.id = c.topic_id "
+        "WHERE c.suspended=0 AND c.review_state<>0 AND c.due_at > 0 AND c.due_at <= ?1;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_card_bind_select_overdue(sqlite3_stmt *statement, sqlite3_int64 latest_due_at)
+{
+    if (statement == NULL) {
+        return SQLITE_MISUSE;
+    }
+    return sqlite3_bind_int64(statement, 1, latest_due_at);
+}
+
+int db_card_prepare_count_due(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "SELECT (SELECT COUNT(*) FROM cards WHERE suspended=0 AND review_state<>0 AND due_at > 0 AND due_at <= ?1), "
+        "(SELECT COUNT(*) FROM cards WHERE review_state=0 AND suspended=0);";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_card_bind_count_due(sqlite3_stmt *statement, sqlite3_int64 latest_due_at)
+{
+    if (statement == NULL) {
+        return SQLITE_MISUSE;
+    }
+    return sqlite3_bind_int64(statement, 1, latest_due_at);
+}
+
+int db_review_prepare_delete(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql = "DELETE FROM reviews WHERE id=?1;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_review_bind_delete(sqlite3_stmt *statement, sqlite3_int64 review_id)
+{
+    if (statement == NULL) {
+        return SQLITE_MISUSE;
+    }
+    return sqlite3_bind_int64(statement, 1, review_id);
+}
+
+int db_checkpoint_prepare_upsert(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "INSERT INTO session_checkpoints(slot, mode, remaining, saved_at, payload) VALUES(?1, ?2, ?3, ?4, ?5) "
+        "ON CONFLICT(slot) DO UPDATE SET mode=excluded.mode, remaining=excluded.remaining, "
+        "saved_at=excluded.saved_at, payload=excluded.payload;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_checkpoint_bind_upsert(sqlite3_stmt *statement, const HrSessionCheckpointRecord *record)
+{
+    if (statement == NULL || record == NULL || record->payload == NULL || record->payload_size > (size_t)INT_MAX) {
+        return SQLITE_MISUSE;
+    }
+
+    int rc = sqlite3_bind_int(statement, 1, record->slot);
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 2, record->mode);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int64(statement, 3, record->remaining);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int64(statement, 4, record->saved_at);
+    }
+    if (rc == SQLITE_OK) {
+        /* The payload only has to outlive the step, which callers run before freeing it. */
+        rc = sqlite3_bind_blob(statement, 5, record->payload, (int)record->payload_size, SQLITE_STATIC);
+    }
+    return rc;
+}
+
+int db_checkpoint_prepare_select(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "SELECT mode, remaining, saved_at, payload FROM session_checkpoints WHERE slot=?1;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_checkpoint_prepare_delete(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql = "DELETE FROM session_checkpoints WHERE slot=?1;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_checkpoint_bind_slot(sqlite3_stmt *statement, int slot)
+{
+    if (statement == NULL) {
+        return SQLITE_MISUSE;
+    }
+    return sqlite3_bind_int(statement, 1, slot);
+}
+
+int db_exam_prepare_insert(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "INSERT INTO exam_sessions(started_at, finished_at, card_count, section_count, answered, correct, "
+        "timed_out, score, readiness, median_latency_ms) VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10);";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_exam_bind_insert(sqlite3_stmt *statement, const HrExamRecord *record)
+{
+    if (statement == NULL || record == NULL) {
+        return SQLITE_MISUSE;
+    }
+
+    int rc = sqlite3_bind_int64(statement, 1, record->started_at);
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int64(statement, 2, record->finished_at);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 3, record->card_count);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 4, record->section_count);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 5, record->answered);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 6, record->correct);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 7, record->timed_out);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_double(statement, 8, record->score);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_double(statement, 9, record->readiness);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 10, record->median_latency_ms);
+    }
+    return rc;
+}
+
+int db_exam_prepare_insert_answer(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "INSERT INTO exam_answers(exam_id, position, card_id, section, rating, duration_ms, timed_out) "
+        "VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7);";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_exam_bind_insert_answer(sqlite3_stmt *statement, const HrExamAnswerRecord *record)
+{
+    if (statement == NULL || record == NULL) {
+        return SQLITE_MISUSE;
+    }
+
+    int rc = sqlite3_bind_int64(statement, 1, record->exam_id);
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 2, record->position);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int64(statement, 3, record->card_id);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 4, record->section);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 5, record->rating);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 6, record->duration_ms);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_bind_int(statement, 7, record->timed_out ? 1 : 0);
+    }
+    return rc;
+}
+
+int db_review_prepare_daily_activity(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "SELECT COUNT(*) AS total_reviews, "
+        "COALESCE(SUM(CASE WHEN review_state = 0 THEN 1 ELSE 0 END), 0) AS new_reviews "
+        "FROM reviews WHERE reviewed_at >= ?1 AND reviewed_at < ?2;";
+    return db_prepare(handle, statement, sql);
+}
+
+int db_review_bind_daily_activity(sqlite3_stmt *statement, const HrReviewSummaryQuery *query)
+{
+    if (statement == NULL || query == NULL || query->end_at <= query->start_at) {
+        return SQLITE_MISUSE;
+    }
+
+    int rc = sqlite3_bind_int64(statement, 1, query->start_at);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    rc = sqlite3_bind_int64(statement, 2, query->end_at);
+    return rc;
+}
+
+int db_review_prepare_select_log(DatabaseHandle *handle, sqlite3_stmt **statement)
+{
+    static const char *sql =
+        "SELECT r.reviewed_at, r.rating, r.scheduled_interval, r.actual_interval, r.duration_ms, t.uuid, r.card_id, r.ease_factor "
+        "FROM reviews r LEFT JOIN cards c ON c.id = r.card_id LEFT JOIN topics t ON t.id = c.topic_id "
+        "ORDER BY r.reviewed_at, r.id;";
+    return db_prepare(handle, statement, sql);
+}
+
 int db_review_prepare_bulk_insert(DatabaseHandle *handle, sqlite3_stmt **statement)
 {
     static const char *sql =
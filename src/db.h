@@ -11,8 +11,11 @@ extern "C" {
  */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <sqlite3.h>
 
+#include "sql_profile.h"
+
 struct ConfigHandle;
 
 typedef struct DatabaseHandle DatabaseHandle;
@@ -46,11 +49,33 @@ typedef struct HrCardRecord {
     bool suspended;
 } HrCardRecord;
 
+typedef struct HrCardScheduleRecord {
+    sqlite3_int64 id;
+    sqlite3_int64 updated_at;
+    sqlite3_int64 due_at;
+    int interval;
+    int ease_factor;
+    int review_state;
+} HrCardScheduleRecord;
+
 typedef struct HrCardDueQuery {
     sqlite3_int64 latest_due_at;
     int limit;
 } HrCardDueQuery;
 
+/* Keyset page over the study queue: rows strictly after (after_due_at, after_id). */
+typedef struct HrCardPageQuery {
+    sqlite3_int64 latest_due_at;
+    sqlite3_int64 after_due_at;
+    sqlite3_int64 after_id;
+    int limit;
+} HrCardPageQuery;
+
+typedef struct HrDueHistogramQuery {
+    sqlite3_int64 start_at;
+    sqlite3_int64 end_at;
+} HrDueHistogramQuery;
+
 typedef struct HrReviewRecord {
     sqlite3_int64 card_id;
     sqlite3_int64 reviewed_at;
@@ -59,9 +84,43 @@ typedef struct HrReviewRecord {
     int scheduled_interval;
     int actual_interval;
     int ease_factor;
-    int review_state;
+    int review_state;     /* Card state before the review (0 = new); counted by daily activity. */
 } HrReviewRecord;
 
+/* Serialized study queue saved so an interrupted session can be resumed. */
+typedef struct HrSessionCheckpointRecord {
+    int slot;                /* Session slot; the primary session uses 0, an exam in progress 1. */
+    int mode;
+    sqlite3_int64 remaining;
+    sqlite3_int64 saved_at;
+    const void *payload;     /* session_manager_checkpoint() or exam_checkpoint() output. */
+    size_t payload_size;
+} HrSessionCheckpointRecord;
+
+/* Summary row of a finished exam simulation (kept apart from the review log). */
+typedef struct HrExamRecord {
+    sqlite3_int64 started_at;
+    sqlite3_int64 finished_at;
+    int card_count;
+    int section_count;
+    int answered;
+    int correct;
+    int timed_out;
+    double score;
+    double readiness;
+    int median_latency_ms;
+} HrExamRecord;
+
+typedef struct HrExamAnswerRecord {
+    sqlite3_int64 exam_id;
+    int position;
+    sqlite3_int64 card_id;
+    int section;
+    int rating;          /* -1 when the section clock ran out before an answer. */
+    int duration_ms;
+    bool timed_out;
+} HrExamAnswerRecord;
+
 typedef struct HrReviewSummaryQuery {
     sqlite3_int64 start_at;
     sqlite3_int64 end_at;
@@ -89,6 +148,26 @@ int db_run_in_transaction(DatabaseHandle *handle, HrDbTxnCallback callback, void
 
 int db_create_backup(DatabaseHandle *handle, const char *tag);
 
+#if HYPERRECALL_ENABLE_DEVTOOLS
+/*
+ * Statement profiling, on when db_profile_statements is set. The functions
+ * below are safe to call either way and report nothing while it is off.
+ */
+bool db_profile_enabled(const DatabaseHandle *handle);
+
+/* Statements by total time, most expensive first; returns how many were copied. */
+size_t db_profile_statements(DatabaseHandle *handle, HrSqlStatementStats *out, size_t capacity);
+
+void db_profile_get_stats(DatabaseHandle *handle, HrSqlProfileStats *out_stats);
+
+void db_profile_reset(DatabaseHandle *handle);
+
+void db_profile_set_slow_threshold(DatabaseHandle *handle, unsigned int slow_query_ms);
+
+/* Appends queued slow statements and their query plans to the slow-query log. */
+size_t db_profile_flush_slow_log(DatabaseHandle *handle);
+#endif /* HYPERRECALL_ENABLE_DEVTOOLS */
+
 int db_topic_prepare_insert(DatabaseHandle *handle, sqlite3_stmt **statement);
 
 int db_topic_bind_insert(sqlite3_stmt *statement, const HrTopicRecord *record);
@@ -101,6 +180,9 @@ int db_topic_prepare_delete(DatabaseHandle *handle, sqlite3_stmt **statement);
 
 int db_topic_bind_delete(sqlite3_stmt *statement, sqlite3_int64 topic_id);
 
+/* Every topic as (uuid, parent uuid or NULL, title); no binding needed. */
+int db_topic_prepare_select_tree(DatabaseHandle *handle, sqlite3_stmt **statement);
+
 int db_topic_prepare_select_by_uuid(DatabaseHandle *handle, sqlite3_stmt **statement);
 
 int db_topic_bind_select_by_uuid(sqlite3_stmt *statement, const char *uuid);
@@ -113,6 +195,10 @@ int db_card_prepare_update(DatabaseHandle *handle, sqlite3_stmt **statement);
 
 int db_card_bind_update(sqlite3_stmt *statement, const HrCardRecord *record);
 
+int db_card_prepare_update_schedule(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_card_bind_update_schedule(sqlite3_stmt *statement, const HrCardScheduleRecord *record);
+
 int db_card_prepare_delete(DatabaseHandle *handle, sqlite3_stmt **statement);
 
 int db_card_bind_delete(sqlite3_stmt *statement, sqlite3_int64 card_id);
@@ -121,6 +207,71 @@ int db_card_prepare_select_due(DatabaseHandle *handle, sqlite3_stmt **statement)
 
 int db_card_bind_select_due(sqlite3_stmt *statement, const HrCardDueQuery *query);
 
+int db_card_prepare_due_histogram(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_card_bind_due_histogram(sqlite3_stmt *statement, const HrDueHistogramQuery *query);
+
+int db_card_prepare_select_scheduled(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_card_prepare_select_new(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_card_bind_select_scheduled(sqlite3_stmt *statement, const HrCardDueQuery *query);
+
+int db_card_prepare_select_scheduled_page(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_card_prepare_select_new_page(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_card_bind_select_page(sqlite3_stmt *statement, const HrCardPageQuery *query);
+
+int db_card_prepare_select_body(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_card_bind_select_body(sqlite3_stmt *statement, sqlite3_int64 card_id);
+
+/* Every unsuspended card with its topic uuid and topic size; no binding needed. */
+int db_card_prepare_select_exam_pool(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_card_prepare_select_overdue(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_card_bind_select_overdue(sqlite3_stmt *statement, sqlite3_int64 latest_due_at);
+
+int db_card_prepare_count_due(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_card_bind_count_due(sqlite3_stmt *statement, sqlite3_int64 latest_due_at);
+
+int db_review_prepare_delete(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_review_bind_delete(sqlite3_stmt *statement, sqlite3_int64 review_id);
+
+int db_checkpoint_prepare_upsert(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_checkpoint_bind_upsert(sqlite3_stmt *statement, const HrSessionCheckpointRecord *record);
+
+int db_checkpoint_prepare_select(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_checkpoint_prepare_delete(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+/* Binds the slot for both the select and delete statements. */
+int db_checkpoint_bind_slot(sqlite3_stmt *statement, int slot);
+
+int db_exam_prepare_insert(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_exam_bind_insert(sqlite3_stmt *statement, const HrExamRecord *record);
+
+int db_exam_prepare_insert_answer(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_exam_bind_insert_answer(sqlite3_stmt *statement, const HrExamAnswerRecord *record);
+
+int db_review_prepare_daily_activity(DatabaseHandle *handle, sqlite3_stmt **statement);
+
+int db_review_bind_daily_activity(sqlite3_stmt *statement, const HrReviewSummaryQuery *query);
+
+/*
+ * Every review in time order as (reviewed_at, rating, scheduled_interval,
+ * actual_interval, duration_ms, topic uuid, card_id, ease_factor); no binding
+ * needed.
+ */
+int db_review_prepare_select_log(DatabaseHandle *handle, sqlite3_stmt **statement);
+
 int db_review_prepare_bulk_insert(DatabaseHandle *handle, sqlite3_stmt **statement);
 
 int db_review_bind_bulk_insert(sqlite3_stmt *statement, const HrReviewRecord *record);
@@ -0,0 +1,456 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "event_bus.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "span_trace.h"
+#include "sync.h"
+
+/** A queued event with owned copies of everything it points to. */
+typedef struct BusEntry {
+    SessionReviewEvent event; /* state and topic_id point into this entry. */
+    SRSState state;
+    SRSPersistedState persisted;
+    char topic_id[SESSION_MAX_KEY_LENGTH];
+    uint64_t ticket;          /* Autosave ticket, 0 for events delivered to subscribers. */
+    bool durable;             /* Writer outcome, set by the bus thread. */
+} BusEntry;
+
+typedef struct BusSubscriber {
+    HrEventDelivery delivery;
+    HrEventHandler handler;
+    void *user_data;
+} BusSubscriber;
+
+/*
+ * The queue is a ring indexed by three monotonically increasing cursors:
+ * producers append at head, the bus thread works through dispatch, and the
+ * pump follows behind at pump. pump <= dispatch <= head always holds, so a
+ * slot is only reused after both consumers are done with it, and the bus
+ * thread can read an entry without the lock.
+ */
+struct HrEventBus {
+    BusEntry *entries;
+    size_t capacity;
+    uint64_t head;
+    uint64_t dispatch;
+    uint64_t pump;
+
+    BusSubscriber subscribers[HR_EVENT_BUS_MAX_SUBSCRIBERS];
+    size_t subscriber_count;
+    bool pump_needed; /* Some consumer runs from event_bus_pump(). */
+
+    HrEventDurableWriter writer;
+    void *writer_user_data;
+    HrEventAckHandler ack;
+    void *ack_user_data;
+    uint64_t next_ticket;
+    uint64_t acknowledged;
+
+    HrMutex lock;
+    HrCond work;     /* Signalled when events are queued or the bus stops. */
+    HrCond progress; /* Broadcast when either consumer advances. */
+    HrThread worker;
+    bool worker_started;
+    bool running;
+    bool stop;
+    bool pumping;
+
+    HrEventBusStats stats;
+};
+
+static void bus_copy_event(BusEntry *entry, const SessionReviewEvent *event)
+{
+    entry->event = *event;
+    if (event->state != NULL) {
+        entry->state = *event->state;
+        entry->event.state = &entry->state;
+    }
+    entry->topic_id[0] = '\0';
+    if (event->context.topic.topic_id != NULL) {
+        snprintf(entry->topic_id, sizeof(entry->topic_id), "%s", event->context.topic.topic_id);
+        entry->event.context.topic.topic_id = entry->topic_id;
+    }
+    entry->ticket = 0u;
+    entry->durable = false;
+}
+
+/* Delivers dispatched events on the calling thread; called and returns with the lock held. */
+static size_t bus_pump_locked(struct HrEventBus *bus, size_t max_events)
+{
+    bus->pumping = true;
+    size_t delivered = 0u;
+    while (bus->pump < bus->dispatch && (max_events == 0u || delivered < max_events)) {
+        const BusEntry *entry = &bus->entries[bus->pump % bus->capacity];
+        hr_mutex_unlock(&bus->lock);
+
+        for (size_t i = 0; entry->ticket == 0u && i < bus->subscriber_count; ++i) {
+            const BusSubscriber *subscriber = &bus->subscribers[i];
+            if (subscriber->delivery == HR_EVENT_DELIVER_PUMP) {
+                subscriber->handler(&entry->event, subscriber->user_data);
+            }
+        }
+        if (entry->ticket != 0u && bus->ack != NULL) {
+            bus->ack(entry->ticket, entry->event.card_id, entry->durable, bus->ack_user_data);
+        }
+
+        hr_mutex_lock(&bus->lock);
+        bus->pump++;
+        bus->stats.pumped++;
+        delivered++;
+        hr_cond_broadcast(&bus->progress);
+    }
+    bus->pumping = false;
+    hr_cond_broadcast(&bus->progress);
+    return delivered;
+}
+
+static void bus_worker(void *user_data)
+{
+    struct HrEventBus *bus = (struct HrEventBus *)user_data;
+
+    span_trace_name_thread("event_bus");
+    hr_mutex_lock(&bus->lock);
+    for (;;) {
+        while (bus->dispatch == bus->head && !bus->stop) {
+            hr_cond_wait(&bus->work, &bus->lock);
+        }
+        if (bus->dispatch == bus->head) {
+            break; /* Stopping and drained. */
+        }
+
+        BusEntry *entry = &bus->entries[bus->dispatch % bus->capacity];
+        hr_mutex_unlock(&bus->lock);
+
+        if (entry->ticket != 0u) {
+            entry->durable = bus->writer(&entry->event, &entry->persisted, bus->writer_user_data);
+        }
+        for (size_t i = 0; entry->ticket == 0u && i < bus->subscriber_count; ++i) {
+            const BusSubscriber *subscriber = &bus->subscribers[i];
+            if (subscriber->delivery == HR_EVENT_DELIVER_DISPATCHER) {
+                subscriber->handler(&entry->event, subscriber->user_data);
+            }
+        }
+
+        hr_mutex_lock(&bus->lock);
+        bus->dispatch++;
+        bus->stats.dispatched++;
+        if (entry->ticket != 0u) {
+            /* One thread writes in queue order, so tickets are acknowledged contiguously. */
+            bus->acknowledged = entry->ticket;
+            if (entry->durable) {
+                bus->stats.autosaves_durable++;
+            } else {
+                bus->stats.autosaves_failed++;
+            }
+        }
+        if (!bus->pump_needed) {
+            bus->pump = bus->dispatch;
+        }
+        hr_cond_broadcast(&bus->progress);
+    }
+    hr_mutex_unlock(&bus->lock);
+}
+
+/* Waits for a free slot and fills it; called and returns with the lock held. */
+static BusEntry *bus_reserve_locked(struct HrEventBus *bus)
+{
+    bool stalled = false;
+    while (bus->running && bus->head - bus->pump >= (uint64_t)bus->capacity) {
+        if (!stalled) {
+            bus->stats.producer_stalls++;
+            stalled = true;
+        }
+        if (bus->pump < bus->dispatch && !bus->pumping) {
+            /* Full of events nobody has pumped yet; waiting could deadlock the pumping thread. */
+            (void)bus_pump_locked(bus, 0u);
+        } else {
+            hr_cond_wait(&bus->progress, &bus->lock);
+        }
+    }
+    if (!bus->running) {
+        return NULL;
+    }
+    return &bus->entries[bus->head % bus->capacity];
+}
+
+static void bus_commit_locked(struct HrEventBus *bus)
+{
+    bus->head++;
+    bus->stats.published++;
+    const size_t queued = (size_t)(bus->head - bus->pump);
+    if (queued > bus->stats.high_water) {
+        bus->stats.high_water = queued;
+    }
+    hr_cond_signal(&bus->work);
+}
+
+static uint64_t bus_now_ms(void)
+{
+    struct timespec ts;
+    if (timespec_get(&ts, TIME_UTC) != TIME_UTC) {
+        return (uint64_t)time(NULL) * 1000u;
+    }
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)(ts.tv_nsec / 1000000L);
+}
+
+struct HrEventBus *event_bus_create(size_t capacity)
+{
+    if (capacity == 0u) {
+        capacity = HR_EVENT_BUS_DEFAULT_CAPACITY;
+    }
+
+    struct HrEventBus *bus = (struct HrEventBus *)calloc(1u, sizeof(struct HrEventBus));
+    if (bus == NULL) {
+        return NULL;
+    }
+
+    bus->entries = (BusEntry *)calloc(capacity, sizeof(BusEntry));
+    if (bus->entries == NULL) {
+        free(bus);
+        return NULL;
+    }
+    bus->capacity = capacity;
+
+    if (!hr_mutex_init(&bus->lock)) {
+        free(bus->entries);
+        free(bus);
+        return NULL;
+    }
+    if (!hr_cond_init(&bus->work)) {
+        hr_mutex_destroy(&bus->lock);
+        free(bus->entries);
+        free(bus);
+        return NULL;
+    }
+    if (!hr_cond_init(&bus->progress)) {
+        hr_cond_destroy(&bus->work);
+        hr_mutex_destroy(&bus->lock);
+        free(bus->entries);
+        free(bus);
+        return NULL;
+    }
+    return bus;
+}
+
+void event_bus_destroy(struct HrEventBus *bus)
+{
+    if (bus == NULL) {
+        return;
+    }
+
+    hr_mutex_lock(&bus->lock);
+    bus->running = false;
+    bus->stop = true;
+    hr_cond_signal(&bus->work);
+    hr_cond_broadcast(&bus->progress);
+    hr_mutex_unlock(&bus->lock);
+
+    if (bus->worker_started) {
+        hr_thread_join(&bus->worker);
+    }
+
+    /* Subscribers still get everything that was accepted before shutdown. */
+    hr_mutex_lock(&bus->lock);
+    (void)bus_pump_locked(bus, 0u);
+    hr_mutex_unlock(&bus->lock);
+
+    hr_cond_destroy(&bus->progress);
+    hr_cond_destroy(&bus->work);
+    hr_mutex_destroy(&bus->lock);
+    free(bus->entries);
+    free(bus);
+}
+
+bool event_bus_subscribe(struct HrEventBus *bus,
+                         HrEventDelivery delivery,
+                         HrEventHandler handler,
+                         void *user_data)
+{
+    if (bus == NULL || handler == NULL || bus->worker_started ||
+        bus->subscriber_count == HR_EVENT_BUS_MAX_SUBSCRIBERS) {
+        return false;
+    }
+
+    BusSubscriber *subscriber = &bus->subscribers[bus->subscriber_count++];
+    subscriber->delivery = delivery;
+    subscriber->handler = handler;
+    subscriber->user_data = user_data;
+    if (delivery == HR_EVENT_DELIVER_PUMP) {
+        bus->pump_needed = true;
+    }
+    return true;
+}
+
+bool event_bus_set_durable_writer(struct HrEventBus *bus,
+                                  HrEventDurableWriter writer,
+                                  void *writer_user_data,
+                                  HrEventAckHandler ack,
+                                  void *ack_user_data)
+{
+    if (bus == NULL || writer == NULL || bus->worker_started) {
+        return false;
+    }
+
+    bus->writer = writer;
+    bus->writer_user_data = writer_user_data;
+    bus->ack = ack;
+    bus->ack_user_data = ack_user_data;
+    if (ack != NULL) {
+        bus->pump_needed = true;
+    }
+    return true;
+}
+
+bool event_bus_start(struct HrEventBus *bus)
+{
+    if (bus == NULL) {
+        return false;
+    }
+    if (bus->worker_started) {
+        return true;
+    }
+
+    bus->running = true;
+    bus->worker_started = hr_thread_start(&bus->worker, bus_worker, bus);
+    bus->running = bus->worker_started;
+    return bus->worker_started;
+}
+
+bool event_bus_publish(struct HrEventBus *bus, const SessionReviewEvent *event)
+{
+    if (bus == NULL || event == NULL) {
+        return false;
+    }
+
+    hr_mutex_lock(&bus->lock);
+    BusEntry *entry = bus_reserve_locked(bus);
+    if (entry != NULL) {
+        bus_copy_event(entry, event);
+        bus_commit_locked(bus);
+    }
+    hr_mutex_unlock(&bus->lock);
+    return entry != NULL;
+}
+
+uint64_t event_bus_request_autosave(struct HrEventBus *bus,
+                                    const SessionReviewEvent *event,
+                                    const SRSPersistedState *persisted)
+{
+    if (bus == NULL || event == NULL || persisted == NULL || bus->writer == NULL) {
+        return 0u;
+    }
+
+    uint64_t ticket = 0u;
+    hr_mutex_lock(&bus->lock);
+    BusEntry *entry = bus_reserve_locked(bus);
+    if (entry != NULL) {
+        bus_copy_event(entry, event);
+        entry->persisted = *persisted;
+        ticket = ++bus->next_ticket;
+        entry->ticket = ticket;
+        bus->stats.autosaves_requested++;
+        bus_commit_locked(bus);
+    }
+    hr_mutex_unlock(&bus->lock);
+    return ticket;
+}
+
+size_t event_bus_pump(struct HrEventBus *bus, size_t max_events)
+{
+    if (bus == NULL) {
+        return 0u;
+    }
+
+    size_t delivered = 0u;
+    hr_mutex_lock(&bus->lock);
+    if (!bus->pumping) {
+        delivered = bus_pump_locked(bus, max_events);
+    }
+    hr_mutex_unlock(&bus->lock);
+    return delivered;
+}
+
+uint64_t event_bus_acknowledged(const struct HrEventBus *bus)
+{
+    if (bus == NULL) {
+        return 0u;
+    }
+
+    struct HrEventBus *mutable_bus = (struct HrEventBus *)bus;
+    hr_mutex_lock(&mutable_bus->lock);
+    const uint64_t acknowledged = bus->acknowledged;
+    hr_mutex_unlock(&mutable_bus->lock);
+    return acknowledged;
+}
+
+bool event_bus_wait_acknowledged(struct HrEventBus *bus, uint64_t ticket, uint32_t timeout_ms)
+{
+    if (bus == NULL) {
+        return false;
+    }
+
+    const uint64_t deadline = bus_now_ms() + timeout_ms;
+    hr_mutex_lock(&bus->lock);
+    while (bus->acknowledged < ticket && bus->worker_started) {
+        const uint64_t now = bus_now_ms();
+        if (now >= deadline) {
+            break;
+        }
+        (void)hr_cond_wait_timeout(&bus->progress, &bus->lock, (uint32_t)(deadline - now));
+    }
+    const bool acknowledged = bus->acknowledged >= ticket;
+    hr_mutex_unlock(&bus->lock);
+    return acknowledged;
+}
+
+void event_bus_flush(struct HrEventBus *bus)
+{
+    if (bus == NULL) {
+        return;
+    }
+
+    hr_mutex_lock(&bus->lock);
+    while (bus->worker_started && bus->dispatch != bus->head) {
+        hr_cond_wait(&bus->progress, &bus->lock);
+    }
+    while (bus->pumping) {
+        hr_cond_wait(&bus->progress, &bus->lock);
+    }
+    (void)bus_pump_locked(bus, 0u);
+    hr_mutex_unlock(&bus->lock);
+}
+
+void event_bus_stats(const struct HrEventBus *bus, HrEventBusStats *out_stats)
+{
+    if (out_stats == NULL) {
+        return;
+    }
+    memset(out_stats, 0, sizeof(*out_stats));
+    if (bus == NULL) {
+        return;
+    }
+
+    struct HrEventBus *mutable_bus = (struct HrEventBus *)bus;
+    hr_mutex_lock(&mutable_bus->lock);
+    *out_stats = bus->stats;
+    hr_mutex_unlock(&mutable_bus->lock);
+}
+
+void event_bus_publish_session_event(const SessionReviewEvent *event, void *user_data)
+{
+    (void)event_bus_publish((struct HrEventBus *)user_data, event);
+}
+
+bool event_bus_autosave_session_event(const SessionReviewEvent *event,
+                                      const SRSPersistedState *persisted,
+                                      void *user_data)
+{
+    return event_bus_request_autosave((struct HrEventBus *)user_data, event, persisted) != 0u;
+}
@@ -0,0 +1,144 @@
+#ifndef HYPERRECALL_EVENT_BUS_H
+#define HYPERRECALL_EVENT_BUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file event_bus.h
+ * @brief Delivers session review events to subscribers off the grading path.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sessions.h"
+
+/** Events queued by a bus created with a capacity of 0. */
+#define HR_EVENT_BUS_DEFAULT_CAPACITY 1024U
+
+/** Subscribers a bus accepts. */
+#define HR_EVENT_BUS_MAX_SUBSCRIBERS 8U
+
+/** Where a subscriber's handler runs. */
+typedef enum HrEventDelivery {
+    HR_EVENT_DELIVER_DISPATCHER = 0, /**< On the bus thread, as soon as the event is queued. */
+    HR_EVENT_DELIVER_PUMP = 1,       /**< On the thread calling event_bus_pump(), after dispatch. */
+} HrEventDelivery;
+
+/**
+ * Receives a copy of a review event. @p event and everything it points to
+ * are only valid for the duration of the call.
+ */
+typedef void (*HrEventHandler)(const SessionReviewEvent *event, void *user_data);
+
+/** Writes an autosave snapshot on the bus thread; returns true once it is durable. */
+typedef bool (*HrEventDurableWriter)(const SessionReviewEvent *event,
+                                     const SRSPersistedState *persisted,
+                                     void *user_data);
+
+/**
+ * Acknowledges autosave @p ticket from event_bus_pump(): @p durable is true
+ * when the writer stored it, false when it failed.
+ */
+typedef void (*HrEventAckHandler)(uint64_t ticket, uint64_t card_id, bool durable, void *user_data);
+
+/** Counters for tuning the queue size and spotting slow consumers. */
+typedef struct HrEventBusStats {
+    uint64_t published;          /**< Events accepted, including autosave requests. */
+    uint64_t dispatched;         /**< Events the bus thread has finished with. */
+    uint64_t pumped;             /**< Events delivered by event_bus_pump(). */
+    uint64_t autosaves_requested;
+    uint64_t autosaves_durable;
+    uint64_t autosaves_failed;
+    uint64_t producer_stalls;    /**< Publishes that waited for queue space. */
+    size_t high_water;           /**< Most events queued at once. */
+} HrEventBusStats;
+
+struct HrEventBus;
+
+/**
+ * Creates a stopped bus with room for @p capacity events (0 selects
+ * HR_EVENT_BUS_DEFAULT_CAPACITY). Subscribe, then call event_bus_start().
+ */
+struct HrEventBus *event_bus_create(size_t capacity);
+
+/** Delivers everything still queued, stops the bus thread and frees the bus. */
+void event_bus_destroy(struct HrEventBus *bus);
+
+/** Adds a subscriber. Only allowed before event_bus_start(). */
+bool event_bus_subscribe(struct HrEventBus *bus,
+                         HrEventDelivery delivery,
+                         HrEventHandler handler,
+                         void *user_data);
+
+/**
+ * Installs the autosave writer and its acknowledgement handler (optional).
+ * Only allowed before event_bus_start().
+ */
+bool event_bus_set_durable_writer(struct HrEventBus *bus,
+                                  HrEventDurableWriter writer,
+                                  void *writer_user_data,
+                                  HrEventAckHandler ack,
+                                  void *ack_user_data);
+
+/** Starts the bus thread. */
+bool event_bus_start(struct HrEventBus *bus);
+
+/**
+ * Copies @p event into the queue (multiple producers may publish at once).
+ *
+ * Blocks only while the bus thread is a full queue behind. When the queue is
+ * full of events waiting for event_bus_pump(), the publisher pumps them
+ * itself, so a UI thread that both grades and pumps cannot deadlock.
+ * Returns false when the bus is not running.
+ */
+bool event_bus_publish(struct HrEventBus *bus, const SessionReviewEvent *event);
+
+/**
+ * Queues an autosave of @p persisted for the durable writer and returns its
+ * ticket (tickets increase by one per request), or 0 when the bus is not
+ * running or has no writer. Subscribers are not sent the event; it reaches
+ * them through event_bus_publish() like any other.
+ */
+uint64_t event_bus_request_autosave(struct HrEventBus *bus,
+                                    const SessionReviewEvent *event,
+                                    const SRSPersistedState *persisted);
+
+/**
+ * Runs pump subscribers and autosave acknowledgements for up to
+ * @p max_events dispatched events (0 = all available) on the calling thread.
+ * Returns the number of events delivered.
+ */
+size_t event_bus_pump(struct HrEventBus *bus, size_t max_events);
+
+/** Highest ticket such that every autosave up to it has been written or has failed. */
+uint64_t event_bus_acknowledged(const struct HrEventBus *bus);
+
+/** Waits until @p ticket is acknowledged; returns false on timeout. */
+bool event_bus_wait_acknowledged(struct HrEventBus *bus, uint64_t ticket, uint32_t timeout_ms);
+
+/** Waits for the bus thread to drain the queue, then pumps everything left. */
+void event_bus_flush(struct HrEventBus *bus);
+
+void event_bus_stats(const struct HrEventBus *bus, HrEventBusStats *out_stats);
+
+/** session_review_callback that publishes to the bus in @p user_data. */
+void event_bus_publish_session_event(const SessionReviewEvent *event, void *user_data);
+
+/**
+ * session_autosave_callback that queues the snapshot on the bus in
+ * @p user_data. Returns true once queued; durability is reported through the
+ * acknowledgement handler rather than by failing the grade.
+ */
+bool event_bus_autosave_session_event(const SessionReviewEvent *event,
+                                      const SRSPersistedState *persisted,
+                                      void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_EVENT_BUS_H */
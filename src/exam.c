@@ -0,0 +1,846 @@
+#include "exam.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum ExamOutcome {
+    EXAM_PENDING = 0,
+    EXAM_CORRECT,
+    EXAM_INCORRECT,
+    EXAM_TIMED_OUT,  /* Answered over the card limit, or expired at it (rating -1). */
+    EXAM_UNANSWERED  /* Cut off by the section clock. */
+} ExamOutcome;
+
+typedef struct ExamItem {
+    uint64_t card_id;
+    size_t section;
+    size_t topic;    /* Index into HrExam::topics. */
+    int rating;      /* -1 until scored. */
+    uint32_t duration_ms;
+    ExamOutcome outcome;
+} ExamItem;
+
+typedef struct ExamTopic {
+    char id[HR_EXAM_MAX_TOPIC_ID];
+    double weight;
+} ExamTopic;
+
+struct HrExam {
+    HrExamConfig config;
+    ExamItem *items;
+    size_t count;
+    ExamTopic *topics;
+    size_t topic_count;
+    size_t *section_end; /* Exclusive end position of each section. */
+    size_t section_count;
+    size_t position;
+    uint64_t section_elapsed_ms;
+    uint64_t total_elapsed_ms;
+    time_t started_at;
+};
+
+typedef struct ExamTopicKey {
+    const char *id;
+    size_t item;
+} ExamTopicKey;
+
+static int exam_compare_topic_keys(const void *lhs, const void *rhs)
+{
+    const ExamTopicKey *a = (const ExamTopicKey *)lhs;
+    const ExamTopicKey *b = (const ExamTopicKey *)rhs;
+    const int order = strcmp(a->id, b->id);
+    if (order != 0) {
+        return order;
+    }
+    return (a->item < b->item) ? -1 : ((a->item > b->item) ? 1 : 0);
+}
+
+static int exam_compare_latency(const void *lhs, const void *rhs)
+{
+    const uint32_t a = *(const uint32_t *)lhs;
+    const uint32_t b = *(const uint32_t *)rhs;
+    return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+static int exam_compare_topic_scores(const void *lhs, const void *rhs)
+{
+    const HrExamTopicScore *a = (const HrExamTopicScore *)lhs;
+    const HrExamTopicScore *b = (const HrExamTopicScore *)rhs;
+    if (a->weight != b->weight) {
+        return (a->weight > b->weight) ? -1 : 1;
+    }
+    return strcmp(a->topic_id, b->topic_id);
+}
+
+/* Groups cards by topic identifier in O(n log n); cards without one share the "" group. */
+static bool exam_build_topics(struct HrExam *exam, const SessionCardSpec *cards)
+{
+    ExamTopicKey *keys = (ExamTopicKey *)malloc(exam->count * sizeof(ExamTopicKey));
+    exam->topics = (ExamTopic *)calloc(exam->count, sizeof(ExamTopic));
+    if (keys == NULL || exam->topics == NULL) {
+        free(keys);
+        return false;
+    }
+
+    for (size_t i = 0; i < exam->count; ++i) {
+        const char *id = (cards[i].has_topic && cards[i].topic.topic_id != NULL) ? cards[i].topic.topic_id : "";
+        keys[i].id = id;
+        keys[i].item = i;
+    }
+    qsort(keys, exam->count, sizeof(ExamTopicKey), exam_compare_topic_keys);
+
+    for (size_t i = 0; i < exam->count; ++i) {
+        if (i == 0 || strcmp(keys[i].id, keys[i - 1].id) != 0) {
+            ExamTopic *topic = &exam->topics[exam->topic_count++];
+            strncpy(topic->id, keys[i].id, HR_EXAM_MAX_TOPIC_ID - 1U);
+            topic->id[HR_EXAM_MAX_TOPIC_ID - 1U] = '\0';
+            const SessionCardSpec *spec = &cards[keys[i].item];
+            topic->weight = (spec->has_topic && spec->topic.weight > 0.0) ? spec->topic.weight : 1.0;
+        }
+        exam->items[keys[i].item].topic = exam->topic_count - 1U;
+    }
+
+    free(keys);
+    return true;
+}
+
+struct HrExam *exam_create(const HrExamConfig *config,
+                           const SessionCardSpec *cards,
+                           size_t count,
+                           time_t started_at)
+{
+    if (cards == NULL || count == 0U) {
+        return NULL;
+    }
+
+    struct HrExam *exam = (struct HrExam *)calloc(1U, sizeof(struct HrExam));
+    if (exam == NULL) {
+        return NULL;
+    }
+
+    if (config != NULL) {
+        exam->config = *config;
+    }
+    if (!(exam->config.pass_threshold > 0.0)) {
+        exam->config.pass_threshold = HR_EXAM_DEFAULT_PASS_THRESHOLD;
+    }
+
+    exam->count = count;
+    exam->section_count = (exam->config.section_count > 0U) ? exam->config.section_count : 1U;
+    if (exam->section_count > count) {
+        exam->section_count = count;
+    }
+    exam->started_at = (started_at > 0) ? started_at : time(NULL);
+
+    exam->items = (ExamItem *)calloc(count, sizeof(ExamItem));
+    exam->section_end = (size_t *)calloc(exam->section_count, sizeof(size_t));
+    if (exam->items == NULL || exam->section_end == NULL || !exam_build_topics(exam, cards)) {
+        exam_destroy(exam);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        ExamItem *item = &exam->items[i];
+        item->card_id = cards[i].card_id;
+        item->section = (i * exam->section_count) / count;
+        item->rating = -1;
+        item->outcome = EXAM_PENDING;
+        exam->section_end[item->section] = i + 1U;
+    }
+    return exam;
+}
+
+void exam_destroy(struct HrExam *exam)
+{
+    if (exam == NULL) {
+        return;
+    }
+
+    free(exam->items);
+    free(exam->topics);
+    free(exam->section_end);
+    free(exam);
+}
+
+bool exam_finished(const struct HrExam *exam)
+{
+    return exam == NULL || exam->position >= exam->count;
+}
+
+bool exam_current(const struct HrExam *exam, HrExamQuestion *out_question)
+{
+    if (exam_finished(exam) || out_question == NULL) {
+        return false;
+    }
+
+    const ExamItem *item = &exam->items[exam->position];
+    const ExamTopic *topic = &exam->topics[item->topic];
+
+    memset(out_question, 0, sizeof(*out_question));
+    out_question->card_id = item->card_id;
+    out_question->topic_id = (topic->id[0] != '\0') ? topic->id : NULL;
+    out_question->position = exam->position;
+    out_question->card_count = exam->count;
+    out_question->section = item->section;
+    out_question->section_count = exam->section_count;
+    out_question->card_time_limit_ms = (exam->config.card_time_limit_ms > 0U) ? exam->config.card_time_limit_ms
+                                                                              : HR_EXAM_UNTIMED;
+    if (exam->config.section_time_limit_ms > 0U) {
+        const uint64_t limit = exam->config.section_time_limit_ms;
+        out_question->section_time_left_ms = (exam->section_elapsed_ms < limit)
+                                                 ? (uint32_t)(limit - exam->section_elapsed_ms)
+                                                 : 0U;
+    } else {
+        out_question->section_time_left_ms = HR_EXAM_UNTIMED;
+    }
+    return true;
+}
+
+size_t exam_peek(const struct HrExam *exam, uint64_t *out_card_ids, size_t capacity)
+{
+    if (exam_finished(exam) || out_card_ids == NULL) {
+        return 0U;
+    }
+
+    size_t count = 0U;
+    for (size_t i = exam->position; i < exam->count && count < capacity; ++i) {
+        out_card_ids[count++] = exam->items[i].card_id;
+    }
+    return count;
+}
+
+static void exam_advance(struct HrExam *exam)
+{
+    const size_t section = exam->items[exam->position].section;
+    exam->position++;
+    if (exam->position < exam->count && exam->items[exam->position].section != section) {
+        exam->section_elapsed_ms = 0U;
+    }
+}
+
+void exam_expire_section(struct HrExam *exam)
+{
+    if (exam_finished(exam)) {
+        return;
+    }
+
+    /* The learner used the whole budget, whatever was charged so far. */
+    const uint64_t limit = exam->config.section_time_limit_ms;
+    if (limit > 0U && exam->section_elapsed_ms < limit) {
+        exam->total_elapsed_ms += limit - exam->section_elapsed_ms;
+        exam->section_elapsed_ms = limit;
+    }
+
+    const size_t end = exam->section_end[exam->items[exam->position].section];
+    while (exam->position < end) {
+        exam->items[exam->position].outcome = EXAM_UNANSWERED;
+        exam_advance(exam);
+    }
+}
+
+/* Scores the current card; a negative @p rating marks a card that ran out its limit unanswered. */
+static void exam_score(struct HrExam *exam, int rating, uint32_t duration_ms)
+{
+    ExamItem *item = &exam->items[exam->position];
+    const uint64_t section_limit = exam->config.section_time_limit_ms;
+    const uint32_t card_limit = exam->config.card_time_limit_ms;
+
+    exam->section_elapsed_ms += duration_ms;
+    exam->total_elapsed_ms += duration_ms;
+    item->duration_ms = duration_ms;
+
+    if (section_limit > 0U && exam->section_elapsed_ms > section_limit) {
+        /* The answer came in after the section had already closed. */
+        item->outcome = EXAM_UNANSWERED;
+    } else if (rating < 0 || (card_limit > 0U && duration_ms > card_limit)) {
+        item->rating = rating;
+        item->outcome = EXAM_TIMED_OUT;
+    } else {
+        item->rating = rating;
+        item->outcome = (rating >= (int)SRS_RESPONSE_HARD && rating <= (int)SRS_RESPONSE_EASY) ? EXAM_CORRECT
+                                                                                               : EXAM_INCORRECT;
+    }
+
+    const bool section_over = (section_limit > 0U && exam->section_elapsed_ms >= section_limit);
+    exam_advance(exam);
+    if (section_over && !exam_finished(exam) && exam->items[exam->position].section == item->section) {
+        exam_expire_section(exam);
+    }
+}
+
+bool exam_answer(struct HrExam *exam, SRSReviewRating rating, uint32_t duration_ms)
+{
+    if (exam_finished(exam)) {
+        return false;
+    }
+    exam_score(exam, (int)rating, duration_ms);
+    return true;
+}
+
+bool exam_expire_card(struct HrExam *exam)
+{
+    if (exam_finished(exam) || exam->config.card_time_limit_ms == 0U) {
+        return false;
+    }
+    /* The learner sat on the card for its whole limit. */
+    exam_score(exam, -1, exam->config.card_time_limit_ms);
+    return true;
+}
+
+static uint32_t exam_percentile(const uint32_t *sorted, size_t count, double fraction)
+{
+    if (count == 0U) {
+        return 0U;
+    }
+    /* Nearest rank. */
+    size_t rank = (size_t)ceil(fraction * (double)count);
+    if (rank == 0U) {
+        rank = 1U;
+    }
+    return sorted[(rank > count ? count : rank) - 1U];
+}
+
+bool exam_report(const struct HrExam *exam, HrExamReport *out_report)
+{
+    if (exam == NULL || out_report == NULL) {
+        return false;
+    }
+
+    memset(out_report, 0, sizeof(*out_report));
+    uint32_t *latencies = (uint32_t *)malloc(exam->count * sizeof(uint32_t));
+    double *latency_sums = (double *)calloc(exam->topic_count, sizeof(double));
+    size_t *answered_per_topic = (size_t *)calloc(exam->topic_count, sizeof(size_t));
+    out_report->topics = (HrExamTopicScore *)calloc(exam->topic_count, sizeof(HrExamTopicScore));
+    if (latencies == NULL || latency_sums == NULL || answered_per_topic == NULL || out_report->topics == NULL) {
+        free(latencies);
+        free(latency_sums);
+        free(answered_per_topic);
+        exam_report_release(out_report);
+        return false;
+    }
+
+    out_report->topic_count = exam->topic_count;
+    for (size_t t = 0; t < exam->topic_count; ++t) {
+        memcpy(out_report->topics[t].topic_id, exam->topics[t].id, HR_EXAM_MAX_TOPIC_ID);
+        out_report->topics[t].weight = exam->topics[t].weight;
+    }
+
+    size_t latency_count = 0U;
+    for (size_t i = 0; i < exam->count; ++i) {
+        const ExamItem *item = &exam->items[i];
+        HrExamTopicScore *topic = &out_report->topics[item->topic];
+        topic->asked++;
+
+        switch (item->outcome) {
+        case EXAM_CORRECT:
+            out_report->correct++;
+            topic->correct++;
+            break;
+        case EXAM_TIMED_OUT:
+            out_report->timed_out++;
+            topic->timed_out++;
+            break;
+        case EXAM_UNANSWERED:
+            out_report->unanswered++;
+            topic->timed_out++;
+            break;
+        case EXAM_INCORRECT:
+        case EXAM_PENDING:
+            break;
+        }
+
+        if (item->rating >= 0 && item->outcome != EXAM_UNANSWERED) {
+            out_report->answered++;
+            latencies[latency_count++] = item->duration_ms;
+            latency_sums[item->topic] += (double)item->duration_ms;
+            answered_per_topic[item->topic]++;
+        }
+    }
+
+    double weight_sum = 0.0;
+    double weighted_accuracy = 0.0;
+    double weighted_variance = 0.0;
+    for (size_t t = 0; t < exam->topic_count; ++t) {
+        HrExamTopicScore *topic = &out_report->topics[t];
+        if (topic->asked == 0U) {
+            continue;
+        }
+        topic->accuracy = (double)topic->correct / (double)topic->asked;
+        if (answered_per_topic[t] > 0U) {
+            topic->mean_latency_ms = latency_sums[t] / (double)answered_per_topic[t];
+        }
+
+        /* Laplace smoothing keeps a topic sampled once or twice from reading as 0% or 100%. */
+        const double trials = (double)topic->asked + 2.0;
+        const double smoothed = ((double)topic->correct + 1.0) / trials;
+        weight_sum += topic->weight;
+        weighted_accuracy += topic->weight * smoothed;
+        weighted_variance += topic->weight * topic->weight * smoothed * (1.0 - smoothed) / trials;
+    }
+
+    if (weight_sum > 0.0) {
+        out_report->readiness = weighted_accuracy / weight_sum;
+        const double margin = 1.96 * sqrt(weighted_variance) / weight_sum;
+        out_report->readiness_low = (out_report->readiness > margin) ? out_report->readiness - margin : 0.0;
+    }
+    out_report->pass_likely = out_report->readiness_low >= exam->config.pass_threshold;
+
+    qsort(latencies, latency_count, sizeof(uint32_t), exam_compare_latency);
+    out_report->median_latency_ms = exam_percentile(latencies, latency_count, 0.5);
+    out_report->p90_latency_ms = exam_percentile(latencies, latency_count, 0.9);
+
+    qsort(out_report->topics, out_report->topic_count, sizeof(HrExamTopicScore), exam_compare_topic_scores);
+
+    out_report->card_count = exam->count;
+    out_report->section_count = exam->section_count;
+    out_report->score = (double)out_report->correct / (double)exam->count;
+    out_report->started_at = exam->started_at;
+    out_report->finished_at = exam->started_at + (time_t)(exam->total_elapsed_ms / 1000U);
+
+    free(latencies);
+    free(latency_sums);
+    free(answered_per_topic);
+    return true;
+}
+
+void exam_report_release(HrExamReport *report)
+{
+    if (report == NULL) {
+        return;
+    }
+
+    free(report->topics);
+    memset(report, 0, sizeof(*report));
+}
+
+typedef struct ExamSaveContext {
+    DatabaseHandle *database;
+    const struct HrExam *exam;
+    const HrExamReport *report;
+    sqlite3_int64 exam_id;
+} ExamSaveContext;
+
+static int exam_clamp_int(uint64_t value)
+{
+    return (value > (uint64_t)INT_MAX) ? INT_MAX : (int)value;
+}
+
+static int exam_delete_checkpoint(DatabaseHandle *database)
+{
+    sqlite3_stmt *stmt = NULL;
+    int rc = db_checkpoint_prepare_delete(database, &stmt);
+    if (rc == SQLITE_OK) {
+        rc = db_checkpoint_bind_slot(stmt, HR_EXAM_CHECKPOINT_SLOT);
+    }
+    if (rc == SQLITE_OK) {
+        rc = (sqlite3_step(stmt) == SQLITE_DONE) ? SQLITE_OK : SQLITE_ERROR;
+    }
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+static int exam_save_txn(sqlite3 *db, void *user_data)
+{
+    ExamSaveContext *context = (ExamSaveContext *)user_data;
+    const HrExamReport *report = context->report;
+
+    HrExamRecord record;
+    memset(&record, 0, sizeof(record));
+    record.started_at = (sqlite3_int64)report->started_at;
+    record.finished_at = (sqlite3_int64)report->finished_at;
+    record.card_count = exam_clamp_int(report->card_count);
+    record.section_count = exam_clamp_int(report->section_count);
+    record.answered = exam_clamp_int(report->answered);
+    record.correct = exam_clamp_int(report->correct);
+    record.timed_out = exam_clamp_int((uint64_t)report->timed_out + report->unanswered);
+    record.score = report->score;
+    record.readiness = report->readiness;
+    record.median_latency_ms = exam_clamp_int(report->median_latency_ms);
+
+    sqlite3_stmt *stmt = NULL;
+    int rc = db_exam_prepare_insert(context->database, &stmt);
+    if (rc == SQLITE_OK) {
+        rc = db_exam_bind_insert(stmt, &record);
+    }
+    if (rc == SQLITE_OK) {
+        rc = (sqlite3_step(stmt) == SQLITE_DONE) ? SQLITE_OK : SQLITE_ERROR;
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    context->exam_id = sqlite3_last_insert_rowid(db);
+
+    stmt = NULL;
+    rc = db_exam_prepare_insert_answer(context->database, &stmt);
+    const struct HrExam *exam = context->exam;
+    for (size_t i = 0; rc == SQLITE_OK && i < exam->count; ++i) {
+        const ExamItem *item = &exam->items[i];
+        HrExamAnswerRecord answer;
+        memset(&answer, 0, sizeof(answer));
+        answer.exam_id = context->exam_id;
+        answer.position = exam_clamp_int(i);
+        answer.card_id = (sqlite3_int64)item->card_id;
+        answer.section = exam_clamp_int(item->section);
+        answer.rating = item->rating;
+        answer.duration_ms = exam_clamp_int(item->duration_ms);
+        answer.timed_out = (item->outcome == EXAM_TIMED_OUT || item->outcome == EXAM_UNANSWERED);
+
+        rc = db_exam_bind_insert_answer(stmt, &answer);
+        if (rc == SQLITE_OK) {
+            rc = (sqlite3_step(stmt) == SQLITE_DONE) ? SQLITE_OK : SQLITE_ERROR;
+        }
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+
+    /* The result is on record, so the exam must not come back on the next start. */
+    return exam_delete_checkpoint(context->database);
+}
+
+bool exam_save(const struct HrExam *exam, DatabaseHandle *database, sqlite3_int64 *out_exam_id)
+{
+    if (exam == NULL || database == NULL || !exam_finished(exam)) {
+        return false;
+    }
+
+    HrExamReport report;
+    if (!exam_report(exam, &report)) {
+        return false;
+    }
+
+    ExamSaveContext context = {database, exam, &report, 0};
+    const int rc = db_run_in_transaction(database, exam_save_txn, &context);
+    exam_report_release(&report);
+    if (rc != SQLITE_OK) {
+        return false;
+    }
+
+    if (out_exam_id != NULL) {
+        *out_exam_id = context.exam_id;
+    }
+    return true;
+}
+
+/*
+ * Checkpoints are a little-endian byte stream: a fixed header with the paper
+ * shape, position and clocks, then the topics (length-prefixed id and
+ * weight), the section ends and one fixed-size record per card.
+ */
+#define EXAM_CHECKPOINT_MAGIC 0x58455248u /* "HREX" */
+#define EXAM_CHECKPOINT_VERSION 1u
+#define EXAM_CHECKPOINT_HEADER_BYTES 88u
+#define EXAM_CHECKPOINT_TOPIC_MIN_BYTES 9u
+#define EXAM_CHECKPOINT_TOPIC_MAX_BYTES (1u + (HR_EXAM_MAX_TOPIC_ID - 1u) + 8u)
+#define EXAM_CHECKPOINT_SECTION_BYTES 8u
+#define EXAM_CHECKPOINT_ITEM_BYTES 25u
+
+typedef struct ExamReader {
+    const unsigned char *at;
+    const unsigned char *end;
+    bool ok;
+} ExamReader;
+
+static unsigned char *exam_put_u64(unsigned char *out, uint64_t value)
+{
+    for (size_t i = 0; i < 8U; ++i) {
+        out[i] = (unsigned char)(value >> (8U * i));
+    }
+    return out + 8;
+}
+
+static unsigned char *exam_put_u32(unsigned char *out, uint32_t value)
+{
+    for (size_t i = 0; i < 4U; ++i) {
+        out[i] = (unsigned char)(value >> (8U * i));
+    }
+    return out + 4;
+}
+
+static unsigned char *exam_put_f64(unsigned char *out, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return exam_put_u64(out, bits);
+}
+
+static uint64_t exam_get_u64(ExamReader *reader)
+{
+    if (!reader->ok || reader->end - reader->at < 8) {
+        reader->ok = false;
+        return 0U;
+    }
+    uint64_t value = 0U;
+    for (size_t i = 0; i < 8U; ++i) {
+        value |= (uint64_t)reader->at[i] << (8U * i);
+    }
+    reader->at += 8;
+    return value;
+}
+
+static uint32_t exam_get_u32(ExamReader *reader)
+{
+    if (!reader->ok || reader->end - reader->at < 4) {
+        reader->ok = false;
+        return 0U;
+    }
+    uint32_t value = 0U;
+    for (size_t i = 0; i < 4U; ++i) {
+        value |= (uint32_t)reader->at[i] << (8U * i);
+    }
+    reader->at += 4;
+    return value;
+}
+
+static unsigned char exam_get_u8(ExamReader *reader)
+{
+    if (!reader->ok || reader->at >= reader->end) {
+        reader->ok = false;
+        return 0U;
+    }
+    return *reader->at++;
+}
+
+static double exam_get_f64(ExamReader *reader)
+{
+    const uint64_t bits = exam_get_u64(reader);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool exam_checkpoint(const struct HrExam *exam, uint32_t card_elapsed_ms, void **out_data, size_t *out_size)
+{
+    if (exam == NULL || out_data == NULL || out_size == NULL) {
+        return false;
+    }
+
+    unsigned char *data = (unsigned char *)malloc(EXAM_CHECKPOINT_HEADER_BYTES +
+                                                  exam->topic_count * EXAM_CHECKPOINT_TOPIC_MAX_BYTES +
+                                                  exam->section_count * EXAM_CHECKPOINT_SECTION_BYTES +
+                                                  exam->count * EXAM_CHECKPOINT_ITEM_BYTES);
+    if (data == NULL) {
+        return false;
+    }
+
+    unsigned char *out = data;
+    out = exam_put_u32(out, EXAM_CHECKPOINT_MAGIC);
+    out = exam_put_u32(out, EXAM_CHECKPOINT_VERSION);
+    out = exam_put_u32(out, exam->config.card_time_limit_ms);
+    out = exam_put_u32(out, exam->config.section_time_limit_ms);
+    out = exam_put_f64(out, exam->config.pass_threshold);
+    out = exam_put_u64(out, (uint64_t)exam->count);
+    out = exam_put_u64(out, (uint64_t)exam->topic_count);
+    out = exam_put_u64(out, (uint64_t)exam->section_count);
+    out = exam_put_u64(out, (uint64_t)exam->position);
+    out = exam_put_u64(out, exam->section_elapsed_ms);
+    out = exam_put_u64(out, exam->total_elapsed_ms);
+    out = exam_put_u64(out, (uint64_t)(int64_t)exam->started_at);
+    out = exam_put_u32(out, card_elapsed_ms);
+    out = exam_put_u32(out, 0U); /* Reserved. */
+
+    for (size_t t = 0; t < exam->topic_count; ++t) {
+        const size_t length = strlen(exam->topics[t].id); /* Always terminated within the buffer. */
+        *out++ = (unsigned char)length;
+        memcpy(out, exam->topics[t].id, length);
+        out += length;
+        out = exam_put_f64(out, exam->topics[t].weight);
+    }
+    for (size_t s = 0; s < exam->section_count; ++s) {
+        out = exam_put_u64(out, (uint64_t)exam->section_end[s]);
+    }
+    for (size_t i = 0; i < exam->count; ++i) {
+        const ExamItem *item = &exam->items[i];
+        out = exam_put_u64(out, item->card_id);
+        out = exam_put_u32(out, (uint32_t)item->section);
+        out = exam_put_u32(out, (uint32_t)item->topic);
+        out = exam_put_u32(out, (uint32_t)(int32_t)item->rating);
+        out = exam_put_u32(out, item->duration_ms);
+        *out++ = (unsigned char)item->outcome;
+    }
+
+    *out_data = data;
+    *out_size = (size_t)(out - data);
+    return true;
+}
+
+struct HrExam *exam_resume(const void *data, size_t size, uint32_t *out_card_elapsed_ms)
+{
+    if (data == NULL || size < EXAM_CHECKPOINT_HEADER_BYTES) {
+        return NULL;
+    }
+
+    ExamReader reader = {(const unsigned char *)data, (const unsigned char *)data + size, true};
+    const uint32_t magic = exam_get_u32(&reader);
+    const uint32_t version = exam_get_u32(&reader);
+    HrExamConfig config;
+    memset(&config, 0, sizeof(config));
+    config.card_time_limit_ms = exam_get_u32(&reader);
+    config.section_time_limit_ms = exam_get_u32(&reader);
+    config.pass_threshold = exam_get_f64(&reader);
+    const uint64_t count = exam_get_u64(&reader);
+    const uint64_t topic_count = exam_get_u64(&reader);
+    const uint64_t section_count = exam_get_u64(&reader);
+    const uint64_t position = exam_get_u64(&reader);
+    const uint64_t section_elapsed_ms = exam_get_u64(&reader);
+    const uint64_t total_elapsed_ms = exam_get_u64(&reader);
+    const int64_t started_at = (int64_t)exam_get_u64(&reader);
+    const uint32_t card_elapsed_ms = exam_get_u32(&reader);
+    (void)exam_get_u32(&reader);
+    if (!reader.ok || magic != EXAM_CHECKPOINT_MAGIC || version != EXAM_CHECKPOINT_VERSION) {
+        return NULL;
+    }
+
+    /* Reject shapes the buffer cannot hold before allocating for them. */
+    const uint64_t available = (uint64_t)(size - EXAM_CHECKPOINT_HEADER_BYTES);
+    if (count == 0U || count > available / EXAM_CHECKPOINT_ITEM_BYTES || topic_count == 0U ||
+        topic_count > count || section_count == 0U || section_count > count || position > count ||
+        count * EXAM_CHECKPOINT_ITEM_BYTES + topic_count * EXAM_CHECKPOINT_TOPIC_MIN_BYTES +
+                section_count * EXAM_CHECKPOINT_SECTION_BYTES >
+            available) {
+        return NULL;
+    }
+
+    struct HrExam *exam = (struct HrExam *)calloc(1U, sizeof(struct HrExam));
+    if (exam == NULL) {
+        return NULL;
+    }
+    exam->config = config;
+    exam->config.section_count = (size_t)section_count;
+    exam->count = (size_t)count;
+    exam->topic_count = (size_t)topic_count;
+    exam->section_count = (size_t)section_count;
+    exam->position = (size_t)position;
+    exam->section_elapsed_ms = section_elapsed_ms;
+    exam->total_elapsed_ms = total_elapsed_ms;
+    exam->started_at = (time_t)started_at;
+    exam->items = (ExamItem *)calloc(exam->count, sizeof(ExamItem));
+    exam->topics = (ExamTopic *)calloc(exam->topic_count, sizeof(ExamTopic));
+    exam->section_end = (size_t *)calloc(exam->section_count, sizeof(size_t));
+    if (exam->items == NULL || exam->topics == NULL || exam->section_end == NULL) {
+        exam_destroy(exam);
+        return NULL;
+    }
+
+    for (size_t t = 0; reader.ok && t < exam->topic_count; ++t) {
+        const size_t length = exam_get_u8(&reader);
+        if (length >= HR_EXAM_MAX_TOPIC_ID || (size_t)(reader.end - reader.at) < length) {
+            reader.ok = false;
+            break;
+        }
+        memcpy(exam->topics[t].id, reader.at, length);
+        reader.at += length;
+        exam->topics[t].weight = exam_get_f64(&reader);
+    }
+    size_t previous_end = 0U;
+    for (size_t s = 0; reader.ok && s < exam->section_count; ++s) {
+        const uint64_t end = exam_get_u64(&reader);
+        reader.ok = reader.ok && end > previous_end && end <= count;
+        exam->section_end[s] = (size_t)end;
+        previous_end = (size_t)end;
+    }
+    for (size_t i = 0; reader.ok && i < exam->count; ++i) {
+        ExamItem *item = &exam->items[i];
+        item->card_id = exam_get_u64(&reader);
+        item->section = exam_get_u32(&reader);
+        item->topic = exam_get_u32(&reader);
+        item->rating = (int)(int32_t)exam_get_u32(&reader);
+        item->duration_ms = exam_get_u32(&reader);
+        const unsigned char outcome = exam_get_u8(&reader);
+        reader.ok = reader.ok && item->section < exam->section_count && item->topic < exam->topic_count &&
+                    item->rating >= -1 && item->rating <= (int)SRS_RESPONSE_CRAM && outcome <= EXAM_UNANSWERED;
+        item->outcome = (ExamOutcome)outcome;
+    }
+    if (!reader.ok || previous_end != exam->count) {
+        exam_destroy(exam);
+        return NULL;
+    }
+
+    if (out_card_elapsed_ms != NULL) {
+        *out_card_elapsed_ms = card_elapsed_ms;
+    }
+    return exam;
+}
+
+typedef struct ExamCheckpointContext {
+    DatabaseHandle *database;
+    const struct HrExam *exam;
+    uint32_t card_elapsed_ms;
+} ExamCheckpointContext;
+
+static int exam_checkpoint_txn(sqlite3 *db, void *user_data)
+{
+    (void)db;
+    ExamCheckpointContext *context = (ExamCheckpointContext *)user_data;
+
+    void *payload = NULL;
+    size_t payload_size = 0U;
+    if (!exam_checkpoint(context->exam, context->card_elapsed_ms, &payload, &payload_size)) {
+        return SQLITE_NOMEM;
+    }
+
+    HrSessionCheckpointRecord record;
+    memset(&record, 0, sizeof(record));
+    record.slot = HR_EXAM_CHECKPOINT_SLOT;
+    record.mode = (int)SESSION_MODE_EXAM_SIM;
+    record.remaining = (sqlite3_int64)(context->exam->count - context->exam->position);
+    record.saved_at = (sqlite3_int64)time(NULL);
+    record.payload = payload;
+    record.payload_size = payload_size;
+
+    sqlite3_stmt *stmt = NULL;
+    int rc = db_checkpoint_prepare_upsert(context->database, &stmt);
+    if (rc == SQLITE_OK) {
+        rc = db_checkpoint_bind_upsert(stmt, &record);
+    }
+    if (rc == SQLITE_OK) {
+        rc = (sqlite3_step(stmt) == SQLITE_DONE) ? SQLITE_OK : SQLITE_ERROR;
+    }
+    sqlite3_finalize(stmt);
+    free(payload);
+    return rc;
+}
+
+bool exam_store_checkpoint(const struct HrExam *exam, uint32_t card_elapsed_ms, DatabaseHandle *database)
+{
+    if (exam == NULL || database == NULL) {
+        return false;
+    }
+
+    ExamCheckpointContext context = {database, exam, card_elapsed_ms};
+    return db_run_in_transaction(database, exam_checkpoint_txn, &context) == SQLITE_OK;
+}
+
+struct HrExam *exam_load_checkpoint(DatabaseHandle *database, uint32_t *out_card_elapsed_ms)
+{
+    if (database == NULL) {
+        return NULL;
+    }
+
+    struct HrExam *exam = NULL;
+    sqlite3_stmt *stmt = NULL;
+    int rc = db_checkpoint_prepare_select(database, &stmt);
+    if (rc == SQLITE_OK) {
+        rc = db_checkpoint_bind_slot(stmt, HR_EXAM_CHECKPOINT_SLOT);
+    }
+    if (rc == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        const void *payload = sqlite3_column_blob(stmt, 3);
+        const int payload_size = sqlite3_column_bytes(stmt, 3);
+        if (payload != NULL && payload_size > 0) {
+            exam = exam_resume(payload, (size_t)payload_size, out_card_elapsed_ms);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return exam;
+}
+
+bool exam_clear_checkpoint(DatabaseHandle *database)
+{
+    return database != NULL && exam_delete_checkpoint(database) == SQLITE_OK;
+}
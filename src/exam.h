@@ -0,0 +1,175 @@
+#ifndef HYPERRECALL_EXAM_H
+#define HYPERRECALL_EXAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file exam.h
+ * @brief Timed exam simulation with sections, latency tracking and readiness scoring.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "db.h"
+#include "sessions.h"
+#include "srs.h"
+
+/** Longest topic identifier (including terminator) kept per exam card. */
+#define HR_EXAM_MAX_TOPIC_ID 64U
+
+/** Readiness lower bound that counts as a likely pass when none is configured. */
+#define HR_EXAM_DEFAULT_PASS_THRESHOLD 0.8
+
+/** Reported for time limits that are not enforced. */
+#define HR_EXAM_UNTIMED UINT32_MAX
+
+/** session_checkpoints slot holding the exam in progress (the primary session uses 0). */
+#define HR_EXAM_CHECKPOINT_SLOT 1
+
+/** Shape and time limits of an exam paper. */
+typedef struct HrExamConfig {
+    size_t section_count;           /**< Sections the paper is split into (0 = one section). */
+    uint32_t card_time_limit_ms;    /**< Longest answer that still scores (0 = untimed). */
+    uint32_t section_time_limit_ms; /**< Answer time available per section (0 = untimed). */
+    double pass_threshold;          /**< Readiness needed for a likely pass (0 = default). */
+} HrExamConfig;
+
+/** The card currently on screen and the clock around it. */
+typedef struct HrExamQuestion {
+    uint64_t card_id;
+    const char *topic_id;          /**< Owned by the exam; NULL when the card has no topic. */
+    size_t position;               /**< Zero-based position on the whole paper. */
+    size_t card_count;             /**< Cards on the paper. */
+    size_t section;                /**< Zero-based section index. */
+    size_t section_count;
+    uint32_t card_time_limit_ms;   /**< HR_EXAM_UNTIMED when cards are untimed. */
+    uint32_t section_time_left_ms; /**< HR_EXAM_UNTIMED when sections are untimed. */
+} HrExamQuestion;
+
+/** Per-topic slice of an exam report. */
+typedef struct HrExamTopicScore {
+    char topic_id[HR_EXAM_MAX_TOPIC_ID];
+    double weight;          /**< Topic weight the paper was sampled with. */
+    size_t asked;           /**< Cards from this topic on the paper. */
+    size_t correct;
+    size_t timed_out;       /**< Over the card limit or cut off by the section clock. */
+    double accuracy;        /**< correct / asked. */
+    double mean_latency_ms; /**< Over answered cards only. */
+} HrExamTopicScore;
+
+/**
+ * Outcome of an exam.
+ *
+ * Ratings of Hard or better count as correct unless the answer exceeded the
+ * card limit. Readiness weights each topic's smoothed accuracy
+ * ((correct + 1) / (asked + 2)) by its topic weight; @p readiness_low is the
+ * lower end of an approximate 95% interval around it, and a pass is called
+ * likely when that bound clears the configured threshold.
+ */
+typedef struct HrExamReport {
+    size_t card_count;
+    size_t section_count;
+    size_t answered;           /**< Cards shown and graded before their section closed. */
+    size_t correct;
+    size_t timed_out;          /**< Answered over the card limit or expired at it. */
+    size_t unanswered;         /**< Cards cut off by a section clock. */
+    double score;              /**< correct / card_count. */
+    double readiness;
+    double readiness_low;
+    bool pass_likely;
+    uint32_t median_latency_ms;
+    uint32_t p90_latency_ms;
+    time_t started_at;
+    time_t finished_at;
+    HrExamTopicScore *topics;  /**< Sorted by topic weight, heaviest first. */
+    size_t topic_count;
+} HrExamReport;
+
+struct HrExam;
+
+/**
+ * Creates an exam over @p cards in the given order (for example a paper from
+ * planner_build_exam()), split into near-equal contiguous sections. Topic
+ * identifiers and weights are copied, so @p cards may be released afterwards.
+ */
+struct HrExam *exam_create(const HrExamConfig *config,
+                           const SessionCardSpec *cards,
+                           size_t count,
+                           time_t started_at);
+
+void exam_destroy(struct HrExam *exam);
+
+/** Describes the card awaiting an answer; returns false once the exam is over. */
+bool exam_current(const struct HrExam *exam, HrExamQuestion *out_question);
+
+/**
+ * Lists the ids of the next cards on the paper, starting with the current
+ * card, for the body prefetcher. Returns the number written.
+ */
+size_t exam_peek(const struct HrExam *exam, uint64_t *out_card_ids, size_t capacity);
+
+/**
+ * Scores the current card and moves on. @p duration_ms is the time the
+ * learner took and is charged to the section clock; once that clock runs
+ * out, the rest of the section is recorded as unanswered.
+ */
+bool exam_answer(struct HrExam *exam, SRSReviewRating rating, uint32_t duration_ms);
+
+/**
+ * Records the current card as timed out without a rating, charging the full
+ * card limit to the section clock, and moves on. Returns false when cards are
+ * untimed or the exam is over.
+ */
+bool exam_expire_card(struct HrExam *exam);
+
+/** Closes the current section early, recording its remaining cards as unanswered. */
+void exam_expire_section(struct HrExam *exam);
+
+bool exam_finished(const struct HrExam *exam);
+
+/** Computes the score report. Release it with exam_report_release(). */
+bool exam_report(const struct HrExam *exam, HrExamReport *out_report);
+
+void exam_report_release(HrExamReport *report);
+
+/**
+ * Stores a finished exam in the exam_sessions/exam_answers tables, in one
+ * transaction that also drops its checkpoint. Nothing is written to the
+ * review log or card schedules.
+ */
+bool exam_save(const struct HrExam *exam, DatabaseHandle *database, sqlite3_int64 *out_exam_id);
+
+/**
+ * Serialises an exam in progress into a malloc'd buffer: the paper with its
+ * topics and sections, every answer so far, the position and both clocks.
+ * @p card_elapsed_ms is the time already spent on the card on screen, which
+ * exam_answer() has not charged yet. Free the buffer with free().
+ */
+bool exam_checkpoint(const struct HrExam *exam, uint32_t card_elapsed_ms, void **out_data, size_t *out_size);
+
+/**
+ * Rebuilds an exam from exam_checkpoint() output, or returns NULL for
+ * malformed data. @p out_card_elapsed_ms (optional) receives the time that
+ * was spent on the current card, for the caller's clock to continue from.
+ */
+struct HrExam *exam_resume(const void *data, size_t size, uint32_t *out_card_elapsed_ms);
+
+/** Writes the exam's checkpoint to HR_EXAM_CHECKPOINT_SLOT, replacing the previous one. */
+bool exam_store_checkpoint(const struct HrExam *exam, uint32_t card_elapsed_ms, DatabaseHandle *database);
+
+/** Resumes the exam stored in HR_EXAM_CHECKPOINT_SLOT; NULL when there is none. */
+struct HrExam *exam_load_checkpoint(DatabaseHandle *database, uint32_t *out_card_elapsed_ms);
+
+/** Drops the stored exam checkpoint, for an exam that was abandoned. */
+bool exam_clear_checkpoint(DatabaseHandle *database);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_EXAM_H */
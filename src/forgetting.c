@@ -0,0 +1,230 @@
+#include "forgetting.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "srs.h"
+
+/* Stabilities searched, in days: about fifteen minutes to a century. */
+#define FORGETTING_MIN_STABILITY 0.01
+#define FORGETTING_MAX_STABILITY 36500.0
+
+/* Coarse log-spaced grid, then golden-section refinement around its best point. */
+#define FORGETTING_GRID_POINTS 32U
+#define FORGETTING_REFINE_STEPS 40U
+
+static const double kBinUpperDays[HR_FORGETTING_BINS - 1U] = {
+    1.0, 2.0, 3.0, 4.0, 5.0, 7.0, 10.0, 14.0, 21.0, 30.0, 45.0, 60.0, 90.0, 180.0, 365.0,
+};
+
+static size_t forgetting_bin_index(double elapsed_days)
+{
+    for (size_t i = 0; i < HR_FORGETTING_BINS - 1U; ++i) {
+        if (elapsed_days < kBinUpperDays[i]) {
+            return i;
+        }
+    }
+    return HR_FORGETTING_BINS - 1U;
+}
+
+static double clean_elapsed(double elapsed_days)
+{
+    return (elapsed_days > 0.0) ? elapsed_days : 0.0;
+}
+
+static double model_retention(HrForgettingModel model, double stability_days, double elapsed_days)
+{
+    if (elapsed_days <= 0.0) {
+        return 1.0;
+    }
+    if (model == HR_FORGETTING_POWER) {
+        return 1.0 / (1.0 + (1.0 / SRS_TARGET_RECALL - 1.0) * elapsed_days / stability_days);
+    }
+    return exp(log(SRS_TARGET_RECALL) * elapsed_days / stability_days);
+}
+
+/* Sum over bins of reviews * (observed - predicted)^2: the per-review squared error up to a constant. */
+static double weighted_sse(const HrForgettingBins *bins, HrForgettingModel model, double log_stability)
+{
+    const double stability = exp(log_stability);
+    double sse = 0.0;
+    for (size_t i = 0; i < HR_FORGETTING_BINS; ++i) {
+        const HrForgettingBin *bin = &bins->bins[i];
+        if (bin->reviews == 0U) {
+            continue;
+        }
+        const double reviews = (double)bin->reviews;
+        const double observed = (double)bin->successful / reviews;
+        const double gap = observed - model_retention(model, stability, bin->elapsed_days / reviews);
+        sse += reviews * gap * gap;
+    }
+    return sse;
+}
+
+/* Returns the log stability minimising weighted_sse() for @p model and stores that minimum. */
+static double fit_model(const HrForgettingBins *bins, HrForgettingModel model, double *out_sse)
+{
+    const double low = log(FORGETTING_MIN_STABILITY);
+    const double step = (log(FORGETTING_MAX_STABILITY) - low) / (double)(FORGETTING_GRID_POINTS - 1U);
+
+    size_t best = 0U;
+    double best_sse = weighted_sse(bins, model, low);
+    for (size_t i = 1; i < FORGETTING_GRID_POINTS; ++i) {
+        const double sse = weighted_sse(bins, model, low + step * (double)i);
+        if (sse < best_sse) {
+            best = i;
+            best_sse = sse;
+        }
+    }
+
+    /* The grid brackets the minimum to the neighbouring points; narrow it down. */
+    static const double kInverseGolden = 0.6180339887498949;
+    double a = low + step * (double)((best > 0U) ? best - 1U : 0U);
+    double b = low + step * (double)((best + 1U < FORGETTING_GRID_POINTS) ? best + 1U : best);
+    double c = b - kInverseGolden * (b - a);
+    double d = a + kInverseGolden * (b - a);
+    double sse_c = weighted_sse(bins, model, c);
+    double sse_d = weighted_sse(bins, model, d);
+    for (size_t i = 0; i < FORGETTING_REFINE_STEPS; ++i) {
+        if (sse_c < sse_d) {
+            b = d;
+            d = c;
+            sse_d = sse_c;
+            c = b - kInverseGolden * (b - a);
+            sse_c = weighted_sse(bins, model, c);
+        } else {
+            a = c;
+            c = d;
+            sse_c = sse_d;
+            d = a + kInverseGolden * (b - a);
+            sse_d = weighted_sse(bins, model, d);
+        }
+    }
+
+    const double refined = 0.5 * (a + b);
+    const double refined_sse = weighted_sse(bins, model, refined);
+    if (refined_sse <= best_sse) {
+        *out_sse = refined_sse;
+        return refined;
+    }
+    *out_sse = best_sse;
+    return low + step * (double)best;
+}
+
+void forgetting_bins_record(HrForgettingBins *bins, double elapsed_days, bool success)
+{
+    if (bins == NULL) {
+        return;
+    }
+
+    elapsed_days = clean_elapsed(elapsed_days);
+    HrForgettingBin *bin = &bins->bins[forgetting_bin_index(elapsed_days)];
+    if (bin->reviews == UINT32_MAX) {
+        return;
+    }
+    bin->reviews++;
+    bin->successful += success ? 1U : 0U;
+    bin->elapsed_days += elapsed_days;
+}
+
+bool forgetting_bins_remove(HrForgettingBins *bins, double elapsed_days, bool success)
+{
+    if (bins == NULL) {
+        return false;
+    }
+
+    elapsed_days = clean_elapsed(elapsed_days);
+    HrForgettingBin *bin = &bins->bins[forgetting_bin_index(elapsed_days)];
+    if (bin->reviews == 0U) {
+        return false;
+    }
+    bin->reviews--;
+    if (success && bin->successful > 0U) {
+        bin->successful--;
+    }
+    /* An emptied bin resets its sum so rounding cannot leave a stray mean behind. */
+    bin->elapsed_days = (bin->reviews > 0U && bin->elapsed_days > elapsed_days) ? bin->elapsed_days - elapsed_days : 0.0;
+    return true;
+}
+
+void forgetting_bins_merge(HrForgettingBins *target, const HrForgettingBins *source)
+{
+    if (target == NULL || source == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < HR_FORGETTING_BINS; ++i) {
+        const uint64_t reviews = (uint64_t)target->bins[i].reviews + source->bins[i].reviews;
+        const uint64_t successful = (uint64_t)target->bins[i].successful + source->bins[i].successful;
+        target->bins[i].reviews = (reviews > UINT32_MAX) ? UINT32_MAX : (uint32_t)reviews;
+        target->bins[i].successful = (successful > UINT32_MAX) ? UINT32_MAX : (uint32_t)successful;
+        target->bins[i].elapsed_days += source->bins[i].elapsed_days;
+    }
+}
+
+uint64_t forgetting_bins_total(const HrForgettingBins *bins)
+{
+    uint64_t total = 0U;
+    if (bins != NULL) {
+        for (size_t i = 0; i < HR_FORGETTING_BINS; ++i) {
+            total += bins->bins[i].reviews;
+        }
+    }
+    return total;
+}
+
+bool forgetting_fit(const HrForgettingBins *bins, HrForgettingCurve *out_curve)
+{
+    if (out_curve == NULL) {
+        return false;
+    }
+    memset(out_curve, 0, sizeof(*out_curve));
+    if (bins == NULL) {
+        return false;
+    }
+
+    double elapsed_sum = 0.0;
+    for (size_t i = 0; i < HR_FORGETTING_BINS; ++i) {
+        out_curve->samples += bins->bins[i].reviews;
+        elapsed_sum += bins->bins[i].elapsed_days;
+    }
+    if (out_curve->samples == 0U) {
+        return false;
+    }
+    out_curve->mean_elapsed_days = elapsed_sum / (double)out_curve->samples;
+    if (out_curve->samples < HR_FORGETTING_MIN_REVIEWS) {
+        return false;
+    }
+
+    double exponential_sse = 0.0;
+    double power_sse = 0.0;
+    const double exponential = fit_model(bins, HR_FORGETTING_EXPONENTIAL, &exponential_sse);
+    const double power = fit_model(bins, HR_FORGETTING_POWER, &power_sse);
+
+    /* Ties go to the exponential, which is the scheduler's own model. */
+    const bool use_power = power_sse < exponential_sse;
+    out_curve->model = use_power ? HR_FORGETTING_POWER : HR_FORGETTING_EXPONENTIAL;
+    out_curve->stability_days = exp(use_power ? power : exponential);
+    out_curve->rmse = sqrt((use_power ? power_sse : exponential_sse) / (double)out_curve->samples);
+    return true;
+}
+
+double forgetting_curve_retention(const HrForgettingCurve *curve, double elapsed_days)
+{
+    if (curve == NULL || curve->model == HR_FORGETTING_NONE || curve->stability_days <= 0.0) {
+        return 0.0;
+    }
+    return model_retention(curve->model, curve->stability_days, elapsed_days);
+}
+
+double forgetting_curve_interval(const HrForgettingCurve *curve, double retention)
+{
+    if (curve == NULL || curve->model == HR_FORGETTING_NONE || curve->stability_days <= 0.0 || retention <= 0.0 ||
+        retention >= 1.0) {
+        return 0.0;
+    }
+    if (curve->model == HR_FORGETTING_POWER) {
+        return curve->stability_days * (1.0 / retention - 1.0) / (1.0 / SRS_TARGET_RECALL - 1.0);
+    }
+    return curve->stability_days * log(retention) / log(SRS_TARGET_RECALL);
+}
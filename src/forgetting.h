@@ -0,0 +1,88 @@
+#ifndef HYPERRECALL_FORGETTING_H
+#define HYPERRECALL_FORGETTING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file forgetting.h
+ * @brief Forgetting-curve fitting over binned review outcomes.
+ *
+ * Reviews are binned by the interval since the previous review; a bin keeps
+ * its review and success counts and the sum of its intervals, which is all
+ * a least-squares fit needs. Bins are plain data, so cohorts merge and
+ * retract reviews exactly and a fit costs the same for ten reviews or ten
+ * million.
+ *
+ * Two one-parameter families are fitted and the closer one kept. Both are
+ * parameterised by stability S, the elapsed time at which predicted
+ * retention falls to SRS_TARGET_RECALL, which is also what the scheduler
+ * assumes happens when a full interval elapses:
+ *   exponential  R(t) = T^(t / S)
+ *   power law    R(t) = 1 / (1 + (1/T - 1) t / S)
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Elapsed-interval bins; upper edges run from 1 day to a year, the last is open. */
+#define HR_FORGETTING_BINS 16U
+
+/** Reviews a cohort needs before it is fitted. */
+#define HR_FORGETTING_MIN_REVIEWS 30U
+
+typedef enum HrForgettingModel {
+    HR_FORGETTING_NONE = 0,        /**< Too few reviews to fit. */
+    HR_FORGETTING_EXPONENTIAL = 1,
+    HR_FORGETTING_POWER = 2,
+} HrForgettingModel;
+
+typedef struct HrForgettingBin {
+    uint32_t reviews;
+    uint32_t successful;   /**< Reviews rated GOOD/EASY/CRAM. */
+    double elapsed_days;   /**< Sum over the bin's reviews. */
+} HrForgettingBin;
+
+/** Sufficient statistics of one cohort. Zero-initialise before use. */
+typedef struct HrForgettingBins {
+    HrForgettingBin bins[HR_FORGETTING_BINS];
+} HrForgettingBins;
+
+/** A fitted forgetting curve. */
+typedef struct HrForgettingCurve {
+    HrForgettingModel model;
+    double stability_days;     /**< Elapsed days at which predicted retention is SRS_TARGET_RECALL. */
+    double mean_elapsed_days;  /**< Mean interval of the fitted reviews. */
+    double rmse;               /**< Review-weighted RMS gap between bin retention and the curve. */
+    uint64_t samples;          /**< Reviews fitted. */
+} HrForgettingCurve;
+
+/** Adds one review taken @p elapsed_days after the previous one. */
+void forgetting_bins_record(HrForgettingBins *bins, double elapsed_days, bool success);
+
+/** Takes back a review added by forgetting_bins_record(); false when its bin is empty. */
+bool forgetting_bins_remove(HrForgettingBins *bins, double elapsed_days, bool success);
+
+void forgetting_bins_merge(HrForgettingBins *target, const HrForgettingBins *source);
+
+uint64_t forgetting_bins_total(const HrForgettingBins *bins);
+
+/**
+ * Fits both families by weighted least squares over the bins and writes the
+ * better one to @p out_curve. Returns false, with the model set to
+ * HR_FORGETTING_NONE, when there are fewer than HR_FORGETTING_MIN_REVIEWS.
+ */
+bool forgetting_fit(const HrForgettingBins *bins, HrForgettingCurve *out_curve);
+
+/** Predicted retention after @p elapsed_days; 0 when @p curve has no fit. */
+double forgetting_curve_retention(const HrForgettingCurve *curve, double elapsed_days);
+
+/** Elapsed days at which predicted retention falls to @p retention (0..1); 0 when there is no fit. */
+double forgetting_curve_interval(const HrForgettingCurve *curve, double retention);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_FORGETTING_H */
@@ -0,0 +1,67 @@
+#include "frame_profile.h"
+
+#include <stddef.h>
+
+#include "sync.h"
+
+#if defined(_MSC_VER)
+#define FRAME_PROFILE_THREAD_LOCAL __declspec(thread)
+#else
+#define FRAME_PROFILE_THREAD_LOCAL _Thread_local
+#endif
+
+static FRAME_PROFILE_THREAD_LOCAL uint64_t tl_phase_micros[HR_FRAME_PHASE_COUNT];
+/* Time taken by finished children of each open phase, innermost last. */
+static FRAME_PROFILE_THREAD_LOCAL uint64_t tl_child_micros[HR_FRAME_PROFILE_MAX_DEPTH];
+static FRAME_PROFILE_THREAD_LOCAL unsigned int tl_depth;
+
+uint64_t frame_profile_begin(void)
+{
+    if (tl_depth >= HR_FRAME_PROFILE_MAX_DEPTH) {
+        return 0U;
+    }
+    tl_child_micros[tl_depth++] = 0U;
+    const uint64_t now = hr_monotonic_micros();
+    /* 0 is reserved for "nested"; the clock only reads 0 at its own epoch. */
+    return (now > 0U) ? now : 1U;
+}
+
+void frame_profile_end(HrFramePhase phase, uint64_t started)
+{
+    if (started == 0U || tl_depth == 0U) {
+        return;
+    }
+    const uint64_t now = hr_monotonic_micros();
+    const uint64_t elapsed = (now > started) ? now - started : 0U;
+    const uint64_t children = tl_child_micros[--tl_depth];
+    if (tl_depth > 0U) {
+        tl_child_micros[tl_depth - 1U] += elapsed;
+    }
+    if ((unsigned int)phase < HR_FRAME_PHASE_COUNT) {
+        tl_phase_micros[phase] += (elapsed > children) ? elapsed - children : 0U;
+    }
+}
+
+void frame_profile_collect(uint64_t out_micros[HR_FRAME_PHASE_COUNT])
+{
+    for (size_t i = 0; i < HR_FRAME_PHASE_COUNT; ++i) {
+        if (out_micros != NULL) {
+            out_micros[i] = tl_phase_micros[i];
+        }
+        tl_phase_micros[i] = 0U;
+    }
+}
+
+const char *frame_profile_phase_name(HrFramePhase phase)
+{
+    switch (phase) {
+    case HR_FRAME_PHASE_DB:
+        return "db";
+    case HR_FRAME_PHASE_RENDER:
+        return "render";
+    case HR_FRAME_PHASE_MEDIA:
+        return "media";
+    default:
+        return "other";
+    }
+}
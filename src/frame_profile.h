@@ -0,0 +1,53 @@
+#ifndef HYPERRECALL_FRAME_PROFILE_H
+#define HYPERRECALL_FRAME_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file frame_profile.h
+ * @brief Per-thread totals of time spent in each subsystem, for attributing slow frames.
+ *
+ * Subsystems bracket their potentially slow work with frame_profile_begin()
+ * and frame_profile_end(); platform_begin_frame() takes the calling thread's
+ * totals with frame_profile_collect() when it measures the frame time, so
+ * both cover the same interval. Totals are thread-local, so work done by the
+ * prefetcher or event bus threads never lands in a UI frame. Time spent in a
+ * phase opened inside another is charged to the inner phase only and
+ * subtracted from the outer one.
+ */
+
+#include <stdint.h>
+
+/** Phases that can be open at once on a thread; deeper ones count towards their parent. */
+#define HR_FRAME_PROFILE_MAX_DEPTH 8U
+
+typedef enum HrFramePhase {
+    HR_FRAME_PHASE_DB = 0,     /**< SQLite statements and transactions. */
+    HR_FRAME_PHASE_RENDER = 1, /**< UI frame processing. */
+    HR_FRAME_PHASE_MEDIA = 2,  /**< Decoding images and audio. */
+    HR_FRAME_PHASE_COUNT = 3,
+} HrFramePhase;
+
+/**
+ * Returns the start to pass to frame_profile_end(); 0 when
+ * HR_FRAME_PROFILE_MAX_DEPTH phases are already open on this thread.
+ * Phases must end in the reverse order they began.
+ */
+uint64_t frame_profile_begin(void);
+
+/** Adds the time since @p started to @p phase on this thread (ignored when @p started is 0). */
+void frame_profile_end(HrFramePhase phase, uint64_t started);
+
+/** Copies this thread's totals in microseconds into @p out_micros and zeroes them. */
+void frame_profile_collect(uint64_t out_micros[HR_FRAME_PHASE_COUNT]);
+
+/** Short lowercase name of @p phase, e.g. "db". */
+const char *frame_profile_phase_name(HrFramePhase phase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_FRAME_PROFILE_H */
@@ -7,6 +7,7 @@
 #include "db.h"
 #include "json.h"
 #include "model.h"
+#include "span_trace.h"
 
 #include <sqlite3.h>
 #include <stdio.h>
@@ -301,7 +302,7 @@ static bool read_file_contents(const char *path, char **out_contents, size_t *ou
     return true;
 }
 
-bool hr_export_json(struct DatabaseHandle *db, const HrExportOptions *options, HrExportResult *result)
+static bool export_json(struct DatabaseHandle *db, const HrExportOptions *options, HrExportResult *result)
 {
     if (!db || !options || !result) {
         return false;
@@ -446,7 +447,7 @@ bool hr_export_json(struct DatabaseHandle *db, const HrExportOptions *options, H
     return true;
 }
 
-bool hr_import_json(struct DatabaseHandle *db, const HrImportOptions *options, HrImportResult *result)
+static bool import_json(struct DatabaseHandle *db, const HrImportOptions *options, HrImportResult *result)
 {
     if (!db || !options || !result) {
         return false;
@@ -607,7 +608,7 @@ bool hr_import_json(struct DatabaseHandle *db, const HrImportOptions *options, H
     return true;
 }
 
-bool hr_export_csv(struct DatabaseHandle *db, const char *output_path, HrExportResult *result)
+static bool export_csv(struct DatabaseHandle *db, const char *output_path, HrExportResult *result)
 {
     if (!db || !output_path || !result) {
         return false;
@@ -664,7 +665,7 @@ bool hr_export_csv(struct DatabaseHandle *db, const char *output_path, HrExportR
     return true;
 }
 
-bool hr_import_csv(struct DatabaseHandle *db, const char *input_path, HrImportResult *result)
+static bool import_csv(struct DatabaseHandle *db, const char *input_path, HrImportResult *result)
 {
     if (!db || !input_path || !result) {
         return false;
@@ -766,3 +767,36 @@ bool hr_import_csv(struct DatabaseHandle *db, const char *input_path, HrImportRe
     return true;
 }
 
+/* Public entry points: each run is one span, so long imports and exports stand out in a trace. */
+
+bool hr_export_json(struct DatabaseHandle *db, const HrExportOptions *options, HrExportResult *result)
+{
+    HR_SPAN_BEGIN(span, "import_export.export_json");
+    const bool ok = export_json(db, options, result);
+    HR_SPAN_END(span);
+    return ok;
+}
+
+bool hr_import_json(struct DatabaseHandle *db, const HrImportOptions *options, HrImportResult *result)
+{
+    HR_SPAN_BEGIN(span, "import_export.import_json");
+    const bool ok = import_json(db, options, result);
+    HR_SPAN_END(span);
+    return ok;
+}
+
+bool hr_export_csv(struct DatabaseHandle *db, const char *output_path, HrExportResult *result)
+{
+    HR_SPAN_BEGIN(span, "import_export.export_csv");
+    const bool ok = export_csv(db, output_path, result);
+    HR_SPAN_END(span);
+    return ok;
+}
+
+bool hr_import_csv(struct DatabaseHandle *db, const char *input_path, HrImportResult *result)
+{
+    HR_SPAN_BEGIN(span, "import_export.import_csv");
+    const bool ok = import_csv(db, input_path, result);
+    HR_SPAN_END(span);
+    return ok;
+}
@@ -0,0 +1,131 @@
+#include "latency.h"
+
+#include <string.h>
+
+/* Sub-bucket bits: values below 2^LATENCY_SUB_BITS are counted exactly. */
+#define LATENCY_SUB_BITS 4U
+
+static uint32_t latency_log2(uint64_t value)
+{
+    uint32_t bits = 0U;
+    while (value >>= 1U) {
+        ++bits;
+    }
+    return bits;
+}
+
+static size_t latency_bucket_index(uint64_t value)
+{
+    if (value < HR_LATENCY_SUB_BUCKETS) {
+        return (size_t)value;
+    }
+
+    const uint32_t magnitude = latency_log2(value);
+    const uint32_t octave = magnitude - LATENCY_SUB_BITS + 1U;
+    if (octave > HR_LATENCY_OCTAVES) {
+        return HR_LATENCY_BUCKETS - 1U;
+    }
+    const uint64_t sub = (value >> (magnitude - LATENCY_SUB_BITS)) & (HR_LATENCY_SUB_BUCKETS - 1U);
+    return (size_t)octave * HR_LATENCY_SUB_BUCKETS + (size_t)sub;
+}
+
+/* Midpoint of the values that map to @p index. */
+static uint64_t latency_bucket_value(size_t index)
+{
+    if (index < HR_LATENCY_SUB_BUCKETS) {
+        return (uint64_t)index;
+    }
+
+    const uint32_t octave = (uint32_t)(index / HR_LATENCY_SUB_BUCKETS);
+    const uint64_t sub = (uint64_t)(index % HR_LATENCY_SUB_BUCKETS);
+    const uint32_t shift = octave - 1U;
+    const uint64_t low = (HR_LATENCY_SUB_BUCKETS + sub) << shift;
+    const uint64_t width = (uint64_t)1U << shift;
+    return low + width / 2U;
+}
+
+void latency_histogram_reset(HrLatencyHistogram *histogram)
+{
+    if (histogram != NULL) {
+        memset(histogram, 0, sizeof(*histogram));
+    }
+}
+
+void latency_histogram_record(HrLatencyHistogram *histogram, uint64_t value)
+{
+    if (histogram == NULL) {
+        return;
+    }
+
+    const size_t index = latency_bucket_index(value);
+    if (histogram->counts[index] != UINT32_MAX) {
+        histogram->counts[index]++;
+    }
+    histogram->samples++;
+    histogram->sum += value;
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+bool latency_histogram_remove(HrLatencyHistogram *histogram, uint64_t value)
+{
+    if (histogram == NULL) {
+        return false;
+    }
+
+    const size_t index = latency_bucket_index(value);
+    if (histogram->counts[index] == 0U || histogram->samples == 0U) {
+        return false;
+    }
+    histogram->counts[index]--;
+    histogram->samples--;
+    histogram->sum = (histogram->sum > value) ? histogram->sum - value : 0U;
+    return true;
+}
+
+void latency_histogram_merge(HrLatencyHistogram *target, const HrLatencyHistogram *source)
+{
+    if (target == NULL || source == NULL || source->samples == 0U) {
+        return;
+    }
+
+    for (size_t i = 0; i < HR_LATENCY_BUCKETS; ++i) {
+        const uint64_t merged = (uint64_t)target->counts[i] + source->counts[i];
+        target->counts[i] = (merged > UINT32_MAX) ? UINT32_MAX : (uint32_t)merged;
+    }
+    target->samples += source->samples;
+    target->sum += source->sum;
+    if (source->max > target->max) {
+        target->max = source->max;
+    }
+}
+
+uint64_t latency_histogram_percentile(const HrLatencyHistogram *histogram, double quantile)
+{
+    if (histogram == NULL || histogram->samples == 0U) {
+        return 0U;
+    }
+    if (quantile >= 1.0) {
+        return histogram->max;
+    }
+    if (quantile < 0.0) {
+        quantile = 0.0;
+    }
+
+    /* Rank of the sample to report, counted from 1. */
+    uint64_t rank = (uint64_t)(quantile * (double)histogram->samples) + 1U;
+    if (rank > histogram->samples) {
+        rank = histogram->samples;
+    }
+
+    uint64_t seen = 0U;
+    for (size_t i = 0; i < HR_LATENCY_BUCKETS; ++i) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            const uint64_t value = latency_bucket_value(i);
+            return (value < histogram->max) ? value : histogram->max;
+        }
+    }
+    return histogram->max;
+}
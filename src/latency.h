@@ -0,0 +1,64 @@
+#ifndef HYPERRECALL_LATENCY_H
+#define HYPERRECALL_LATENCY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file latency.h
+ * @brief Fixed-size log-linear histogram with percentile queries.
+ *
+ * Built for durations but unit-agnostic: callers pick the unit (microseconds
+ * for input latency, milliseconds for answer time, minutes for intervals).
+ * Histograms with the same layout merge by adding counts, so per-topic
+ * sketches roll up into wider ones without losing accuracy.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Linear sub-buckets per power of two; bounds the relative error to about 1/16. */
+#define HR_LATENCY_SUB_BUCKETS 16U
+
+/** Powers of two covered above the linear range (up to about 2^40 units). */
+#define HR_LATENCY_OCTAVES 36U
+
+#define HR_LATENCY_BUCKETS (HR_LATENCY_SUB_BUCKETS * (HR_LATENCY_OCTAVES + 1U))
+
+/**
+ * Histogram of non-negative samples. Plain data: zero-initialise or call
+ * latency_histogram_reset(), then record without allocating.
+ */
+typedef struct HrLatencyHistogram {
+    uint32_t counts[HR_LATENCY_BUCKETS];
+    uint64_t samples;
+    uint64_t sum;
+    uint64_t max;
+} HrLatencyHistogram;
+
+void latency_histogram_reset(HrLatencyHistogram *histogram);
+
+/** Adds one sample in O(1). */
+void latency_histogram_record(HrLatencyHistogram *histogram, uint64_t value);
+
+/**
+ * Takes back a sample added earlier by latency_histogram_record(). The
+ * maximum is not lowered. Returns false when no sample is left in its bucket.
+ */
+bool latency_histogram_remove(HrLatencyHistogram *histogram, uint64_t value);
+
+/** Adds every sample of @p source to @p target. */
+void latency_histogram_merge(HrLatencyHistogram *target, const HrLatencyHistogram *source);
+
+/**
+ * Returns the value below which a fraction @p quantile (0..1) of samples
+ * fall, as the midpoint of the containing bucket; 0 when empty.
+ */
+uint64_t latency_histogram_percentile(const HrLatencyHistogram *histogram, double quantile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_LATENCY_H */
@@ -7,6 +7,9 @@
 #include <string.h>
 #include <time.h>
 
+#include "frame_profile.h"
+#include "span_trace.h"
+
 // Stub implementations for Qt6 backend
 static inline double GetTime(void) { 
     return (double)time(NULL);
@@ -480,6 +483,8 @@ static bool hr_media_load_image(const HrMediaSource *source, Image *out_image)
         return false;
     }
 
+    HR_SPAN_BEGIN(span, "media.decode_image");
+    const uint64_t started = frame_profile_begin();
     if (source->data != NULL && source->data_size > 0U) {
         char hint[HR_MEDIA_MAX_HINT];
         const char *file_type = hr_media_resolve_hint(source, hint, sizeof(hint));
@@ -490,6 +495,8 @@ static bool hr_media_load_image(const HrMediaSource *source, Image *out_image)
     } else if (source->path != NULL && source->path[0] != '\0') {
         *out_image = LoadImage(source->path);
     }
+    frame_profile_end(HR_FRAME_PHASE_MEDIA, started);
+    HR_SPAN_END(span);
 
     return out_image->data != NULL;
 }
@@ -527,6 +534,8 @@ static bool hr_media_load_wave(const HrMediaSource *source, Wave *out_wave)
         return false;
     }
 
+    HR_SPAN_BEGIN(span, "media.decode_audio");
+    const uint64_t started = frame_profile_begin();
     if (source->data != NULL && source->data_size > 0U) {
         char hint[HR_MEDIA_MAX_HINT];
         const char *file_type = hr_media_resolve_hint(source, hint, sizeof(hint));
@@ -537,6 +546,8 @@ static bool hr_media_load_wave(const HrMediaSource *source, Wave *out_wave)
     } else if (source->path != NULL && source->path[0] != '\0') {
         *out_wave = LoadWave(source->path);
     }
+    frame_profile_end(HR_FRAME_PHASE_MEDIA, started);
+    HR_SPAN_END(span);
 
     return out_wave->data != NULL;
 }
@@ -0,0 +1,590 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "metrics_export.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#ifndef S_ISDIR
+#define S_ISDIR(m) (((m) & _S_IFMT) == _S_IFDIR)
+#endif
+#endif
+
+#include "analytics.h"
+#include "sync.h"
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+#define METRICS_NDJSON_FILE "metrics.ndjson"
+#define METRICS_PROMETHEUS_FILE "metrics.prom"
+
+/* Room for every sample in the wider of the two formats, plus headers. */
+#define METRICS_TEXT_CAPACITY (HR_METRICS_MAX_SAMPLES * 224U + 256U)
+
+static const char *const kRatingLabels[HR_ANALYTICS_RATING_BUCKETS] = {"again", "hard", "good", "easy", "cram"};
+
+struct HrMetricsExporter {
+    char directory[PATH_MAX];
+    unsigned int formats;
+    uint64_t max_bytes;
+    unsigned int keep_files;
+    bool directory_ready;
+
+    HrMutex lock;
+    HrCond wake;
+    HrThread writer;
+    bool stop;
+    bool pending;
+    HrMetricsSnapshot pending_snapshot;
+    HrMetricsExportStats stats;
+
+    /* Owned by the writer thread. */
+    HrMetricsSnapshot writing;
+    char text[METRICS_TEXT_CAPACITY];
+};
+
+typedef struct MetricsText {
+    char *data;
+    size_t capacity;
+    size_t length;
+    bool overflow;
+} MetricsText;
+
+static void text_append(MetricsText *text, const char *format, ...)
+{
+    if (text->overflow) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    const int written = vsnprintf(text->data + text->length, text->capacity - text->length, format, args);
+    va_end(args);
+    if (written < 0 || (size_t)written >= text->capacity - text->length) {
+        text->overflow = true;
+        return;
+    }
+    text->length += (size_t)written;
+}
+
+/* Integers print exactly; everything else keeps nine significant digits. */
+static void text_append_value(MetricsText *text, double value, bool json)
+{
+    if (isnan(value)) {
+        text_append(text, json ? "null" : "NaN");
+    } else if (isinf(value)) {
+        text_append(text, json ? "null" : (value > 0.0 ? "+Inf" : "-Inf"));
+    } else if (value == floor(value) && fabs(value) < 9007199254740992.0) {
+        text_append(text, "%.0f", value);
+    } else {
+        text_append(text, "%.9g", value);
+    }
+}
+
+static bool copy_field(char *target, size_t capacity, const char *value)
+{
+    const size_t length = (value != NULL) ? strlen(value) : 0U;
+    if (length >= capacity) {
+        return false;
+    }
+    memcpy(target, (value != NULL) ? value : "", length);
+    target[length] = '\0';
+    return true;
+}
+
+void metrics_snapshot_reset(HrMetricsSnapshot *snapshot)
+{
+    if (snapshot == NULL) {
+        return;
+    }
+    snapshot->captured_at = (int64_t)time(NULL);
+    snapshot->count = 0U;
+}
+
+bool metrics_snapshot_add(HrMetricsSnapshot *snapshot,
+                          const char *name,
+                          const char *label_key,
+                          const char *label_value,
+                          HrMetricKind kind,
+                          double value)
+{
+    if (snapshot == NULL || name == NULL || name[0] == '\0' || snapshot->count >= HR_METRICS_MAX_SAMPLES) {
+        return false;
+    }
+
+    HrMetricSample *sample = &snapshot->samples[snapshot->count];
+    const bool labelled = label_key != NULL && label_key[0] != '\0';
+    if (!copy_field(sample->name, sizeof(sample->name), name) ||
+        !copy_field(sample->label_key, sizeof(sample->label_key), labelled ? label_key : NULL) ||
+        !copy_field(sample->label_value, sizeof(sample->label_value), labelled ? label_value : NULL)) {
+        return false;
+    }
+    sample->kind = kind;
+    sample->value = value;
+    snapshot->count++;
+    return true;
+}
+
+static void add_quantiles(HrMetricsSnapshot *snapshot, const char *name, const char *count_name,
+                          const HrAnalyticsQuantiles *quantiles)
+{
+    metrics_snapshot_add(snapshot, name, "quantile", "0.5", HR_METRIC_GAUGE, quantiles->p50);
+    metrics_snapshot_add(snapshot, name, "quantile", "0.9", HR_METRIC_GAUGE, quantiles->p90);
+    metrics_snapshot_add(snapshot, name, "quantile", "0.99", HR_METRIC_GAUGE, quantiles->p99);
+    metrics_snapshot_add(snapshot, name, "quantile", "1", HR_METRIC_GAUGE, quantiles->max);
+    metrics_snapshot_add(snapshot, count_name, NULL, NULL, HR_METRIC_COUNTER, (double)quantiles->samples);
+}
+
+static void capture_analytics(HrMetricsSnapshot *snapshot, const HrAnalyticsDashboard *dashboard)
+{
+    const HrAnalyticsReviewSummary *reviews = &dashboard->reviews;
+    metrics_snapshot_add(snapshot, "hyperrecall_reviews_total", NULL, NULL, HR_METRIC_COUNTER,
+                         (double)reviews->total_reviews);
+    for (size_t i = 0; i < HR_ANALYTICS_RATING_BUCKETS; ++i) {
+        metrics_snapshot_add(snapshot, "hyperrecall_review_ratings_total", "rating", kRatingLabels[i],
+                             HR_METRIC_COUNTER, (double)reviews->rating_counts[i]);
+    }
+    metrics_snapshot_add(snapshot, "hyperrecall_average_interval_minutes", NULL, NULL, HR_METRIC_GAUGE,
+                         reviews->average_interval_minutes);
+    metrics_snapshot_add(snapshot, "hyperrecall_streak_days", "streak", "current", HR_METRIC_GAUGE,
+                         (double)dashboard->streaks.current_streak);
+    metrics_snapshot_add(snapshot, "hyperrecall_streak_days", "streak", "longest", HR_METRIC_GAUGE,
+                         (double)dashboard->streaks.longest_streak);
+
+    add_quantiles(snapshot, "hyperrecall_answer_time_ms", "hyperrecall_answer_time_ms_count", &dashboard->answer_time);
+    add_quantiles(snapshot, "hyperrecall_scheduled_interval_days", "hyperrecall_scheduled_interval_days_count",
+                  &dashboard->scheduled_interval);
+    add_quantiles(snapshot, "hyperrecall_input_latency_ms", "hyperrecall_input_latency_ms_count",
+                  &dashboard->input_latency);
+
+    metrics_snapshot_add(snapshot, "hyperrecall_memory_stability_days", NULL, NULL, HR_METRIC_GAUGE,
+                         dashboard->forgetting_curve.stability_days);
+    metrics_snapshot_add(snapshot, "hyperrecall_memory_stability_samples", NULL, NULL, HR_METRIC_GAUGE,
+                         (double)dashboard->forgetting_curve.samples);
+
+    const HrAnalyticsFrameStats *frames = &dashboard->frames;
+    metrics_snapshot_add(snapshot, "hyperrecall_frames_total", NULL, NULL, HR_METRIC_COUNTER,
+                         (double)frames->frames_tracked);
+    metrics_snapshot_add(snapshot, "hyperrecall_frame_seconds_total", NULL, NULL, HR_METRIC_COUNTER,
+                         frames->total_time_seconds);
+    add_quantiles(snapshot, "hyperrecall_recent_frame_time_ms", "hyperrecall_recent_frame_time_ms_count",
+                  &frames->recent_frame_time);
+    for (size_t i = 0; i <= HR_FRAME_PHASE_COUNT; ++i) {
+        metrics_snapshot_add(snapshot, "hyperrecall_long_frames_total", "phase",
+                             frame_profile_phase_name((HrFramePhase)i), HR_METRIC_COUNTER,
+                             (double)frames->long_frames_by_phase[i]);
+    }
+}
+
+static void capture_media(HrMetricsSnapshot *snapshot, const HrMediaCacheStats *media)
+{
+    static const char *const kKinds[4] = {"texture", "audio", "thumbnail", "mask"};
+    const double entries[4] = {(double)media->texture_count, (double)media->audio_count,
+                               (double)media->thumbnail_count, (double)media->mask_count};
+    const double bytes[4] = {(double)media->texture_bytes, (double)media->audio_bytes,
+                             (double)media->thumbnail_bytes, (double)media->mask_bytes};
+    for (size_t i = 0; i < 4U; ++i) {
+        metrics_snapshot_add(snapshot, "hyperrecall_media_cache_entries", "kind", kKinds[i], HR_METRIC_GAUGE,
+                             entries[i]);
+    }
+    for (size_t i = 0; i < 4U; ++i) {
+        metrics_snapshot_add(snapshot, "hyperrecall_media_cache_bytes", "kind", kKinds[i], HR_METRIC_GAUGE, bytes[i]);
+    }
+}
+
+static void capture_prefetch(HrMetricsSnapshot *snapshot, const HrPrefetchStats *prefetch)
+{
+    metrics_snapshot_add(snapshot, "hyperrecall_prefetch_hits_total", NULL, NULL, HR_METRIC_COUNTER,
+                         (double)prefetch->hits);
+    metrics_snapshot_add(snapshot, "hyperrecall_prefetch_misses_total", NULL, NULL, HR_METRIC_COUNTER,
+                         (double)prefetch->misses);
+    metrics_snapshot_add(snapshot, "hyperrecall_prefetch_bodies_loaded_total", NULL, NULL, HR_METRIC_COUNTER,
+                         (double)prefetch->bodies_loaded);
+    metrics_snapshot_add(snapshot, "hyperrecall_prefetch_media_warmed_total", NULL, NULL, HR_METRIC_COUNTER,
+                         (double)prefetch->media_warmed);
+    metrics_snapshot_add(snapshot, "hyperrecall_prefetch_media_failed_total", NULL, NULL, HR_METRIC_COUNTER,
+                         (double)prefetch->media_failed);
+}
+
+static void capture_events(HrMetricsSnapshot *snapshot, const HrEventBusStats *events)
+{
+    metrics_snapshot_add(snapshot, "hyperrecall_events_published_total", NULL, NULL, HR_METRIC_COUNTER,
+                         (double)events->published);
+    metrics_snapshot_add(snapshot, "hyperrecall_events_dispatched_total", NULL, NULL, HR_METRIC_COUNTER,
+                         (double)events->dispatched);
+    metrics_snapshot_add(snapshot, "hyperrecall_events_pumped_total", NULL, NULL, HR_METRIC_COUNTER,
+                         (double)events->pumped);
+    metrics_snapshot_add(snapshot, "hyperrecall_event_producer_stalls_total", NULL, NULL, HR_METRIC_COUNTER,
+                         (double)events->producer_stalls);
+    metrics_snapshot_add(snapshot, "hyperrecall_event_queue_high_water", NULL, NULL, HR_METRIC_GAUGE,
+                         (double)events->high_water);
+    metrics_snapshot_add(snapshot, "hyperrecall_autosaves_total", "outcome", "requested", HR_METRIC_COUNTER,
+                         (double)events->autosaves_requested);
+    metrics_snapshot_add(snapshot, "hyperrecall_autosaves_total", "outcome", "durable", HR_METRIC_COUNTER,
+                         (double)events->autosaves_durable);
+    metrics_snapshot_add(snapshot, "hyperrecall_autosaves_total", "outcome", "failed", HR_METRIC_COUNTER,
+                         (double)events->autosaves_failed);
+}
+
+void metrics_snapshot_capture(HrMetricsSnapshot *snapshot, const HrMetricsSources *sources)
+{
+    metrics_snapshot_reset(snapshot);
+    if (snapshot == NULL || sources == NULL) {
+        return;
+    }
+
+    const HrAnalyticsDashboard *dashboard = analytics_dashboard(sources->analytics);
+    if (dashboard != NULL) {
+        capture_analytics(snapshot, dashboard);
+    }
+
+    if (sources->media != NULL) {
+        HrMediaCacheStats media = {0};
+        prefetcher_lock_media(sources->prefetcher);
+        media_cache_get_stats(sources->media, &media);
+        prefetcher_unlock_media(sources->prefetcher);
+        capture_media(snapshot, &media);
+    }
+
+    if (sources->prefetcher != NULL) {
+        HrPrefetchStats prefetch = {0};
+        prefetcher_get_stats(sources->prefetcher, &prefetch);
+        capture_prefetch(snapshot, &prefetch);
+    }
+
+    if (sources->events != NULL) {
+        HrEventBusStats events = {0};
+        event_bus_stats(sources->events, &events);
+        capture_events(snapshot, &events);
+    }
+}
+
+unsigned int metrics_parse_formats(const char *text)
+{
+    if (text == NULL) {
+        return 0U;
+    }
+    if (strcmp(text, "ndjson") == 0) {
+        return HR_METRICS_FORMAT_NDJSON;
+    }
+    if (strcmp(text, "prometheus") == 0) {
+        return HR_METRICS_FORMAT_PROMETHEUS;
+    }
+    if (strcmp(text, "both") == 0) {
+        return HR_METRICS_FORMAT_NDJSON | HR_METRICS_FORMAT_PROMETHEUS;
+    }
+    return 0U;
+}
+
+/* {"ts":...,"metrics":{"name":value,"labelled":{"label_value":value,...},...}} */
+static bool format_ndjson(const HrMetricsSnapshot *snapshot, MetricsText *text)
+{
+    text_append(text, "{\"ts\":%" PRId64 ",\"metrics\":{", snapshot->captured_at);
+    for (size_t i = 0; i < snapshot->count; ++i) {
+        const HrMetricSample *sample = &snapshot->samples[i];
+        const bool first_of_name = i == 0U || strcmp(sample->name, snapshot->samples[i - 1U].name) != 0;
+        const bool last_of_name = i + 1U == snapshot->count || strcmp(sample->name, snapshot->samples[i + 1U].name) != 0;
+        const bool labelled = sample->label_key[0] != '\0';
+
+        if (first_of_name) {
+            text_append(text, "%s\"%s\":%s", (i > 0U) ? "," : "", sample->name, labelled ? "{" : "");
+        } else {
+            text_append(text, ",");
+        }
+        if (labelled) {
+            text_append(text, "\"%s\":", sample->label_value);
+        }
+        text_append_value(text, sample->value, true);
+        if (labelled && last_of_name) {
+            text_append(text, "}");
+        }
+    }
+    text_append(text, "}}\n");
+    return !text->overflow;
+}
+
+static bool format_prometheus(const HrMetricsSnapshot *snapshot, MetricsText *text)
+{
+    text_append(text, "# TYPE hyperrecall_snapshot_timestamp_seconds gauge\n");
+    text_append(text, "hyperrecall_snapshot_timestamp_seconds %" PRId64 "\n", snapshot->captured_at);
+    for (size_t i = 0; i < snapshot->count; ++i) {
+        const HrMetricSample *sample = &snapshot->samples[i];
+        if (i == 0U || strcmp(sample->name, snapshot->samples[i - 1U].name) != 0) {
+            text_append(text, "# TYPE %s %s\n", sample->name,
+                        (sample->kind == HR_METRIC_COUNTER) ? "counter" : "gauge");
+        }
+        if (sample->label_key[0] != '\0') {
+            text_append(text, "%s{%s=\"%s\"} ", sample->name, sample->label_key, sample->label_value);
+        } else {
+            text_append(text, "%s ", sample->name);
+        }
+        text_append_value(text, sample->value, false);
+        text_append(text, "\n");
+    }
+    return !text->overflow;
+}
+
+static bool ensure_directory_exists(const char *path)
+{
+    if (path == NULL || path[0] == '\0') {
+        return false;
+    }
+
+    struct stat info;
+    if (stat(path, &info) == 0) {
+        return S_ISDIR(info.st_mode);
+    }
+
+#if defined(_WIN32)
+    int rc = _mkdir(path);
+#else
+    int rc = mkdir(path, 0700);
+#endif
+    if (rc == 0) {
+        return true;
+    }
+
+    if (errno == EEXIST) {
+        return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+    }
+
+    return false;
+}
+
+static bool compose_path(char *buffer, size_t capacity, const char *directory, const char *file, unsigned int index)
+{
+    const int written = (index > 0U) ? snprintf(buffer, capacity, "%s/%s.%u", directory, file, index)
+                                     : snprintf(buffer, capacity, "%s/%s", directory, file);
+    return written >= 0 && (size_t)written < capacity;
+}
+
+/* metrics.ndjson becomes .1, .1 becomes .2 and so on; the oldest beyond keep_files is dropped. */
+static bool rotate_ndjson(struct HrMetricsExporter *exporter)
+{
+    char from[PATH_MAX];
+    char to[PATH_MAX];
+
+    if (exporter->keep_files == 0U) {
+        return compose_path(from, sizeof(from), exporter->directory, METRICS_NDJSON_FILE, 0U) && remove(from) == 0;
+    }
+
+    if (compose_path(to, sizeof(to), exporter->directory, METRICS_NDJSON_FILE, exporter->keep_files)) {
+        remove(to);
+    }
+    for (unsigned int index = exporter->keep_files; index > 0U; --index) {
+        if (!compose_path(from, sizeof(from), exporter->directory, METRICS_NDJSON_FILE, index - 1U) ||
+            !compose_path(to, sizeof(to), exporter->directory, METRICS_NDJSON_FILE, index)) {
+            return false;
+        }
+        if (rename(from, to) != 0 && index == 1U) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool write_ndjson(struct HrMetricsExporter *exporter, const char *line, size_t length, bool *out_rotated)
+{
+    char path[PATH_MAX];
+    if (!compose_path(path, sizeof(path), exporter->directory, METRICS_NDJSON_FILE, 0U)) {
+        return false;
+    }
+
+    struct stat info;
+    if (exporter->max_bytes > 0U && stat(path, &info) == 0 && info.st_size > 0 &&
+        (uint64_t)info.st_size + length > exporter->max_bytes) {
+        *out_rotated = rotate_ndjson(exporter);
+    }
+
+    FILE *file = fopen(path, "ab");
+    if (file == NULL) {
+        return false;
+    }
+    const bool wrote = fwrite(line, 1U, length, file) == length;
+    return (fclose(file) == 0) && wrote;
+}
+
+static bool write_prometheus(struct HrMetricsExporter *exporter, const char *body, size_t length)
+{
+    char path[PATH_MAX];
+    char temp_path[PATH_MAX];
+    if (!compose_path(path, sizeof(path), exporter->directory, METRICS_PROMETHEUS_FILE, 0U) ||
+        !compose_path(temp_path, sizeof(temp_path), exporter->directory, METRICS_PROMETHEUS_FILE ".tmp", 0U)) {
+        return false;
+    }
+
+    FILE *file = fopen(temp_path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    const bool wrote = fwrite(body, 1U, length, file) == length;
+    if (fclose(file) != 0 || !wrote) {
+        remove(temp_path);
+        return false;
+    }
+
+#if defined(_WIN32)
+    /* rename() does not replace an existing file here. */
+    remove(path);
+#endif
+    if (rename(temp_path, path) != 0) {
+        remove(temp_path);
+        return false;
+    }
+    return true;
+}
+
+static bool write_snapshot(struct HrMetricsExporter *exporter, const HrMetricsSnapshot *snapshot, bool *out_rotated)
+{
+    if (!exporter->directory_ready) {
+        exporter->directory_ready = ensure_directory_exists(exporter->directory);
+        if (!exporter->directory_ready) {
+            return false;
+        }
+    }
+
+    bool ok = true;
+    if ((exporter->formats & HR_METRICS_FORMAT_NDJSON) != 0U) {
+        MetricsText text = {exporter->text, sizeof(exporter->text), 0U, false};
+        ok = format_ndjson(snapshot, &text) && write_ndjson(exporter, text.data, text.length, out_rotated) && ok;
+    }
+    if ((exporter->formats & HR_METRICS_FORMAT_PROMETHEUS) != 0U) {
+        MetricsText text = {exporter->text, sizeof(exporter->text), 0U, false};
+        ok = format_prometheus(snapshot, &text) && write_prometheus(exporter, text.data, text.length) && ok;
+    }
+    return ok;
+}
+
+static void metrics_writer(void *user_data)
+{
+    struct HrMetricsExporter *exporter = (struct HrMetricsExporter *)user_data;
+
+    hr_mutex_lock(&exporter->lock);
+    for (;;) {
+        while (!exporter->pending && !exporter->stop) {
+            hr_cond_wait(&exporter->wake, &exporter->lock);
+        }
+        /* A pending snapshot is still written after a stop request. */
+        if (!exporter->pending) {
+            break;
+        }
+        exporter->writing = exporter->pending_snapshot;
+        exporter->pending = false;
+        hr_mutex_unlock(&exporter->lock);
+
+        bool rotated = false;
+        const bool ok = write_snapshot(exporter, &exporter->writing, &rotated);
+
+        hr_mutex_lock(&exporter->lock);
+        exporter->stats.rotations += rotated ? 1U : 0U;
+        if (ok) {
+            exporter->stats.written++;
+        } else {
+            exporter->stats.failed++;
+        }
+    }
+    hr_mutex_unlock(&exporter->lock);
+}
+
+struct HrMetricsExporter *metrics_exporter_create(const HrMetricsExportConfig *config)
+{
+    if (config == NULL || config->directory == NULL || config->directory[0] == '\0' ||
+        (config->formats & (HR_METRICS_FORMAT_NDJSON | HR_METRICS_FORMAT_PROMETHEUS)) == 0U ||
+        strlen(config->directory) >= PATH_MAX) {
+        return NULL;
+    }
+
+    struct HrMetricsExporter *exporter = (struct HrMetricsExporter *)calloc(1U, sizeof(*exporter));
+    if (exporter == NULL) {
+        return NULL;
+    }
+
+    memcpy(exporter->directory, config->directory, strlen(config->directory) + 1U);
+    exporter->formats = config->formats;
+    exporter->max_bytes = config->max_bytes;
+    exporter->keep_files = config->keep_files;
+
+    const bool lock_ready = hr_mutex_init(&exporter->lock);
+    const bool wake_ready = hr_cond_init(&exporter->wake);
+    bool writer_started = false;
+    if (lock_ready && wake_ready) {
+        writer_started = hr_thread_start(&exporter->writer, metrics_writer, exporter);
+    }
+
+    if (!writer_started) {
+        if (lock_ready) {
+            hr_mutex_destroy(&exporter->lock);
+        }
+        if (wake_ready) {
+            hr_cond_destroy(&exporter->wake);
+        }
+        free(exporter);
+        return NULL;
+    }
+
+    return exporter;
+}
+
+void metrics_exporter_destroy(struct HrMetricsExporter *exporter)
+{
+    if (exporter == NULL) {
+        return;
+    }
+
+    hr_mutex_lock(&exporter->lock);
+    exporter->stop = true;
+    hr_cond_signal(&exporter->wake);
+    hr_mutex_unlock(&exporter->lock);
+    hr_thread_join(&exporter->writer);
+
+    hr_cond_destroy(&exporter->wake);
+    hr_mutex_destroy(&exporter->lock);
+    free(exporter);
+}
+
+bool metrics_exporter_submit(struct HrMetricsExporter *exporter, const HrMetricsSnapshot *snapshot)
+{
+    if (exporter == NULL || snapshot == NULL) {
+        return false;
+    }
+
+    hr_mutex_lock(&exporter->lock);
+    if (exporter->pending) {
+        exporter->stats.replaced++;
+    }
+    exporter->pending_snapshot = *snapshot;
+    exporter->pending = true;
+    exporter->stats.submitted++;
+    hr_cond_signal(&exporter->wake);
+    hr_mutex_unlock(&exporter->lock);
+    return true;
+}
+
+void metrics_exporter_stats(struct HrMetricsExporter *exporter, HrMetricsExportStats *out_stats)
+{
+    if (out_stats == NULL) {
+        return;
+    }
+    memset(out_stats, 0, sizeof(*out_stats));
+    if (exporter == NULL) {
+        return;
+    }
+
+    hr_mutex_lock(&exporter->lock);
+    *out_stats = exporter->stats;
+    hr_mutex_unlock(&exporter->lock);
+}
@@ -0,0 +1,125 @@
+#ifndef HYPERRECALL_METRICS_EXPORT_H
+#define HYPERRECALL_METRICS_EXPORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file metrics_export.h
+ * @brief Periodic snapshots of learner and app health for external scrapers.
+ *
+ * The owner captures a snapshot on its own thread, which only copies
+ * counters into a flat list of samples, and submits it. A background thread
+ * formats and writes it: one JSON object per line appended to
+ * metrics.ndjson, rotated by size to metrics.ndjson.1 .. .N, and/or the
+ * Prometheus text format written to metrics.prom through a temporary file
+ * and a rename, so a scraper never reads half a file. Submitting never
+ * waits for I/O; a snapshot still pending when the next one arrives is
+ * replaced by it.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "event_bus.h"
+#include "media.h"
+#include "prefetch.h"
+
+struct AnalyticsHandle;
+
+/** Most samples a snapshot holds. */
+#define HR_METRICS_MAX_SAMPLES 96U
+
+#define HR_METRICS_MAX_NAME 64U
+#define HR_METRICS_MAX_LABEL 24U
+
+/** Output formats; combine as bits. */
+typedef enum HrMetricsFormat {
+    HR_METRICS_FORMAT_NDJSON = 1,
+    HR_METRICS_FORMAT_PROMETHEUS = 2,
+} HrMetricsFormat;
+
+typedef enum HrMetricKind {
+    HR_METRIC_GAUGE = 0,
+    HR_METRIC_COUNTER = 1, /**< Only grows while the app runs. */
+} HrMetricKind;
+
+/** One value, optionally under a single label such as rating="good". */
+typedef struct HrMetricSample {
+    char name[HR_METRICS_MAX_NAME];         /**< Prometheus-style name, e.g. hyperrecall_reviews_total. */
+    char label_key[HR_METRICS_MAX_LABEL];   /**< Empty for an unlabelled sample. */
+    char label_value[HR_METRICS_MAX_LABEL];
+    HrMetricKind kind;
+    double value;
+} HrMetricSample;
+
+/** Samples sharing a name are kept adjacent; each name has one kind. */
+typedef struct HrMetricsSnapshot {
+    int64_t captured_at; /**< Unix seconds. */
+    size_t count;
+    HrMetricSample samples[HR_METRICS_MAX_SAMPLES];
+} HrMetricsSnapshot;
+
+/** Where metrics_snapshot_capture() reads from; NULL members are skipped. */
+typedef struct HrMetricsSources {
+    const struct AnalyticsHandle *analytics;
+    const struct HrMediaCache *media;   /**< Read under the prefetcher's media lock when both are set. */
+    struct HrPrefetcher *prefetcher;
+    const struct HrEventBus *events;
+} HrMetricsSources;
+
+typedef struct HrMetricsExportConfig {
+    const char *directory;     /**< Created on first write when missing. */
+    unsigned int formats;      /**< HrMetricsFormat bits. */
+    uint64_t max_bytes;        /**< NDJSON size that triggers a rotation (0 = never rotate). */
+    unsigned int keep_files;   /**< Rotated NDJSON files kept (0 drops the old file on rotation). */
+} HrMetricsExportConfig;
+
+typedef struct HrMetricsExportStats {
+    uint64_t submitted;
+    uint64_t written;    /**< Snapshots written in every configured format. */
+    uint64_t replaced;   /**< Snapshots superseded before the writer reached them. */
+    uint64_t failed;
+    uint64_t rotations;
+} HrMetricsExportStats;
+
+struct HrMetricsExporter;
+
+/** Clears @p snapshot and stamps it with the current time. */
+void metrics_snapshot_reset(HrMetricsSnapshot *snapshot);
+
+/**
+ * Appends a sample. @p label_key may be NULL for an unlabelled sample.
+ * Returns false when the snapshot is full or a string does not fit.
+ */
+bool metrics_snapshot_add(HrMetricsSnapshot *snapshot,
+                          const char *name,
+                          const char *label_key,
+                          const char *label_value,
+                          HrMetricKind kind,
+                          double value);
+
+/** Resets @p snapshot and fills it from @p sources on the calling thread. */
+void metrics_snapshot_capture(HrMetricsSnapshot *snapshot, const HrMetricsSources *sources);
+
+/** Parses "ndjson", "prometheus" or "both"; returns 0 for anything else. */
+unsigned int metrics_parse_formats(const char *text);
+
+/** Copies the configuration and starts the writer thread. */
+struct HrMetricsExporter *metrics_exporter_create(const HrMetricsExportConfig *config);
+
+/** Writes any pending snapshot, stops the writer and frees the exporter. */
+void metrics_exporter_destroy(struct HrMetricsExporter *exporter);
+
+/** Hands @p snapshot to the writer and returns without waiting for it. */
+bool metrics_exporter_submit(struct HrMetricsExporter *exporter, const HrMetricsSnapshot *snapshot);
+
+void metrics_exporter_stats(struct HrMetricsExporter *exporter, HrMetricsExportStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_METRICS_EXPORT_H */
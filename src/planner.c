@@ -0,0 +1,1053 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "planner.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HR_PLANNER_SECONDS_PER_DAY 86400
+
+/* Saved cursor layout: version, now, remaining, since_new, served counts, then two lanes. */
+#define HR_PLANNER_CURSOR_STATE_VERSION 1U
+#define HR_PLANNER_CURSOR_LANE_BYTES 25U
+#define HR_PLANNER_CURSOR_STATE_BYTES (44U + 2U * HR_PLANNER_CURSOR_LANE_BYTES)
+
+struct HrStudyPlanner {
+    DatabaseHandle *database;
+    HrSrsConfig quota;
+    SRSConfig srs_config;
+    unsigned int reviews_per_new;
+    HrPlannerDailyCounters counters;
+    bool counters_loaded;
+    HrPlannerTopicWeightFn topic_weight_fn;
+    void *topic_weight_user_data;
+};
+
+/** Candidate held in the bounded backlog heap. */
+typedef struct PlannerBacklogEntry {
+    double score;
+    SessionCardSpec spec;
+    char topic_id[HR_PLANNER_MAX_TOPIC_ID];
+} PlannerBacklogEntry;
+
+/** Keyset position of one row read by a cursor lane. */
+typedef struct PlannerRowKey {
+    sqlite3_int64 due_at;
+    sqlite3_int64 id;
+} PlannerRowKey;
+
+/**
+ * One side (reviews or new cards) of a streaming cursor, read a page at a
+ * time. The after_* keys run ahead to the end of the page just read; the
+ * served_* keys stop at the last row handed out, which is where a saved
+ * cursor picks up again.
+ */
+typedef struct PlannerCursorLane {
+    sqlite3_stmt *stmt;
+    bool new_cards;
+    bool exhausted;
+    size_t quota_left;
+    sqlite3_int64 after_due_at;
+    sqlite3_int64 after_id;
+    sqlite3_int64 served_due_at;
+    sqlite3_int64 served_id;
+    SessionCardSpec *page;
+    char (*topics)[HR_PLANNER_MAX_TOPIC_ID];
+    PlannerRowKey *keys;
+    size_t page_capacity;
+    size_t page_count;
+    size_t page_index;
+} PlannerCursorLane;
+
+struct HrPlannerCursor {
+    struct HrStudyPlanner *planner;
+    time_t now;
+    size_t remaining;
+    size_t since_new;
+    PlannerCursorLane reviews;
+    PlannerCursorLane fresh;
+    char (*out_topics)[HR_PLANNER_MAX_TOPIC_ID];
+    size_t out_capacity;
+    size_t served_reviews;
+    size_t served_new;
+};
+
+static time_t planner_day_start(time_t now)
+{
+    if (now <= 0) {
+        now = time(NULL);
+    }
+    return now - (now % HR_PLANNER_SECONDS_PER_DAY);
+}
+
+static unsigned int planner_remaining(unsigned int limit, unsigned int used)
+{
+    return (used >= limit) ? 0U : (limit - used);
+}
+
+static void planner_spec_from_row(sqlite3_stmt *stmt,
+                                  const SRSConfig *config,
+                                  SessionCardSpec *spec,
+                                  char *topic_buffer)
+{
+    memset(spec, 0, sizeof(*spec));
+
+    const sqlite3_int64 card_id = sqlite3_column_int64(stmt, 0);
+    const sqlite3_int64 due_at = sqlite3_column_int64(stmt, 1);
+    const int interval = sqlite3_column_int(stmt, 2);
+    const int ease = sqlite3_column_int(stmt, 3);
+    const int review_state = sqlite3_column_int(stmt, 4);
+    const unsigned char *topic_uuid = sqlite3_column_text(stmt, 5);
+
+    spec->card_id = (uint64_t)card_id;
+
+    if (review_state != 0) {
+        /* Cards only persist due/interval/ease, so the last review is derived from them. */
+        SRSPersistedState *persisted = &spec->persisted_state;
+        persisted->version = SRS_STATE_VERSION;
+        persisted->mode = (uint32_t)SRS_MODE_MASTERY;
+        persisted->due_unix = (int64_t)due_at;
+        persisted->interval_days = (interval > 0) ? (double)interval : config->starting_interval_days;
+        persisted->last_review_unix = (int64_t)due_at - (int64_t)(persisted->interval_days * HR_PLANNER_SECONDS_PER_DAY);
+        persisted->ease_factor = (ease > 0) ? (double)ease / 100.0 : config->ease_default;
+        persisted->topic_adjustment = 1.0;
+        spec->has_persisted_state = true;
+    }
+
+    topic_buffer[0] = '\0';
+    if (topic_uuid != NULL) {
+        strncpy(topic_buffer, (const char *)topic_uuid, HR_PLANNER_MAX_TOPIC_ID - 1U);
+        topic_buffer[HR_PLANNER_MAX_TOPIC_ID - 1U] = '\0';
+        spec->has_topic = true;
+        spec->topic.topic_id = topic_buffer;
+        spec->topic.weight = 1.0;
+    }
+}
+
+static size_t planner_fetch(struct HrStudyPlanner *planner,
+                            bool new_cards,
+                            time_t now,
+                            size_t limit,
+                            SessionCardSpec *specs,
+                            char (*topics)[HR_PLANNER_MAX_TOPIC_ID])
+{
+    if (limit == 0U) {
+        return 0U;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    int rc = new_cards ? db_card_prepare_select_new(planner->database, &stmt)
+                       : db_card_prepare_select_scheduled(planner->database, &stmt);
+    if (rc != SQLITE_OK) {
+        return 0U;
+    }
+
+    HrCardDueQuery query = {
+        .latest_due_at = (sqlite3_int64)now,
+        .limit = (limit > (size_t)INT_MAX) ? INT_MAX : (int)limit,
+    };
+
+    size_t fetched = 0U;
+    if (db_card_bind_select_scheduled(stmt, &query) == SQLITE_OK) {
+        while (fetched < limit && sqlite3_step(stmt) == SQLITE_ROW) {
+            planner_spec_from_row(stmt, &planner->srs_config, &specs[fetched], topics[fetched]);
+            fetched++;
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    return fetched;
+}
+
+static bool planner_count_due(struct HrStudyPlanner *planner,
+                              time_t now,
+                              size_t *out_reviews,
+                              size_t *out_new)
+{
+    sqlite3_stmt *stmt = NULL;
+    if (db_card_prepare_count_due(planner->database, &stmt) != SQLITE_OK) {
+        return false;
+    }
+
+    bool ok = false;
+    if (db_card_bind_count_due(stmt, (sqlite3_int64)now) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        *out_reviews = (size_t)sqlite3_column_int64(stmt, 0);
+        *out_new = (size_t)sqlite3_column_int64(stmt, 1);
+        ok = true;
+    }
+
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+static double planner_topic_weight(const struct HrStudyPlanner *planner, const char *topic_id)
+{
+    if (planner->topic_weight_fn == NULL || topic_id == NULL) {
+        return 1.0;
+    }
+
+    const double weight = planner->topic_weight_fn(topic_id, planner->topic_weight_user_data);
+    return (weight > 0.0) ? weight : 1.0;
+}
+
+/*
+ * A review is worth most while the card is slipping but still recoverable:
+ * R * (1 - R) peaks at even odds, so barely overdue cards (safe for a few more
+ * days) and long-forgotten ones (a relearn either way) rank below it.
+ */
+static double planner_backlog_score(double recall, double topic_weight)
+{
+    return topic_weight * recall * (1.0 - recall);
+}
+
+/* Orders backlog entries so that the heap root is the weakest candidate. */
+static bool planner_backlog_less(const PlannerBacklogEntry *a, const PlannerBacklogEntry *b)
+{
+    if (a->score != b->score) {
+        return a->score < b->score;
+    }
+    return a->spec.card_id > b->spec.card_id;
+}
+
+static void planner_backlog_swap(PlannerBacklogEntry *a, PlannerBacklogEntry *b)
+{
+    PlannerBacklogEntry tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static void planner_backlog_sift_up(PlannerBacklogEntry *heap, size_t index)
+{
+    while (index > 0U) {
+        const size_t parent = (index - 1U) / 2U;
+        if (!planner_backlog_less(&heap[index], &heap[parent])) {
+            break;
+        }
+        planner_backlog_swap(&heap[index], &heap[parent]);
+        index = parent;
+    }
+}
+
+static void planner_backlog_sift_down(PlannerBacklogEntry *heap, size_t count, size_t index)
+{
+    for (;;) {
+        const size_t left = index * 2U + 1U;
+        const size_t right = left + 1U;
+        size_t smallest = index;
+        if (left < count && planner_backlog_less(&heap[left], &heap[smallest])) {
+            smallest = left;
+        }
+        if (right < count && planner_backlog_less(&heap[right], &heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        planner_backlog_swap(&heap[index], &heap[smallest]);
+        index = smallest;
+    }
+}
+
+static int planner_backlog_compare_desc(const void *lhs, const void *rhs)
+{
+    const PlannerBacklogEntry *a = (const PlannerBacklogEntry *)lhs;
+    const PlannerBacklogEntry *b = (const PlannerBacklogEntry *)rhs;
+    if (planner_backlog_less(b, a)) {
+        return -1;
+    }
+    if (planner_backlog_less(a, b)) {
+        return 1;
+    }
+    return 0;
+}
+
+struct HrStudyPlanner *planner_create(DatabaseHandle *database,
+                                      const HrSrsConfig *quota,
+                                      const SRSConfig *srs_config)
+{
+    if (database == NULL) {
+        return NULL;
+    }
+
+    struct HrStudyPlanner *planner = (struct HrStudyPlanner *)calloc(1U, sizeof(struct HrStudyPlanner));
+    if (planner == NULL) {
+        return NULL;
+    }
+
+    planner->database = database;
+    if (quota != NULL) {
+        planner->quota = *quota;
+    } else {
+        planner->quota.daily_new_cards = 20U;
+        planner->quota.daily_review_limit = 200U;
+    }
+    if (srs_config != NULL) {
+        planner->srs_config = *srs_config;
+    } else {
+        srs_default_config(&planner->srs_config);
+    }
+    planner->reviews_per_new = HR_PLANNER_DEFAULT_REVIEWS_PER_NEW;
+    planner->counters_loaded = false;
+    return planner;
+}
+
+void planner_destroy(struct HrStudyPlanner *planner)
+{
+    free(planner);
+}
+
+void planner_set_quota(struct HrStudyPlanner *planner, const HrSrsConfig *quota)
+{
+    if (planner == NULL || quota == NULL) {
+        return;
+    }
+
+    planner->quota = *quota;
+}
+
+void planner_set_mix_ratio(struct HrStudyPlanner *planner, unsigned int reviews_per_new)
+{
+    if (planner == NULL) {
+        return;
+    }
+
+    planner->reviews_per_new = reviews_per_new;
+}
+
+void planner_set_topic_weights(struct HrStudyPlanner *planner,
+                               HrPlannerTopicWeightFn weight_fn,
+                               void *user_data)
+{
+    if (planner == NULL) {
+        return;
+    }
+
+    planner->topic_weight_fn = weight_fn;
+    planner->topic_weight_user_data = user_data;
+}
+
+bool planner_refresh_counters(struct HrStudyPlanner *planner, time_t now)
+{
+    if (planner == NULL) {
+        return false;
+    }
+
+    const time_t day_start = planner_day_start(now);
+    HrReviewSummaryQuery query = {
+        .start_at = (sqlite3_int64)day_start,
+        .end_at = (sqlite3_int64)day_start + HR_PLANNER_SECONDS_PER_DAY,
+    };
+
+    sqlite3_stmt *stmt = NULL;
+    if (db_review_prepare_daily_activity(planner->database, &stmt) != SQLITE_OK) {
+        return false;
+    }
+
+    bool ok = false;
+    if (db_review_bind_daily_activity(stmt, &query) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        const sqlite3_int64 total = sqlite3_column_int64(stmt, 0);
+        const sqlite3_int64 new_reviews = sqlite3_column_int64(stmt, 1);
+        planner->counters.day_start = day_start;
+        planner->counters.new_reviewed = (unsigned int)new_reviews;
+        planner->counters.reviews_done = (unsigned int)(total - new_reviews);
+        planner->counters_loaded = true;
+        ok = true;
+    }
+
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+const HrPlannerDailyCounters *planner_counters(struct HrStudyPlanner *planner, time_t now)
+{
+    if (planner == NULL) {
+        return NULL;
+    }
+
+    const time_t day_start = planner_day_start(now);
+    if (!planner->counters_loaded) {
+        if (!planner_refresh_counters(planner, now)) {
+            memset(&planner->counters, 0, sizeof(planner->counters));
+            planner->counters.day_start = day_start;
+        }
+    } else if (planner->counters.day_start != day_start) {
+        /* A new day starts empty; no need to rescan the log. */
+        planner->counters.day_start = day_start;
+        planner->counters.new_reviewed = 0U;
+        planner->counters.reviews_done = 0U;
+    }
+
+    return &planner->counters;
+}
+
+void planner_record_review(struct HrStudyPlanner *planner, const SessionReviewEvent *event)
+{
+    if (planner == NULL || event == NULL || event->simulated) {
+        return;
+    }
+
+    time_t timestamp = event->result.review_time != 0 ? event->result.review_time : event->context.now;
+    HrPlannerDailyCounters *counters = (HrPlannerDailyCounters *)planner_counters(planner, timestamp);
+    if (counters == NULL || counters->day_start != planner_day_start(timestamp)) {
+        return;
+    }
+
+    unsigned int *counter = event->first_review ? &counters->new_reviewed : &counters->reviews_done;
+    if (!event->undone) {
+        (*counter)++;
+    } else if (*counter > 0U) {
+        (*counter)--;
+    }
+}
+
+void planner_record_session_event(const SessionReviewEvent *event, void *user_data)
+{
+    if (user_data == NULL) {
+        return;
+    }
+    planner_record_review((struct HrStudyPlanner *)user_data, event);
+}
+
+bool planner_build(struct HrStudyPlanner *planner,
+                   time_t now,
+                   size_t max_cards,
+                   HrPlannerPlan *out_plan)
+{
+    if (planner == NULL || out_plan == NULL) {
+        return false;
+    }
+
+    memset(out_plan, 0, sizeof(*out_plan));
+    if (now <= 0) {
+        now = time(NULL);
+    }
+
+    const HrPlannerDailyCounters *counters = planner_counters(planner, now);
+    size_t review_quota = planner_remaining(planner->quota.daily_review_limit, counters->reviews_done);
+    size_t new_quota = planner_remaining(planner->quota.daily_new_cards, counters->new_reviewed);
+
+    size_t due_reviews = 0U;
+    size_t available_new = 0U;
+    if (!planner_count_due(planner, now, &due_reviews, &available_new)) {
+        return false;
+    }
+
+    size_t review_take = (due_reviews < review_quota) ? due_reviews : review_quota;
+    size_t new_take = (available_new < new_quota) ? available_new : new_quota;
+    if (max_cards > 0U && review_take + new_take > max_cards) {
+        /* Keep the configured mix when the session itself is capped. */
+        const size_t ratio = (size_t)planner->reviews_per_new;
+        size_t new_share = (ratio > 0U) ? (max_cards / (ratio + 1U)) : 0U;
+        if (new_share > new_take) {
+            new_share = new_take;
+        }
+        size_t review_share = max_cards - new_share;
+        if (review_share > review_take) {
+            review_share = review_take;
+            new_share = (max_cards - review_share < new_take) ? (max_cards - review_share) : new_take;
+        }
+        review_take = review_share;
+        new_take = new_share;
+    }
+
+    const size_t total = review_take + new_take;
+    out_plan->deferred_reviews = due_reviews - review_take;
+    out_plan->deferred_new = available_new - new_take;
+    if (total == 0U) {
+        return true;
+    }
+
+    SessionCardSpec *reviews = (SessionCardSpec *)calloc(total, sizeof(SessionCardSpec));
+    char (*topics)[HR_PLANNER_MAX_TOPIC_ID] = calloc(total, sizeof(*topics));
+    out_plan->cards = (SessionCardSpec *)calloc(total, sizeof(SessionCardSpec));
+    if (reviews == NULL || topics == NULL || out_plan->cards == NULL) {
+        free(reviews);
+        free(topics);
+        free(out_plan->cards);
+        out_plan->cards = NULL;
+        return false;
+    }
+    out_plan->topic_ids = topics;
+
+    const size_t fetched_reviews = planner_fetch(planner, false, now, review_take, reviews, topics);
+    SessionCardSpec *fresh = reviews + fetched_reviews;
+    const size_t fetched_new = planner_fetch(planner, true, now, new_take, fresh, topics + fetched_reviews);
+
+    /* Interleave: one new card after every reviews_per_new reviews. */
+    size_t review_index = 0U;
+    size_t new_index = 0U;
+    size_t since_new = 0U;
+    const size_t ratio = (size_t)planner->reviews_per_new;
+    while (review_index < fetched_reviews || new_index < fetched_new) {
+        bool take_new = false;
+        if (new_index < fetched_new) {
+            take_new = (review_index >= fetched_reviews) || (ratio > 0U && since_new >= ratio);
+        }
+
+        if (take_new) {
+            out_plan->cards[out_plan->count++] = fresh[new_index++];
+            since_new = 0U;
+        } else {
+            out_plan->cards[out_plan->count++] = reviews[review_index++];
+            since_new++;
+        }
+    }
+    free(reviews);
+
+    out_plan->review_count = fetched_reviews;
+    out_plan->new_count = fetched_new;
+    out_plan->deferred_reviews = due_reviews - fetched_reviews;
+    out_plan->deferred_new = available_new - fetched_new;
+    return true;
+}
+
+bool planner_build_backlog(struct HrStudyPlanner *planner,
+                           time_t now,
+                           size_t max_cards,
+                           HrPlannerPlan *out_plan)
+{
+    if (planner == NULL || out_plan == NULL) {
+        return false;
+    }
+
+    memset(out_plan, 0, sizeof(*out_plan));
+    if (now <= 0) {
+        now = time(NULL);
+    }
+
+    const HrPlannerDailyCounters *counters = planner_counters(planner, now);
+    size_t capacity = (max_cards > 0U) ? max_cards : (size_t)HR_PLANNER_DEFAULT_BACKLOG_SIZE;
+    const size_t review_quota = planner_remaining(planner->quota.daily_review_limit, counters->reviews_done);
+    if (capacity > review_quota) {
+        capacity = review_quota;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    if (db_card_prepare_select_overdue(planner->database, &stmt) != SQLITE_OK) {
+        return false;
+    }
+    if (db_card_bind_select_overdue(stmt, (sqlite3_int64)now) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    PlannerBacklogEntry *heap = NULL;
+    if (capacity > 0U) {
+        heap = (PlannerBacklogEntry *)calloc(capacity, sizeof(PlannerBacklogEntry));
+        if (heap == NULL) {
+            sqlite3_finalize(stmt);
+            return false;
+        }
+    }
+
+    size_t streamed = 0U;
+    size_t kept = 0U;
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        streamed++;
+        if (capacity == 0U) {
+            continue;
+        }
+
+        const sqlite3_int64 due_at = sqlite3_column_int64(stmt, 1);
+        const int interval = sqlite3_column_int(stmt, 2);
+        const char *topic_uuid = (const char *)sqlite3_column_text(stmt, 5);
+
+        SRSState estimate;
+        memset(&estimate, 0, sizeof(estimate));
+        estimate.interval_days = (interval > 0) ? (double)interval : planner->srs_config.starting_interval_days;
+        estimate.last_review = (time_t)(due_at - (sqlite3_int64)(estimate.interval_days * HR_PLANNER_SECONDS_PER_DAY));
+
+        const double topic_weight = planner_topic_weight(planner, topic_uuid);
+        PlannerBacklogEntry candidate;
+        candidate.score = planner_backlog_score(srs_recall_probability(&estimate, now), topic_weight);
+        candidate.spec.card_id = (uint64_t)sqlite3_column_int64(stmt, 0);
+
+        /* Only rows that beat the weakest kept entry are materialised. */
+        if (kept == capacity && !planner_backlog_less(&heap[0], &candidate)) {
+            continue;
+        }
+
+        const size_t slot = (kept < capacity) ? kept : 0U;
+        PlannerBacklogEntry *entry = &heap[slot];
+        entry->score = candidate.score;
+        planner_spec_from_row(stmt, &planner->srs_config, &entry->spec, entry->topic_id);
+        entry->spec.topic.weight = topic_weight;
+
+        if (kept < capacity) {
+            kept++;
+            planner_backlog_sift_up(heap, slot);
+        } else {
+            planner_backlog_sift_down(heap, kept, 0U);
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_DONE) {
+        free(heap);
+        return false;
+    }
+
+    out_plan->deferred_reviews = streamed - kept;
+    if (kept == 0U) {
+        free(heap);
+        return true;
+    }
+
+    qsort(heap, kept, sizeof(PlannerBacklogEntry), planner_backlog_compare_desc);
+
+    out_plan->cards = (SessionCardSpec *)calloc(kept, sizeof(SessionCardSpec));
+    out_plan->topic_ids = calloc(kept, sizeof(*out_plan->topic_ids));
+    if (out_plan->cards == NULL || out_plan->topic_ids == NULL) {
+        free(heap);
+        planner_plan_release(out_plan);
+        return false;
+    }
+
+    /* Topic pointers are rebound here because heap entries moved while sifting. */
+    for (size_t i = 0U; i < kept; ++i) {
+        out_plan->cards[i] = heap[i].spec;
+        memcpy(out_plan->topic_ids[i], heap[i].topic_id, HR_PLANNER_MAX_TOPIC_ID);
+        if (out_plan->cards[i].has_topic) {
+            out_plan->cards[i].topic.topic_id = out_plan->topic_ids[i];
+        }
+    }
+    free(heap);
+
+    out_plan->count = kept;
+    out_plan->review_count = kept;
+    return true;
+}
+
+/* xorshift64* step; the state must never be zero. */
+static uint64_t planner_exam_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+bool planner_build_exam(struct HrStudyPlanner *planner,
+                        size_t card_count,
+                        uint64_t seed,
+                        HrPlannerPlan *out_plan)
+{
+    if (planner == NULL || out_plan == NULL) {
+        return false;
+    }
+
+    memset(out_plan, 0, sizeof(*out_plan));
+    const size_t capacity = (card_count > 0U) ? card_count : (size_t)HR_PLANNER_DEFAULT_EXAM_SIZE;
+    uint64_t rng = (seed != 0U) ? seed : ((uint64_t)time(NULL) ^ 0x9E3779B97F4A7C15ULL);
+    if (rng == 0U) {
+        rng = 0x9E3779B97F4A7C15ULL;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    if (db_card_prepare_select_exam_pool(planner->database, &stmt) != SQLITE_OK) {
+        return false;
+    }
+
+    PlannerBacklogEntry *heap = (PlannerBacklogEntry *)calloc(capacity, sizeof(PlannerBacklogEntry));
+    if (heap == NULL) {
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    size_t kept = 0U;
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *topic_uuid = (const char *)sqlite3_column_text(stmt, 5);
+        const sqlite3_int64 topic_cards = sqlite3_column_int64(stmt, 6);
+        const double topic_weight = planner_topic_weight(planner, topic_uuid);
+
+        /*
+         * Efraimidis-Spirakis: keep the largest log(u) / w. Spreading a topic's
+         * weight over its cards makes the topic, not the card, the sampling unit.
+         */
+        const double card_weight = topic_weight / (double)((topic_cards > 0) ? topic_cards : 1);
+        const double u = ((double)(planner_exam_random(&rng) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+        PlannerBacklogEntry candidate;
+        candidate.score = log(u) / card_weight;
+        candidate.spec.card_id = (uint64_t)sqlite3_column_int64(stmt, 0);
+
+        if (kept == capacity && !planner_backlog_less(&heap[0], &candidate)) {
+            continue;
+        }
+
+        const size_t slot = (kept < capacity) ? kept : 0U;
+        PlannerBacklogEntry *entry = &heap[slot];
+        entry->score = candidate.score;
+        planner_spec_from_row(stmt, &planner->srs_config, &entry->spec, entry->topic_id);
+        entry->spec.topic.weight = topic_weight;
+
+        if (kept < capacity) {
+            kept++;
+            planner_backlog_sift_up(heap, slot);
+        } else {
+            planner_backlog_sift_down(heap, kept, 0U);
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_DONE) {
+        free(heap);
+        return false;
+    }
+    if (kept == 0U) {
+        free(heap);
+        return true;
+    }
+
+    /* Sampling keys are independent of card order, so sorting by them shuffles the paper. */
+    qsort(heap, kept, sizeof(PlannerBacklogEntry), planner_backlog_compare_desc);
+
+    out_plan->cards = (SessionCardSpec *)calloc(kept, sizeof(SessionCardSpec));
+    out_plan->topic_ids = calloc(kept, sizeof(*out_plan->topic_ids));
+    if (out_plan->cards == NULL || out_plan->topic_ids == NULL) {
+        free(heap);
+        planner_plan_release(out_plan);
+        return false;
+    }
+
+    for (size_t i = 0U; i < kept; ++i) {
+        out_plan->cards[i] = heap[i].spec;
+        memcpy(out_plan->topic_ids[i], heap[i].topic_id, HR_PLANNER_MAX_TOPIC_ID);
+        if (out_plan->cards[i].has_topic) {
+            out_plan->cards[i].topic.topic_id = out_plan->topic_ids[i];
+        }
+        if (out_plan->cards[i].has_persisted_state) {
+            out_plan->review_count++;
+        } else {
+            out_plan->new_count++;
+        }
+    }
+    free(heap);
+
+    out_plan->count = kept;
+    return true;
+}
+
+void planner_plan_release(HrPlannerPlan *plan)
+{
+    if (plan == NULL) {
+        return;
+    }
+
+    free(plan->cards);
+    free(plan->topic_ids);
+    memset(plan, 0, sizeof(*plan));
+}
+
+static bool planner_lane_fill(struct HrPlannerCursor *cursor, PlannerCursorLane *lane, size_t want)
+{
+    if (lane->exhausted || lane->quota_left == 0U) {
+        lane->exhausted = true;
+        return false;
+    }
+    if (want > lane->quota_left) {
+        want = lane->quota_left;
+    }
+    if (want > (size_t)INT_MAX) {
+        want = (size_t)INT_MAX;
+    }
+
+    if (lane->page_capacity < want) {
+        SessionCardSpec *page = (SessionCardSpec *)realloc(lane->page, want * sizeof(SessionCardSpec));
+        if (page == NULL) {
+            return false;
+        }
+        lane->page = page;
+        char (*topics)[HR_PLANNER_MAX_TOPIC_ID] = realloc(lane->topics, want * sizeof(*topics));
+        if (topics == NULL) {
+            return false;
+        }
+        lane->topics = topics;
+        PlannerRowKey *keys = (PlannerRowKey *)realloc(lane->keys, want * sizeof(PlannerRowKey));
+        if (keys == NULL) {
+            return false;
+        }
+        lane->keys = keys;
+        lane->page_capacity = want;
+    }
+
+    if (lane->stmt == NULL) {
+        DatabaseHandle *database = cursor->planner->database;
+        const int rc = lane->new_cards ? db_card_prepare_select_new_page(database, &lane->stmt)
+                                       : db_card_prepare_select_scheduled_page(database, &lane->stmt);
+        if (rc != SQLITE_OK) {
+            lane->stmt = NULL;
+            lane->exhausted = true;
+            return false;
+        }
+    } else {
+        sqlite3_reset(lane->stmt);
+    }
+
+    HrCardPageQuery query = {
+        .latest_due_at = (sqlite3_int64)cursor->now,
+        .after_due_at = lane->after_due_at,
+        .after_id = lane->after_id,
+        .limit = (int)want,
+    };
+
+    lane->page_count = 0U;
+    lane->page_index = 0U;
+    if (db_card_bind_select_page(lane->stmt, &query) == SQLITE_OK) {
+        while (lane->page_count < want && sqlite3_step(lane->stmt) == SQLITE_ROW) {
+            lane->after_id = sqlite3_column_int64(lane->stmt, 0);
+            lane->after_due_at = sqlite3_column_int64(lane->stmt, 1);
+            lane->keys[lane->page_count].id = lane->after_id;
+            lane->keys[lane->page_count].due_at = lane->after_due_at;
+            planner_spec_from_row(lane->stmt, &cursor->planner->srs_config,
+                                  &lane->page[lane->page_count], lane->topics[lane->page_count]);
+            lane->page_count++;
+        }
+    }
+
+    if (lane->page_count < want) {
+        lane->exhausted = true;
+    }
+    return lane->page_count > 0U;
+}
+
+static bool planner_lane_ready(struct HrPlannerCursor *cursor, PlannerCursorLane *lane, size_t want)
+{
+    if (lane->page_index < lane->page_count) {
+        return true;
+    }
+    return planner_lane_fill(cursor, lane, want);
+}
+
+static void planner_lane_release(PlannerCursorLane *lane)
+{
+    if (lane->stmt != NULL) {
+        sqlite3_finalize(lane->stmt);
+    }
+    free(lane->page);
+    free(lane->topics);
+    free(lane->keys);
+    memset(lane, 0, sizeof(*lane));
+}
+
+struct HrPlannerCursor *planner_cursor_open(struct HrStudyPlanner *planner, time_t now, size_t max_cards)
+{
+    if (planner == NULL) {
+        return NULL;
+    }
+    if (now <= 0) {
+        now = time(NULL);
+    }
+
+    struct HrPlannerCursor *cursor = (struct HrPlannerCursor *)calloc(1, sizeof(*cursor));
+    if (cursor == NULL) {
+        return NULL;
+    }
+
+    const HrPlannerDailyCounters *counters = planner_counters(planner, now);
+    cursor->planner = planner;
+    cursor->now = now;
+    cursor->remaining = (max_cards > 0U) ? max_cards : SIZE_MAX;
+    cursor->reviews.quota_left = planner_remaining(planner->quota.daily_review_limit, counters->reviews_done);
+    cursor->fresh.quota_left = planner_remaining(planner->quota.daily_new_cards, counters->new_reviewed);
+    cursor->fresh.new_cards = true;
+    return cursor;
+}
+
+void planner_cursor_close(struct HrPlannerCursor *cursor)
+{
+    if (cursor == NULL) {
+        return;
+    }
+
+    planner_lane_release(&cursor->reviews);
+    planner_lane_release(&cursor->fresh);
+    free(cursor->out_topics);
+    free(cursor);
+}
+
+size_t planner_cursor_fetch(void *user_data, SessionCardSpec *out_cards, size_t capacity)
+{
+    struct HrPlannerCursor *cursor = (struct HrPlannerCursor *)user_data;
+    if (cursor == NULL || out_cards == NULL || capacity == 0U) {
+        return 0U;
+    }
+
+    if (cursor->out_capacity < capacity) {
+        char (*topics)[HR_PLANNER_MAX_TOPIC_ID] = realloc(cursor->out_topics, capacity * sizeof(*topics));
+        if (topics == NULL) {
+            return 0U;
+        }
+        cursor->out_topics = topics;
+        cursor->out_capacity = capacity;
+    }
+
+    /* Same interleave as planner_build(), carried across pages through since_new. */
+    const size_t ratio = (size_t)cursor->planner->reviews_per_new;
+    size_t produced = 0U;
+    while (produced < capacity && cursor->remaining > 0U) {
+        const bool has_review = planner_lane_ready(cursor, &cursor->reviews, capacity);
+        const bool has_new = planner_lane_ready(cursor, &cursor->fresh, capacity);
+        if (!has_review && !has_new) {
+            break;
+        }
+
+        const bool take_new = has_new && (!has_review || (ratio > 0U && cursor->since_new >= ratio));
+        PlannerCursorLane *lane = take_new ? &cursor->fresh : &cursor->reviews;
+        const size_t index = lane->page_index++;
+        lane->quota_left--;
+        lane->served_due_at = lane->keys[index].due_at;
+        lane->served_id = lane->keys[index].id;
+
+        SessionCardSpec *spec = &out_cards[produced];
+        *spec = lane->page[index];
+        if (spec->has_topic) {
+            memcpy(cursor->out_topics[produced], lane->topics[index], HR_PLANNER_MAX_TOPIC_ID);
+            spec->topic.topic_id = cursor->out_topics[produced];
+        }
+
+        if (take_new) {
+            cursor->since_new = 0U;
+            cursor->served_new++;
+        } else {
+            cursor->since_new++;
+            cursor->served_reviews++;
+        }
+        cursor->remaining--;
+        produced++;
+    }
+    return produced;
+}
+
+void planner_cursor_close_source(void *cursor)
+{
+    planner_cursor_close((struct HrPlannerCursor *)cursor);
+}
+
+static unsigned char *planner_put_u64(unsigned char *out, uint64_t value)
+{
+    for (unsigned int i = 0U; i < 8U; ++i) {
+        out[i] = (unsigned char)(value >> (8U * i));
+    }
+    return out + 8;
+}
+
+static uint64_t planner_get_u64(const unsigned char **in)
+{
+    uint64_t value = 0U;
+    for (unsigned int i = 0U; i < 8U; ++i) {
+        value |= (uint64_t)(*in)[i] << (8U * i);
+    }
+    *in += 8;
+    return value;
+}
+
+static unsigned char *planner_put_lane(unsigned char *out, const PlannerCursorLane *lane)
+{
+    /* Rows read but not yet handed out are read again, so only a drained lane counts as exhausted. */
+    *out++ = (unsigned char)(lane->exhausted && lane->page_index >= lane->page_count);
+    out = planner_put_u64(out, (uint64_t)lane->quota_left);
+    out = planner_put_u64(out, (uint64_t)lane->served_due_at);
+    return planner_put_u64(out, (uint64_t)lane->served_id);
+}
+
+static void planner_get_lane(const unsigned char **in, PlannerCursorLane *lane)
+{
+    lane->exhausted = (**in != 0U);
+    *in += 1;
+    const uint64_t quota_left = planner_get_u64(in);
+    lane->quota_left = (quota_left > (uint64_t)SIZE_MAX) ? SIZE_MAX : (size_t)quota_left;
+    lane->served_due_at = (sqlite3_int64)planner_get_u64(in);
+    lane->served_id = (sqlite3_int64)planner_get_u64(in);
+    lane->after_due_at = lane->served_due_at;
+    lane->after_id = lane->served_id;
+}
+
+size_t planner_cursor_save(void *user_data, void *out, size_t capacity)
+{
+    const struct HrPlannerCursor *cursor = (const struct HrPlannerCursor *)user_data;
+    if (cursor == NULL || out == NULL || capacity < HR_PLANNER_CURSOR_STATE_BYTES) {
+        return 0U;
+    }
+
+    unsigned char *at = (unsigned char *)out;
+    const uint32_t version = HR_PLANNER_CURSOR_STATE_VERSION;
+    for (unsigned int i = 0U; i < 4U; ++i) {
+        *at++ = (unsigned char)(version >> (8U * i));
+    }
+    at = planner_put_u64(at, (uint64_t)(int64_t)cursor->now);
+    at = planner_put_u64(at, (cursor->remaining == SIZE_MAX) ? UINT64_MAX : (uint64_t)cursor->remaining);
+    at = planner_put_u64(at, (uint64_t)cursor->since_new);
+    at = planner_put_u64(at, (uint64_t)cursor->served_reviews);
+    at = planner_put_u64(at, (uint64_t)cursor->served_new);
+    at = planner_put_lane(at, &cursor->reviews);
+    at = planner_put_lane(at, &cursor->fresh);
+    return (size_t)(at - (unsigned char *)out);
+}
+
+struct HrPlannerCursor *planner_cursor_restore(struct HrStudyPlanner *planner, const void *state, size_t size)
+{
+    if (planner == NULL || state == NULL || size != HR_PLANNER_CURSOR_STATE_BYTES) {
+        return NULL;
+    }
+
+    const unsigned char *in = (const unsigned char *)state;
+    uint32_t version = 0U;
+    for (unsigned int i = 0U; i < 4U; ++i) {
+        version |= (uint32_t)in[i] << (8U * i);
+    }
+    in += 4;
+    if (version != HR_PLANNER_CURSOR_STATE_VERSION) {
+        return NULL;
+    }
+
+    struct HrPlannerCursor *cursor = (struct HrPlannerCursor *)calloc(1, sizeof(*cursor));
+    if (cursor == NULL) {
+        return NULL;
+    }
+
+    cursor->planner = planner;
+    cursor->now = (time_t)(int64_t)planner_get_u64(&in);
+    const uint64_t remaining = planner_get_u64(&in);
+    cursor->remaining = (remaining > (uint64_t)SIZE_MAX) ? SIZE_MAX : (size_t)remaining;
+    cursor->since_new = (size_t)planner_get_u64(&in);
+    cursor->served_reviews = (size_t)planner_get_u64(&in);
+    cursor->served_new = (size_t)planner_get_u64(&in);
+    planner_get_lane(&in, &cursor->reviews);
+    planner_get_lane(&in, &cursor->fresh);
+    cursor->fresh.new_cards = true;
+    return cursor;
+}
+
+bool planner_cursor_deferred(struct HrPlannerCursor *cursor, size_t *out_reviews, size_t *out_new)
+{
+    if (cursor == NULL || out_reviews == NULL || out_new == NULL) {
+        return false;
+    }
+
+    size_t due_reviews = 0U;
+    size_t available_new = 0U;
+    if (!planner_count_due(cursor->planner, cursor->now, &due_reviews, &available_new)) {
+        return false;
+    }
+
+    /* Everything beyond what the quotas (and session cap) still let through waits for tomorrow. */
+    size_t review_room = cursor->served_reviews + cursor->reviews.quota_left;
+    size_t new_room = cursor->served_new + cursor->fresh.quota_left;
+    if (cursor->remaining != SIZE_MAX) {
+        const size_t cap = cursor->served_reviews + cursor->served_new + cursor->remaining;
+        review_room = (review_room < cap) ? review_room : cap;
+        new_room = (new_room < cap) ? new_room : cap;
+    }
+    *out_reviews = (due_reviews > review_room) ? (due_reviews - review_room) : 0U;
+    *out_new = (available_new > new_room) ? (available_new - new_room) : 0U;
+    return true;
+}
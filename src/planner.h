@@ -0,0 +1,174 @@
+#ifndef HYPERRECALL_PLANNER_H
+#define HYPERRECALL_PLANNER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file planner.h
+ * @brief Builds quota-aware study queues from the card and review tables.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "cfg.h"
+#include "db.h"
+#include "sessions.h"
+#include "srs.h"
+
+/** Default number of review cards served between two new cards. */
+#define HR_PLANNER_DEFAULT_REVIEWS_PER_NEW 4U
+
+/** Maximum length (including terminator) of topic identifiers copied into a plan. */
+#define HR_PLANNER_MAX_TOPIC_ID 64U
+
+/** Number of cards a backlog triage plan serves when no cap is supplied. */
+#define HR_PLANNER_DEFAULT_BACKLOG_SIZE 100U
+
+/** Number of cards on an exam paper when no size is supplied. */
+#define HR_PLANNER_DEFAULT_EXAM_SIZE 50U
+
+/** Returns the relative importance of a topic (1.0 = neutral). */
+typedef double (*HrPlannerTopicWeightFn)(const char *topic_id, void *user_data);
+
+/** Activity already completed on the current UTC day. */
+typedef struct HrPlannerDailyCounters {
+    time_t day_start;          /**< UTC midnight the counters belong to. */
+    unsigned int new_reviewed; /**< New cards introduced today. */
+    unsigned int reviews_done; /**< Review (previously seen) cards processed today. */
+} HrPlannerDailyCounters;
+
+/** Session queue produced by planner_build(). */
+typedef struct HrPlannerPlan {
+    SessionCardSpec *cards;                       /**< Interleaved queue, ready for session_manager_begin_ordered(). */
+    size_t count;                                 /**< Number of entries in @p cards. */
+    size_t new_count;                             /**< New cards included in the plan. */
+    size_t review_count;                          /**< Review cards included in the plan. */
+    size_t deferred_new;                          /**< New cards held back by today's quota. */
+    size_t deferred_reviews;                      /**< Due reviews spilled over to tomorrow's plan. */
+    char (*topic_ids)[HR_PLANNER_MAX_TOPIC_ID];   /**< Storage backing each card's topic identifier. */
+} HrPlannerPlan;
+
+struct HrStudyPlanner;
+struct HrPlannerCursor;
+
+/** Creates a planner reading from @p database using the supplied quotas. */
+struct HrStudyPlanner *planner_create(DatabaseHandle *database,
+                                      const HrSrsConfig *quota,
+                                      const SRSConfig *srs_config);
+
+/** Releases the planner. The database handle is not closed. */
+void planner_destroy(struct HrStudyPlanner *planner);
+
+/** Replaces the daily new/review quotas. */
+void planner_set_quota(struct HrStudyPlanner *planner, const HrSrsConfig *quota);
+
+/** Sets how many review cards are served before each new card (0 puts new cards last). */
+void planner_set_mix_ratio(struct HrStudyPlanner *planner, unsigned int reviews_per_new);
+
+/** Installs the lookup used to weight backlog cards by topic (NULL weighs every topic 1.0). */
+void planner_set_topic_weights(struct HrStudyPlanner *planner,
+                               HrPlannerTopicWeightFn weight_fn,
+                               void *user_data);
+
+/** Re-reads today's activity from the review log index. */
+bool planner_refresh_counters(struct HrStudyPlanner *planner, time_t now);
+
+/** Returns today's counters, rolling them over when @p now is on a new day. */
+const HrPlannerDailyCounters *planner_counters(struct HrStudyPlanner *planner, time_t now);
+
+/** Folds a completed review into the rolling daily counters. */
+void planner_record_review(struct HrStudyPlanner *planner, const SessionReviewEvent *event);
+
+/** Convenience wrapper matching the session_manager review callback signature. */
+void planner_record_session_event(const SessionReviewEvent *event, void *user_data);
+
+/**
+ * Builds today's remaining queue.
+ *
+ * Only as many rows as the remaining quotas allow (further capped by
+ * @p max_cards when non-zero) are read from the database; overflow is
+ * reported through the deferred counters and stays due for tomorrow.
+ */
+bool planner_build(struct HrStudyPlanner *planner,
+                   time_t now,
+                   size_t max_cards,
+                   HrPlannerPlan *out_plan);
+
+/**
+ * Builds a triage queue for an overdue backlog.
+ *
+ * Every overdue card is streamed from the database once and ranked by
+ * estimated recall probability (which already reflects how far past due it
+ * is) and topic weight; only the
+ * best @p max_cards (default HR_PLANNER_DEFAULT_BACKLOG_SIZE, and never more
+ * than today's remaining review quota) are kept in a bounded heap and served
+ * highest value first. The rest are reported as deferred reviews.
+ */
+bool planner_build_backlog(struct HrStudyPlanner *planner,
+                           time_t now,
+                           size_t max_cards,
+                           HrPlannerPlan *out_plan);
+
+/**
+ * Samples an exam paper of @p card_count cards (0 = HR_PLANNER_DEFAULT_EXAM_SIZE)
+ * from every unsuspended card.
+ *
+ * Each topic's share of the paper follows its topic weight rather than its
+ * size; cards within a topic are equally likely. The pool is streamed once
+ * through a bounded heap (weighted reservoir sampling), and the paper comes
+ * back in random order. @p seed makes the draw reproducible (0 = time based).
+ */
+bool planner_build_exam(struct HrStudyPlanner *planner,
+                        size_t card_count,
+                        uint64_t seed,
+                        HrPlannerPlan *out_plan);
+
+/** Releases memory owned by a plan produced by planner_build(). */
+void planner_plan_release(HrPlannerPlan *plan);
+
+/**
+ * Opens a streaming cursor over today's remaining queue.
+ *
+ * Opening does no database work; rows are read in keyset pages as the
+ * session asks for them, using the same quotas and new/review interleave as
+ * planner_build(). @p max_cards caps the session (0 = quotas only). The
+ * cursor must stay open until the session using it ends.
+ */
+struct HrPlannerCursor *planner_cursor_open(struct HrStudyPlanner *planner, time_t now, size_t max_cards);
+
+/** Closes a cursor returned by planner_cursor_open(). */
+void planner_cursor_close(struct HrPlannerCursor *cursor);
+
+/** session_source_fetch adapter; pass the cursor as the source user data. */
+size_t planner_cursor_fetch(void *cursor, SessionCardSpec *out_cards, size_t capacity);
+
+/** session_source_close adapter that closes the cursor when the session ends. */
+void planner_cursor_close_source(void *cursor);
+
+/**
+ * session_source_save adapter: writes the cursor's position (the keyset key
+ * of the last row served from each lane, its quotas and interleave state)
+ * and returns the bytes written, or 0 when @p capacity is too small.
+ */
+size_t planner_cursor_save(void *cursor, void *out, size_t capacity);
+
+/**
+ * Reopens a cursor saved by planner_cursor_save(). It carries on after the
+ * last card it served, keeping the original session's clock and quotas.
+ * Returns NULL when the state is not a saved cursor.
+ */
+struct HrPlannerCursor *planner_cursor_restore(struct HrStudyPlanner *planner, const void *state, size_t size);
+
+/** Counts due cards the cursor's quotas will leave for tomorrow. */
+bool planner_cursor_deferred(struct HrPlannerCursor *cursor, size_t *out_reviews, size_t *out_new);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_PLANNER_H */
@@ -13,6 +13,8 @@ extern "C" {
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "frame_profile.h"
+
 /**
  * @brief Describes the configuration required to initialize the platform layer.
  */
@@ -34,6 +36,7 @@ typedef struct HrPlatformFrame {
     int render_width;    /**< Width of the current render surface in pixels. */
     int render_height;   /**< Height of the current render surface in pixels. */
     bool resized;        /**< Indicates whether the window was resized this frame. */
+    uint64_t phase_micros[HR_FRAME_PHASE_COUNT]; /**< Time each profiled phase took on this thread over delta_time. */
 } HrPlatformFrame;
 
 struct PlatformHandle;
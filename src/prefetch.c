@@ -0,0 +1,514 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "prefetch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "span_trace.h"
+#include "sync.h"
+
+typedef enum PrefetchSlotState {
+    PREFETCH_SLOT_EMPTY = 0,
+    PREFETCH_SLOT_LOADING, /* Claimed by the worker, which is reading it without the lock. */
+    PREFETCH_SLOT_READY,
+    PREFETCH_SLOT_STALE,   /* Left the window; the worker frees it on its next pass. */
+} PrefetchSlotState;
+
+typedef struct PrefetchSlot {
+    PrefetchSlotState state;
+    bool loaded;
+    HrCardBody body;
+    HrMediaHandle handles[HR_PREFETCH_MAX_MEDIA];
+    size_t handle_count;
+} PrefetchSlot;
+
+struct HrPrefetcher {
+    DatabaseHandle *database;
+    struct HrMediaCache *media;
+    HrPrefetchMediaResolver resolver;
+    void *resolver_user_data;
+
+    size_t depth;
+    PrefetchSlot *slots; /* depth slots for the window plus depth awaiting release. */
+    size_t slot_count;
+    uint64_t *wanted;
+    size_t wanted_count;
+
+    HrMutex lock;
+    HrMutex media_lock;
+    HrCond wake;
+    HrThread worker;
+    bool worker_started;
+    bool stop;
+    bool pending;
+
+    HrPrefetchStats stats;
+};
+
+static char *prefetch_copy_text(const unsigned char *text)
+{
+    if (text == NULL) {
+        return NULL;
+    }
+
+    const size_t length = strlen((const char *)text);
+    char *copy = (char *)malloc(length + 1U);
+    if (copy != NULL) {
+        memcpy(copy, text, length + 1U);
+    }
+    return copy;
+}
+
+static bool prefetch_copy_body(const HrCardBody *source, HrCardBody *out_body)
+{
+    memset(out_body, 0, sizeof(*out_body));
+    out_body->card_id = source->card_id;
+    out_body->prompt = prefetch_copy_text((const unsigned char *)source->prompt);
+    out_body->response = prefetch_copy_text((const unsigned char *)source->response);
+    out_body->mnemonic = prefetch_copy_text((const unsigned char *)source->mnemonic);
+    if ((source->prompt != NULL && out_body->prompt == NULL) ||
+        (source->response != NULL && out_body->response == NULL) ||
+        (source->mnemonic != NULL && out_body->mnemonic == NULL)) {
+        prefetcher_body_release(out_body);
+        return false;
+    }
+    return true;
+}
+
+static bool prefetch_read_body(sqlite3_stmt *stmt, uint64_t card_id, HrCardBody *out_body)
+{
+    memset(out_body, 0, sizeof(*out_body));
+    out_body->card_id = card_id;
+
+    sqlite3_reset(stmt);
+    if (db_card_bind_select_body(stmt, (sqlite3_int64)card_id) != SQLITE_OK ||
+        sqlite3_step(stmt) != SQLITE_ROW) {
+        return false;
+    }
+
+    out_body->prompt = prefetch_copy_text(sqlite3_column_text(stmt, 0));
+    out_body->response = prefetch_copy_text(sqlite3_column_text(stmt, 1));
+    out_body->mnemonic = prefetch_copy_text(sqlite3_column_text(stmt, 2));
+    sqlite3_reset(stmt);
+    return out_body->prompt != NULL && out_body->response != NULL;
+}
+
+static bool prefetch_acquire_media(struct HrMediaCache *cache,
+                                   const HrPrefetchMedia *media,
+                                   HrMediaHandle *out_handle)
+{
+    const HrMediaSource source = {
+        .uuid = media->uuid,
+        .path = (media->path[0] != '\0') ? media->path : NULL,
+        .logical_type = media->logical_type,
+    };
+
+    switch (media->kind) {
+    case HR_MEDIA_RESOURCE_TEXTURE: {
+        HrMediaTextureView view;
+        if (!media_cache_acquire_texture(cache, &source, &view)) {
+            return false;
+        }
+        *out_handle = view.handle;
+        return true;
+    }
+    case HR_MEDIA_RESOURCE_AUDIO: {
+        HrMediaSoundView view;
+        if (!media_cache_acquire_audio(cache, &source, &view)) {
+            return false;
+        }
+        *out_handle = view.handle;
+        return true;
+    }
+    case HR_MEDIA_RESOURCE_THUMBNAIL: {
+        HrMediaImageView view;
+        if (!media_cache_acquire_thumbnail(cache, &source, media->max_dimension, &view)) {
+            return false;
+        }
+        *out_handle = view.handle;
+        return true;
+    }
+    case HR_MEDIA_RESOURCE_OCCLUSION_MASK: {
+        HrMediaImageView view;
+        if (!media_cache_acquire_occlusion_mask(cache, &source, &view)) {
+            return false;
+        }
+        *out_handle = view.handle;
+        return true;
+    }
+    }
+    return false;
+}
+
+static void prefetch_release_media(struct HrPrefetcher *prefetcher,
+                                   const HrMediaHandle *handles,
+                                   size_t count)
+{
+    if (prefetcher->media == NULL || count == 0U) {
+        return;
+    }
+
+    hr_mutex_lock(&prefetcher->media_lock);
+    for (size_t i = 0; i < count; ++i) {
+        media_cache_release(prefetcher->media, handles[i]);
+    }
+    hr_mutex_unlock(&prefetcher->media_lock);
+}
+
+static PrefetchSlot *prefetch_find_slot(struct HrPrefetcher *prefetcher, uint64_t card_id)
+{
+    for (size_t i = 0; i < prefetcher->slot_count; ++i) {
+        PrefetchSlot *slot = &prefetcher->slots[i];
+        if (slot->state != PREFETCH_SLOT_EMPTY && slot->state != PREFETCH_SLOT_STALE &&
+            slot->body.card_id == card_id) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static bool prefetch_is_wanted(const struct HrPrefetcher *prefetcher, uint64_t card_id)
+{
+    for (size_t i = 0; i < prefetcher->wanted_count; ++i) {
+        if (prefetcher->wanted[i] == card_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Frees one stale slot outside the lock. Returns false when none are left. */
+static bool prefetch_reclaim_one(struct HrPrefetcher *prefetcher)
+{
+    for (size_t i = 0; i < prefetcher->slot_count; ++i) {
+        PrefetchSlot *slot = &prefetcher->slots[i];
+        if (slot->state != PREFETCH_SLOT_STALE) {
+            continue;
+        }
+
+        PrefetchSlot released = *slot;
+        memset(slot, 0, sizeof(*slot));
+        hr_mutex_unlock(&prefetcher->lock);
+
+        prefetcher_body_release(&released.body);
+        prefetch_release_media(prefetcher, released.handles, released.handle_count);
+
+        hr_mutex_lock(&prefetcher->lock);
+        return true;
+    }
+    return false;
+}
+
+/* Loads the nearest wanted card that has no slot yet. Returns false when nothing is left to do. */
+static bool prefetch_load_one(struct HrPrefetcher *prefetcher, sqlite3_stmt *stmt)
+{
+    PrefetchSlot *slot = NULL;
+    uint64_t card_id = 0U;
+    for (size_t i = 0; i < prefetcher->wanted_count && slot == NULL; ++i) {
+        if (prefetch_find_slot(prefetcher, prefetcher->wanted[i]) != NULL) {
+            continue;
+        }
+        for (size_t j = 0; j < prefetcher->slot_count; ++j) {
+            if (prefetcher->slots[j].state == PREFETCH_SLOT_EMPTY) {
+                slot = &prefetcher->slots[j];
+                card_id = prefetcher->wanted[i];
+                break;
+            }
+        }
+        if (slot == NULL) {
+            /* Every slot is busy; wait for stale ones to be reclaimed. */
+            return false;
+        }
+    }
+    if (slot == NULL) {
+        return false;
+    }
+
+    slot->state = PREFETCH_SLOT_LOADING;
+    slot->body.card_id = card_id;
+    HrPrefetchMediaResolver resolver = prefetcher->resolver;
+    void *resolver_user_data = prefetcher->resolver_user_data;
+    hr_mutex_unlock(&prefetcher->lock);
+
+    HrCardBody body;
+    memset(&body, 0, sizeof(body));
+    const bool loaded = (stmt != NULL) && prefetch_read_body(stmt, card_id, &body);
+
+    HrPrefetchMedia media[HR_PREFETCH_MAX_MEDIA];
+    HrMediaHandle handles[HR_PREFETCH_MAX_MEDIA];
+    size_t media_count = 0U;
+    size_t handle_count = 0U;
+    size_t media_failed = 0U;
+    if (loaded && resolver != NULL && prefetcher->media != NULL) {
+        memset(media, 0, sizeof(media));
+        media_count = resolver(card_id, media, HR_PREFETCH_MAX_MEDIA, resolver_user_data);
+        if (media_count > HR_PREFETCH_MAX_MEDIA) {
+            media_count = HR_PREFETCH_MAX_MEDIA;
+        }
+
+        hr_mutex_lock(&prefetcher->media_lock);
+        for (size_t i = 0; i < media_count; ++i) {
+            if (prefetch_acquire_media(prefetcher->media, &media[i], &handles[handle_count])) {
+                handle_count++;
+            } else {
+                media_failed++;
+            }
+        }
+        hr_mutex_unlock(&prefetcher->media_lock);
+    }
+
+    hr_mutex_lock(&prefetcher->lock);
+    prefetcher->stats.media_warmed += handle_count;
+    prefetcher->stats.media_failed += media_failed;
+    if (loaded) {
+        prefetcher->stats.bodies_loaded++;
+        slot->body = body;
+    } else {
+        prefetcher_body_release(&body);
+        slot->body.card_id = card_id;
+    }
+    memcpy(slot->handles, handles, handle_count * sizeof(HrMediaHandle));
+    slot->handle_count = handle_count;
+    slot->loaded = loaded;
+
+    /*
+     * The window may have moved on while the lock was dropped. Failed loads stay
+     * READY without a body so they are not retried; lookups fall back to the caller.
+     */
+    if (slot->state == PREFETCH_SLOT_STALE) {
+        prefetcher->pending = true;
+    } else {
+        slot->state = PREFETCH_SLOT_READY;
+    }
+    return true;
+}
+
+static void prefetch_worker(void *user_data)
+{
+    struct HrPrefetcher *prefetcher = (struct HrPrefetcher *)user_data;
+
+    span_trace_name_thread("prefetch");
+    sqlite3_stmt *stmt = NULL;
+    if (db_card_prepare_select_body(prefetcher->database, &stmt) != SQLITE_OK) {
+        stmt = NULL;
+    }
+
+    hr_mutex_lock(&prefetcher->lock);
+    while (!prefetcher->stop) {
+        if (!prefetcher->pending) {
+            hr_cond_wait(&prefetcher->wake, &prefetcher->lock);
+            continue;
+        }
+        prefetcher->pending = false;
+
+        while (!prefetcher->stop && prefetch_reclaim_one(prefetcher)) {
+        }
+        /* Nearest card first; a new schedule restarts the pass from the top. */
+        while (!prefetcher->stop && !prefetcher->pending && prefetch_load_one(prefetcher, stmt)) {
+        }
+    }
+    hr_mutex_unlock(&prefetcher->lock);
+
+    if (stmt != NULL) {
+        sqlite3_finalize(stmt);
+    }
+}
+
+struct HrPrefetcher *prefetcher_create(DatabaseHandle *database,
+                                       struct HrMediaCache *media,
+                                       size_t depth)
+{
+    if (database == NULL) {
+        return NULL;
+    }
+
+    struct HrPrefetcher *prefetcher = (struct HrPrefetcher *)calloc(1U, sizeof(*prefetcher));
+    if (prefetcher == NULL) {
+        return NULL;
+    }
+
+    prefetcher->database = database;
+    prefetcher->media = media;
+    prefetcher->depth = (depth > 0U) ? depth : HR_PREFETCH_DEFAULT_DEPTH;
+    prefetcher->slot_count = prefetcher->depth * 2U;
+    prefetcher->slots = (PrefetchSlot *)calloc(prefetcher->slot_count, sizeof(PrefetchSlot));
+    prefetcher->wanted = (uint64_t *)calloc(prefetcher->depth, sizeof(uint64_t));
+    if (prefetcher->slots == NULL || prefetcher->wanted == NULL) {
+        free(prefetcher->slots);
+        free(prefetcher->wanted);
+        free(prefetcher);
+        return NULL;
+    }
+
+    const bool lock_ready = hr_mutex_init(&prefetcher->lock);
+    const bool media_lock_ready = hr_mutex_init(&prefetcher->media_lock);
+    const bool wake_ready = hr_cond_init(&prefetcher->wake);
+    if (lock_ready && media_lock_ready && wake_ready) {
+        prefetcher->worker_started = hr_thread_start(&prefetcher->worker, prefetch_worker, prefetcher);
+    }
+
+    if (!prefetcher->worker_started) {
+        if (lock_ready) {
+            hr_mutex_destroy(&prefetcher->lock);
+        }
+        if (media_lock_ready) {
+            hr_mutex_destroy(&prefetcher->media_lock);
+        }
+        if (wake_ready) {
+            hr_cond_destroy(&prefetcher->wake);
+        }
+        free(prefetcher->slots);
+        free(prefetcher->wanted);
+        free(prefetcher);
+        return NULL;
+    }
+
+    return prefetcher;
+}
+
+void prefetcher_destroy(struct HrPrefetcher *prefetcher)
+{
+    if (prefetcher == NULL) {
+        return;
+    }
+
+    hr_mutex_lock(&prefetcher->lock);
+    prefetcher->stop = true;
+    hr_cond_signal(&prefetcher->wake);
+    hr_mutex_unlock(&prefetcher->lock);
+    hr_thread_join(&prefetcher->worker);
+
+    for (size_t i = 0; i < prefetcher->slot_count; ++i) {
+        PrefetchSlot *slot = &prefetcher->slots[i];
+        prefetcher_body_release(&slot->body);
+        prefetch_release_media(prefetcher, slot->handles, slot->handle_count);
+    }
+
+    hr_cond_destroy(&prefetcher->wake);
+    hr_mutex_destroy(&prefetcher->media_lock);
+    hr_mutex_destroy(&prefetcher->lock);
+    free(prefetcher->slots);
+    free(prefetcher->wanted);
+    free(prefetcher);
+}
+
+void prefetcher_set_media_resolver(struct HrPrefetcher *prefetcher,
+                                   HrPrefetchMediaResolver resolver,
+                                   void *user_data)
+{
+    if (prefetcher == NULL) {
+        return;
+    }
+
+    hr_mutex_lock(&prefetcher->lock);
+    prefetcher->resolver = resolver;
+    prefetcher->resolver_user_data = user_data;
+    hr_mutex_unlock(&prefetcher->lock);
+}
+
+void prefetcher_schedule(struct HrPrefetcher *prefetcher, const uint64_t *card_ids, size_t count)
+{
+    if (prefetcher == NULL) {
+        return;
+    }
+    if (card_ids == NULL) {
+        count = 0U;
+    }
+    if (count > prefetcher->depth) {
+        count = prefetcher->depth;
+    }
+
+    hr_mutex_lock(&prefetcher->lock);
+    if (count > 0U) {
+        memcpy(prefetcher->wanted, card_ids, count * sizeof(uint64_t));
+    }
+    prefetcher->wanted_count = count;
+
+    for (size_t i = 0; i < prefetcher->slot_count; ++i) {
+        PrefetchSlot *slot = &prefetcher->slots[i];
+        const bool wanted = prefetch_is_wanted(prefetcher, slot->body.card_id);
+        if ((slot->state == PREFETCH_SLOT_READY || slot->state == PREFETCH_SLOT_LOADING) && !wanted) {
+            slot->state = PREFETCH_SLOT_STALE;
+        } else if (slot->state == PREFETCH_SLOT_STALE && slot->loaded && wanted &&
+                   prefetch_find_slot(prefetcher, slot->body.card_id) == NULL) {
+            /* Back in the window before the worker got to it (e.g. a card graded Again). */
+            slot->state = PREFETCH_SLOT_READY;
+        }
+    }
+
+    prefetcher->pending = true;
+    hr_cond_signal(&prefetcher->wake);
+    hr_mutex_unlock(&prefetcher->lock);
+}
+
+bool prefetcher_get_body(struct HrPrefetcher *prefetcher, uint64_t card_id, HrCardBody *out_body)
+{
+    if (prefetcher == NULL || out_body == NULL) {
+        return false;
+    }
+
+    hr_mutex_lock(&prefetcher->lock);
+    const PrefetchSlot *slot = prefetch_find_slot(prefetcher, card_id);
+    if (slot != NULL && slot->state == PREFETCH_SLOT_READY && slot->loaded) {
+        const bool copied = prefetch_copy_body(&slot->body, out_body);
+        prefetcher->stats.hits++;
+        hr_mutex_unlock(&prefetcher->lock);
+        return copied;
+    }
+    prefetcher->stats.misses++;
+    hr_mutex_unlock(&prefetcher->lock);
+
+    /* Not warm yet: read it here rather than wait for the worker. */
+    sqlite3_stmt *stmt = NULL;
+    if (db_card_prepare_select_body(prefetcher->database, &stmt) != SQLITE_OK) {
+        return false;
+    }
+    const bool loaded = prefetch_read_body(stmt, card_id, out_body);
+    sqlite3_finalize(stmt);
+    if (!loaded) {
+        prefetcher_body_release(out_body);
+    }
+    return loaded;
+}
+
+void prefetcher_body_release(HrCardBody *body)
+{
+    if (body == NULL) {
+        return;
+    }
+
+    free(body->prompt);
+    free(body->response);
+    free(body->mnemonic);
+    body->prompt = NULL;
+    body->response = NULL;
+    body->mnemonic = NULL;
+}
+
+void prefetcher_lock_media(struct HrPrefetcher *prefetcher)
+{
+    if (prefetcher != NULL) {
+        hr_mutex_lock(&prefetcher->media_lock);
+    }
+}
+
+void prefetcher_unlock_media(struct HrPrefetcher *prefetcher)
+{
+    if (prefetcher != NULL) {
+        hr_mutex_unlock(&prefetcher->media_lock);
+    }
+}
+
+void prefetcher_get_stats(struct HrPrefetcher *prefetcher, HrPrefetchStats *out_stats)
+{
+    if (prefetcher == NULL || out_stats == NULL) {
+        return;
+    }
+
+    hr_mutex_lock(&prefetcher->lock);
+    *out_stats = prefetcher->stats;
+    hr_mutex_unlock(&prefetcher->lock);
+}
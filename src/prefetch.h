@@ -0,0 +1,113 @@
+#ifndef HYPERRECALL_PREFETCH_H
+#define HYPERRECALL_PREFETCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file prefetch.h
+ * @brief Look-ahead loader that warms card bodies and media for upcoming session cards.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "db.h"
+#include "media.h"
+
+/** Number of upcoming cards kept warm when no depth is supplied. */
+#define HR_PREFETCH_DEFAULT_DEPTH 4U
+
+/** Maximum media resources warmed per card. */
+#define HR_PREFETCH_MAX_MEDIA 4U
+
+/** Media resource a card will need when it is displayed. */
+typedef struct HrPrefetchMedia {
+    HrMediaResourceKind kind;      /**< Which media_cache_acquire_* call warms it. */
+    HrMediaType logical_type;      /**< Logical type forwarded to the cache. */
+    char uuid[HR_MEDIA_MAX_UUID];  /**< Cache identifier. */
+    char path[HR_MEDIA_MAX_PATH];  /**< Source path on disk. */
+    int max_dimension;             /**< Thumbnail edge length (thumbnails only). */
+} HrPrefetchMedia;
+
+/**
+ * Lists the media a card needs. Runs on the prefetch worker; returns the
+ * number of entries written to @p out_media (at most @p capacity).
+ */
+typedef size_t (*HrPrefetchMediaResolver)(uint64_t card_id,
+                                          HrPrefetchMedia *out_media,
+                                          size_t capacity,
+                                          void *user_data);
+
+/** Text fields of a card, owned by the caller once returned. */
+typedef struct HrCardBody {
+    uint64_t card_id;
+    char *prompt;
+    char *response;
+    char *mnemonic; /**< NULL when the card has none. */
+} HrCardBody;
+
+/** Counters describing how well the look-ahead keeps up. */
+typedef struct HrPrefetchStats {
+    uint64_t hits;          /**< Bodies served from the warm window. */
+    uint64_t misses;        /**< Bodies loaded synchronously by the caller. */
+    uint64_t bodies_loaded; /**< Bodies read by the worker. */
+    uint64_t media_warmed;  /**< Media resources acquired by the worker. */
+    uint64_t media_failed;  /**< Media resources that failed to load. */
+} HrPrefetchStats;
+
+struct HrPrefetcher;
+
+/**
+ * Creates a prefetcher and starts its worker thread.
+ *
+ * The worker shares @p database (opened in serialized mode) and, when
+ * @p media is not NULL, warms resources in that cache. Up to @p depth cards
+ * are kept warm (0 uses HR_PREFETCH_DEFAULT_DEPTH).
+ */
+struct HrPrefetcher *prefetcher_create(DatabaseHandle *database,
+                                       struct HrMediaCache *media,
+                                       size_t depth);
+
+/** Stops the worker, releases warmed media and frees the prefetcher. */
+void prefetcher_destroy(struct HrPrefetcher *prefetcher);
+
+/** Installs the lookup that maps cards to their media (NULL warms bodies only). */
+void prefetcher_set_media_resolver(struct HrPrefetcher *prefetcher,
+                                   HrPrefetchMediaResolver resolver,
+                                   void *user_data);
+
+/**
+ * Replaces the look-ahead window with @p card_ids (nearest first). Cards that
+ * fall out of the window are released by the worker; returns immediately.
+ */
+void prefetcher_schedule(struct HrPrefetcher *prefetcher, const uint64_t *card_ids, size_t count);
+
+/**
+ * Copies the body of @p card_id into @p out_body, from the warm window when
+ * possible and otherwise by reading the database on the calling thread.
+ * Release the copy with prefetcher_body_release().
+ */
+bool prefetcher_get_body(struct HrPrefetcher *prefetcher, uint64_t card_id, HrCardBody *out_body);
+
+/** Frees strings returned by prefetcher_get_body(). */
+void prefetcher_body_release(HrCardBody *body);
+
+/**
+ * Serializes access to the shared media cache. Hold it around any
+ * media_cache_* call made while the prefetcher is running.
+ */
+void prefetcher_lock_media(struct HrPrefetcher *prefetcher);
+
+void prefetcher_unlock_media(struct HrPrefetcher *prefetcher);
+
+/** Copies the current counters. */
+void prefetcher_get_stats(struct HrPrefetcher *prefetcher, HrPrefetchStats *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_PREFETCH_H */
@@ -63,6 +63,33 @@ void AnalyticsScreenWidget::setupUI()
     streakLayout->addWidget(m_streakLabel);
     statsLayout->addWidget(streakBox);
     
+    // Keypress-to-next-card latency card
+    auto *latencyBox = new QGroupBox("Input Latency (p50 / p90 / p99)", this);
+    auto *latencyLayout = new QVBoxLayout(latencyBox);
+    m_latencyLabel = new QLabel(NO_DATA_PLACEHOLDER, latencyBox);
+    m_latencyLabel->setStyleSheet("font-size: 20pt; font-weight: bold; color: #9b59b6;");
+    m_latencyLabel->setAlignment(Qt::AlignCenter);
+    latencyLayout->addWidget(m_latencyLabel);
+    statsLayout->addWidget(latencyBox);
+    
+    // Learner response time card
+    auto *answerBox = new QGroupBox("Answer Time (p50 / p90 / p99)", this);
+    auto *answerLayout = new QVBoxLayout(answerBox);
+    m_answerTimeLabel = new QLabel(NO_DATA_PLACEHOLDER, answerBox);
+    m_answerTimeLabel->setStyleSheet("font-size: 20pt; font-weight: bold; color: #16a085;");
+    m_answerTimeLabel->setAlignment(Qt::AlignCenter);
+    answerLayout->addWidget(m_answerTimeLabel);
+    statsLayout->addWidget(answerBox);
+    
+    // Fitted forgetting curve: stability and predicted retention after a week
+    auto *forgettingBox = new QGroupBox("Memory Stability", this);
+    auto *forgettingLayout = new QVBoxLayout(forgettingBox);
+    m_forgettingLabel = new QLabel(NO_DATA_PLACEHOLDER, forgettingBox);
+    m_forgettingLabel->setStyleSheet("font-size: 20pt; font-weight: bold; color: #c0392b;");
+    m_forgettingLabel->setAlignment(Qt::AlignCenter);
+    forgettingLayout->addWidget(m_forgettingLabel);
+    statsLayout->addWidget(forgettingBox);
+    
     mainLayout->addLayout(statsLayout);
     
     // Chart placeholder
@@ -107,6 +134,17 @@ void AnalyticsScreenWidget::setupUI()
     
     activityLayout->addWidget(m_recentActivityTable);
     mainLayout->addWidget(activityBox);
+    
+    // Weakest topics, ranked on their whole subtree
+    auto *weakBox = new QGroupBox("Weakest Topics", this);
+    auto *weakLayout = new QVBoxLayout(weakBox);
+    
+    m_weakTopicsTable = new QTableWidget(0, 4, weakBox);
+    m_weakTopicsTable->setHorizontalHeaderLabels({"Topic", "Reviews", "Success", "Answer p90"});
+    m_weakTopicsTable->horizontalHeader()->setStretchLastSection(true);
+    m_weakTopicsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    weakLayout->addWidget(m_weakTopicsTable);
+    mainLayout->addWidget(weakBox);
 }
 
 void AnalyticsScreenWidget::setAnalytics(struct AnalyticsHandle *analytics)
@@ -127,6 +165,9 @@ void AnalyticsScreenWidget::refreshStats()
         m_totalReviewsLabel->setText("142");
         m_averageEaseLabel->setText("2.5");
         m_streakLabel->setText("7 days");
+        m_latencyLabel->setText(NO_DATA_PLACEHOLDER);
+        m_answerTimeLabel->setText(NO_DATA_PLACEHOLDER);
+        m_forgettingLabel->setText(NO_DATA_PLACEHOLDER);
         return;
     }
     
@@ -162,16 +203,60 @@ void AnalyticsScreenWidget::refreshStats()
         m_streakLabel->setText("0 days");
     }
     
+    const HrAnalyticsQuantiles &latency = dashboard->input_latency;
+    if (latency.samples > 0) {
+        m_latencyLabel->setText(QString("%1 / %2 / %3 ms")
+                                    .arg(latency.p50, 0, 'f', 1)
+                                    .arg(latency.p90, 0, 'f', 1)
+                                    .arg(latency.p99, 0, 'f', 1));
+    } else {
+        m_latencyLabel->setText(NO_DATA_PLACEHOLDER);
+    }
+    
+    const HrAnalyticsQuantiles &answer = dashboard->answer_time;
+    if (answer.samples > 0) {
+        m_answerTimeLabel->setText(QString("%1 / %2 / %3 s")
+                                       .arg(answer.p50 / 1000.0, 0, 'f', 1)
+                                       .arg(answer.p90 / 1000.0, 0, 'f', 1)
+                                       .arg(answer.p99 / 1000.0, 0, 'f', 1));
+    } else {
+        m_answerTimeLabel->setText(NO_DATA_PLACEHOLDER);
+    }
+    
+    const HrForgettingCurve &curve = dashboard->forgetting_curve;
+    if (curve.model != HR_FORGETTING_NONE) {
+        m_forgettingLabel->setText(QString("%1 d (%2% at 7 d)")
+                                       .arg(curve.stability_days, 0, 'f', 1)
+                                       .arg(forgetting_curve_retention(&curve, 7.0) * 100.0, 0, 'f', 0));
+        m_forgettingLabel->setToolTip(QString("%1 fit over %2 reviews, RMS error %3")
+                                          .arg(curve.model == HR_FORGETTING_POWER ? "Power-law" : "Exponential")
+                                          .arg(curve.samples)
+                                          .arg(curve.rmse, 0, 'f', 3));
+    } else {
+        m_forgettingLabel->setText(NO_DATA_PLACEHOLDER);
+        m_forgettingLabel->setToolTip(QString());
+    }
+    
     // Update recent activity table with heatmap data
     m_recentActivityTable->setRowCount(0);
     
-    // Show last 10 days from heatmap
-    size_t rows = dashboard->heatmap_count > 10 ? 10 : dashboard->heatmap_count;
+    // Show the last 10 active days, walking back from the newest day in the heatmap
+    const size_t maxRows = 10;
+    const HrAnalyticsHeatmapSample *recent[maxRows];
+    size_t rows = 0;
+    for (size_t age = 0; age < dashboard->heatmap_capacity && rows < maxRows && rows < dashboard->heatmap_count;
+         ++age) {
+        const time_t day = dashboard->heatmap_latest_day - static_cast<time_t>(age) * 86400;
+        const HrAnalyticsHeatmapSample *sample = analytics_heatmap_day(dashboard, day);
+        if (sample && sample->total_reviews > 0) {
+            recent[rows++] = sample;
+        }
+    }
     for (size_t i = 0; i < rows; i++) {
         int row = m_recentActivityTable->rowCount();
         m_recentActivityTable->insertRow(row);
         
-        const HrAnalyticsHeatmapSample *sample = &dashboard->heatmap[dashboard->heatmap_count - rows + i];
+        const HrAnalyticsHeatmapSample *sample = recent[rows - 1 - i];
         
         // Format date
         time_t day = sample->day_start_utc;
@@ -192,4 +277,21 @@ void AnalyticsScreenWidget::refreshStats()
         item->setFlags(item->flags() & ~Qt::ItemIsEnabled);
         m_recentActivityTable->setItem(0, 0, item);
     }
+    
+    // Topics with too few reviews to judge are left out of the ranking
+    const size_t minTopicReviews = 10;
+    HrAnalyticsTopicSummary weakest[5];
+    const size_t weakCount = analytics_weakest_topics(m_analytics, minTopicReviews, weakest, 5);
+    m_weakTopicsTable->setRowCount(static_cast<int>(weakCount));
+    for (size_t i = 0; i < weakCount; i++) {
+        const HrAnalyticsTopicSummary &topic = weakest[i];
+        const int row = static_cast<int>(i);
+        const QString name = QString::fromUtf8(topic.title[0] != '\0' ? topic.title : topic.topic_id);
+        m_weakTopicsTable->setItem(row, 0, new QTableWidgetItem(name));
+        m_weakTopicsTable->setItem(row, 1, new QTableWidgetItem(QString::number(topic.total_reviews)));
+        m_weakTopicsTable->setItem(row, 2, new QTableWidgetItem(QString("%1%").arg(topic.success_rate * 100.0, 0, 'f', 0)));
+        m_weakTopicsTable->setItem(row, 3, new QTableWidgetItem(topic.answer_time.samples > 0
+                                                                    ? QString("%1 s").arg(topic.answer_time.p90 / 1000.0, 0, 'f', 1)
+                                                                    : QString(NO_DATA_PLACEHOLDER)));
+    }
 }
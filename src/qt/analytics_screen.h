@@ -32,7 +32,11 @@ private:
     QLabel *m_totalReviewsLabel;
     QLabel *m_averageEaseLabel;
     QLabel *m_streakLabel;
+    QLabel *m_latencyLabel;
+    QLabel *m_answerTimeLabel;
+    QLabel *m_forgettingLabel;
     QTableWidget *m_recentActivityTable;
+    QTableWidget *m_weakTopicsTable;
     QWidget *m_chartPlaceholder;
 };
 
@@ -213,13 +213,26 @@ void MainWindow::processFrame()
     HrPlatformFrame frame_info = {};
     
     if (platform_begin_frame(m_app->platform, &frame_info)) {
-        // Update status bar with frame info
+        // Update status bar with the rolling frame-time percentiles and long-frame count
+        const HrAnalyticsDashboard *dashboard = m_app->analytics ? analytics_dashboard(m_app->analytics) : nullptr;
         if (m_statusLabel && frame_info.index % 60 == 0) {
-            m_statusLabel->setText(
-                tr("Frame: %1 | FPS: %2")
-                    .arg(frame_info.index)
-                    .arg(frame_info.delta_time > 0 ? 1.0 / frame_info.delta_time : 0, 0, 'f', 1)
-            );
+            if (dashboard && dashboard->frames.recent_frame_time.samples > 0) {
+                const HrAnalyticsFrameStats &frames = dashboard->frames;
+                const double p50 = frames.recent_frame_time.p50;
+                m_statusLabel->setText(
+                    tr("Frame: %1 | FPS: %2 | p99: %3 ms | Long frames: %4")
+                        .arg(frame_info.index)
+                        .arg(p50 > 0 ? 1000.0 / p50 : 0, 0, 'f', 1)
+                        .arg(frames.recent_frame_time.p99, 0, 'f', 1)
+                        .arg(frames.long_frames)
+                );
+            } else {
+                m_statusLabel->setText(
+                    tr("Frame: %1 | FPS: %2")
+                        .arg(frame_info.index)
+                        .arg(frame_info.delta_time > 0 ? 1.0 / frame_info.delta_time : 0, 0, 'f', 1)
+                );
+            }
         }
         
         // Let UI process the frame
@@ -232,6 +245,9 @@ void MainWindow::processFrame()
             analytics_record_frame(m_app->analytics, &frame_info);
         }
         
+        // Deliver queued review events and run the backup/checkpoint timers
+        app_update(m_app, frame_info.delta_time);
+        
         platform_end_frame(m_app->platform);
     } else {
         // Platform signaled close
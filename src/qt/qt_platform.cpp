@@ -56,6 +56,9 @@ bool QtPlatformHandle::beginFrame(HrPlatformFrame *out_frame)
     double deltaTime = (m_frameIndex == 1) ? 0.016 : (currentTime - m_previousTime);
     m_previousTime = currentTime;
 
+    // Phase totals are taken at the same point, so they cover the same interval as deltaTime.
+    frame_profile_collect(out_frame != nullptr ? out_frame->phase_micros : nullptr);
+
     if (out_frame != nullptr) {
         out_frame->index = m_frameIndex;
         out_frame->delta_time = deltaTime;
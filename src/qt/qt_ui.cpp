@@ -13,6 +13,8 @@
 #include <cstring>
 
 extern "C" {
+#include "../frame_profile.h"
+#include "../span_trace.h"
 #include "../ui.h"
 #include "../theme.h"
 }
@@ -23,6 +25,8 @@ QtUiContext::QtUiContext(const UiConfig *config, QWidget *parentWidget)
     , m_sessions(nullptr)
     , m_analytics(nullptr)
     , m_database(nullptr)
+    , m_planner(nullptr)
+    , m_prefetcher(nullptr)
     , m_importExport(nullptr)
     , m_enableDevtools(false)
     , m_currentScreen(UI_SCREEN_STUDY)
@@ -42,6 +46,9 @@ QtUiContext::QtUiContext(const UiConfig *config, QWidget *parentWidget)
     memset(&m_lastFrame, 0, sizeof(m_lastFrame));
     
     setupWidgets();
+    if (config != nullptr) {
+        m_studyScreen->setHotkeys(config->study_hotkeys);
+    }
     
     // Toast timer
     m_toastTimer = new QTimer(this);
@@ -57,6 +64,8 @@ QtUiContext::~QtUiContext()
     m_sessions = nullptr;
     m_analytics = nullptr;
     m_database = nullptr;
+    m_planner = nullptr;
+    m_prefetcher = nullptr;
     m_importExport = nullptr;
 }
 
@@ -107,6 +116,9 @@ void QtUiContext::attachSessionManager(struct SessionManager *sessions,
     if (callbacks != nullptr) {
         m_chainedCallbacks = *callbacks;
     }
+    if (m_sessions != nullptr) {
+        session_manager_set_callbacks(m_sessions, &m_chainedCallbacks);
+    }
     
     if (m_studyScreen) {
         m_studyScreen->setSessionManager(sessions);
@@ -120,6 +132,9 @@ void QtUiContext::attachAnalytics(struct AnalyticsHandle *analytics)
     if (m_analyticsScreen) {
         m_analyticsScreen->setAnalytics(analytics);
     }
+    if (m_studyScreen) {
+        m_studyScreen->setAnalytics(analytics);
+    }
 }
 
 void QtUiContext::attachDatabase(DatabaseHandle *database)
@@ -129,6 +144,27 @@ void QtUiContext::attachDatabase(DatabaseHandle *database)
     if (m_libraryScreen) {
         m_libraryScreen->setDatabase(database);
     }
+    if (m_studyScreen) {
+        m_studyScreen->setDatabase(database);
+    }
+}
+
+void QtUiContext::attachPlanner(struct HrStudyPlanner *planner)
+{
+    m_planner = planner;
+    
+    if (m_studyScreen) {
+        m_studyScreen->setPlanner(planner);
+    }
+}
+
+void QtUiContext::attachPrefetcher(struct HrPrefetcher *prefetcher)
+{
+    m_prefetcher = prefetcher;
+    
+    if (m_studyScreen) {
+        m_studyScreen->setPrefetcher(prefetcher);
+    }
 }
 
 void QtUiContext::attachImportExport(struct ImportExportContext *io_context)
@@ -347,6 +383,26 @@ void ui_attach_database(UiContext *ui, DatabaseHandle *database)
     qtUi->attachDatabase(database);
 }
 
+void ui_attach_planner(UiContext *ui, struct HrStudyPlanner *planner)
+{
+    if (ui == nullptr) {
+        return;
+    }
+    
+    auto *qtUi = reinterpret_cast<QtUiContext *>(ui);
+    qtUi->attachPlanner(planner);
+}
+
+void ui_attach_prefetcher(UiContext *ui, struct HrPrefetcher *prefetcher)
+{
+    if (ui == nullptr) {
+        return;
+    }
+    
+    auto *qtUi = reinterpret_cast<QtUiContext *>(ui);
+    qtUi->attachPrefetcher(prefetcher);
+}
+
 void ui_attach_import_export(UiContext *ui, struct ImportExportContext *io_context)
 {
     if (ui == nullptr) {
@@ -390,7 +446,12 @@ bool ui_process_frame(UiContext *ui, const HrPlatformFrame *frame)
     }
     
     auto *qtUi = reinterpret_cast<QtUiContext *>(ui);
-    return qtUi->processFrame(frame);
+    HR_SPAN_BEGIN(span, "ui.frame");
+    const uint64_t started = frame_profile_begin();
+    const bool ok = qtUi->processFrame(frame);
+    frame_profile_end(HR_FRAME_PHASE_RENDER, started);
+    HR_SPAN_END(span);
+    return ok;
 }
 
 void ui_toggle_command_palette(UiContext *ui)
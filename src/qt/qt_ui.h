@@ -43,6 +43,8 @@ public:
                               const SessionCallbacks *callbacks);
     void attachAnalytics(struct AnalyticsHandle *analytics);
     void attachDatabase(DatabaseHandle *database);
+    void attachPlanner(struct HrStudyPlanner *planner);
+    void attachPrefetcher(struct HrPrefetcher *prefetcher);
     void attachImportExport(struct ImportExportContext *io_context);
     void setFonts(const HrRenderFontSet *fonts, float base_font_size);
     
@@ -74,6 +76,8 @@ private:
     struct SessionManager *m_sessions;
     struct AnalyticsHandle *m_analytics;
     DatabaseHandle *m_database;
+    struct HrStudyPlanner *m_planner;
+    struct HrPrefetcher *m_prefetcher;
     struct ImportExportContext *m_importExport;
     SessionCallbacks m_chainedCallbacks;
     
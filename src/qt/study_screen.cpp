@@ -1,26 +1,75 @@
 #include "study_screen.h"
 
+#include <QCheckBox>
+#include <QEvent>
 #include <QLabel>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
+#include <QKeySequence>
+#include <QShortcut>
 #include <QTextEdit>
 #include <QStackedWidget>
 #include <QString>
+#include <QStringList>
+#include <cstring>
+#include <ctime>
 
 extern "C" {
 #include "../srs.h"
 }
 
+namespace {
+
+constexpr uint64_t kNoCard = UINT64_MAX;
+
+// Used when the configuration leaves an action unbound.
+const char *const kDefaultHotkeys[UI_STUDY_ACTION_COUNT] = {"Space", "1", "2", "3", "4"};
+
+} // namespace
+
 StudyScreenWidget::StudyScreenWidget(QWidget *parent)
     : QWidget(parent)
     , m_sessions(nullptr)
+    , m_planner(nullptr)
+    , m_cursor(nullptr)
+    , m_deferred(0)
+    , m_prefetcher(nullptr)
+    , m_database(nullptr)
+    , m_analytics(nullptr)
+    , m_exam(nullptr)
+    , m_examCarried(0)
+    , m_examShown(0)
+    , m_examReported(false)
+    , m_examResumeChecked(false)
+    , m_shownCardId(kNoCard)
+    , m_shownRemaining(0)
+    , m_rapidMode(false)
+    , m_revealed(true)
+    , m_latencyPending(false)
     , m_sessionActive(false)
 {
+    std::memset(&m_plan, 0, sizeof(m_plan));
+    std::memset(m_hotkeys, 0, sizeof(m_hotkeys));
     setupUI();
+    setHotkeys(nullptr);
     showWelcomeScreen();
 }
 
+StudyScreenWidget::~StudyScreenWidget()
+{
+    // An unfinished exam is picked up again on the next start, clock included.
+    if (m_exam && !exam_finished(m_exam)) {
+        storeExamCheckpoint();
+    }
+    if (m_sessions) {
+        session_manager_end(m_sessions);
+    }
+    planner_cursor_close(m_cursor);
+    planner_plan_release(&m_plan);
+    exam_destroy(m_exam);
+}
+
 void StudyScreenWidget::setupUI()
 {
     auto *mainLayout = new QVBoxLayout(this);
@@ -31,8 +80,8 @@ void StudyScreenWidget::setupUI()
     mainLayout->addWidget(m_statusLabel);
     
     // Create stacked widget for different states
-    auto *stackedWidget = new QStackedWidget(this);
-    mainLayout->addWidget(stackedWidget, 1);
+    m_stack = new QStackedWidget(this);
+    mainLayout->addWidget(m_stack, 1);
     
     // Welcome screen
     m_welcomeWidget = new QWidget(this);
@@ -63,8 +112,26 @@ void StudyScreenWidget::setupUI()
     connect(m_startCramBtn, &QPushButton::clicked, this, &StudyScreenWidget::onStartCramSession);
     welcomeLayout->addWidget(m_startCramBtn);
     
+    m_startBacklogBtn = new QPushButton("Catch Up on Backlog", m_welcomeWidget);
+    m_startBacklogBtn->setMinimumHeight(50);
+    m_startBacklogBtn->setStyleSheet("font-size: 14pt;");
+    m_startBacklogBtn->setToolTip("Review the overdue cards most worth saving first");
+    connect(m_startBacklogBtn, &QPushButton::clicked, this, &StudyScreenWidget::onStartBacklogSession);
+    welcomeLayout->addWidget(m_startBacklogBtn);
+    
+    m_startExamBtn = new QPushButton("Take Practice Exam", m_welcomeWidget);
+    m_startExamBtn->setMinimumHeight(50);
+    m_startExamBtn->setStyleSheet("font-size: 14pt;");
+    m_startExamBtn->setToolTip("Timed paper sampled by topic weight; does not affect your schedule");
+    connect(m_startExamBtn, &QPushButton::clicked, this, &StudyScreenWidget::onStartExam);
+    welcomeLayout->addWidget(m_startExamBtn);
+    
+    m_rapidCheck = new QCheckBox("Rapid review: keyboard only, reveal the answer before grading", m_welcomeWidget);
+    connect(m_rapidCheck, &QCheckBox::toggled, this, [this](bool checked) { m_rapidMode = checked; });
+    welcomeLayout->addWidget(m_rapidCheck, 0, Qt::AlignCenter);
+    
     welcomeLayout->addStretch();
-    stackedWidget->addWidget(m_welcomeWidget);
+    m_stack->addWidget(m_welcomeWidget);
     
     // Review screen
     m_reviewWidget = new QWidget(this);
@@ -74,8 +141,18 @@ void StudyScreenWidget::setupUI()
     m_cardDisplay->setReadOnly(true);
     m_cardDisplay->setStyleSheet("font-size: 16pt; padding: 20px;");
     m_cardDisplay->setPlainText("Card content will appear here...\n\nThis is a prototype card display.");
+    // Keys go to the study shortcuts, never to the text view.
+    m_cardDisplay->setFocusPolicy(Qt::NoFocus);
+    m_cardDisplay->viewport()->installEventFilter(this);
     reviewLayout->addWidget(m_cardDisplay, 1);
     
+    m_revealBtn = new QPushButton("Show Answer", m_reviewWidget);
+    m_revealBtn->setMinimumHeight(50);
+    m_revealBtn->setStyleSheet("font-size: 14pt;");
+    m_revealBtn->hide();
+    connect(m_revealBtn, &QPushButton::clicked, this, &StudyScreenWidget::onReveal);
+    reviewLayout->addWidget(m_revealBtn);
+    
     // Answer buttons
     auto *buttonLayout = new QHBoxLayout();
     
@@ -104,55 +181,79 @@ void StudyScreenWidget::setupUI()
     buttonLayout->addWidget(m_easyBtn);
     
     reviewLayout->addLayout(buttonLayout);
-    stackedWidget->addWidget(m_reviewWidget);
+    
+    // Undo/redo for mis-clicked grades
+    auto *historyLayout = new QHBoxLayout();
+    historyLayout->addStretch();
+    
+    m_undoBtn = new QPushButton("Undo", m_reviewWidget);
+    m_undoBtn->setToolTip("Revert the last grade (Ctrl+Z)");
+    m_undoBtn->setEnabled(false);
+    connect(m_undoBtn, &QPushButton::clicked, this, &StudyScreenWidget::onUndo);
+    historyLayout->addWidget(m_undoBtn);
+    
+    m_redoBtn = new QPushButton("Redo", m_reviewWidget);
+    m_redoBtn->setToolTip("Re-apply the grade that was undone (Ctrl+Shift+Z)");
+    m_redoBtn->setEnabled(false);
+    connect(m_redoBtn, &QPushButton::clicked, this, &StudyScreenWidget::onRedo);
+    historyLayout->addWidget(m_redoBtn);
+    
+    reviewLayout->addLayout(historyLayout);
+    m_stack->addWidget(m_reviewWidget);
+    
+    auto *undoShortcut = new QShortcut(QKeySequence::Undo, this);
+    connect(undoShortcut, &QShortcut::activated, this, &StudyScreenWidget::onUndo);
+    auto *redoShortcut = new QShortcut(QKeySequence::Redo, this);
+    connect(redoShortcut, &QShortcut::activated, this, &StudyScreenWidget::onRedo);
     
     // Complete screen
     m_completeWidget = new QWidget(this);
     auto *completeLayout = new QVBoxLayout(m_completeWidget);
     completeLayout->addStretch();
     
-    auto *completeLabel = new QLabel("Session Complete!", m_completeWidget);
-    completeLabel->setStyleSheet("font-size: 24pt; font-weight: bold;");
-    completeLabel->setAlignment(Qt::AlignCenter);
-    completeLayout->addWidget(completeLabel);
+    m_completeTitle = new QLabel("Session Complete!", m_completeWidget);
+    m_completeTitle->setStyleSheet("font-size: 24pt; font-weight: bold;");
+    m_completeTitle->setAlignment(Qt::AlignCenter);
+    completeLayout->addWidget(m_completeTitle);
     
-    auto *statsLabel = new QLabel("Great work! Check analytics for details.", m_completeWidget);
-    statsLabel->setStyleSheet("font-size: 14pt; color: gray;");
-    statsLabel->setAlignment(Qt::AlignCenter);
-    completeLayout->addWidget(statsLabel);
+    m_completeStats = new QLabel("Great work! Check analytics for details.", m_completeWidget);
+    m_completeStats->setStyleSheet("font-size: 14pt; color: gray;");
+    m_completeStats->setAlignment(Qt::AlignCenter);
+    completeLayout->addWidget(m_completeStats);
+    
+    m_leaveResultsBtn = new QPushButton("Done", m_completeWidget);
+    m_leaveResultsBtn->setMinimumHeight(40);
+    connect(m_leaveResultsBtn, &QPushButton::clicked, this, &StudyScreenWidget::onLeaveResults);
+    completeLayout->addWidget(m_leaveResultsBtn, 0, Qt::AlignCenter);
     
     completeLayout->addStretch();
-    stackedWidget->addWidget(m_completeWidget);
+    m_stack->addWidget(m_completeWidget);
 }
 
 void StudyScreenWidget::showWelcomeScreen()
 {
-    auto *stackedWidget = findChild<QStackedWidget*>();
-    if (stackedWidget) {
-        stackedWidget->setCurrentWidget(m_welcomeWidget);
-    }
+    m_stack->setCurrentWidget(m_welcomeWidget);
     m_statusLabel->setText("Ready to study");
     m_sessionActive = false;
+    m_shownCardId = kNoCard;
+    m_latencyPending = false;
 }
 
 void StudyScreenWidget::showCardReview()
 {
-    auto *stackedWidget = findChild<QStackedWidget*>();
-    if (stackedWidget) {
-        stackedWidget->setCurrentWidget(m_reviewWidget);
+    if (m_stack->currentWidget() != m_reviewWidget) {
+        m_stack->setCurrentWidget(m_reviewWidget);
     }
-    m_statusLabel->setText("Study Session Active - Card 1 of 10");
     m_sessionActive = true;
 }
 
 void StudyScreenWidget::showSessionComplete()
 {
-    auto *stackedWidget = findChild<QStackedWidget*>();
-    if (stackedWidget) {
-        stackedWidget->setCurrentWidget(m_completeWidget);
-    }
+    m_stack->setCurrentWidget(m_completeWidget);
     m_statusLabel->setText("Session completed!");
     m_sessionActive = false;
+    m_shownCardId = kNoCard;
+    m_latencyPending = false;
     emit sessionCompleted();
 }
 
@@ -161,36 +262,427 @@ void StudyScreenWidget::setSessionManager(struct SessionManager *sessions)
     m_sessions = sessions;
 }
 
+void StudyScreenWidget::setPlanner(struct HrStudyPlanner *planner)
+{
+    m_planner = planner;
+}
+
+void StudyScreenWidget::setPrefetcher(struct HrPrefetcher *prefetcher)
+{
+    m_prefetcher = prefetcher;
+}
+
+void StudyScreenWidget::setDatabase(DatabaseHandle *database)
+{
+    m_database = database;
+}
+
+void StudyScreenWidget::setAnalytics(struct AnalyticsHandle *analytics)
+{
+    m_analytics = analytics;
+}
+
+void StudyScreenWidget::setHotkeys(const char *const hotkeys[UI_STUDY_ACTION_COUNT])
+{
+    for (int i = 0; i < UI_STUDY_ACTION_COUNT; ++i) {
+        const char *binding = (hotkeys != nullptr && hotkeys[i] != nullptr && hotkeys[i][0] != '\0')
+                                  ? hotkeys[i]
+                                  : kDefaultHotkeys[i];
+        const QKeySequence sequence = QKeySequence::fromString(QString::fromUtf8(binding));
+        if (!m_hotkeys[i]) {
+            m_hotkeys[i] = new QShortcut(sequence, this);
+            m_hotkeys[i]->setContext(Qt::WidgetWithChildrenShortcut);
+            const auto action = static_cast<UiStudyAction>(i);
+            connect(m_hotkeys[i], &QShortcut::activated, this, [this, action]() { onHotkey(action); });
+        } else {
+            m_hotkeys[i]->setKey(sequence);
+        }
+    }
+    
+    const QString reveal = m_hotkeys[UI_STUDY_ACTION_REVEAL]->key().toString(QKeySequence::NativeText);
+    m_revealBtn->setText(QString("Show Answer (%1)").arg(reveal));
+    m_againBtn->setToolTip(m_hotkeys[UI_STUDY_ACTION_AGAIN]->key().toString(QKeySequence::NativeText));
+    m_hardBtn->setToolTip(m_hotkeys[UI_STUDY_ACTION_HARD]->key().toString(QKeySequence::NativeText));
+    m_goodBtn->setToolTip(m_hotkeys[UI_STUDY_ACTION_GOOD]->key().toString(QKeySequence::NativeText));
+    m_easyBtn->setToolTip(m_hotkeys[UI_STUDY_ACTION_EASY]->key().toString(QKeySequence::NativeText));
+}
+
+bool StudyScreenWidget::eventFilter(QObject *watched, QEvent *event)
+{
+    // The viewport paints the card that a grading keypress brought up; that closes the measurement.
+    if (m_latencyPending && event->type() == QEvent::Paint && watched == m_cardDisplay->viewport()) {
+        m_latencyPending = false;
+        if (m_analytics) {
+            analytics_record_input_latency(m_analytics, static_cast<uint64_t>(m_inputClock.nsecsElapsed() / 1000));
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void StudyScreenWidget::onHotkey(UiStudyAction action)
+{
+    if (!m_sessionActive) {
+        return;
+    }
+    
+    if (action == UI_STUDY_ACTION_REVEAL) {
+        onReveal();
+        return;
+    }
+    if (!m_revealed) {
+        return; // Rapid review grades only what the learner has seen.
+    }
+    
+    static const SRSReviewRating kRatings[UI_STUDY_ACTION_COUNT] = {
+        SRS_RESPONSE_FAIL, SRS_RESPONSE_FAIL, SRS_RESPONSE_HARD, SRS_RESPONSE_GOOD, SRS_RESPONSE_EASY};
+    m_inputClock.start();
+    m_latencyPending = true;
+    gradeCurrent(kRatings[action]);
+}
+
+void StudyScreenWidget::onReveal()
+{
+    if (m_sessionActive && !m_revealed) {
+        setRevealed(true);
+    }
+}
+
+void StudyScreenWidget::setRevealed(bool revealed)
+{
+    m_revealed = revealed;
+    m_revealBtn->setVisible(!revealed);
+    m_againBtn->setEnabled(revealed);
+    m_hardBtn->setEnabled(revealed);
+    m_goodBtn->setEnabled(revealed);
+    m_easyBtn->setEnabled(revealed);
+    renderCard();
+}
+
+void StudyScreenWidget::renderCard()
+{
+    QString text = m_shownPrompt;
+    if (m_revealed) {
+        if (!m_shownResponse.isEmpty()) {
+            text += "\n\n" + m_shownResponse;
+        }
+        text += "\n\n" + m_shownDetails;
+    }
+    m_cardDisplay->setPlainText(text);
+}
+
+void StudyScreenWidget::showCard(const SessionCard *card, size_t remaining)
+{
+    m_shownCardId = card->card_id;
+    m_shownRemaining = remaining;
+    
+    QString status = QString("Study Session Active - %1 cards remaining").arg(remaining);
+    if (m_deferred > 0) {
+        status += QString(" (%1 deferred by daily limits)").arg(m_deferred);
+    }
+    m_statusLabel->setText(status);
+    
+    // The body is normally already warm from the previous card's prefetch.
+    m_shownPrompt.clear();
+    m_shownResponse.clear();
+    HrCardBody body;
+    if (m_prefetcher && prefetcher_get_body(m_prefetcher, card->card_id, &body)) {
+        m_shownPrompt = QString::fromUtf8(body.prompt);
+        if (body.response) {
+            m_shownResponse = QString::fromUtf8(body.response);
+        }
+        prefetcher_body_release(&body);
+    }
+    m_shownDetails = QString("Card ID: %1\n\n"
+                             "Ease: %2\n"
+                             "Interval: %3 days\n"
+                             "Mode: %4")
+                         .arg(card->card_id)
+                         .arg(card->state.ease_factor, 0, 'f', 2)
+                         .arg(card->state.interval_days)
+                         .arg(card->state.mode == SRS_MODE_MASTERY ? "Mastery" : "Cram");
+    if (m_shownPrompt.isEmpty()) {
+        m_shownPrompt = QString("Card %1").arg(card->card_id);
+    }
+    
+    setRevealed(!m_rapidMode);
+    m_answerClock.start();
+    schedulePrefetch();
+}
+
+void StudyScreenWidget::schedulePrefetch()
+{
+    if (!m_prefetcher) {
+        return;
+    }
+    
+    // Warm the cards after the one on screen while the user is answering it.
+    uint64_t upcoming[HR_PREFETCH_DEFAULT_DEPTH + 1];
+    const size_t count = m_exam ? exam_peek(m_exam, upcoming, HR_PREFETCH_DEFAULT_DEPTH + 1)
+                                : session_manager_peek(m_sessions, upcoming, HR_PREFETCH_DEFAULT_DEPTH + 1);
+    if (count > 1) {
+        prefetcher_schedule(m_prefetcher, upcoming + 1, count - 1);
+    } else {
+        prefetcher_schedule(m_prefetcher, nullptr, 0);
+    }
+}
+
+bool StudyScreenWidget::startPlannedSession(SessionMode mode, bool backlog)
+{
+    if (!m_planner) {
+        return session_manager_begin(m_sessions, mode, nullptr, 0);
+    }
+    
+    // The previous session still borrows topic strings from the old plan or cursor.
+    session_manager_end(m_sessions);
+    planner_cursor_close(m_cursor);
+    m_cursor = nullptr;
+    planner_plan_release(&m_plan);
+    m_deferred = 0;
+    
+    const std::time_t now = std::time(nullptr);
+    if (backlog) {
+        // Triage has to rank every overdue card before serving the first one.
+        if (!planner_build_backlog(m_planner, now, 0, &m_plan)) {
+            return false;
+        }
+        m_deferred = m_plan.deferred_new + m_plan.deferred_reviews;
+        return session_manager_begin_ordered(m_sessions, mode, m_plan.cards, m_plan.count);
+    }
+    
+    // Regular sessions stream from the due index so the first card only waits for one page.
+    m_cursor = planner_cursor_open(m_planner, now, 0);
+    if (!m_cursor) {
+        return false;
+    }
+    
+    SessionCardSource source{};
+    source.fetch = planner_cursor_fetch;
+    source.user_data = m_cursor;
+    source.page_size = SESSION_DEFAULT_PAGE_SIZE;
+    // Checkpoints store the cursor position; the screen keeps ownership, so there is no close hook.
+    source.save = planner_cursor_save;
+    if (!session_manager_begin_stream(m_sessions, mode, &source)) {
+        return false;
+    }
+    
+    size_t deferredReviews = 0;
+    size_t deferredNew = 0;
+    if (planner_cursor_deferred(m_cursor, &deferredReviews, &deferredNew)) {
+        m_deferred = deferredReviews + deferredNew;
+    }
+    return true;
+}
+
+void StudyScreenWidget::updateExam()
+{
+    if (exam_finished(m_exam)) {
+        if (!m_examReported) {
+            if (m_prefetcher) {
+                prefetcher_schedule(m_prefetcher, nullptr, 0);
+            }
+            showExamReport();
+        }
+        return;
+    }
+    
+    HrExamQuestion question;
+    if (!exam_current(m_exam, &question)) {
+        return;
+    }
+    
+    if (question.position != m_examShown) {
+        // A new card is on screen; its answer time starts now.
+        m_examShown = question.position;
+        m_examClock.restart();
+        
+        m_shownPrompt.clear();
+        m_shownResponse.clear();
+        HrCardBody body;
+        if (m_prefetcher && prefetcher_get_body(m_prefetcher, question.card_id, &body)) {
+            m_shownPrompt = QString::fromUtf8(body.prompt);
+            if (body.response) {
+                m_shownResponse = QString::fromUtf8(body.response);
+            }
+            prefetcher_body_release(&body);
+        }
+        if (m_shownPrompt.isEmpty()) {
+            m_shownPrompt = QString("Card %1").arg(question.card_id);
+        }
+        m_shownDetails = QString("Card ID: %1\nTopic: %2")
+                             .arg(question.card_id)
+                             .arg(question.topic_id ? QString::fromUtf8(question.topic_id) : QString("(none)"));
+        
+        // The learner grades themselves against the answer, so it is always revealed first.
+        setRevealed(false);
+        schedulePrefetch();
+    }
+    
+    // The section clock only counts answer time, so the card on screen eats into it too.
+    const qint64 elapsed = examCardElapsed();
+    if (question.section_time_left_ms != HR_EXAM_UNTIMED &&
+        elapsed >= static_cast<qint64>(question.section_time_left_ms)) {
+        exam_expire_section(m_exam);
+        m_examCarried = 0;
+        storeExamCheckpoint();
+        updateExam();
+        return;
+    }
+    if (question.card_time_limit_ms != HR_EXAM_UNTIMED &&
+        elapsed >= static_cast<qint64>(question.card_time_limit_ms)) {
+        exam_expire_card(m_exam);
+        m_examCarried = 0;
+        storeExamCheckpoint();
+        updateExam();
+        return;
+    }
+    
+    QString status = QString("Practice Exam - Section %1 of %2 - Card %3 of %4")
+                         .arg(question.section + 1)
+                         .arg(question.section_count)
+                         .arg(question.position + 1)
+                         .arg(question.card_count);
+    if (question.section_time_left_ms != HR_EXAM_UNTIMED) {
+        const qint64 left = (static_cast<qint64>(question.section_time_left_ms) - elapsed) / 1000;
+        status += QString(" - %1:%2 left")
+                      .arg(left / 60)
+                      .arg(left % 60, 2, 10, QLatin1Char('0'));
+    }
+    m_statusLabel->setText(status);
+    
+    // Exam grades are final; there is no history to step through.
+    m_undoBtn->setEnabled(false);
+    m_redoBtn->setEnabled(false);
+    
+    showCardReview();
+}
+
+void StudyScreenWidget::answerExam(SRSReviewRating rating)
+{
+    const qint64 elapsed = examCardElapsed();
+    exam_answer(m_exam, rating, elapsed > 0 ? static_cast<uint32_t>(elapsed) : 0U);
+    m_examCarried = 0;
+    storeExamCheckpoint();
+    updateExam();
+}
+
+qint64 StudyScreenWidget::examCardElapsed() const
+{
+    return m_examClock.elapsed() + m_examCarried;
+}
+
+void StudyScreenWidget::storeExamCheckpoint()
+{
+    // A finished exam is stored by exam_save(), which also drops the checkpoint.
+    if (!m_database || !m_exam || exam_finished(m_exam)) {
+        return;
+    }
+    const qint64 elapsed = examCardElapsed();
+    const uint32_t cardElapsed = elapsed <= 0 ? 0U
+                                 : elapsed >= static_cast<qint64>(UINT32_MAX) ? UINT32_MAX
+                                                                             : static_cast<uint32_t>(elapsed);
+    exam_store_checkpoint(m_exam, cardElapsed, m_database);
+}
+
+void StudyScreenWidget::resumeExam()
+{
+    // A resumed study session wins; starting an exam ends any session anyway.
+    if (m_exam || (m_sessions && session_manager_current(m_sessions) != nullptr)) {
+        return;
+    }
+    
+    uint32_t cardElapsed = 0;
+    m_exam = exam_load_checkpoint(m_database, &cardElapsed);
+    if (!m_exam) {
+        return;
+    }
+    
+    m_examShown = static_cast<size_t>(-1);
+    m_examReported = false;
+    m_examCarried = static_cast<qint64>(cardElapsed);
+    m_examClock.start();
+}
+
+void StudyScreenWidget::showExamReport()
+{
+    m_examReported = true;
+    
+    HrExamReport report;
+    if (!exam_report(m_exam, &report)) {
+        m_completeTitle->setText("Exam Complete");
+        m_completeStats->setText("The exam report could not be computed.");
+        showSessionComplete();
+        return;
+    }
+    
+    const bool saved = m_database && exam_save(m_exam, m_database, nullptr);
+    
+    QStringList lines;
+    lines << QString("Score: %1 of %2 (%3%)")
+                 .arg(report.correct)
+                 .arg(report.card_count)
+                 .arg(report.score * 100.0, 0, 'f', 0);
+    if (report.timed_out > 0 || report.unanswered > 0) {
+        lines << QString("%1 over the card limit, %2 cut off by the section clock")
+                     .arg(report.timed_out)
+                     .arg(report.unanswered);
+    }
+    lines << QString("Readiness: %1% (at least %2%) - pass %3")
+                 .arg(report.readiness * 100.0, 0, 'f', 0)
+                 .arg(report.readiness_low * 100.0, 0, 'f', 0)
+                 .arg(report.pass_likely ? "likely" : "not yet likely");
+    lines << QString("Answer time: median %1 s, 90th percentile %2 s")
+                 .arg(report.median_latency_ms / 1000.0, 0, 'f', 1)
+                 .arg(report.p90_latency_ms / 1000.0, 0, 'f', 1);
+    for (size_t i = 0; i < report.topic_count; ++i) {
+        const HrExamTopicScore &topic = report.topics[i];
+        lines << QString("%1: %2/%3 correct")
+                     .arg(topic.topic_id[0] ? QString::fromUtf8(topic.topic_id) : QString("(no topic)"))
+                     .arg(topic.correct)
+                     .arg(topic.asked);
+    }
+    if (!saved) {
+        lines << QString("Results were not saved.");
+    }
+    exam_report_release(&report);
+    
+    m_completeTitle->setText("Exam Complete");
+    m_completeStats->setText(lines.join('\n'));
+    showSessionComplete();
+}
+
 void StudyScreenWidget::update()
 {
+    // Checked on the first frame, once the prefetcher the exam cards are read through is attached.
+    if (!m_examResumeChecked && m_database) {
+        m_examResumeChecked = true;
+        resumeExam();
+    }
+    
+    if (m_exam) {
+        updateExam();
+        return;
+    }
+    
     if (!m_sessions) {
         return;
     }
     
+    m_undoBtn->setEnabled(session_manager_undo_available(m_sessions) > 0);
+    m_redoBtn->setEnabled(session_manager_redo_available(m_sessions) > 0);
+    
     // Check if there's an active session
     const SessionCard *current = session_manager_current(m_sessions);
     if (current != nullptr) {
-        // Update UI to show current card
-        size_t remaining = session_manager_remaining(m_sessions);
-        m_statusLabel->setText(
-            QString("Study Session Active - %1 cards remaining")
-                .arg(remaining)
-        );
-        
-        // Display card content (for now, just show the card ID)
-        m_cardDisplay->setPlainText(
-            QString("Card ID: %1\n\n"
-                   "Ease: %2\n"
-                   "Interval: %3 days\n"
-                   "Mode: %4")
-                .arg(current->card_id)
-                .arg(current->state.ease_factor, 0, 'f', 2)
-                .arg(current->state.interval_days)
-                .arg(current->state.mode == SRS_MODE_MASTERY ? "Mastery" : "Cram")
-        );
-        
+        // Re-queued cards come back with the same id, so the remaining count is part of the key.
+        const size_t remaining = session_manager_remaining(m_sessions);
+        if (current->card_id != m_shownCardId || remaining != m_shownRemaining) {
+            showCard(current, remaining);
+        }
         showCardReview();
-    } else {
+    } else if (m_sessionActive) {
+        if (m_prefetcher) {
+            prefetcher_schedule(m_prefetcher, nullptr, 0);
+        }
         showWelcomeScreen();
     }
 }
@@ -202,9 +694,7 @@ void StudyScreenWidget::onStartMasterySession()
         return;
     }
     
-    // TODO: Get cards from database
-    // For now, start an empty session to test the flow
-    bool started = session_manager_begin(m_sessions, SESSION_MODE_MASTERY, nullptr, 0);
+    bool started = startPlannedSession(SESSION_MODE_MASTERY, false);
     if (started) {
         update();
     } else {
@@ -219,9 +709,7 @@ void StudyScreenWidget::onStartCramSession()
         return;
     }
     
-    // TODO: Get cards from database  
-    // For now, start an empty session to test the flow
-    bool started = session_manager_begin(m_sessions, SESSION_MODE_CRAM, nullptr, 0);
+    bool started = startPlannedSession(SESSION_MODE_CRAM, false);
     if (started) {
         update();
     } else {
@@ -229,67 +717,143 @@ void StudyScreenWidget::onStartCramSession()
     }
 }
 
-void StudyScreenWidget::onAnswerEasy()
+void StudyScreenWidget::onStartBacklogSession()
 {
     if (!m_sessions) {
-        m_cardDisplay->setPlainText("Next card would appear here...");
+        showCardReview();  // Show placeholder for now
         return;
     }
     
-    SRSReviewResult result;
-    bool graded = session_manager_grade(m_sessions, SRS_RESPONSE_EASY, nullptr, &result);
-    if (graded) {
+    bool started = startPlannedSession(SESSION_MODE_MASTERY, true);
+    if (started) {
         update();
     } else {
-        // Session complete
-        showSessionComplete();
+        showWelcomeScreen();
     }
 }
 
-void StudyScreenWidget::onAnswerGood()
+void StudyScreenWidget::onStartExam()
 {
+    if (!m_planner) {
+        return;
+    }
+    
+    // The exam borrows the study screen, so any session in progress ends first.
+    if (m_sessions) {
+        session_manager_end(m_sessions);
+    }
+    planner_cursor_close(m_cursor);
+    m_cursor = nullptr;
+    planner_plan_release(&m_plan);
+    m_deferred = 0;
+    exam_destroy(m_exam);
+    m_exam = nullptr;
+    if (m_database) {
+        exam_clear_checkpoint(m_database);
+    }
+    
+    HrPlannerPlan paper;
+    std::memset(&paper, 0, sizeof(paper));
+    if (!planner_build_exam(m_planner, 0, 0, &paper)) {
+        showWelcomeScreen();
+        return;
+    }
+    
+    HrExamConfig config{};
+    config.section_count = 2;
+    config.card_time_limit_ms = 60U * 1000U;
+    config.section_time_limit_ms = 15U * 60U * 1000U;
+    m_exam = exam_create(&config, paper.cards, paper.count, std::time(nullptr));
+    planner_plan_release(&paper);
+    if (!m_exam) {
+        showWelcomeScreen();
+        return;
+    }
+    
+    m_examShown = static_cast<size_t>(-1);
+    m_examReported = false;
+    m_examCarried = 0;
+    m_examClock.start();
+    storeExamCheckpoint();
+    update();
+}
+
+void StudyScreenWidget::onLeaveResults()
+{
+    exam_destroy(m_exam);
+    m_exam = nullptr;
+    m_completeTitle->setText("Session Complete!");
+    m_completeStats->setText("Great work! Check analytics for details.");
+    showWelcomeScreen();
+}
+
+void StudyScreenWidget::gradeCurrent(SRSReviewRating rating)
+{
+    if (m_exam) {
+        answerExam(rating);
+        return;
+    }
     if (!m_sessions) {
+        m_latencyPending = false;
         m_cardDisplay->setPlainText("Next card would appear here...");
         return;
     }
     
+    if (m_answerClock.isValid()) {
+        const qint64 answerMs = m_answerClock.elapsed();
+        session_manager_set_answer_time(m_sessions, answerMs > 0 ? static_cast<uint32_t>(answerMs) : 0U);
+    }
+    
     SRSReviewResult result;
-    bool graded = session_manager_grade(m_sessions, SRS_RESPONSE_GOOD, nullptr, &result);
-    if (graded) {
+    if (session_manager_grade(m_sessions, rating, nullptr, &result)) {
         update();
     } else {
         showSessionComplete();
     }
 }
 
+void StudyScreenWidget::onAnswerEasy()
+{
+    gradeCurrent(SRS_RESPONSE_EASY);
+}
+
+void StudyScreenWidget::onAnswerGood()
+{
+    gradeCurrent(SRS_RESPONSE_GOOD);
+}
+
 void StudyScreenWidget::onAnswerHard()
 {
-    if (!m_sessions) {
-        m_cardDisplay->setPlainText("Next card would appear here...");
+    gradeCurrent(SRS_RESPONSE_HARD);
+}
+
+void StudyScreenWidget::onAnswerAgain()
+{
+    gradeCurrent(SRS_RESPONSE_FAIL);
+}
+
+void StudyScreenWidget::onUndo()
+{
+    if (!m_sessions || m_exam) {
         return;
     }
     
-    SRSReviewResult result;
-    bool graded = session_manager_grade(m_sessions, SRS_RESPONSE_HARD, nullptr, &result);
-    if (graded) {
+    // The undone card becomes current again; the grade buttons re-grade it.
+    if (session_manager_undo(m_sessions, nullptr)) {
         update();
-    } else {
-        showSessionComplete();
     }
 }
 
-void StudyScreenWidget::onAnswerAgain()
+void StudyScreenWidget::onRedo()
 {
-    if (!m_sessions) {
-        m_cardDisplay->setPlainText("Card will be shown again soon...");
+    if (!m_sessions || m_exam) {
         return;
     }
     
     SRSReviewResult result;
-    bool graded = session_manager_grade(m_sessions, SRS_RESPONSE_FAIL, nullptr, &result);
-    if (graded) {
+    if (session_manager_redo(m_sessions, &result)) {
         update();
     } else {
-        showSessionComplete();
+        m_redoBtn->setEnabled(false);
     }
 }
@@ -1,15 +1,27 @@
 #ifndef HYPERRECALL_STUDY_SCREEN_H
 #define HYPERRECALL_STUDY_SCREEN_H
 
+#include <QElapsedTimer>
+#include <QString>
 #include <QWidget>
 
+class QCheckBox;
+class QEvent;
 class QLabel;
 class QPushButton;
+class QShortcut;
+class QStackedWidget;
 class QVBoxLayout;
 class QTextEdit;
 
 extern "C" {
+#include "../analytics.h"
+#include "../db.h"
+#include "../exam.h"
+#include "../planner.h"
+#include "../prefetch.h"
 #include "../sessions.h"
+#include "../ui.h"
 }
 
 /**
@@ -20,41 +32,109 @@ class StudyScreenWidget : public QWidget {
 
 public:
     explicit StudyScreenWidget(QWidget *parent = nullptr);
+    ~StudyScreenWidget() override;
     
     void setSessionManager(struct SessionManager *sessions);
+    void setPlanner(struct HrStudyPlanner *planner);
+    void setPrefetcher(struct HrPrefetcher *prefetcher);
+    void setDatabase(DatabaseHandle *database);
+    void setAnalytics(struct AnalyticsHandle *analytics);
+    /** Binds study actions to key sequences; NULL or empty entries keep the defaults. */
+    void setHotkeys(const char *const hotkeys[UI_STUDY_ACTION_COUNT]);
     void update();
 
 signals:
     void sessionCompleted();
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private slots:
     void onStartMasterySession();
     void onStartCramSession();
+    void onStartBacklogSession();
+    void onStartExam();
+    void onLeaveResults();
+    void onReveal();
     void onAnswerEasy();
     void onAnswerGood();
     void onAnswerHard();
     void onAnswerAgain();
+    void onUndo();
+    void onRedo();
 
 private:
     void setupUI();
     void showWelcomeScreen();
     void showCardReview();
     void showSessionComplete();
+    bool startPlannedSession(SessionMode mode, bool backlog);
+    void schedulePrefetch();
+    void updateExam();
+    void answerExam(SRSReviewRating rating);
+    void showExamReport();
+    qint64 examCardElapsed() const;
+    void storeExamCheckpoint();
+    void resumeExam();
+    void gradeCurrent(SRSReviewRating rating);
+    void onHotkey(UiStudyAction action);
+    void showCard(const SessionCard *card, size_t remaining);
+    void renderCard();
+    void setRevealed(bool revealed);
     
     struct SessionManager *m_sessions;
+    struct HrStudyPlanner *m_planner;
+    HrPlannerPlan m_plan; // Owns topic strings referenced by a backlog session.
+    struct HrPlannerCursor *m_cursor; // Feeds streamed sessions; closed after the session ends.
+    size_t m_deferred;
+    struct HrPrefetcher *m_prefetcher;
+    DatabaseHandle *m_database;
+    struct AnalyticsHandle *m_analytics;
+    struct HrExam *m_exam; // Active exam simulation; graded apart from the session queue.
+    QElapsedTimer m_examClock; // Time spent on the exam card on screen.
+    qint64 m_examCarried; // Time spent on that card before the app was restarted.
+    size_t m_examShown; // Paper position currently displayed.
+    bool m_examReported;
+    bool m_examResumeChecked; // The stored exam checkpoint has been looked for.
+    
+    // Card currently rendered; update() runs every frame and only redraws on change.
+    uint64_t m_shownCardId;
+    size_t m_shownRemaining;
+    QString m_shownPrompt;
+    QString m_shownResponse;
+    QString m_shownDetails;
+    bool m_rapidMode; // Keyboard-first: the answer stays hidden until revealed.
+    bool m_revealed;
+    
+    // Keypress-to-next-card-painted measurement, reported to analytics.
+    QElapsedTimer m_inputClock;
+    bool m_latencyPending;
+    QElapsedTimer m_answerClock; // Time the learner spends on the card on screen.
+    
+    QShortcut *m_hotkeys[UI_STUDY_ACTION_COUNT];
     
     QLabel *m_statusLabel;
+    QStackedWidget *m_stack;
     QTextEdit *m_cardDisplay;
     QPushButton *m_startMasteryBtn;
     QPushButton *m_startCramBtn;
+    QPushButton *m_startBacklogBtn;
+    QPushButton *m_startExamBtn;
+    QPushButton *m_leaveResultsBtn;
+    QCheckBox *m_rapidCheck;
+    QPushButton *m_revealBtn;
     QPushButton *m_easyBtn;
     QPushButton *m_goodBtn;
     QPushButton *m_hardBtn;
     QPushButton *m_againBtn;
+    QPushButton *m_undoBtn;
+    QPushButton *m_redoBtn;
     
     QWidget *m_welcomeWidget;
     QWidget *m_reviewWidget;
     QWidget *m_completeWidget;
+    QLabel *m_completeTitle;
+    QLabel *m_completeStats;
     
     bool m_sessionActive;
 };
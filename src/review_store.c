@@ -0,0 +1,579 @@
+#include "review_store.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "srs.h"
+
+#define STORE_SECONDS_PER_DAY 86400
+
+/* Rating column value of a retracted row; no query accepts it. */
+#define STORE_RETRACTED 0xFFU
+
+#define STORE_MAX_DAYS 65535U
+
+/*
+ * One block of columns. Times are offsets from @c base_at, kept strictly
+ * above INT32_MIN so that an exclusive bound one second past any offset
+ * still fits in 32 bits.
+ */
+typedef struct StoreBlock {
+    int64_t base_at;
+    int64_t min_at;
+    int64_t max_at;
+    uint32_t rows;
+    int32_t at_offset[HR_REVIEW_STORE_BLOCK_ROWS];
+    uint32_t card[HR_REVIEW_STORE_BLOCK_ROWS];
+    uint32_t duration_ms[HR_REVIEW_STORE_BLOCK_ROWS];
+    uint16_t elapsed_days[HR_REVIEW_STORE_BLOCK_ROWS];
+    uint16_t scheduled_days[HR_REVIEW_STORE_BLOCK_ROWS];
+    uint8_t rating[HR_REVIEW_STORE_BLOCK_ROWS];
+} StoreBlock;
+
+typedef char StoreTopicId[HR_REVIEW_STORE_MAX_TOPIC_ID];
+
+struct HrReviewStore {
+    StoreBlock **blocks;
+    size_t block_count;
+    size_t block_capacity;
+    uint64_t live_rows;
+    uint64_t *card_ids;     /* Card dictionary: index -> card id. */
+    uint32_t *card_topics;  /* Index -> topic index of the card's latest row. */
+    size_t card_count;
+    size_t card_capacity;
+    uint32_t *card_slots;   /* Open-addressed card id -> index + 1 (0 = empty); power-of-two capacity. */
+    size_t card_slot_capacity;
+    StoreTopicId *topic_ids; /* Topic dictionary; entry 0 is the empty id. */
+    size_t topic_count;
+    size_t topic_capacity;
+    uint32_t *topic_slots;   /* Open-addressed topic id -> index + 1. */
+    size_t topic_slot_capacity;
+};
+
+/* Per-query lookup tables shared by the kernels. */
+typedef struct StoreFilter {
+    bool has_start;
+    bool has_end;
+    int64_t start_at;
+    int64_t end_at;
+    uint8_t rating_ok[256];
+    uint8_t success[256];
+    uint8_t *card_ok; /* Per card index; NULL when every topic matches. */
+} StoreFilter;
+
+static uint64_t card_hash(uint64_t card_id)
+{
+    uint64_t hash = card_id * 0x9E3779B97F4A7C15ULL;
+    return hash ^ (hash >> 32U);
+}
+
+static uint64_t topic_hash(const char *topic_id)
+{
+    uint64_t hash = 1469598103934665603ULL; /* FNV-1a */
+    for (const unsigned char *p = (const unsigned char *)topic_id; *p != '\0'; ++p) {
+        hash ^= (uint64_t)*p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* Doubles @p capacity from @p initial until it exceeds @p count. */
+static size_t next_capacity(size_t capacity, size_t count, size_t initial)
+{
+    size_t next = (capacity == 0U) ? initial : capacity;
+    while (next <= count) {
+        next *= 2U;
+    }
+    return next;
+}
+
+static uint32_t *card_probe(uint32_t *slots, size_t capacity, const uint64_t *card_ids, uint64_t card_id)
+{
+    size_t index = (size_t)card_hash(card_id) & (capacity - 1U);
+    while (slots[index] != 0U && card_ids[slots[index] - 1U] != card_id) {
+        index = (index + 1U) & (capacity - 1U);
+    }
+    return &slots[index];
+}
+
+static uint32_t *topic_probe(uint32_t *slots, size_t capacity, StoreTopicId *topic_ids, const char *topic_id)
+{
+    size_t index = (size_t)topic_hash(topic_id) & (capacity - 1U);
+    while (slots[index] != 0U && strcmp(topic_ids[slots[index] - 1U], topic_id) != 0) {
+        index = (index + 1U) & (capacity - 1U);
+    }
+    return &slots[index];
+}
+
+static bool find_card(const struct HrReviewStore *store, uint64_t card_id, uint32_t *out_index)
+{
+    if (store->card_slot_capacity == 0U) {
+        return false;
+    }
+    const uint32_t slot = *card_probe(store->card_slots, store->card_slot_capacity, store->card_ids, card_id);
+    if (slot == 0U) {
+        return false;
+    }
+    *out_index = slot - 1U;
+    return true;
+}
+
+static bool ensure_card(struct HrReviewStore *store, uint64_t card_id, uint32_t *out_index)
+{
+    if (find_card(store, card_id, out_index)) {
+        return true;
+    }
+    if (store->card_count >= UINT32_MAX - 1U) {
+        return false;
+    }
+
+    if ((store->card_count + 1U) * 4U > store->card_slot_capacity * 3U) {
+        const size_t capacity = (store->card_slot_capacity == 0U) ? 1024U : store->card_slot_capacity * 2U;
+        uint32_t *slots = (uint32_t *)calloc(capacity, sizeof(*slots));
+        if (slots == NULL) {
+            return false;
+        }
+        for (size_t i = 0; i < store->card_count; ++i) {
+            *card_probe(slots, capacity, store->card_ids, store->card_ids[i]) = (uint32_t)i + 1U;
+        }
+        free(store->card_slots);
+        store->card_slots = slots;
+        store->card_slot_capacity = capacity;
+    }
+
+    if (store->card_count == store->card_capacity) {
+        /* Both dictionary columns grow together; a failure part way leaves the capacity as it was. */
+        const size_t capacity = next_capacity(store->card_capacity, store->card_count, 1024U);
+        uint64_t *ids = (uint64_t *)realloc(store->card_ids, capacity * sizeof(*ids));
+        if (ids == NULL) {
+            return false;
+        }
+        store->card_ids = ids;
+        uint32_t *topics = (uint32_t *)realloc(store->card_topics, capacity * sizeof(*topics));
+        if (topics == NULL) {
+            return false;
+        }
+        store->card_topics = topics;
+        store->card_capacity = capacity;
+    }
+
+    const uint32_t index = (uint32_t)store->card_count++;
+    store->card_ids[index] = card_id;
+    store->card_topics[index] = HR_REVIEW_STORE_NO_TOPIC;
+    *card_probe(store->card_slots, store->card_slot_capacity, store->card_ids, card_id) = index + 1U;
+    *out_index = index;
+    return true;
+}
+
+static bool ensure_topic(struct HrReviewStore *store, const char *topic_id, uint32_t *out_index)
+{
+    if (review_store_find_topic(store, topic_id, out_index)) {
+        return true;
+    }
+
+    if ((store->topic_count + 1U) * 4U > store->topic_slot_capacity * 3U) {
+        const size_t capacity = (store->topic_slot_capacity == 0U) ? 64U : store->topic_slot_capacity * 2U;
+        uint32_t *slots = (uint32_t *)calloc(capacity, sizeof(*slots));
+        if (slots == NULL) {
+            return false;
+        }
+        for (size_t i = 0; i < store->topic_count; ++i) {
+            *topic_probe(slots, capacity, store->topic_ids, store->topic_ids[i]) = (uint32_t)i + 1U;
+        }
+        free(store->topic_slots);
+        store->topic_slots = slots;
+        store->topic_slot_capacity = capacity;
+    }
+    if (store->topic_count == store->topic_capacity) {
+        const size_t capacity = next_capacity(store->topic_capacity, store->topic_count, 64U);
+        StoreTopicId *ids = (StoreTopicId *)realloc(store->topic_ids, capacity * sizeof(*ids));
+        if (ids == NULL) {
+            return false;
+        }
+        store->topic_ids = ids;
+        store->topic_capacity = capacity;
+    }
+
+    const uint32_t index = (uint32_t)store->topic_count++;
+    strcpy(store->topic_ids[index], topic_id);
+    *topic_probe(store->topic_slots, store->topic_slot_capacity, store->topic_ids, topic_id) = index + 1U;
+    *out_index = index;
+    return true;
+}
+
+/* Returns the block the next row at @p reviewed_at goes into, opening one when needed. */
+static StoreBlock *writable_block(struct HrReviewStore *store, int64_t reviewed_at)
+{
+    if (store->block_count > 0U) {
+        StoreBlock *last = store->blocks[store->block_count - 1U];
+        const int64_t offset = reviewed_at - last->base_at;
+        if (last->rows < HR_REVIEW_STORE_BLOCK_ROWS && offset > INT32_MIN && offset <= INT32_MAX) {
+            return last;
+        }
+    }
+
+    if (store->block_count == store->block_capacity) {
+        const size_t capacity = next_capacity(store->block_capacity, store->block_count, 64U);
+        StoreBlock **blocks = (StoreBlock **)realloc(store->blocks, capacity * sizeof(*blocks));
+        if (blocks == NULL) {
+            return NULL;
+        }
+        store->blocks = blocks;
+        store->block_capacity = capacity;
+    }
+    StoreBlock *block = (StoreBlock *)malloc(sizeof(*block));
+    if (block == NULL) {
+        return NULL;
+    }
+    block->base_at = reviewed_at;
+    block->min_at = reviewed_at;
+    block->max_at = reviewed_at;
+    block->rows = 0U;
+    store->blocks[store->block_count++] = block;
+    return block;
+}
+
+static uint16_t saturate_days(uint32_t days)
+{
+    return (days > STORE_MAX_DAYS) ? (uint16_t)STORE_MAX_DAYS : (uint16_t)days;
+}
+
+static bool filter_init(const struct HrReviewStore *store, const HrReviewQuery *query, StoreFilter *filter)
+{
+    memset(filter, 0, sizeof(*filter));
+    for (int rating = SRS_RESPONSE_FAIL; rating <= SRS_RESPONSE_CRAM; ++rating) {
+        filter->rating_ok[rating] = 1U;
+        filter->success[rating] = (rating >= SRS_RESPONSE_GOOD) ? 1U : 0U;
+    }
+    if (query == NULL) {
+        return true;
+    }
+
+    filter->has_start = query->start_at != 0;
+    filter->has_end = query->end_at != 0;
+    filter->start_at = query->start_at;
+    filter->end_at = query->end_at;
+    if (query->rating_mask != 0U) {
+        for (int rating = SRS_RESPONSE_FAIL; rating <= SRS_RESPONSE_CRAM; ++rating) {
+            filter->rating_ok[rating] = (query->rating_mask & (1U << rating)) ? 1U : 0U;
+        }
+    }
+
+    if (query->topic_set == NULL && query->topic_id == NULL) {
+        return true;
+    }
+    filter->card_ok = (uint8_t *)calloc((store->card_count > 0U) ? store->card_count : 1U, 1U);
+    if (filter->card_ok == NULL) {
+        return false;
+    }
+    uint32_t topic = 0U;
+    const bool known = query->topic_set != NULL || review_store_find_topic(store, query->topic_id, &topic);
+    for (size_t i = 0; known && i < store->card_count; ++i) {
+        const uint32_t card_topic = store->card_topics[i];
+        filter->card_ok[i] = (query->topic_set != NULL) ? (query->topic_set[card_topic] != 0U)
+                                                         : (card_topic == topic);
+    }
+    return true;
+}
+
+/*
+ * Writes 1 into @p selection for each row of @p block that passes
+ * @p filter, 0 otherwise. Returns false without touching @p selection when
+ * the block's time range rules out every row.
+ */
+static bool filter_block(const StoreBlock *block, const StoreFilter *filter, uint8_t *selection)
+{
+    if ((filter->has_end && block->min_at >= filter->end_at) || (filter->has_start && block->max_at < filter->start_at)) {
+        return false;
+    }
+
+    const uint32_t rows = block->rows;
+    for (uint32_t i = 0; i < rows; ++i) {
+        selection[i] = filter->rating_ok[block->rating[i]];
+    }
+
+    /* Blocks wholly inside the range skip the per-row time test. */
+    const bool clip_start = filter->has_start && block->min_at < filter->start_at;
+    const bool clip_end = filter->has_end && block->max_at >= filter->end_at;
+    if (clip_start || clip_end) {
+        const int32_t low = clip_start ? (int32_t)(filter->start_at - block->base_at) : INT32_MIN;
+        const int32_t high = clip_end ? (int32_t)(filter->end_at - block->base_at - 1) : INT32_MAX;
+        for (uint32_t i = 0; i < rows; ++i) {
+            selection[i] &= (uint8_t)((block->at_offset[i] >= low) & (block->at_offset[i] <= high));
+        }
+    }
+
+    if (filter->card_ok != NULL) {
+        for (uint32_t i = 0; i < rows; ++i) {
+            selection[i] &= filter->card_ok[block->card[i]];
+        }
+    }
+    return true;
+}
+
+/* Oldest live-or-retracted row time, used as the day origin of unbounded queries. */
+static int64_t store_oldest(const struct HrReviewStore *store)
+{
+    int64_t oldest = 0;
+    for (size_t b = 0; b < store->block_count; ++b) {
+        if (b == 0U || store->blocks[b]->min_at < oldest) {
+            oldest = store->blocks[b]->min_at;
+        }
+    }
+    return oldest;
+}
+
+static int64_t floor_to_day(int64_t timestamp)
+{
+    int64_t days = timestamp / STORE_SECONDS_PER_DAY;
+    if (timestamp % STORE_SECONDS_PER_DAY < 0) {
+        --days;
+    }
+    return days * STORE_SECONDS_PER_DAY;
+}
+
+struct HrReviewStore *review_store_create(void)
+{
+    struct HrReviewStore *store = (struct HrReviewStore *)calloc(1U, sizeof(struct HrReviewStore));
+    if (store == NULL) {
+        return NULL;
+    }
+    uint32_t none = 0U;
+    if (!ensure_topic(store, "", &none)) {
+        review_store_destroy(store);
+        return NULL;
+    }
+    return store;
+}
+
+void review_store_destroy(struct HrReviewStore *store)
+{
+    if (store == NULL) {
+        return;
+    }
+
+    review_store_clear(store);
+    free(store->blocks);
+    free(store->card_ids);
+    free(store->card_topics);
+    free(store->card_slots);
+    free(store->topic_ids);
+    free(store->topic_slots);
+    free(store);
+}
+
+void review_store_clear(struct HrReviewStore *store)
+{
+    if (store == NULL) {
+        return;
+    }
+
+    for (size_t b = 0; b < store->block_count; ++b) {
+        free(store->blocks[b]);
+    }
+    store->block_count = 0U;
+    store->live_rows = 0U;
+}
+
+bool review_store_append(struct HrReviewStore *store, const HrReviewRow *row)
+{
+    if (store == NULL || row == NULL || row->rating < SRS_RESPONSE_FAIL || row->rating > SRS_RESPONSE_CRAM) {
+        return false;
+    }
+
+    uint32_t card = 0U;
+    if (!ensure_card(store, row->card_id, &card)) {
+        return false;
+    }
+    /* Cards rarely change topic, so the card's current entry usually saves the dictionary lookup. */
+    const char *topic_id = (row->topic_id != NULL && strlen(row->topic_id) < HR_REVIEW_STORE_MAX_TOPIC_ID) ? row->topic_id : "";
+    uint32_t topic = store->card_topics[card];
+    if (strcmp(store->topic_ids[topic], topic_id) != 0 && !ensure_topic(store, topic_id, &topic)) {
+        return false;
+    }
+    StoreBlock *block = writable_block(store, row->reviewed_at);
+    if (block == NULL) {
+        return false;
+    }
+
+    store->card_topics[card] = topic;
+    const uint32_t i = block->rows++;
+    block->at_offset[i] = (int32_t)(row->reviewed_at - block->base_at);
+    block->card[i] = card;
+    block->duration_ms[i] = row->duration_ms;
+    block->elapsed_days[i] = saturate_days(row->elapsed_days);
+    block->scheduled_days[i] = saturate_days(row->scheduled_days);
+    block->rating[i] = (uint8_t)row->rating;
+    if (row->reviewed_at < block->min_at) {
+        block->min_at = row->reviewed_at;
+    }
+    if (row->reviewed_at > block->max_at) {
+        block->max_at = row->reviewed_at;
+    }
+    store->live_rows++;
+    return true;
+}
+
+bool review_store_retract(struct HrReviewStore *store, uint64_t card_id, int64_t reviewed_at)
+{
+    uint32_t card = 0U;
+    if (store == NULL || !find_card(store, card_id, &card)) {
+        return false;
+    }
+
+    for (size_t b = store->block_count; b-- > 0U;) {
+        StoreBlock *block = store->blocks[b];
+        if (reviewed_at < block->min_at || reviewed_at > block->max_at) {
+            continue;
+        }
+        const int32_t offset = (int32_t)(reviewed_at - block->base_at);
+        for (uint32_t i = block->rows; i-- > 0U;) {
+            if (block->card[i] == card && block->at_offset[i] == offset && block->rating[i] != STORE_RETRACTED) {
+                block->rating[i] = STORE_RETRACTED;
+                store->live_rows--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint64_t review_store_rows(const struct HrReviewStore *store)
+{
+    return (store != NULL) ? store->live_rows : 0U;
+}
+
+size_t review_store_memory(const struct HrReviewStore *store)
+{
+    if (store == NULL) {
+        return 0U;
+    }
+    return sizeof(*store) + store->block_count * sizeof(StoreBlock) + store->block_capacity * sizeof(StoreBlock *) +
+           store->card_capacity * (sizeof(uint64_t) + sizeof(uint32_t)) + store->card_slot_capacity * sizeof(uint32_t) +
+           store->topic_capacity * sizeof(StoreTopicId) + store->topic_slot_capacity * sizeof(uint32_t);
+}
+
+size_t review_store_topic_count(const struct HrReviewStore *store)
+{
+    return (store != NULL) ? store->topic_count : 0U;
+}
+
+bool review_store_find_topic(const struct HrReviewStore *store, const char *topic_id, uint32_t *out_index)
+{
+    if (store == NULL || topic_id == NULL || out_index == NULL || store->topic_slot_capacity == 0U) {
+        return false;
+    }
+    const uint32_t slot = *topic_probe(store->topic_slots, store->topic_slot_capacity, store->topic_ids, topic_id);
+    if (slot == 0U) {
+        return false;
+    }
+    *out_index = slot - 1U;
+    return true;
+}
+
+const char *review_store_topic_id(const struct HrReviewStore *store, uint32_t index)
+{
+    return (store != NULL && index < store->topic_count) ? store->topic_ids[index] : NULL;
+}
+
+uint64_t review_store_count(const struct HrReviewStore *store, const HrReviewQuery *query)
+{
+    StoreFilter filter;
+    if (store == NULL || !filter_init(store, query, &filter)) {
+        return 0U;
+    }
+
+    uint8_t selection[HR_REVIEW_STORE_BLOCK_ROWS];
+    uint64_t matched = 0U;
+    for (size_t b = 0; b < store->block_count; ++b) {
+        const StoreBlock *block = store->blocks[b];
+        if (!filter_block(block, &filter, selection)) {
+            continue;
+        }
+        uint32_t block_matched = 0U;
+        for (uint32_t i = 0; i < block->rows; ++i) {
+            block_matched += selection[i];
+        }
+        matched += block_matched;
+    }
+    free(filter.card_ok);
+    return matched;
+}
+
+uint64_t review_store_group(const struct HrReviewStore *store,
+                            const HrReviewQuery *query,
+                            HrReviewGroupKey key,
+                            HrReviewGroup *out_groups,
+                            size_t group_count)
+{
+    if (out_groups == NULL || group_count == 0U) {
+        return 0U;
+    }
+    memset(out_groups, 0, group_count * sizeof(*out_groups));
+
+    StoreFilter filter;
+    if (store == NULL || !filter_init(store, query, &filter)) {
+        return 0U;
+    }
+
+    const int64_t day_origin = floor_to_day(filter.has_start ? filter.start_at : store_oldest(store));
+    const size_t last = group_count - 1U;
+    uint8_t selection[HR_REVIEW_STORE_BLOCK_ROWS];
+    uint32_t keys[HR_REVIEW_STORE_BLOCK_ROWS];
+    uint64_t matched = 0U;
+
+    for (size_t b = 0; b < store->block_count; ++b) {
+        const StoreBlock *block = store->blocks[b];
+        if (!filter_block(block, &filter, selection)) {
+            continue;
+        }
+        const uint32_t rows = block->rows;
+
+        switch (key) {
+        case HR_REVIEW_GROUP_RATING:
+            for (uint32_t i = 0; i < rows; ++i) {
+                keys[i] = block->rating[i];
+            }
+            break;
+        case HR_REVIEW_GROUP_TOPIC:
+            for (uint32_t i = 0; i < rows; ++i) {
+                keys[i] = store->card_topics[block->card[i]];
+            }
+            break;
+        case HR_REVIEW_GROUP_DAY: {
+            const int64_t shift = block->base_at - day_origin;
+            for (uint32_t i = 0; i < rows; ++i) {
+                const int64_t day = (shift + block->at_offset[i]) / STORE_SECONDS_PER_DAY;
+                keys[i] = (day < 0) ? 0U : (day > (int64_t)UINT32_MAX) ? UINT32_MAX : (uint32_t)day;
+            }
+            break;
+        }
+        case HR_REVIEW_GROUP_ELAPSED_DAYS:
+            for (uint32_t i = 0; i < rows; ++i) {
+                keys[i] = block->elapsed_days[i];
+            }
+            break;
+        case HR_REVIEW_GROUP_SCHEDULED_DAYS:
+            for (uint32_t i = 0; i < rows; ++i) {
+                keys[i] = block->scheduled_days[i];
+            }
+            break;
+        case HR_REVIEW_GROUP_ALL:
+        default:
+            memset(keys, 0, rows * sizeof(keys[0]));
+            break;
+        }
+
+        /* Unselected rows add zero, which keeps the loop free of branches on the selection. */
+        for (uint32_t i = 0; i < rows; ++i) {
+            const uint32_t selected = selection[i];
+            HrReviewGroup *group = &out_groups[(keys[i] < last) ? keys[i] : last];
+            group->reviews += selected;
+            group->successful += selected & filter.success[block->rating[i]];
+            group->duration_ms += (uint64_t)(block->duration_ms[i] * selected);
+            matched += selected;
+        }
+    }
+    free(filter.card_ok);
+    return matched;
+}
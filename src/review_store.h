@@ -0,0 +1,127 @@
+#ifndef HYPERRECALL_REVIEW_STORE_H
+#define HYPERRECALL_REVIEW_STORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file review_store.h
+ * @brief Column-oriented in-memory copy of the review log for ad-hoc queries.
+ *
+ * Rows are appended in review order into fixed-size blocks of parallel
+ * columns. Review times are stored as 32-bit offsets from the block's first
+ * time and cards as indexes into a card dictionary that also maps each card
+ * to its topic, so a row takes 17 bytes. Every block records its time range:
+ * time-range queries skip blocks outside it and drop the per-row time test
+ * for blocks wholly inside it. The filter and group-by kernels run one block
+ * at a time as branch-free loops over the columns they need.
+ *
+ * Not thread-safe; the owner serialises appends and queries.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Rows per column block. */
+#define HR_REVIEW_STORE_BLOCK_ROWS 4096U
+
+/** Longest topic identifier the topic dictionary keeps, including the terminator. */
+#define HR_REVIEW_STORE_MAX_TOPIC_ID 64U
+
+/** Topic index of cards without a topic. */
+#define HR_REVIEW_STORE_NO_TOPIC 0U
+
+/** One review as appended to the store. */
+typedef struct HrReviewRow {
+    uint64_t card_id;
+    int64_t reviewed_at;      /**< Unix seconds. */
+    int rating;               /**< SRSReviewRating; other values are rejected. */
+    uint32_t duration_ms;     /**< Time taken to answer (0 when not measured). */
+    uint32_t scheduled_days;  /**< Interval the scheduler assigned; saturates at 65535. */
+    uint32_t elapsed_days;    /**< Interval since the previous review; saturates at 65535. */
+    const char *topic_id;     /**< Card's topic; NULL or empty for none. Later rows move the card. */
+} HrReviewRow;
+
+/** Row filter; zero-initialise and set the fields that apply. */
+typedef struct HrReviewQuery {
+    int64_t start_at;          /**< Inclusive lower bound on review time (0 = unbounded). */
+    int64_t end_at;            /**< Exclusive upper bound on review time (0 = unbounded). */
+    const char *topic_id;      /**< NULL for every topic, "" for cards without one. */
+    const uint8_t *topic_set;  /**< Optional review_store_topic_count() flags by topic index; overrides @c topic_id. */
+    uint32_t rating_mask;      /**< Bit (1 << rating) per accepted rating (0 = all). */
+} HrReviewQuery;
+
+/** Column a group-by kernel groups on. */
+typedef enum HrReviewGroupKey {
+    HR_REVIEW_GROUP_ALL = 0,          /**< Everything in group 0. */
+    HR_REVIEW_GROUP_RATING = 1,       /**< Group = rating. */
+    HR_REVIEW_GROUP_TOPIC = 2,        /**< Group = topic index. */
+    HR_REVIEW_GROUP_DAY = 3,          /**< Group = UTC days since the day of start_at (or of the oldest row). */
+    HR_REVIEW_GROUP_ELAPSED_DAYS = 4, /**< Group = days since the previous review; gives the retention curve. */
+    HR_REVIEW_GROUP_SCHEDULED_DAYS = 5,
+} HrReviewGroupKey;
+
+/** Totals of one group. */
+typedef struct HrReviewGroup {
+    uint64_t reviews;
+    uint64_t successful;   /**< Reviews rated GOOD/EASY/CRAM. */
+    uint64_t duration_ms;  /**< Sum over the group's reviews. */
+} HrReviewGroup;
+
+struct HrReviewStore;
+
+struct HrReviewStore *review_store_create(void);
+
+void review_store_destroy(struct HrReviewStore *store);
+
+/** Drops every row; the dictionaries are kept. */
+void review_store_clear(struct HrReviewStore *store);
+
+/** Appends one review. Returns false for an invalid row or on allocation failure. */
+bool review_store_append(struct HrReviewStore *store, const HrReviewRow *row);
+
+/**
+ * Removes the newest live row of @p card_id reviewed at @p reviewed_at, as
+ * when a review is undone. Searches from the end, so recent rows are found
+ * quickly. Returns false when there is no such row.
+ */
+bool review_store_retract(struct HrReviewStore *store, uint64_t card_id, int64_t reviewed_at);
+
+/** Live rows (appended minus retracted). */
+uint64_t review_store_rows(const struct HrReviewStore *store);
+
+/** Bytes held by columns and dictionaries. */
+size_t review_store_memory(const struct HrReviewStore *store);
+
+/** Topic dictionary size; valid topic indexes are below it (index 0 is "no topic"). */
+size_t review_store_topic_count(const struct HrReviewStore *store);
+
+/** Looks up the index of @p topic_id; returns false when the store has never seen it. */
+bool review_store_find_topic(const struct HrReviewStore *store, const char *topic_id, uint32_t *out_index);
+
+/** Returns the identifier of topic @p index ("" for the no-topic entry), or NULL when out of range. */
+const char *review_store_topic_id(const struct HrReviewStore *store, uint32_t index);
+
+/** Counts the live rows matching @p query (NULL matches all). */
+uint64_t review_store_count(const struct HrReviewStore *store, const HrReviewQuery *query);
+
+/**
+ * Adds every live row matching @p query (NULL matches all) into
+ * @p out_groups[key], after zeroing all @p group_count groups. Keys at or
+ * past the last group are counted in it, so the last group is an open-ended
+ * tail. Returns the rows matched, or 0 when @p out_groups is NULL or
+ * @p group_count is 0.
+ */
+uint64_t review_store_group(const struct HrReviewStore *store,
+                            const HrReviewQuery *query,
+                            HrReviewGroupKey key,
+                            HrReviewGroup *out_groups,
+                            size_t group_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_REVIEW_STORE_H */
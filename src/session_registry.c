@@ -0,0 +1,470 @@
+#include "session_registry.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sync.h"
+
+#define REGISTRY_INITIAL_CAPACITY 256u
+#define REGISTRY_NO_OWNER 0u
+
+typedef struct RegistrySession {
+    struct HrSessionRegistry *registry;
+    struct SessionManager *manager; /* NULL while the slot is unused. */
+    uint32_t owner;                 /* Tag stored in the ownership table (slot + 1). */
+    size_t claimed;
+    SessionCallbacks installed;
+} RegistrySession;
+
+struct HrSessionRegistry {
+    HrMutex table_lock;  /* Guards the ownership table and claim counters. */
+    HrMutex writer_lock; /* Serializes the shared callbacks (database writes). */
+
+    /* Open-addressing map card_id -> owner tag with linear probing. */
+    uint64_t *card_ids;
+    uint32_t *owners; /* REGISTRY_NO_OWNER marks an empty bucket. */
+    uint32_t *claims; /* Copies of the card the owner has queued; released at zero. */
+    size_t capacity;  /* Always a power of two. */
+    size_t count;
+
+    SessionCallbacks shared;
+    struct HrTraceRing *trace_ring; /* Shared by every session; not owned. */
+    RegistrySession sessions[HR_SESSION_REGISTRY_MAX_SESSIONS];
+    size_t session_count;
+};
+
+static size_t registry_hash(uint64_t card_id)
+{
+    /* splitmix64 finaliser: sequential ids spread over the whole table. */
+    card_id ^= card_id >> 30;
+    card_id *= 0xbf58476d1ce4e5b9ULL;
+    card_id ^= card_id >> 27;
+    card_id *= 0x94d049bb133111ebULL;
+    card_id ^= card_id >> 31;
+    return (size_t)card_id;
+}
+
+static size_t registry_find(const struct HrSessionRegistry *registry, uint64_t card_id)
+{
+    const size_t mask = registry->capacity - 1u;
+    size_t bucket = registry_hash(card_id) & mask;
+    while (registry->owners[bucket] != REGISTRY_NO_OWNER) {
+        if (registry->card_ids[bucket] == card_id) {
+            return bucket;
+        }
+        bucket = (bucket + 1u) & mask;
+    }
+    return bucket;
+}
+
+/* Rebuilds the table at @p capacity, dropping every card held by @p skip_owner. */
+static bool registry_rehash(struct HrSessionRegistry *registry, size_t capacity, uint32_t skip_owner)
+{
+    uint64_t *card_ids = (uint64_t *)calloc(capacity, sizeof(uint64_t));
+    uint32_t *owners = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+    uint32_t *claims = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+    if (card_ids == NULL || owners == NULL || claims == NULL) {
+        free(card_ids);
+        free(owners);
+        free(claims);
+        return false;
+    }
+
+    uint64_t *old_ids = registry->card_ids;
+    uint32_t *old_owners = registry->owners;
+    uint32_t *old_claims = registry->claims;
+    const size_t old_capacity = registry->capacity;
+
+    registry->card_ids = card_ids;
+    registry->owners = owners;
+    registry->claims = claims;
+    registry->capacity = capacity;
+    registry->count = 0u;
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_owners[i] == REGISTRY_NO_OWNER || old_owners[i] == skip_owner) {
+            continue;
+        }
+        const size_t bucket = registry_find(registry, old_ids[i]);
+        registry->card_ids[bucket] = old_ids[i];
+        registry->owners[bucket] = old_owners[i];
+        registry->claims[bucket] = old_claims[i];
+        registry->count++;
+    }
+
+    free(old_ids);
+    free(old_owners);
+    free(old_claims);
+    return true;
+}
+
+/* Empties @p bucket, shifting later members of its probe run back so lookups stay tombstone-free. */
+static void registry_remove_bucket(struct HrSessionRegistry *registry, size_t bucket)
+{
+    const size_t mask = registry->capacity - 1u;
+    size_t hole = bucket;
+    size_t next = (hole + 1u) & mask;
+    while (registry->owners[next] != REGISTRY_NO_OWNER) {
+        const size_t home = registry_hash(registry->card_ids[next]) & mask;
+        /* Move the entry when its home does not lie cyclically in (hole, next]. */
+        const bool movable = (hole <= next) ? (home <= hole || home > next)
+                                            : (home <= hole && home > next);
+        if (movable) {
+            registry->card_ids[hole] = registry->card_ids[next];
+            registry->owners[hole] = registry->owners[next];
+            registry->claims[hole] = registry->claims[next];
+            hole = next;
+        }
+        next = (next + 1u) & mask;
+    }
+    registry->owners[hole] = REGISTRY_NO_OWNER;
+    registry->card_ids[hole] = 0u;
+    registry->claims[hole] = 0u;
+    registry->count--;
+}
+
+static bool registry_claim(uint64_t card_id, void *user_data)
+{
+    RegistrySession *session = (RegistrySession *)user_data;
+    struct HrSessionRegistry *registry = session->registry;
+
+    hr_mutex_lock(&registry->table_lock);
+    bool claimed = false;
+    size_t bucket = registry_find(registry, card_id);
+    if (registry->owners[bucket] != REGISTRY_NO_OWNER) {
+        /* A second copy (a re-queued or restored card) holds the claim until both are gone. */
+        claimed = (registry->owners[bucket] == session->owner);
+        if (claimed) {
+            registry->claims[bucket]++;
+        }
+    } else {
+        /* Grow at 70% load; if that fails the card is served without a claim. */
+        if ((registry->count + 1u) * 10u > registry->capacity * 7u &&
+            registry_rehash(registry, registry->capacity * 2u, REGISTRY_NO_OWNER)) {
+            bucket = registry_find(registry, card_id);
+        }
+        if ((registry->count + 1u) < registry->capacity) {
+            registry->card_ids[bucket] = card_id;
+            registry->owners[bucket] = session->owner;
+            registry->claims[bucket] = 1u;
+            registry->count++;
+            session->claimed++;
+        }
+        claimed = true;
+    }
+    hr_mutex_unlock(&registry->table_lock);
+    return claimed;
+}
+
+static void registry_release(uint64_t card_id, void *user_data)
+{
+    RegistrySession *session = (RegistrySession *)user_data;
+    struct HrSessionRegistry *registry = session->registry;
+
+    hr_mutex_lock(&registry->table_lock);
+    const size_t bucket = registry_find(registry, card_id);
+    if (registry->owners[bucket] == session->owner && --registry->claims[bucket] == 0u) {
+        registry_remove_bucket(registry, bucket);
+        session->claimed--;
+    }
+    hr_mutex_unlock(&registry->table_lock);
+}
+
+static void registry_session_event(const SessionReviewEvent *event, void *user_data)
+{
+    struct HrSessionRegistry *registry = (struct HrSessionRegistry *)user_data;
+    hr_mutex_lock(&registry->writer_lock);
+    registry->shared.session_event(event, registry->shared.session_user_data);
+    hr_mutex_unlock(&registry->writer_lock);
+}
+
+static void registry_analytics_event(const SessionReviewEvent *event, void *user_data)
+{
+    struct HrSessionRegistry *registry = (struct HrSessionRegistry *)user_data;
+    hr_mutex_lock(&registry->writer_lock);
+    registry->shared.analytics_event(event, registry->shared.analytics_user_data);
+    hr_mutex_unlock(&registry->writer_lock);
+}
+
+static bool registry_autosave_event(const SessionReviewEvent *event,
+                                    const SRSPersistedState *persisted,
+                                    void *user_data)
+{
+    struct HrSessionRegistry *registry = (struct HrSessionRegistry *)user_data;
+    hr_mutex_lock(&registry->writer_lock);
+    const bool saved = registry->shared.autosave_event(event, persisted, registry->shared.autosave_user_data);
+    hr_mutex_unlock(&registry->writer_lock);
+    return saved;
+}
+
+static bool registry_record_event(const SessionReviewEvent *event,
+                                  const SRSPersistedState *persisted,
+                                  int64_t *out_review_id,
+                                  void *user_data)
+{
+    struct HrSessionRegistry *registry = (struct HrSessionRegistry *)user_data;
+    hr_mutex_lock(&registry->writer_lock);
+    const bool recorded = registry->shared.record_event(event,
+                                                        persisted,
+                                                        out_review_id,
+                                                        registry->shared.record_user_data);
+    hr_mutex_unlock(&registry->writer_lock);
+    return recorded;
+}
+
+static bool registry_revert_event(uint64_t card_id,
+                                  int64_t review_id,
+                                  const SRSPersistedState *restored,
+                                  void *user_data)
+{
+    struct HrSessionRegistry *registry = (struct HrSessionRegistry *)user_data;
+    hr_mutex_lock(&registry->writer_lock);
+    const bool reverted = registry->shared.revert_event(card_id,
+                                                        review_id,
+                                                        restored,
+                                                        registry->shared.revert_user_data);
+    hr_mutex_unlock(&registry->writer_lock);
+    return reverted;
+}
+
+#if HYPERRECALL_ENABLE_DEVTOOLS
+static void registry_devtools_event(const SessionReviewEvent *event, void *user_data)
+{
+    struct HrSessionRegistry *registry = (struct HrSessionRegistry *)user_data;
+    hr_mutex_lock(&registry->writer_lock);
+    registry->shared.devtools_event(event, registry->shared.devtools_user_data);
+    hr_mutex_unlock(&registry->writer_lock);
+}
+#endif
+
+/* Routes each shared callback that is set through its writer-locked wrapper. */
+static void registry_wrap_callbacks(struct HrSessionRegistry *registry, SessionCallbacks *out_callbacks)
+{
+    memset(out_callbacks, 0, sizeof(*out_callbacks));
+    const SessionCallbacks *shared = &registry->shared;
+
+    if (shared->session_event != NULL) {
+        out_callbacks->session_event = registry_session_event;
+        out_callbacks->session_user_data = registry;
+    }
+    if (shared->analytics_event != NULL) {
+        out_callbacks->analytics_event = registry_analytics_event;
+        out_callbacks->analytics_user_data = registry;
+    }
+    if (shared->autosave_event != NULL) {
+        out_callbacks->autosave_event = registry_autosave_event;
+        out_callbacks->autosave_user_data = registry;
+    }
+    if (shared->record_event != NULL) {
+        out_callbacks->record_event = registry_record_event;
+        out_callbacks->record_user_data = registry;
+    }
+    if (shared->revert_event != NULL) {
+        out_callbacks->revert_event = registry_revert_event;
+        out_callbacks->revert_user_data = registry;
+    }
+#if HYPERRECALL_ENABLE_DEVTOOLS
+    if (shared->devtools_event != NULL) {
+        out_callbacks->devtools_event = registry_devtools_event;
+        out_callbacks->devtools_user_data = registry;
+    }
+#endif
+}
+
+static RegistrySession *registry_lookup(const struct HrSessionRegistry *registry,
+                                        const struct SessionManager *manager)
+{
+    if (registry == NULL || manager == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < HR_SESSION_REGISTRY_MAX_SESSIONS; ++i) {
+        if (registry->sessions[i].manager == manager) {
+            return (RegistrySession *)&registry->sessions[i];
+        }
+    }
+    return NULL;
+}
+
+struct HrSessionRegistry *session_registry_create(const SessionCallbacks *shared_callbacks)
+{
+    struct HrSessionRegistry *registry = (struct HrSessionRegistry *)calloc(1u, sizeof(struct HrSessionRegistry));
+    if (registry == NULL) {
+        return NULL;
+    }
+
+    registry->card_ids = (uint64_t *)calloc(REGISTRY_INITIAL_CAPACITY, sizeof(uint64_t));
+    registry->owners = (uint32_t *)calloc(REGISTRY_INITIAL_CAPACITY, sizeof(uint32_t));
+    registry->claims = (uint32_t *)calloc(REGISTRY_INITIAL_CAPACITY, sizeof(uint32_t));
+    if (registry->card_ids == NULL || registry->owners == NULL || registry->claims == NULL) {
+        free(registry->card_ids);
+        free(registry->owners);
+        free(registry->claims);
+        free(registry);
+        return NULL;
+    }
+    registry->capacity = REGISTRY_INITIAL_CAPACITY;
+
+    if (!hr_mutex_init(&registry->table_lock)) {
+        free(registry->card_ids);
+        free(registry->owners);
+        free(registry->claims);
+        free(registry);
+        return NULL;
+    }
+    if (!hr_mutex_init(&registry->writer_lock)) {
+        hr_mutex_destroy(&registry->table_lock);
+        free(registry->card_ids);
+        free(registry->owners);
+        free(registry->claims);
+        free(registry);
+        return NULL;
+    }
+
+    if (shared_callbacks != NULL) {
+        registry->shared = *shared_callbacks;
+    }
+
+    for (size_t i = 0; i < HR_SESSION_REGISTRY_MAX_SESSIONS; ++i) {
+        registry->sessions[i].registry = registry;
+        registry->sessions[i].owner = (uint32_t)(i + 1u);
+    }
+    return registry;
+}
+
+void session_registry_destroy(struct HrSessionRegistry *registry)
+{
+    if (registry == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < HR_SESSION_REGISTRY_MAX_SESSIONS; ++i) {
+        if (registry->sessions[i].manager != NULL) {
+            session_registry_close(registry, registry->sessions[i].manager);
+        }
+    }
+
+    hr_mutex_destroy(&registry->writer_lock);
+    hr_mutex_destroy(&registry->table_lock);
+    free(registry->card_ids);
+    free(registry->owners);
+    free(registry->claims);
+    free(registry);
+}
+
+struct SessionManager *session_registry_open(struct HrSessionRegistry *registry)
+{
+    if (registry == NULL) {
+        return NULL;
+    }
+
+    RegistrySession *session = NULL;
+    for (size_t i = 0; i < HR_SESSION_REGISTRY_MAX_SESSIONS; ++i) {
+        if (registry->sessions[i].manager == NULL) {
+            session = &registry->sessions[i];
+            break;
+        }
+    }
+    if (session == NULL) {
+        return NULL;
+    }
+
+    struct SessionManager *manager = session_manager_create();
+    if (manager == NULL) {
+        return NULL;
+    }
+
+    const SessionOwnership ownership = {registry_claim, registry_release, session};
+    session_manager_set_ownership(manager, &ownership);
+    registry_wrap_callbacks(registry, &session->installed);
+    session_manager_set_callbacks(manager, &session->installed);
+    session_manager_set_trace_ring(manager, registry->trace_ring, (uint16_t)session->owner);
+
+    session->manager = manager;
+    session->claimed = 0u;
+    registry->session_count++;
+    return manager;
+}
+
+void session_registry_set_trace_ring(struct HrSessionRegistry *registry, struct HrTraceRing *ring)
+{
+    if (registry == NULL) {
+        return;
+    }
+
+    registry->trace_ring = ring;
+    for (size_t i = 0; i < HR_SESSION_REGISTRY_MAX_SESSIONS; ++i) {
+        if (registry->sessions[i].manager != NULL) {
+            session_manager_set_trace_ring(registry->sessions[i].manager, ring, (uint16_t)registry->sessions[i].owner);
+        }
+    }
+}
+
+void session_registry_close(struct HrSessionRegistry *registry, struct SessionManager *manager)
+{
+    RegistrySession *session = registry_lookup(registry, manager);
+    if (session == NULL) {
+        return;
+    }
+
+    /* Ending the session hands every queued card back through registry_release(). */
+    session_manager_end(manager);
+
+    hr_mutex_lock(&registry->table_lock);
+    if (session->claimed > 0u) {
+        (void)registry_rehash(registry, registry->capacity, session->owner);
+        session->claimed = 0u;
+    }
+    hr_mutex_unlock(&registry->table_lock);
+
+    session_manager_destroy(manager);
+    session->manager = NULL;
+    registry->session_count--;
+}
+
+bool session_registry_callbacks(const struct HrSessionRegistry *registry,
+                                const struct SessionManager *manager,
+                                SessionCallbacks *out_callbacks)
+{
+    const RegistrySession *session = registry_lookup(registry, manager);
+    if (session == NULL || out_callbacks == NULL) {
+        return false;
+    }
+
+    *out_callbacks = session->installed;
+    return true;
+}
+
+size_t session_registry_count(const struct HrSessionRegistry *registry)
+{
+    return (registry != NULL) ? registry->session_count : 0u;
+}
+
+struct SessionManager *session_registry_owner(struct HrSessionRegistry *registry, uint64_t card_id)
+{
+    if (registry == NULL) {
+        return NULL;
+    }
+
+    struct SessionManager *owner = NULL;
+    hr_mutex_lock(&registry->table_lock);
+    const size_t bucket = registry_find(registry, card_id);
+    const uint32_t tag = registry->owners[bucket];
+    if (tag != REGISTRY_NO_OWNER) {
+        owner = registry->sessions[tag - 1u].manager;
+    }
+    hr_mutex_unlock(&registry->table_lock);
+    return owner;
+}
+
+size_t session_registry_claimed(struct HrSessionRegistry *registry, const struct SessionManager *manager)
+{
+    RegistrySession *session = registry_lookup(registry, manager);
+    if (session == NULL) {
+        return 0u;
+    }
+
+    hr_mutex_lock(&registry->table_lock);
+    const size_t claimed = session->claimed;
+    hr_mutex_unlock(&registry->table_lock);
+    return claimed;
+}
@@ -0,0 +1,76 @@
+#ifndef HYPERRECALL_SESSION_REGISTRY_H
+#define HYPERRECALL_SESSION_REGISTRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file session_registry.h
+ * @brief Runs several study sessions side by side over one card ownership table.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sessions.h"
+
+/** Largest number of sessions a registry keeps open at once. */
+#define HR_SESSION_REGISTRY_MAX_SESSIONS 8U
+
+struct HrSessionRegistry;
+
+/**
+ * Creates a registry whose sessions share @p shared_callbacks (copied).
+ *
+ * Every session opened from the registry claims its cards in a common
+ * ownership table, so a card queued in one session is skipped by the others
+ * until it is graded or the session ends; a session holding several copies
+ * of a card keeps it until the last copy is gone. The shared callbacks are invoked
+ * under a single writer lock, so reviews from different sessions reach the
+ * database and analytics one at a time.
+ */
+struct HrSessionRegistry *session_registry_create(const SessionCallbacks *shared_callbacks);
+
+/** Closes every session still open and frees the registry. */
+void session_registry_destroy(struct HrSessionRegistry *registry);
+
+/**
+ * Creates a session manager wired to the ownership table and the serialized
+ * callbacks. Scheduler configuration is left to the caller. Returns NULL when
+ * HR_SESSION_REGISTRY_MAX_SESSIONS sessions are already open.
+ */
+struct SessionManager *session_registry_open(struct HrSessionRegistry *registry);
+
+/**
+ * Traces every session, open now or later, into @p ring (NULL stops tracing).
+ * Records are tagged with the session's slot number, starting at 1.
+ */
+void session_registry_set_trace_ring(struct HrSessionRegistry *registry, struct HrTraceRing *ring);
+
+/** Ends and destroys a session opened by this registry, releasing its cards. */
+void session_registry_close(struct HrSessionRegistry *registry, struct SessionManager *manager);
+
+/**
+ * Copies the callbacks installed on @p manager. Consumers that reinstall
+ * callbacks must start from this set to keep persistence serialized.
+ */
+bool session_registry_callbacks(const struct HrSessionRegistry *registry,
+                                const struct SessionManager *manager,
+                                SessionCallbacks *out_callbacks);
+
+/** Number of sessions currently open. */
+size_t session_registry_count(const struct HrSessionRegistry *registry);
+
+/** Returns the session currently serving @p card_id, or NULL when it is free. */
+struct SessionManager *session_registry_owner(struct HrSessionRegistry *registry, uint64_t card_id);
+
+/** Number of cards @p manager holds in the ownership table. */
+size_t session_registry_claimed(struct HrSessionRegistry *registry, const struct SessionManager *manager);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_SESSION_REGISTRY_H */
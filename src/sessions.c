@@ -4,10 +4,65 @@
 #include <string.h>
 #include <time.h>
 
+#include "span_trace.h"
+#include "trace_ring.h"
+
+#define SESSION_SECONDS_PER_DAY 86400
+#define SESSION_NO_INDEX ((size_t)-1)
+
 typedef struct SessionCardEntry {
     SessionCard card;
+    time_t serve_at;   /* Heap key: when the card should next be shown. */
+    uint64_t sequence; /* Tie-breaker keeping insertion order among equal keys. */
+    size_t heap_index; /* Position in the heap while queued, kept by the sift helpers. */
+    char topic_id[SESSION_MAX_KEY_LENGTH];    /* Owned copies used by streamed sessions, */
+    char sibling_key[SESSION_MAX_KEY_LENGTH]; /* whose source reuses its spec buffers. */
 } SessionCardEntry;
 
+/** Open-addressing map from a borrowed identifier to a dense group number. */
+typedef struct SessionKeyIndex {
+    const char **keys;
+    size_t *groups;
+    size_t capacity;
+    size_t group_count;
+} SessionKeyIndex;
+
+/** Sibling identifiers reviewed on the current UTC day (owned copies). */
+typedef struct SessionSiblingLog {
+    char **keys;
+    size_t capacity;
+    size_t count;
+    int64_t day;
+} SessionSiblingLog;
+
+/** Topic group waiting out its separation window. */
+typedef struct SessionCooldown {
+    size_t group;
+    size_t release_position;
+} SessionCooldown;
+
+/** Snapshot taken before a grade so it can be reverted. */
+typedef struct SessionUndoEntry {
+    SessionCardEntry before;  /* Card and heap key as they were before the grade. */
+    size_t slot;              /* Queue slot the card occupied. */
+    bool requeued;            /* Card stayed in the heap rather than being popped. */
+    time_t graded_due;        /* Due date the grade produced (for the load balancer). */
+    int64_t review_id;
+    SRSReviewRating rating;
+    SRSReviewContext context;
+    SRSReviewResult result;
+    bool simulated;
+    bool first_review;
+    uint32_t answer_ms;
+} SessionUndoEntry;
+
+typedef struct SessionRedoEntry {
+    uint64_t card_id;
+    SRSReviewRating rating;
+    SRSReviewContext context;
+    uint32_t answer_ms;
+} SessionRedoEntry;
+
 struct SessionManager {
     SRSConfig config;
     SRSCalibrationHooks calibration_hooks;
@@ -16,33 +71,101 @@ struct SessionManager {
     SRSCallbacks srs_callbacks;
     bool srs_callbacks_enabled;
 
+    srs_review_fn review_fn; /* Scheduler variant resolved when the session begins. */
+
     SessionCallbacks callbacks;
+    SessionOwnership ownership;
+
+    SRSLoadBalancer *load_balancer;
+
+    SessionSpacingConfig spacing;
+    SessionSiblingLog reviewed_siblings;
 
-    SessionCardEntry *queue;
+    SessionCardEntry *queue; /* Card storage; serving order lives in @c heap. */
     size_t queue_count;
-    size_t queue_index;
+    size_t *heap;            /* Min-heap of queue indices keyed on (serve_at, sequence). */
+    size_t heap_count;
+    uint64_t next_sequence;
+    size_t served_count;
+    double relearn_horizon_minutes;
+
+    bool streaming;             /* Queue is paged in from @c source. */
+    bool source_exhausted;
+    SessionCardSource source;
+    SessionCardSpec *page_specs; /* Scratch buffers sized to one page. */
+    SessionCardEntry *page_entries;
+    size_t *free_slots;         /* Queue slots available for the next page. */
+    size_t free_count;
+    time_t stream_key_floor;    /* Largest heap key handed to a streamed card so far. */
+
+    SessionUndoEntry undo_ring[SESSION_UNDO_DEPTH];
+    size_t undo_head;
+    size_t undo_count;
+    SessionRedoEntry redo_stack[SESSION_UNDO_DEPTH];
+    size_t redo_count;
+    bool replaying; /* Set while session_manager_redo() re-grades a card. */
+    uint32_t pending_answer_ms; /* Reported by the next grade. */
 
     SessionMode mode;
     bool in_session;
 
-#if HYPERRECALL_ENABLE_DEVTOOLS
-    SessionReviewEvent *trace_frames;
-    size_t trace_count;
-    size_t trace_capacity;
-#endif
+    struct HrTraceRing *trace_ring; /* Shared review trace (optional, not owned). */
+    uint16_t trace_source;
 };
 
+static bool session_claim_card(struct SessionManager *manager, uint64_t card_id)
+{
+    return manager->ownership.claim == NULL ||
+           manager->ownership.claim(card_id, manager->ownership.user_data);
+}
+
+static void session_release_card(struct SessionManager *manager, uint64_t card_id)
+{
+    if (manager->ownership.release != NULL) {
+        manager->ownership.release(card_id, manager->ownership.user_data);
+    }
+}
+
 static void session_manager_reset_queue(struct SessionManager *manager)
 {
     if (manager == NULL) {
         return;
     }
 
+    if (manager->queue != NULL && manager->heap != NULL) {
+        for (size_t i = 0; i < manager->heap_count; ++i) {
+            session_release_card(manager, manager->queue[manager->heap[i]].card.card_id);
+        }
+    }
+
     free(manager->queue);
     manager->queue = NULL;
     manager->queue_count = 0u;
-    manager->queue_index = 0u;
+    free(manager->heap);
+    manager->heap = NULL;
+    manager->heap_count = 0u;
+    manager->next_sequence = 0u;
+    manager->served_count = 0u;
     manager->in_session = false;
+
+    free(manager->page_specs);
+    manager->page_specs = NULL;
+    free(manager->page_entries);
+    manager->page_entries = NULL;
+    free(manager->free_slots);
+    manager->free_slots = NULL;
+    manager->free_count = 0u;
+    if (manager->source.close != NULL) {
+        manager->source.close(manager->source.user_data);
+    }
+    memset(&manager->source, 0, sizeof(manager->source));
+    manager->streaming = false;
+    manager->source_exhausted = false;
+    manager->stream_key_floor = 0;
+
+    manager->undo_head = 0u;
+    manager->undo_count = 0u;
+    manager->redo_count = 0u;
 }
 
 static void session_card_from_spec(SessionCard *card,
@@ -56,6 +179,7 @@ static void session_card_from_spec(SessionCard *card,
     memset(card, 0, sizeof(*card));
     card->card_id = (spec != NULL) ? spec->card_id : 0u;
     card->user_data = (spec != NULL) ? spec->user_data : NULL;
+    card->sibling_key = (spec != NULL) ? spec->sibling_key : NULL;
 
     SRSTopicContext topic = {0};
     if (spec != NULL && spec->has_topic) {
@@ -117,6 +241,540 @@ static int compare_due_time(const void *lhs, const void *rhs)
     return (due_a < due_b) ? -1 : 1;
 }
 
+static size_t session_hash_key(const char *key)
+{
+    /* FNV-1a; identifiers are short UUID-style strings. */
+    uint64_t hash = 1469598103934665603ull;
+    for (const unsigned char *cursor = (const unsigned char *)key; *cursor != '\0'; ++cursor) {
+        hash ^= (uint64_t)*cursor;
+        hash *= 1099511628211ull;
+    }
+    return (size_t)hash;
+}
+
+static size_t session_table_capacity(size_t expected)
+{
+    size_t capacity = 16u;
+    while (capacity < expected * 2u) {
+        capacity <<= 1u;
+    }
+    return capacity;
+}
+
+static bool session_key_index_init(SessionKeyIndex *index, size_t expected)
+{
+    memset(index, 0, sizeof(*index));
+    index->capacity = session_table_capacity(expected);
+    index->keys = (const char **)calloc(index->capacity, sizeof(const char *));
+    index->groups = (size_t *)calloc(index->capacity, sizeof(size_t));
+    if (index->keys == NULL || index->groups == NULL) {
+        free(index->keys);
+        free(index->groups);
+        memset(index, 0, sizeof(*index));
+        return false;
+    }
+    return true;
+}
+
+static void session_key_index_release(SessionKeyIndex *index)
+{
+    free(index->keys);
+    free(index->groups);
+    memset(index, 0, sizeof(*index));
+}
+
+/* Returns the group for @p key, assigning the next group number on first sight. */
+static size_t session_key_index_group(SessionKeyIndex *index, const char *key, bool *out_inserted)
+{
+    const size_t mask = index->capacity - 1u;
+    size_t slot = session_hash_key(key) & mask;
+    while (index->keys[slot] != NULL) {
+        if (strcmp(index->keys[slot], key) == 0) {
+            *out_inserted = false;
+            return index->groups[slot];
+        }
+        slot = (slot + 1u) & mask;
+    }
+
+    index->keys[slot] = key;
+    index->groups[slot] = index->group_count++;
+    *out_inserted = true;
+    return index->groups[slot];
+}
+
+static void session_sibling_log_clear(SessionSiblingLog *log)
+{
+    if (log->keys != NULL) {
+        for (size_t i = 0; i < log->capacity; ++i) {
+            free(log->keys[i]);
+        }
+    }
+    free(log->keys);
+    log->keys = NULL;
+    log->capacity = 0u;
+    log->count = 0u;
+}
+
+static bool session_sibling_log_contains(const SessionSiblingLog *log, const char *key)
+{
+    if (log->count == 0u) {
+        return false;
+    }
+
+    const size_t mask = log->capacity - 1u;
+    size_t slot = session_hash_key(key) & mask;
+    while (log->keys[slot] != NULL) {
+        if (strcmp(log->keys[slot], key) == 0) {
+            return true;
+        }
+        slot = (slot + 1u) & mask;
+    }
+    return false;
+}
+
+static void session_sibling_log_place(char **keys, size_t capacity, char *key)
+{
+    const size_t mask = capacity - 1u;
+    size_t slot = session_hash_key(key) & mask;
+    while (keys[slot] != NULL) {
+        slot = (slot + 1u) & mask;
+    }
+    keys[slot] = key;
+}
+
+static void session_sibling_log_insert(SessionSiblingLog *log, const char *key)
+{
+    if (session_sibling_log_contains(log, key)) {
+        return;
+    }
+
+    if ((log->count + 1u) * 2u > log->capacity) {
+        const size_t capacity = session_table_capacity(log->count + 1u);
+        char **keys = (char **)calloc(capacity, sizeof(char *));
+        if (keys == NULL) {
+            return;
+        }
+        for (size_t i = 0; i < log->capacity; ++i) {
+            if (log->keys[i] != NULL) {
+                session_sibling_log_place(keys, capacity, log->keys[i]);
+            }
+        }
+        free(log->keys);
+        log->keys = keys;
+        log->capacity = capacity;
+    }
+
+    const size_t length = strlen(key);
+    char *copy = (char *)malloc(length + 1u);
+    if (copy == NULL) {
+        return;
+    }
+    memcpy(copy, key, length + 1u);
+    session_sibling_log_place(log->keys, log->capacity, copy);
+    log->count++;
+}
+
+static void session_sibling_log_roll(SessionSiblingLog *log, time_t now)
+{
+    const int64_t day = (int64_t)now / SESSION_SECONDS_PER_DAY;
+    if (log->day != day) {
+        session_sibling_log_clear(log);
+        log->day = day;
+    }
+}
+
+/*
+ * Keeps the first card of every sibling group and leaves the rest out of
+ * the queue, handing them back to the ownership hooks. Cards whose sibling
+ * was already reviewed today are left out as well. Their stored due dates
+ * are not touched.
+ */
+static size_t session_bury_siblings(struct SessionManager *manager,
+                                    SessionCardEntry *entries,
+                                    size_t count)
+{
+    SessionKeyIndex index;
+    if (!session_key_index_init(&index, count)) {
+        return count;
+    }
+
+    size_t kept = 0u;
+    for (size_t i = 0; i < count; ++i) {
+        const char *key = entries[i].card.sibling_key;
+        bool first = true;
+        if (key != NULL && key[0] != '\0') {
+            (void)session_key_index_group(&index, key, &first);
+            if (first && session_sibling_log_contains(&manager->reviewed_siblings, key)) {
+                first = false;
+            }
+        }
+
+        if (first) {
+            entries[kept++] = entries[i];
+        } else {
+            session_release_card(manager, entries[i].card.card_id);
+        }
+    }
+
+    session_key_index_release(&index);
+    return kept;
+}
+
+static void session_group_heap_push(size_t *heap, size_t *size, const size_t *head, size_t group)
+{
+    size_t index = (*size)++;
+    heap[index] = group;
+    while (index > 0u) {
+        const size_t parent = (index - 1u) / 2u;
+        if (head[heap[parent]] <= head[heap[index]]) {
+            break;
+        }
+        const size_t tmp = heap[parent];
+        heap[parent] = heap[index];
+        heap[index] = tmp;
+        index = parent;
+    }
+}
+
+static size_t session_group_heap_pop(size_t *heap, size_t *size, const size_t *head)
+{
+    const size_t top = heap[0];
+    heap[0] = heap[--(*size)];
+    size_t index = 0u;
+    for (;;) {
+        const size_t left = index * 2u + 1u;
+        const size_t right = left + 1u;
+        size_t smallest = index;
+        if (left < *size && head[heap[left]] < head[heap[smallest]]) {
+            smallest = left;
+        }
+        if (right < *size && head[heap[right]] < head[heap[smallest]]) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        const size_t tmp = heap[smallest];
+        heap[smallest] = heap[index];
+        heap[index] = tmp;
+        index = smallest;
+    }
+    return top;
+}
+
+/*
+ * Reorders @p entries so same-topic cards sit at least @p separation cards
+ * apart while otherwise preserving the incoming order. Ready topics live in a
+ * min-heap keyed on the queue position of their next card and topics that were
+ * just served wait in a FIFO until their window passes, giving O(n log n).
+ * When every remaining topic is cooling down the earliest one is released
+ * early rather than stalling the queue.
+ */
+static void session_spread_topics(SessionCardEntry *entries, size_t count, size_t separation)
+{
+    SessionKeyIndex index;
+    if (!session_key_index_init(&index, count)) {
+        return;
+    }
+
+    size_t *next = (size_t *)malloc(count * sizeof(size_t));
+    size_t *head = (size_t *)malloc(count * sizeof(size_t));
+    size_t *tail = (size_t *)malloc(count * sizeof(size_t));
+    size_t *heap = (size_t *)malloc(count * sizeof(size_t));
+    SessionCooldown *cooldown = (SessionCooldown *)malloc(count * sizeof(SessionCooldown));
+    SessionCardEntry *ordered = (SessionCardEntry *)malloc(count * sizeof(SessionCardEntry));
+    if (next != NULL && head != NULL && tail != NULL && heap != NULL &&
+        cooldown != NULL && ordered != NULL) {
+        for (size_t i = 0; i < count; ++i) {
+            const char *topic = entries[i].card.topic.topic_id;
+            bool inserted = true;
+            size_t group;
+            if (topic != NULL && topic[0] != '\0') {
+                group = session_key_index_group(&index, topic, &inserted);
+            } else {
+                group = index.group_count++;
+            }
+
+            next[i] = SESSION_NO_INDEX;
+            if (inserted) {
+                head[group] = i;
+            } else {
+                next[tail[group]] = i;
+            }
+            tail[group] = i;
+        }
+
+        size_t heap_size = 0u;
+        for (size_t group = 0; group < index.group_count; ++group) {
+            session_group_heap_push(heap, &heap_size, head, group);
+        }
+
+        size_t cooldown_front = 0u;
+        size_t cooldown_back = 0u;
+        for (size_t position = 0; position < count; ++position) {
+            while (cooldown_front < cooldown_back && cooldown[cooldown_front].release_position <= position) {
+                session_group_heap_push(heap, &heap_size, head, cooldown[cooldown_front++].group);
+            }
+            if (heap_size == 0u) {
+                session_group_heap_push(heap, &heap_size, head, cooldown[cooldown_front++].group);
+            }
+
+            const size_t group = session_group_heap_pop(heap, &heap_size, head);
+            const size_t card = head[group];
+            ordered[position] = entries[card];
+
+            head[group] = next[card];
+            if (head[group] != SESSION_NO_INDEX) {
+                cooldown[cooldown_back].group = group;
+                cooldown[cooldown_back].release_position = position + separation + 1u;
+                cooldown_back++;
+            }
+        }
+
+        memcpy(entries, ordered, count * sizeof(SessionCardEntry));
+    }
+
+    free(next);
+    free(head);
+    free(tail);
+    free(heap);
+    free(cooldown);
+    free(ordered);
+    session_key_index_release(&index);
+}
+
+/*
+ * Drops cards another session is already serving and claims the rest, so a
+ * card is never queued in two sessions at once.
+ */
+static size_t session_claim_entries(struct SessionManager *manager,
+                                    SessionCardEntry *entries,
+                                    size_t count)
+{
+    if (manager->ownership.claim == NULL) {
+        return count;
+    }
+
+    size_t kept = 0u;
+    for (size_t i = 0; i < count; ++i) {
+        if (session_claim_card(manager, entries[i].card.card_id)) {
+            entries[kept++] = entries[i];
+        }
+    }
+    return kept;
+}
+
+static size_t session_apply_spacing(struct SessionManager *manager,
+                                    SessionCardEntry *entries,
+                                    size_t count)
+{
+    if (!manager->spacing.enabled || count < 2u) {
+        return count;
+    }
+
+    const time_t now = time(NULL);
+    session_sibling_log_roll(&manager->reviewed_siblings, now);
+
+    if (manager->spacing.bury_siblings) {
+        count = session_bury_siblings(manager, entries, count);
+    }
+    if (manager->spacing.topic_separation > 0u && count > 1u) {
+        session_spread_topics(entries, count, manager->spacing.topic_separation);
+    }
+    return count;
+}
+
+static void session_default_spacing(SessionSpacingConfig *spacing)
+{
+    spacing->enabled = true;
+    spacing->bury_siblings = true;
+    spacing->topic_separation = SESSION_DEFAULT_TOPIC_SEPARATION;
+}
+
+static bool session_entry_before(const SessionCardEntry *a, const SessionCardEntry *b)
+{
+    if (a->serve_at != b->serve_at) {
+        return a->serve_at < b->serve_at;
+    }
+    return a->sequence < b->sequence;
+}
+
+static void session_heap_swap(struct SessionManager *manager, size_t a, size_t b)
+{
+    size_t *heap = manager->heap;
+    const size_t tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+    manager->queue[heap[a]].heap_index = a;
+    manager->queue[heap[b]].heap_index = b;
+}
+
+/* Both sifts also record the final position of the entry they started with. */
+static void session_heap_sift_up(struct SessionManager *manager, size_t index)
+{
+    size_t *heap = manager->heap;
+    while (index > 0u) {
+        const size_t parent = (index - 1u) / 2u;
+        if (!session_entry_before(&manager->queue[heap[index]], &manager->queue[heap[parent]])) {
+            break;
+        }
+        session_heap_swap(manager, parent, index);
+        index = parent;
+    }
+    manager->queue[heap[index]].heap_index = index;
+}
+
+static void session_heap_sift_down(struct SessionManager *manager, size_t index)
+{
+    size_t *heap = manager->heap;
+    const size_t count = manager->heap_count;
+    for (;;) {
+        const size_t left = index * 2u + 1u;
+        const size_t right = left + 1u;
+        size_t first = index;
+        if (left < count && session_entry_before(&manager->queue[heap[left]], &manager->queue[heap[first]])) {
+            first = left;
+        }
+        if (right < count && session_entry_before(&manager->queue[heap[right]], &manager->queue[heap[first]])) {
+            first = right;
+        }
+        if (first == index) {
+            break;
+        }
+        session_heap_swap(manager, first, index);
+        index = first;
+    }
+    manager->queue[heap[index]].heap_index = index;
+}
+
+static int compare_time_values(const void *lhs, const void *rhs)
+{
+    const time_t a = *(const time_t *)lhs;
+    const time_t b = *(const time_t *)rhs;
+    return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+/*
+ * Seeds heap keys for a freshly built queue. Position i receives the i-th
+ * smallest due time, so the keys are monotonic in queue order (the sorted
+ * and spaced order is served unchanged) while relearning cards re-inserted
+ * later still interleave by their real due time.
+ */
+static bool session_heap_build(struct SessionManager *manager)
+{
+    const size_t count = manager->queue_count;
+    manager->heap = (size_t *)malloc(count * sizeof(size_t));
+    time_t *dues = (time_t *)malloc(count * sizeof(time_t));
+    if (manager->heap == NULL || dues == NULL) {
+        free(manager->heap);
+        manager->heap = NULL;
+        free(dues);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        dues[i] = manager->queue[i].card.state.due;
+    }
+    qsort(dues, count, sizeof(time_t), compare_time_values);
+
+    for (size_t i = 0; i < count; ++i) {
+        manager->queue[i].serve_at = dues[i];
+        manager->queue[i].sequence = manager->next_sequence++;
+        manager->queue[i].heap_index = i;
+        manager->heap[i] = i;
+    }
+    manager->heap_count = count;
+
+    free(dues);
+    return true;
+}
+
+static void session_copy_key(char *storage, const char *key)
+{
+    if (key == NULL) {
+        storage[0] = '\0';
+        return;
+    }
+    size_t length = 0u;
+    while (length + 1u < SESSION_MAX_KEY_LENGTH && key[length] != '\0') {
+        ++length;
+    }
+    memcpy(storage, key, length);
+    storage[length] = '\0';
+}
+
+/* Points a streamed card's identifiers at the copies held in its own slot. */
+static void session_entry_own_keys(SessionCardEntry *entry)
+{
+    entry->card.topic.topic_id = (entry->topic_id[0] != '\0') ? entry->topic_id : NULL;
+    entry->card.sibling_key = (entry->sibling_key[0] != '\0') ? entry->sibling_key : NULL;
+    if (entry->card.has_custom_context) {
+        entry->card.custom_context.topic.topic_id = entry->card.topic.topic_id;
+    }
+}
+
+/*
+ * Pulls the next page from the card source into free queue slots. Each page
+ * gets its own spacing pass and is keyed after everything streamed before it,
+ * so pages are served in source order.
+ */
+static void session_stream_refill(struct SessionManager *manager)
+{
+    if (!manager->streaming || manager->source_exhausted || manager->free_count == 0u) {
+        return;
+    }
+
+    HR_SPAN_BEGIN(span, "session.refill");
+    size_t want = manager->source.page_size;
+    if (want > manager->free_count) {
+        want = manager->free_count;
+    }
+
+    SessionCardEntry *page = manager->page_entries;
+    size_t produced = 0u;
+    /* Keep pulling while whole pages are owned by other sessions. */
+    while (produced == 0u) {
+        memset(manager->page_specs, 0, want * sizeof(SessionCardSpec));
+        produced = manager->source.fetch(manager->source.user_data, manager->page_specs, want);
+        if (produced == 0u) {
+            manager->source_exhausted = true;
+            HR_SPAN_END(span);
+            return;
+        }
+        if (produced > want) {
+            produced = want;
+        }
+
+        for (size_t i = 0; i < produced; ++i) {
+            session_card_from_spec(&page[i].card, &manager->page_specs[i], &manager->config);
+        }
+        produced = session_claim_entries(manager, page, produced);
+    }
+
+    produced = session_apply_spacing(manager, page, produced);
+
+    for (size_t i = 0; i < produced; ++i) {
+        const size_t slot = manager->free_slots[--manager->free_count];
+        SessionCardEntry *entry = &manager->queue[slot];
+        entry->card = page[i].card;
+
+        session_copy_key(entry->topic_id, page[i].card.topic.topic_id);
+        session_copy_key(entry->sibling_key, page[i].card.sibling_key);
+        session_entry_own_keys(entry);
+
+        if (entry->card.state.due > manager->stream_key_floor) {
+            manager->stream_key_floor = entry->card.state.due;
+        }
+        entry->serve_at = manager->stream_key_floor;
+        entry->sequence = manager->next_sequence++;
+
+        manager->heap[manager->heap_count] = slot;
+        session_heap_sift_up(manager, manager->heap_count);
+        manager->heap_count++;
+    }
+    HR_SPAN_END(span);
+}
+
 static SRSReviewContext session_compose_context(struct SessionManager *manager,
                                                 const SessionCard *card,
                                                 const SRSReviewContext *override_context)
@@ -178,6 +836,36 @@ static SRSReviewContext session_compose_context(struct SessionManager *manager,
     return context;
 }
 
+static uint32_t session_trace_clamp(size_t value)
+{
+    return (value > (size_t)UINT32_MAX) ? UINT32_MAX : (uint32_t)value;
+}
+
+/* Flattens the event onto the stack; the ring copies it without allocating. */
+static void session_trace_event(struct SessionManager *manager, const SessionReviewEvent *event)
+{
+    HrTraceRecord record;
+    record.sequence = 0u;
+    record.card_id = event->card_id;
+    record.review_id = event->review_id;
+    record.review_time = (int64_t)event->result.review_time;
+    record.due = (int64_t)event->result.due;
+    record.previous_interval_days = event->result.previous_interval_days;
+    record.interval_days = event->result.interval_days;
+    record.ease_factor = event->result.applied_ease_factor;
+    record.queue_position = session_trace_clamp(event->queue_position);
+    record.remaining = session_trace_clamp(event->remaining);
+    record.source = manager->trace_source;
+    record.mode = (uint8_t)event->mode;
+    record.rating = (uint8_t)event->result.rating;
+    record.flags = (uint8_t)((event->simulated ? HR_TRACE_FLAG_SIMULATED : 0u) |
+                             (event->first_review ? HR_TRACE_FLAG_FIRST_REVIEW : 0u) |
+                             (event->requeued ? HR_TRACE_FLAG_REQUEUED : 0u) |
+                             (event->undone ? HR_TRACE_FLAG_UNDONE : 0u) |
+                             (event->result.used_cram ? HR_TRACE_FLAG_USED_CRAM : 0u));
+    trace_ring_record(manager->trace_ring, &record);
+}
+
 static void session_emit_callbacks(struct SessionManager *manager,
                                    const SessionReviewEvent *event)
 {
@@ -196,21 +884,17 @@ static void session_emit_callbacks(struct SessionManager *manager,
     if (manager->callbacks.devtools_event != NULL) {
         manager->callbacks.devtools_event(event, manager->callbacks.devtools_user_data);
     }
+#endif
 
-    if (manager->trace_count == manager->trace_capacity) {
-        size_t new_capacity = (manager->trace_capacity == 0u) ? 16u : (manager->trace_capacity * 2u);
-        SessionReviewEvent *resized = (SessionReviewEvent *)realloc(manager->trace_frames,
-                                                                    new_capacity * sizeof(SessionReviewEvent));
-        if (resized != NULL) {
-            manager->trace_frames = resized;
-            manager->trace_capacity = new_capacity;
-        }
+    if (manager->trace_ring != NULL) {
+        session_trace_event(manager, event);
     }
+}
 
-    if (manager->trace_count < manager->trace_capacity && manager->trace_frames != NULL) {
-        manager->trace_frames[manager->trace_count++] = *event;
-    }
-#endif
+static void session_manager_select_review_fn(struct SessionManager *manager)
+{
+    manager->review_fn = srs_select_review_fn(manager->calibration_enabled ? &manager->calibration_hooks : NULL,
+                                              manager->srs_callbacks_enabled ? &manager->srs_callbacks : NULL);
 }
 
 struct SessionManager *session_manager_create(void)
@@ -226,14 +910,14 @@ struct SessionManager *session_manager_create(void)
     memset(&manager->srs_callbacks, 0, sizeof(manager->srs_callbacks));
     manager->srs_callbacks_enabled = false;
     memset(&manager->callbacks, 0, sizeof(manager->callbacks));
+    manager->load_balancer = NULL;
+    manager->relearn_horizon_minutes = SESSION_DEFAULT_RELEARN_HORIZON_MINUTES;
+    session_manager_select_review_fn(manager);
+    session_default_spacing(&manager->spacing);
     manager->mode = SESSION_MODE_MASTERY;
     manager->in_session = false;
-
-#if HYPERRECALL_ENABLE_DEVTOOLS
-    manager->trace_frames = NULL;
-    manager->trace_count = 0u;
-    manager->trace_capacity = 0u;
-#endif
+    manager->trace_ring = NULL;
+    manager->trace_source = 0u;
 
     return manager;
 }
@@ -245,14 +929,7 @@ void session_manager_destroy(struct SessionManager *manager)
     }
 
     session_manager_end(manager);
-
-#if HYPERRECALL_ENABLE_DEVTOOLS
-    free(manager->trace_frames);
-    manager->trace_frames = NULL;
-    manager->trace_count = 0u;
-    manager->trace_capacity = 0u;
-#endif
-
+    session_sibling_log_clear(&manager->reviewed_siblings);
     free(manager);
 }
 
@@ -283,6 +960,8 @@ void session_manager_set_calibration(struct SessionManager *manager,
         memset(&manager->calibration_hooks, 0, sizeof(manager->calibration_hooks));
         manager->calibration_enabled = false;
     }
+
+    session_manager_select_review_fn(manager);
 }
 
 void session_manager_set_srs_callbacks(struct SessionManager *manager,
@@ -299,6 +978,55 @@ void session_manager_set_srs_callbacks(struct SessionManager *manager,
         memset(&manager->srs_callbacks, 0, sizeof(manager->srs_callbacks));
         manager->srs_callbacks_enabled = false;
     }
+
+    session_manager_select_review_fn(manager);
+}
+
+void session_manager_set_load_balancer(struct SessionManager *manager,
+                                       SRSLoadBalancer *balancer)
+{
+    if (manager == NULL) {
+        return;
+    }
+
+    manager->load_balancer = balancer;
+}
+
+void session_manager_set_spacing(struct SessionManager *manager,
+                                 const SessionSpacingConfig *spacing)
+{
+    if (manager == NULL) {
+        return;
+    }
+
+    if (spacing != NULL) {
+        manager->spacing = *spacing;
+    } else {
+        session_default_spacing(&manager->spacing);
+    }
+}
+
+void session_manager_set_relearn_horizon(struct SessionManager *manager, double minutes)
+{
+    if (manager == NULL) {
+        return;
+    }
+
+    manager->relearn_horizon_minutes = (minutes > 0.0) ? minutes : 0.0;
+}
+
+void session_manager_set_ownership(struct SessionManager *manager,
+                                   const SessionOwnership *ownership)
+{
+    if (manager == NULL) {
+        return;
+    }
+
+    if (ownership != NULL) {
+        manager->ownership = *ownership;
+    } else {
+        memset(&manager->ownership, 0, sizeof(manager->ownership));
+    }
 }
 
 void session_manager_set_callbacks(struct SessionManager *manager,
@@ -315,22 +1043,20 @@ void session_manager_set_callbacks(struct SessionManager *manager,
     }
 }
 
-bool session_manager_begin(struct SessionManager *manager,
-                           SessionMode mode,
-                           const SessionCardSpec *cards,
-                           size_t count)
+static bool session_manager_begin_queue(struct SessionManager *manager,
+                                        SessionMode mode,
+                                        const SessionCardSpec *cards,
+                                        size_t count,
+                                        bool sort_by_due)
 {
     if (manager == NULL) {
         return false;
     }
 
-#if HYPERRECALL_ENABLE_DEVTOOLS
-    session_manager_trace_clear(manager);
-#endif
-
     session_manager_reset_queue(manager);
 
     manager->mode = mode;
+    session_manager_select_review_fn(manager);
 
     if (count == 0u) {
         manager->in_session = false;
@@ -350,15 +1076,92 @@ bool session_manager_begin(struct SessionManager *manager,
         session_card_from_spec(&entries[i].card, &cards[i], &manager->config);
     }
 
-    if (mode != SESSION_MODE_CUSTOM) {
+    count = session_claim_entries(manager, entries, count);
+
+    if (sort_by_due) {
         qsort(entries, count, sizeof(SessionCardEntry), compare_due_time);
     }
 
+    count = session_apply_spacing(manager, entries, count);
+
     manager->queue = entries;
     manager->queue_count = count;
-    manager->queue_index = 0u;
-    manager->in_session = (count > 0u);
+    if (count > 0u && !session_heap_build(manager)) {
+        for (size_t i = 0; i < count; ++i) {
+            session_release_card(manager, entries[i].card.card_id);
+        }
+        session_manager_reset_queue(manager);
+        return false;
+    }
+    manager->in_session = (manager->heap_count > 0u);
+
+    return true;
+}
+
+bool session_manager_begin(struct SessionManager *manager,
+                           SessionMode mode,
+                           const SessionCardSpec *cards,
+                           size_t count)
+{
+    HR_SPAN_BEGIN(span, "session.begin");
+    const bool ok = session_manager_begin_queue(manager, mode, cards, count, mode != SESSION_MODE_CUSTOM);
+    HR_SPAN_END(span);
+    return ok;
+}
+
+bool session_manager_begin_ordered(struct SessionManager *manager,
+                                   SessionMode mode,
+                                   const SessionCardSpec *cards,
+                                   size_t count)
+{
+    HR_SPAN_BEGIN(span, "session.begin");
+    const bool ok = session_manager_begin_queue(manager, mode, cards, count, false);
+    HR_SPAN_END(span);
+    return ok;
+}
+
+bool session_manager_begin_stream(struct SessionManager *manager,
+                                  SessionMode mode,
+                                  const SessionCardSource *source)
+{
+    if (manager == NULL || source == NULL || source->fetch == NULL) {
+        return false;
+    }
+
+    session_manager_reset_queue(manager);
 
+    manager->mode = mode;
+    session_manager_select_review_fn(manager);
+
+    const size_t page_size = (source->page_size > 0u) ? source->page_size : SESSION_DEFAULT_PAGE_SIZE;
+    /* One page being studied plus one page of headroom for refills and re-queued cards. */
+    const size_t capacity = page_size * 2u;
+
+    manager->queue = (SessionCardEntry *)calloc(capacity, sizeof(SessionCardEntry));
+    manager->heap = (size_t *)malloc(capacity * sizeof(size_t));
+    manager->free_slots = (size_t *)malloc(capacity * sizeof(size_t));
+    manager->page_specs = (SessionCardSpec *)calloc(page_size, sizeof(SessionCardSpec));
+    manager->page_entries = (SessionCardEntry *)calloc(page_size, sizeof(SessionCardEntry));
+    if (manager->queue == NULL || manager->heap == NULL || manager->free_slots == NULL ||
+        manager->page_specs == NULL || manager->page_entries == NULL) {
+        session_manager_reset_queue(manager);
+        return false;
+    }
+
+    manager->queue_count = capacity;
+    for (size_t i = 0; i < capacity; ++i) {
+        manager->free_slots[i] = capacity - 1u - i;
+    }
+    manager->free_count = capacity;
+
+    manager->source = *source;
+    manager->source.page_size = page_size;
+    manager->streaming = true;
+    manager->source_exhausted = false;
+    manager->stream_key_floor = 0;
+
+    session_stream_refill(manager);
+    manager->in_session = (manager->heap_count > 0u);
     return true;
 }
 
@@ -377,11 +1180,11 @@ const SessionCard *session_manager_current(const struct SessionManager *manager)
         return NULL;
     }
 
-    if (manager->queue_index >= manager->queue_count) {
+    if (manager->heap_count == 0u) {
         return NULL;
     }
 
-    return &manager->queue[manager->queue_index].card;
+    return &manager->queue[manager->heap[0]].card;
 }
 
 SessionMode session_manager_mode(const struct SessionManager *manager)
@@ -398,11 +1201,78 @@ size_t session_manager_remaining(const struct SessionManager *manager)
         return 0u;
     }
 
-    if (manager->queue_index >= manager->queue_count) {
+    return manager->heap_count;
+}
+
+size_t session_manager_peek(const struct SessionManager *manager,
+                            uint64_t *out_card_ids,
+                            size_t capacity)
+{
+    if (manager == NULL || !manager->in_session || out_card_ids == NULL || capacity == 0u) {
         return 0u;
     }
+    if (capacity > SESSION_MAX_PEEK) {
+        capacity = SESSION_MAX_PEEK;
+    }
+
+    /*
+     * Best-first walk of the heap: the next card is always the smallest key
+     * among the children of cards already listed, so only O(capacity) nodes
+     * are touched and the heap itself is left alone.
+     */
+    size_t frontier[SESSION_MAX_PEEK + 1u];
+    size_t frontier_count = 0u;
+    size_t produced = 0u;
+    if (manager->heap_count > 0u) {
+        frontier[frontier_count++] = 0u;
+    }
+
+    while (produced < capacity && frontier_count > 0u) {
+        size_t best = 0u;
+        for (size_t i = 1u; i < frontier_count; ++i) {
+            if (session_entry_before(&manager->queue[manager->heap[frontier[i]]],
+                                     &manager->queue[manager->heap[frontier[best]]])) {
+                best = i;
+            }
+        }
+
+        const size_t node = frontier[best];
+        frontier[best] = frontier[--frontier_count];
+        out_card_ids[produced++] = manager->queue[manager->heap[node]].card.card_id;
+
+        const size_t left = node * 2u + 1u;
+        if (left < manager->heap_count) {
+            frontier[frontier_count++] = left;
+        }
+        if (left + 1u < manager->heap_count) {
+            frontier[frontier_count++] = left + 1u;
+        }
+    }
+    return produced;
+}
+
+/* Claims the next undo slot, overwriting the oldest snapshot once the ring is full. */
+static SessionUndoEntry *session_undo_push(struct SessionManager *manager)
+{
+    size_t index;
+    if (manager->undo_count < SESSION_UNDO_DEPTH) {
+        index = (manager->undo_head + manager->undo_count) % SESSION_UNDO_DEPTH;
+        manager->undo_count++;
+    } else {
+        index = manager->undo_head;
+        manager->undo_head = (manager->undo_head + 1u) % SESSION_UNDO_DEPTH;
+    }
+
+    SessionUndoEntry *entry = &manager->undo_ring[index];
+    memset(entry, 0, sizeof(*entry));
+    return entry;
+}
 
-    return manager->queue_count - manager->queue_index;
+void session_manager_set_answer_time(struct SessionManager *manager, uint32_t answer_ms)
+{
+    if (manager != NULL) {
+        manager->pending_answer_ms = answer_ms;
+    }
 }
 
 bool session_manager_grade(struct SessionManager *manager,
@@ -414,12 +1284,15 @@ bool session_manager_grade(struct SessionManager *manager,
         return false;
     }
 
-    if (manager->queue_index >= manager->queue_count) {
+    if (manager->heap_count == 0u) {
         return false;
     }
 
-    SessionCardEntry *entry = &manager->queue[manager->queue_index];
+    HR_SPAN_BEGIN(span, "session.grade");
+    const size_t slot = manager->heap[0];
+    SessionCardEntry *entry = &manager->queue[slot];
     SessionCard *card = &entry->card;
+    const SessionCardEntry before = *entry;
 
     SRSReviewContext context = session_compose_context(manager, card, override_context);
 
@@ -427,102 +1300,721 @@ bool session_manager_grade(struct SessionManager *manager,
 
     SRSState working_state = card->state;
     SRSState *state_ptr = simulate_only ? &working_state : &card->state;
+    const time_t previous_due = working_state.due;
 
     const SRSCalibrationHooks *hooks = manager->calibration_enabled ? &manager->calibration_hooks : NULL;
     const SRSCallbacks *callbacks = manager->srs_callbacks_enabled ? &manager->srs_callbacks : NULL;
 
-    SRSReviewResult result = srs_apply_review(&manager->config,
-                                              state_ptr,
-                                              rating,
-                                              &context,
-                                              hooks,
-                                              callbacks);
+    /* The composed context is already normalised, as the specialised variants require. */
+    SRSReviewResult result = manager->review_fn(&manager->config,
+                                                state_ptr,
+                                                rating,
+                                                &context,
+                                                hooks,
+                                                callbacks);
 
     if (!simulate_only) {
         card->state = *state_ptr;
+        if (manager->load_balancer != NULL) {
+            srs_load_balancer_apply(manager->load_balancer,
+                                    &manager->config,
+                                    previous_due,
+                                    &card->state,
+                                    &result);
+        }
     }
 
+    /* Learning steps that fall due within the horizon are served again this session. */
+    const bool requeue = !simulate_only &&
+                         difftime(result.due, context.now) <= manager->relearn_horizon_minutes * 60.0;
+
     SessionReviewEvent event;
     memset(&event, 0, sizeof(event));
     event.card_id = card->card_id;
     event.mode = manager->mode;
     event.simulated = simulate_only;
-    event.queue_position = manager->queue_index;
-    event.remaining = (manager->queue_count > (manager->queue_index + 1u))
-                          ? (manager->queue_count - (manager->queue_index + 1u))
-                          : 0u;
+    event.first_review = (working_state.last_review == 0);
+    event.requeued = requeue;
+    event.queue_position = manager->served_count;
+    event.remaining = manager->heap_count - (requeue ? 0u : 1u);
     event.state = &card->state;
     event.context = context;
     event.result = result;
+    event.answer_ms = manager->pending_answer_ms;
 
     bool autosave_ok = true;
+    int64_t review_id = 0;
     SRSPersistedState persisted_state;
     memset(&persisted_state, 0, sizeof(persisted_state));
 
     if (!simulate_only) {
         srs_state_pack(&card->state, &persisted_state);
 
-        if (manager->callbacks.autosave_event != NULL) {
+        if (manager->callbacks.record_event != NULL) {
+            autosave_ok = manager->callbacks.record_event(&event,
+                                                          &persisted_state,
+                                                          &review_id,
+                                                          manager->callbacks.record_user_data);
+        }
+
+        if (autosave_ok && manager->callbacks.autosave_event != NULL) {
             autosave_ok = manager->callbacks.autosave_event(&event,
                                                             &persisted_state,
                                                             manager->callbacks.autosave_user_data);
+            if (!autosave_ok && review_id != 0 && manager->callbacks.revert_event != NULL) {
+                SRSPersistedState previous_state;
+                srs_state_pack(&working_state, &previous_state);
+                (void)manager->callbacks.revert_event(card->card_id,
+                                                      review_id,
+                                                      &previous_state,
+                                                      manager->callbacks.revert_user_data);
+            }
         }
     }
+    event.review_id = review_id;
 
     if (!autosave_ok) {
         /* Restore the previous state if persistence fails. */
+        if (manager->load_balancer != NULL) {
+            srs_load_balancer_remove(manager->load_balancer, card->state.due);
+            if (previous_due > 0) {
+                srs_load_balancer_add(manager->load_balancer, previous_due, 1u);
+            }
+        }
         card->state = working_state;
+        HR_SPAN_END(span);
         return false;
     }
 
+    if (!simulate_only && card->sibling_key != NULL && card->sibling_key[0] != '\0') {
+        session_sibling_log_roll(&manager->reviewed_siblings, context.now);
+        session_sibling_log_insert(&manager->reviewed_siblings, card->sibling_key);
+    }
+
     session_emit_callbacks(manager, &event);
 
     if (out_result != NULL) {
         *out_result = result;
     }
 
-    manager->queue_index += 1u;
-    if (manager->queue_index >= manager->queue_count) {
-        manager->in_session = false;
+    SessionUndoEntry *undo = session_undo_push(manager);
+    undo->before = before;
+    undo->slot = slot;
+    undo->requeued = requeue;
+    undo->graded_due = card->state.due;
+    undo->review_id = review_id;
+    undo->rating = rating;
+    undo->context = context;
+    undo->result = result;
+    undo->simulated = simulate_only;
+    undo->first_review = event.first_review;
+    undo->answer_ms = event.answer_ms;
+    manager->pending_answer_ms = 0u;
+    if (!manager->replaying) {
+        manager->redo_count = 0u;
     }
 
+    manager->served_count += 1u;
+    if (requeue) {
+        entry->serve_at = card->state.due;
+        entry->sequence = manager->next_sequence++;
+    } else {
+        if (manager->streaming) {
+            manager->free_slots[manager->free_count++] = manager->heap[0];
+        }
+        manager->heap[0] = manager->heap[--manager->heap_count];
+        session_release_card(manager, card->card_id);
+    }
+    if (manager->heap_count > 0u) {
+        session_heap_sift_down(manager, 0u);
+    }
+
+    if (manager->streaming && manager->heap_count <= manager->source.page_size / 2u) {
+        session_stream_refill(manager);
+    }
+    manager->in_session = (manager->heap_count > 0u);
+
+    HR_SPAN_END(span);
     return true;
 }
 
-#if HYPERRECALL_ENABLE_DEVTOOLS
-size_t session_manager_trace_count(const struct SessionManager *manager)
+/*
+ * Points the older undo entries of @p card_id at @p slot. A streamed card
+ * that left the queue can come back in a different slot, and the slot it
+ * had may hold another card by then.
+ */
+static void session_undo_reslot(struct SessionManager *manager, uint64_t card_id, size_t slot)
 {
-    if (manager == NULL) {
+    for (size_t i = 0; i + 1u < manager->undo_count; ++i) {
+        SessionUndoEntry *entry = &manager->undo_ring[(manager->undo_head + i) % SESSION_UNDO_DEPTH];
+        if (entry->before.card.card_id == card_id) {
+            entry->slot = slot;
+        }
+    }
+}
+
+bool session_manager_undo(struct SessionManager *manager, SessionReviewEvent *out_event)
+{
+    if (manager == NULL || manager->queue == NULL || manager->undo_count == 0u) {
+        return false;
+    }
+
+    const size_t index = (manager->undo_head + manager->undo_count - 1u) % SESSION_UNDO_DEPTH;
+    const SessionUndoEntry *undo = &manager->undo_ring[index];
+
+    /* Work out where the card goes back before touching any state. */
+    size_t slot = undo->slot;
+    size_t heap_index = manager->heap_count;
+    if (undo->requeued) {
+        /* The slot must still hold this card; anything else means the history no longer applies. */
+        heap_index = manager->queue[slot].heap_index;
+        if (heap_index >= manager->heap_count || manager->heap[heap_index] != slot ||
+            manager->queue[slot].card.card_id != undo->before.card.card_id) {
+            return false;
+        }
+    } else if (manager->streaming ? (manager->free_count == 0u)
+                                  : (manager->heap_count >= manager->queue_count)) {
+        return false;
+    } else if (!session_claim_card(manager, undo->before.card.card_id)) {
+        /* Another session picked the card up after it left this queue. */
+        return false;
+    }
+
+    if (!undo->simulated && undo->review_id != 0 && manager->callbacks.revert_event != NULL) {
+        SRSPersistedState previous_state;
+        srs_state_pack(&undo->before.card.state, &previous_state);
+        if (!manager->callbacks.revert_event(undo->before.card.card_id,
+                                             undo->review_id,
+                                             &previous_state,
+                                             manager->callbacks.revert_user_data)) {
+            if (!undo->requeued) {
+                session_release_card(manager, undo->before.card.card_id);
+            }
+            return false;
+        }
+    }
+
+    if (!undo->simulated && manager->load_balancer != NULL) {
+        srs_load_balancer_remove(manager->load_balancer, undo->graded_due);
+        if (undo->before.card.state.due > 0) {
+            srs_load_balancer_add(manager->load_balancer, undo->before.card.state.due, 1u);
+        }
+    }
+
+    if (undo->requeued) {
+        /* Its old key is smaller than the re-queue key, so it only moves up. */
+        SessionCardEntry *entry = &manager->queue[slot];
+        entry->card.state = undo->before.card.state;
+        entry->serve_at = undo->before.serve_at;
+        entry->sequence = undo->before.sequence;
+        session_heap_sift_up(manager, heap_index);
+    } else {
+        if (manager->streaming) {
+            /* The old slot may have been recycled by a refill since. */
+            slot = manager->free_slots[--manager->free_count];
+            session_undo_reslot(manager, undo->before.card.card_id, slot);
+        }
+        manager->queue[slot] = undo->before;
+        if (manager->streaming) {
+            session_entry_own_keys(&manager->queue[slot]);
+        }
+        manager->heap[manager->heap_count] = slot;
+        session_heap_sift_up(manager, manager->heap_count);
+        manager->heap_count++;
+    }
+
+    if (manager->served_count > 0u) {
+        manager->served_count -= 1u;
+    }
+    manager->in_session = true;
+
+    const SessionCard *card = &manager->queue[slot].card;
+    SessionReviewEvent event;
+    memset(&event, 0, sizeof(event));
+    event.card_id = card->card_id;
+    event.mode = manager->mode;
+    event.simulated = undo->simulated;
+    event.first_review = undo->first_review;
+    event.undone = true;
+    event.queue_position = manager->served_count;
+    event.remaining = manager->heap_count;
+    event.review_id = undo->review_id;
+    event.state = &card->state;
+    event.context = undo->context;
+    event.context.topic.topic_id = card->topic.topic_id;
+    event.result = undo->result;
+    event.answer_ms = undo->answer_ms;
+
+    if (manager->redo_count < SESSION_UNDO_DEPTH) {
+        SessionRedoEntry *redo = &manager->redo_stack[manager->redo_count++];
+        redo->card_id = card->card_id;
+        redo->rating = undo->rating;
+        redo->context = undo->context;
+        redo->context.topic.topic_id = NULL; /* Re-derived from the card on redo. */
+        redo->answer_ms = undo->answer_ms;
+    }
+    manager->undo_count--;
+
+    session_emit_callbacks(manager, &event);
+    if (out_event != NULL) {
+        *out_event = event;
+    }
+    return true;
+}
+
+bool session_manager_redo(struct SessionManager *manager, SRSReviewResult *out_result)
+{
+    if (manager == NULL || manager->redo_count == 0u) {
+        return false;
+    }
+
+    const SessionRedoEntry redo = manager->redo_stack[manager->redo_count - 1u];
+    const SessionCard *current = session_manager_current(manager);
+    if (current == NULL || current->card_id != redo.card_id) {
+        /* The queue moved on; the redo history no longer applies. */
+        manager->redo_count = 0u;
+        return false;
+    }
+
+    manager->replaying = true;
+    manager->pending_answer_ms = redo.answer_ms;
+    const bool graded = session_manager_grade(manager, redo.rating, &redo.context, out_result);
+    manager->replaying = false;
+    if (graded) {
+        manager->redo_count--;
+    } else {
+        manager->pending_answer_ms = 0u;
+    }
+    return graded;
+}
+
+size_t session_manager_undo_available(const struct SessionManager *manager)
+{
+    return (manager != NULL) ? manager->undo_count : 0u;
+}
+
+size_t session_manager_redo_available(const struct SessionManager *manager)
+{
+    return (manager != NULL) ? manager->redo_count : 0u;
+}
+
+/*
+ * Checkpoints are a little-endian byte stream: a fixed header, then for
+ * streamed sessions the length-prefixed source position, then one record per
+ * queued card in heap order, each with its heap key, packed scheduler state,
+ * optional context overrides and length-prefixed keys. Version 1 had no
+ * flags and no source position.
+ */
+#define SESSION_CHECKPOINT_MAGIC 0x50434852u /* "HRCP" */
+#define SESSION_CHECKPOINT_VERSION 2u
+#define SESSION_CHECKPOINT_HEADER_BYTES 40u
+#define SESSION_CHECKPOINT_FLAG_STREAMED 0x1u
+#define SESSION_CHECKPOINT_FLAG_EXHAUSTED 0x2u
+#define SESSION_CHECKPOINT_FIXED_CARD_BYTES 103u
+#define SESSION_CHECKPOINT_MAX_CARD_BYTES \
+    (SESSION_CHECKPOINT_FIXED_CARD_BYTES + 25u + 2u * (SESSION_MAX_KEY_LENGTH - 1u))
+
+typedef struct SessionReader {
+    const unsigned char *at;
+    const unsigned char *end;
+    bool ok;
+} SessionReader;
+
+static unsigned char *session_put_u64(unsigned char *out, uint64_t value)
+{
+    for (size_t i = 0; i < 8u; ++i) {
+        out[i] = (unsigned char)(value >> (8u * i));
+    }
+    return out + 8;
+}
+
+static unsigned char *session_put_u32(unsigned char *out, uint32_t value)
+{
+    for (size_t i = 0; i < 4u; ++i) {
+        out[i] = (unsigned char)(value >> (8u * i));
+    }
+    return out + 4;
+}
+
+static unsigned char *session_put_f64(unsigned char *out, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return session_put_u64(out, bits);
+}
+
+static unsigned char *session_put_key(unsigned char *out, const char *key)
+{
+    size_t length = 0u;
+    while (key != NULL && length + 1u < SESSION_MAX_KEY_LENGTH && key[length] != '\0') {
+        ++length;
+    }
+    *out++ = (unsigned char)length;
+    if (length > 0u) {
+        memcpy(out, key, length);
+    }
+    return out + length;
+}
+
+static uint64_t session_get_u64(SessionReader *reader)
+{
+    if (!reader->ok || reader->end - reader->at < 8) {
+        reader->ok = false;
+        return 0u;
+    }
+    uint64_t value = 0u;
+    for (size_t i = 0; i < 8u; ++i) {
+        value |= (uint64_t)reader->at[i] << (8u * i);
+    }
+    reader->at += 8;
+    return value;
+}
+
+static uint32_t session_get_u32(SessionReader *reader)
+{
+    if (!reader->ok || reader->end - reader->at < 4) {
+        reader->ok = false;
+        return 0u;
+    }
+    uint32_t value = 0u;
+    for (size_t i = 0; i < 4u; ++i) {
+        value |= (uint32_t)reader->at[i] << (8u * i);
+    }
+    reader->at += 4;
+    return value;
+}
+
+static unsigned char session_get_u8(SessionReader *reader)
+{
+    if (!reader->ok || reader->at >= reader->end) {
+        reader->ok = false;
         return 0u;
     }
+    return *reader->at++;
+}
+
+static double session_get_f64(SessionReader *reader)
+{
+    const uint64_t bits = session_get_u64(reader);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void session_get_key(SessionReader *reader, char *storage)
+{
+    const size_t length = session_get_u8(reader);
+    if (!reader->ok || length >= SESSION_MAX_KEY_LENGTH || (size_t)(reader->end - reader->at) < length) {
+        reader->ok = false;
+        storage[0] = '\0';
+        return;
+    }
+    memcpy(storage, reader->at, length);
+    storage[length] = '\0';
+    reader->at += length;
+}
+
+bool session_manager_checkpoint(const struct SessionManager *manager,
+                                void **out_data,
+                                size_t *out_size)
+{
+    if (manager == NULL || out_data == NULL || out_size == NULL) {
+        return false;
+    }
+
+    const size_t count = (manager->in_session && manager->queue != NULL) ? manager->heap_count : 0u;
+    const bool streamed = manager->in_session && manager->streaming;
+    unsigned char *data = (unsigned char *)malloc(SESSION_CHECKPOINT_HEADER_BYTES + 4u + SESSION_MAX_SOURCE_STATE +
+                                                  count * SESSION_CHECKPOINT_MAX_CARD_BYTES);
+    if (data == NULL) {
+        return false;
+    }
 
-    return manager->trace_count;
+    uint32_t flags = 0u;
+    if (streamed) {
+        flags |= SESSION_CHECKPOINT_FLAG_STREAMED;
+        flags |= manager->source_exhausted ? SESSION_CHECKPOINT_FLAG_EXHAUSTED : 0u;
+    }
+
+    unsigned char *out = data;
+    out = session_put_u32(out, SESSION_CHECKPOINT_MAGIC);
+    out = session_put_u32(out, SESSION_CHECKPOINT_VERSION);
+    out = session_put_u32(out, (uint32_t)manager->mode);
+    out = session_put_u32(out, flags);
+    out = session_put_u64(out, (uint64_t)manager->served_count);
+    out = session_put_u64(out, manager->next_sequence);
+    out = session_put_u64(out, (uint64_t)count);
+
+    if (streamed) {
+        /* A source without a save hook stores nothing and resumes as the loaded window only. */
+        size_t state_size = 0u;
+        if (!manager->source_exhausted && manager->source.save != NULL) {
+            state_size = manager->source.save(manager->source.user_data, out + 4, SESSION_MAX_SOURCE_STATE);
+            if (state_size > SESSION_MAX_SOURCE_STATE) {
+                state_size = 0u;
+            }
+        }
+        out = session_put_u32(out, (uint32_t)state_size);
+        out += state_size;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const SessionCardEntry *entry = &manager->queue[manager->heap[i]];
+        const SessionCard *card = &entry->card;
+        SRSPersistedState persisted;
+        srs_state_pack(&card->state, &persisted);
+
+        out = session_put_u64(out, card->card_id);
+        out = session_put_u64(out, (uint64_t)(int64_t)entry->serve_at);
+        out = session_put_u64(out, entry->sequence);
+        out = session_put_u32(out, persisted.version);
+        out = session_put_u32(out, persisted.mode);
+        out = session_put_u32(out, persisted.consecutive_correct);
+        out = session_put_u64(out, (uint64_t)persisted.due_unix);
+        out = session_put_u64(out, (uint64_t)persisted.last_review_unix);
+        out = session_put_f64(out, persisted.ease_factor);
+        out = session_put_f64(out, persisted.interval_days);
+        out = session_put_f64(out, persisted.cram_interval_minutes);
+        out = session_put_f64(out, persisted.cram_bleed_minutes);
+        out = session_put_f64(out, persisted.topic_adjustment);
+        out = session_put_f64(out, card->topic.weight);
+        *out++ = card->has_custom_context ? 1u : 0u;
+        if (card->has_custom_context) {
+            out = session_put_u64(out, (uint64_t)(int64_t)card->custom_context.now);
+            out = session_put_u64(out, (uint64_t)(int64_t)card->custom_context.exam_date);
+            *out++ = card->custom_context.cram_session ? 1u : 0u;
+            out = session_put_f64(out, card->custom_context.topic.weight);
+        }
+        out = session_put_key(out, card->topic.topic_id);
+        out = session_put_key(out, card->sibling_key);
+    }
+
+    *out_data = data;
+    *out_size = (size_t)(out - data);
+    return true;
+}
+
+/* Reads one card record into @p entry; its keys point into the entry itself. */
+static bool session_read_card(SessionReader *reader, SessionCardEntry *entry, const SRSConfig *config)
+{
+    SessionCard *card = &entry->card;
+    memset(entry, 0, sizeof(*entry));
+
+    card->card_id = session_get_u64(reader);
+    entry->serve_at = (time_t)(int64_t)session_get_u64(reader);
+    entry->sequence = session_get_u64(reader);
+
+    SRSPersistedState persisted;
+    persisted.version = session_get_u32(reader);
+    persisted.mode = session_get_u32(reader);
+    persisted.consecutive_correct = session_get_u32(reader);
+    persisted.due_unix = (int64_t)session_get_u64(reader);
+    persisted.last_review_unix = (int64_t)session_get_u64(reader);
+    persisted.ease_factor = session_get_f64(reader);
+    persisted.interval_days = session_get_f64(reader);
+    persisted.cram_interval_minutes = session_get_f64(reader);
+    persisted.cram_bleed_minutes = session_get_f64(reader);
+    persisted.topic_adjustment = session_get_f64(reader);
+    srs_state_unpack(&card->state, &persisted, config);
+
+    card->topic.weight = session_get_f64(reader);
+    card->has_custom_context = (session_get_u8(reader) != 0u);
+    if (card->has_custom_context) {
+        card->custom_context.now = (time_t)(int64_t)session_get_u64(reader);
+        card->custom_context.exam_date = (time_t)(int64_t)session_get_u64(reader);
+        card->custom_context.cram_session = (session_get_u8(reader) != 0u);
+        card->custom_context.topic.weight = session_get_f64(reader);
+    }
+    session_get_key(reader, entry->topic_id);
+    session_get_key(reader, entry->sibling_key);
+    return reader->ok;
+}
+
+/** Header fields of a checkpoint, with @c cards positioned at the first card record. */
+typedef struct SessionCheckpointView {
+    uint32_t mode;
+    uint32_t flags;
+    uint64_t served;
+    uint64_t next_sequence;
+    size_t count;
+    const unsigned char *source_state;
+    size_t source_state_size;
+    SessionReader cards;
+} SessionCheckpointView;
+
+static bool session_checkpoint_open(const void *data, size_t size, SessionCheckpointView *view)
+{
+    if (data == NULL || size < SESSION_CHECKPOINT_HEADER_BYTES) {
+        return false;
+    }
+
+    memset(view, 0, sizeof(*view));
+    SessionReader reader = {(const unsigned char *)data, (const unsigned char *)data + size, true};
+    const uint32_t magic = session_get_u32(&reader);
+    const uint32_t version = session_get_u32(&reader);
+    view->mode = session_get_u32(&reader);
+    view->flags = session_get_u32(&reader);
+    view->served = session_get_u64(&reader);
+    view->next_sequence = session_get_u64(&reader);
+    const uint64_t stored_count = session_get_u64(&reader);
+    if (!reader.ok || magic != SESSION_CHECKPOINT_MAGIC || (version != 1u && version != SESSION_CHECKPOINT_VERSION) ||
+        view->mode > (uint32_t)SESSION_MODE_EXAM_SIM) {
+        return false;
+    }
+    if (version == 1u) {
+        view->flags = 0u; /* The field was reserved. */
+    }
+
+    if ((view->flags & SESSION_CHECKPOINT_FLAG_STREAMED) != 0u) {
+        const uint32_t state_size = session_get_u32(&reader);
+        if (!reader.ok || state_size > SESSION_MAX_SOURCE_STATE || (size_t)(reader.end - reader.at) < state_size) {
+            return false;
+        }
+        view->source_state = reader.at;
+        view->source_state_size = state_size;
+        reader.at += state_size;
+    }
+
+    /* Reject counts the buffer cannot hold before anyone allocates for them. */
+    if (stored_count > (uint64_t)((size_t)(reader.end - reader.at) / SESSION_CHECKPOINT_FIXED_CARD_BYTES)) {
+        return false;
+    }
+    view->count = (size_t)stored_count;
+    view->cards = reader;
+    return true;
 }
 
-bool session_manager_trace_get(const struct SessionManager *manager,
-                               size_t index,
-                               SessionReviewEvent *out_event)
+bool session_checkpoint_source_state(const void *data,
+                                     size_t size,
+                                     const void **out_state,
+                                     size_t *out_size)
 {
-    if (manager == NULL || out_event == NULL) {
+    SessionCheckpointView view;
+    if (out_state == NULL || out_size == NULL || !session_checkpoint_open(data, size, &view) ||
+        view.source_state_size == 0u || (view.flags & SESSION_CHECKPOINT_FLAG_EXHAUSTED) != 0u) {
         return false;
     }
+    *out_state = view.source_state;
+    *out_size = view.source_state_size;
+    return true;
+}
+
+/*
+ * Shared by both resume paths. With @p source the queue gets the streaming
+ * layout of session_manager_begin_stream(), sized for at least the restored
+ * cards, and the remaining slots are free for later pages.
+ */
+static bool session_resume_checkpoint(struct SessionManager *manager,
+                                      const void *data,
+                                      size_t size,
+                                      const SessionCardSource *source)
+{
+    SessionCheckpointView view;
+    if (manager == NULL || !session_checkpoint_open(data, size, &view)) {
+        return false;
+    }
+    size_t count = view.count;
+
+    const size_t page_size = (source == NULL) ? 0u
+                             : (source->page_size > 0u) ? source->page_size : SESSION_DEFAULT_PAGE_SIZE;
+    size_t capacity = (count > 0u) ? count : 1u;
+    if (source != NULL && capacity < page_size * 2u) {
+        capacity = page_size * 2u;
+    }
 
-    if (index >= manager->trace_count) {
+    /* Parse into fresh storage so a bad checkpoint leaves the current session alone. */
+    SessionCardEntry *entries = (SessionCardEntry *)calloc(capacity, sizeof(SessionCardEntry));
+    size_t *heap = (size_t *)malloc(capacity * sizeof(size_t));
+    size_t *free_slots = (source != NULL) ? (size_t *)malloc(capacity * sizeof(size_t)) : NULL;
+    SessionCardSpec *page_specs = (source != NULL) ? (SessionCardSpec *)calloc(page_size, sizeof(SessionCardSpec)) : NULL;
+    SessionCardEntry *page_entries =
+        (source != NULL) ? (SessionCardEntry *)calloc(page_size, sizeof(SessionCardEntry)) : NULL;
+    bool ok = entries != NULL && heap != NULL &&
+              (source == NULL || (free_slots != NULL && page_specs != NULL && page_entries != NULL));
+    for (size_t i = 0; ok && i < count; ++i) {
+        ok = session_read_card(&view.cards, &entries[i], &manager->config);
+    }
+    if (!ok) {
+        free(entries);
+        free(heap);
+        free(free_slots);
+        free(page_specs);
+        free(page_entries);
         return false;
     }
 
-    *out_event = manager->trace_frames[index];
+    session_manager_reset_queue(manager);
+    manager->mode = (SessionMode)view.mode;
+    session_manager_select_review_fn(manager);
+
+    count = session_claim_entries(manager, entries, count);
+    time_t key_floor = 0;
+    for (size_t i = 0; i < count; ++i) {
+        session_entry_own_keys(&entries[i]);
+        entries[i].heap_index = i;
+        heap[i] = i;
+        if (entries[i].serve_at > key_floor) {
+            key_floor = entries[i].serve_at;
+        }
+    }
+
+    manager->queue = entries;
+    manager->queue_count = (source != NULL) ? capacity : count;
+    manager->heap = heap;
+    manager->heap_count = count;
+    /* Records arrive in heap order; the pass only matters when claims dropped cards. */
+    for (size_t i = count / 2u; i-- > 0u;) {
+        session_heap_sift_down(manager, i);
+    }
+    manager->served_count = (size_t)view.served;
+    manager->next_sequence = view.next_sequence;
+
+    if (source != NULL) {
+        for (size_t i = 0; i < capacity - count; ++i) {
+            free_slots[i] = capacity - 1u - i;
+        }
+        manager->free_slots = free_slots;
+        manager->free_count = capacity - count;
+        manager->page_specs = page_specs;
+        manager->page_entries = page_entries;
+        manager->source = *source;
+        manager->source.page_size = page_size;
+        manager->streaming = true;
+        manager->source_exhausted = (view.flags & SESSION_CHECKPOINT_FLAG_EXHAUSTED) != 0u;
+        /* Later pages are keyed after every restored card, as if the stream never stopped. */
+        manager->stream_key_floor = key_floor;
+        if (manager->heap_count <= page_size / 2u) {
+            session_stream_refill(manager);
+        }
+    }
+    manager->in_session = (manager->heap_count > 0u);
     return true;
 }
 
-void session_manager_trace_clear(struct SessionManager *manager)
+bool session_manager_resume(struct SessionManager *manager, const void *data, size_t size)
+{
+    return session_resume_checkpoint(manager, data, size, NULL);
+}
+
+bool session_manager_resume_stream(struct SessionManager *manager,
+                                   const void *data,
+                                   size_t size,
+                                   const SessionCardSource *source)
+{
+    if (source == NULL || source->fetch == NULL) {
+        return false;
+    }
+    return session_resume_checkpoint(manager, data, size, source);
+}
+
+void session_manager_set_trace_ring(struct SessionManager *manager,
+                                    struct HrTraceRing *ring,
+                                    uint16_t source)
 {
     if (manager == NULL) {
         return;
     }
 
-    if (manager->trace_frames != NULL) {
-        manager->trace_count = 0u;
-    }
+    manager->trace_ring = ring;
+    manager->trace_source = source;
 }
-#endif
@@ -35,6 +35,7 @@ typedef struct SessionCardSpec {
     SRSPersistedState persisted_state; /**< Serialized scheduler state (optional). */
     bool has_topic;                    /**< True when @p topic is provided. */
     SRSTopicContext topic;             /**< Topic metadata for analytics and modifiers. */
+    const char *sibling_key;           /**< Shared media/note identifier (NULL when unique; the planner sets none). */
     bool has_context;                  /**< True when @p context overrides are supplied. */
     SRSReviewContext context;          /**< Optional per-card context defaults. */
     void *user_data;                   /**< Caller-provided handle associated with the card. */
@@ -47,6 +48,7 @@ typedef struct SessionCard {
     uint64_t card_id;             /**< Unique identifier for the queued card. */
     SRSState state;               /**< Active spaced repetition state. */
     SRSTopicContext topic;        /**< Topic metadata applied during reviews. */
+    const char *sibling_key;      /**< Shared media/note identifier borrowed from the spec. */
     bool has_custom_context;      /**< True when @p custom_context should be used. */
     SRSReviewContext custom_context; /**< Caller supplied context overrides. */
     void *user_data;              /**< User data pointer mirrored from spec. */
@@ -59,8 +61,13 @@ typedef struct SessionReviewEvent {
     uint64_t card_id;                  /**< Card identifier used for analytics hooks. */
     SessionMode mode;                  /**< Session mode driving the review. */
     bool simulated;                    /**< True when the session avoided persistence. */
-    size_t queue_position;             /**< Zero-based index of the processed card. */
-    size_t remaining;                  /**< Cards remaining after completing the review. */
+    bool first_review;                 /**< True when the card had never been reviewed before. */
+    bool requeued;                     /**< True when the card returns later in this session. */
+    bool undone;                       /**< True when this event reverts an earlier review. */
+    int64_t review_id;                 /**< Review log row written for the review (0 when none). */
+    uint32_t answer_ms;                /**< Time the learner took to answer (0 when not measured). */
+    size_t queue_position;             /**< Number of reviews served before this one. */
+    size_t remaining;                  /**< Reviews left after this one (including requeued cards). */
     const SRSState *state;             /**< Pointer to the (possibly updated) card state. */
     SRSReviewContext context;          /**< Context supplied to the scheduler. */
     SRSReviewResult result;            /**< Scheduler output from srs_apply_review(). */
@@ -71,6 +78,24 @@ typedef bool (*session_autosave_callback)(const SessionReviewEvent *event,
                                           const SRSPersistedState *persisted,
                                           void *user_data);
 
+/**
+ * Callback that writes a review to the review log, returning its row id.
+ * Returning false rolls the in-memory review back, as for autosave failures.
+ */
+typedef bool (*session_record_callback)(const SessionReviewEvent *event,
+                                        const SRSPersistedState *persisted,
+                                        int64_t *out_review_id,
+                                        void *user_data);
+
+/**
+ * Callback that deletes review @p review_id and restores the card's stored
+ * schedule to @p restored, atomically.
+ */
+typedef bool (*session_revert_callback)(uint64_t card_id,
+                                        int64_t review_id,
+                                        const SRSPersistedState *restored,
+                                        void *user_data);
+
 /** Callback invoked for session/analytics consumers after a review completes. */
 typedef void (*session_review_callback)(const SessionReviewEvent *event,
                                         void *user_data);
@@ -89,13 +114,104 @@ typedef struct SessionCallbacks {
     void *analytics_user_data;               /**< User data for @p analytics_event. */
     session_autosave_callback autosave_event;/**< Invoked to persist SRS state. */
     void *autosave_user_data;                /**< User data for @p autosave_event. */
+    session_record_callback record_event;    /**< Writes the review log row (optional). */
+    void *record_user_data;                  /**< User data for @p record_event. */
+    session_revert_callback revert_event;    /**< Reverts a logged review on undo (optional). */
+    void *revert_user_data;                  /**< User data for @p revert_event. */
 #if HYPERRECALL_ENABLE_DEVTOOLS
     session_devtools_callback devtools_event;/**< Optional developer tooling hook. */
     void *devtools_user_data;                /**< User data for @p devtools_event. */
 #endif /* HYPERRECALL_ENABLE_DEVTOOLS */
 } SessionCallbacks;
 
+/** Cards falling due within this many minutes of a review are shown again in-session. */
+#define SESSION_DEFAULT_RELEARN_HORIZON_MINUTES 30.0
+
+/** Default number of other cards served between two cards of the same topic. */
+#define SESSION_DEFAULT_TOPIC_SEPARATION 3u
+
+/**
+ * Controls how session queues are spaced before study begins.
+ *
+ * Siblings share a sibling_key (the same media asset or source note). Only
+ * the first sibling in a queue is served; the rest are buried, as are
+ * siblings of cards already reviewed today. Burying only leaves a card out
+ * of the session: its stored due date is unchanged and the reviewed-today
+ * log is kept in memory, so it comes back after a restart or the next UTC
+ * day. Cards sharing a topic are kept at least @p topic_separation
+ * positions apart whenever the queue mix allows it.
+ */
+typedef struct SessionSpacingConfig {
+    bool enabled;            /**< Master switch for the spacing pass. */
+    bool bury_siblings;      /**< Removes later siblings from the queue. */
+    size_t topic_separation; /**< Minimum cards between same-topic cards (0 disables). */
+} SessionSpacingConfig;
+
+/**
+ * Arbitrates which session may serve a card when several run side by side.
+ *
+ * @p claim is asked before a card enters the queue and may refuse cards that
+ * another session is serving; refused cards are left out of this session.
+ * Every claimed card is handed back through @p release once it leaves the
+ * queue (graded without re-queueing, buried, or dropped when the session
+ * ends). Undoing a grade claims the card again and fails if it is refused.
+ */
+typedef bool (*session_claim_callback)(uint64_t card_id, void *user_data);
+
+typedef void (*session_release_callback)(uint64_t card_id, void *user_data);
+
+typedef struct SessionOwnership {
+    session_claim_callback claim;     /**< Reserves a card for this session. */
+    session_release_callback release; /**< Returns a reserved card. */
+    void *user_data;                  /**< Context passed to both callbacks. */
+} SessionOwnership;
+
+/** Number of grades that can be undone in a session. */
+#define SESSION_UNDO_DEPTH 32u
+
+/** Cards requested per page by streamed sessions when the source leaves it unset. */
+#define SESSION_DEFAULT_PAGE_SIZE 64u
+
+/** Upper bound on how far ahead session_manager_peek() looks. */
+#define SESSION_MAX_PEEK 16u
+
+/** Longest topic/sibling identifier (including terminator) kept for streamed cards. */
+#define SESSION_MAX_KEY_LENGTH 64u
+
+/**
+ * Produces the next page of cards for a streamed session.
+ *
+ * Writes at most @p capacity specs into @p out_cards and returns how many
+ * were written; returning 0 marks the source as exhausted. Strings referenced
+ * by the specs only need to stay valid until the next call.
+ */
+typedef size_t (*session_source_fetch)(void *user_data,
+                                       SessionCardSpec *out_cards,
+                                       size_t capacity);
+
+/** Largest source position a checkpoint stores for a streamed session. */
+#define SESSION_MAX_SOURCE_STATE 256u
+
+/**
+ * Writes the source's position, just past the last card it has handed out,
+ * into @p out and returns the bytes written (0 when it cannot be saved).
+ */
+typedef size_t (*session_source_save)(void *user_data, void *out, size_t capacity);
+
+/** Releases a source once the session that accepted it no longer needs it. */
+typedef void (*session_source_close)(void *user_data);
+
+/** Cursor-style card source used by session_manager_begin_stream(). */
+typedef struct SessionCardSource {
+    session_source_fetch fetch; /**< Pulls the next page of cards. */
+    void *user_data;            /**< Caller context passed to @p fetch. */
+    size_t page_size;           /**< Cards per page (0 uses SESSION_DEFAULT_PAGE_SIZE). */
+    session_source_save save;   /**< Optional; lets checkpoints resume the whole stream. */
+    session_source_close close; /**< Optional; called when the session ends or is replaced. */
+} SessionCardSource;
+
 struct SessionManager;
+struct HrTraceRing;
 
 /** Allocates a new session manager instance. */
 struct SessionManager *session_manager_create(void);
@@ -115,6 +231,33 @@ void session_manager_set_calibration(struct SessionManager *manager,
 void session_manager_set_srs_callbacks(struct SessionManager *manager,
                                        const SRSCallbacks *callbacks);
 
+/**
+ * Attaches a due-date load balancer applied after every persisted review.
+ *
+ * The balancer is borrowed, not owned; pass NULL to schedule reviews at
+ * exactly now + interval again.
+ */
+void session_manager_set_load_balancer(struct SessionManager *manager,
+                                       SRSLoadBalancer *balancer);
+
+/** Applies the queue spacing policy (NULL restores the defaults). */
+void session_manager_set_spacing(struct SessionManager *manager,
+                                 const SessionSpacingConfig *spacing);
+
+/**
+ * Sets how soon a graded card must fall due again to be re-queued in the
+ * current session (0 disables re-queueing). Re-queued cards are re-inserted
+ * into the session heap by due time in O(log n).
+ */
+void session_manager_set_relearn_horizon(struct SessionManager *manager, double minutes);
+
+/**
+ * Installs the card ownership hooks consulted when queues are built (NULL
+ * serves every card). Takes effect from the next begin call.
+ */
+void session_manager_set_ownership(struct SessionManager *manager,
+                                   const SessionOwnership *ownership);
+
 /** Registers session, analytics, autosave, and developer tooling callbacks. */
 void session_manager_set_callbacks(struct SessionManager *manager,
                                    const SessionCallbacks *callbacks);
@@ -130,6 +273,31 @@ bool session_manager_begin(struct SessionManager *manager,
                            const SessionCardSpec *cards,
                            size_t count);
 
+/**
+ * Initializes a session queue that keeps @p cards in the supplied order.
+ *
+ * Used by planners that interleave new and review cards themselves; the
+ * mode still controls cram/persistence behaviour.
+ */
+bool session_manager_begin_ordered(struct SessionManager *manager,
+                                   SessionMode mode,
+                                   const SessionCardSpec *cards,
+                                   size_t count);
+
+/**
+ * Starts a session that pulls cards from @p source one page at a time.
+ *
+ * Only the first page is loaded before the first card is available; the next
+ * page is fetched once half of the loaded cards have been reviewed. Memory is
+ * bounded by two pages regardless of how many cards the source yields, and
+ * session_manager_remaining() counts loaded cards only. The source must stay
+ * valid until the session ends; when it has a close hook, the session calls
+ * it at that point (not when this function fails).
+ */
+bool session_manager_begin_stream(struct SessionManager *manager,
+                                  SessionMode mode,
+                                  const SessionCardSource *source);
+
 /** Clears any in-flight session state and releases queued cards. */
 void session_manager_end(struct SessionManager *manager);
 
@@ -139,9 +307,24 @@ const SessionCard *session_manager_current(const struct SessionManager *manager)
 /** Returns the active session mode. */
 SessionMode session_manager_mode(const struct SessionManager *manager);
 
-/** Returns how many cards remain (including the current card when any). */
+/** Returns how many reviews remain (including the current card and re-queued cards). */
 size_t session_manager_remaining(const struct SessionManager *manager);
 
+/**
+ * Lists the ids of the next cards in serve order, starting with the current
+ * card, without changing the queue. At most SESSION_MAX_PEEK ids are written.
+ * Cards graded Again may still jump ahead of this order once re-queued.
+ */
+size_t session_manager_peek(const struct SessionManager *manager,
+                            uint64_t *out_card_ids,
+                            size_t capacity);
+
+/**
+ * Records how long the learner took on the current card. The next successful
+ * grade reports it as SessionReviewEvent::answer_ms and clears it.
+ */
+void session_manager_set_answer_time(struct SessionManager *manager, uint32_t answer_ms);
+
 /**
  * Grades the current card using the supplied rating and optional context
  * overrides, advancing the session queue on success.
@@ -151,18 +334,83 @@ bool session_manager_grade(struct SessionManager *manager,
                            const SRSReviewContext *override_context,
                            SRSReviewResult *out_result);
 
-#if HYPERRECALL_ENABLE_DEVTOOLS
-/** Returns the number of developer trace frames recorded for the session. */
-size_t session_manager_trace_count(const struct SessionManager *manager);
+/**
+ * Reverts the most recent grade of the session.
+ *
+ * The card's previous state and queue position are restored from a fixed
+ * ring of SESSION_UNDO_DEPTH snapshots, so the card becomes current again
+ * without rebuilding the queue. When the review was logged, the revert
+ * callback removes the row and restores the stored schedule first; if that
+ * fails nothing changes. Consumers receive an event with @c undone set.
+ */
+bool session_manager_undo(struct SessionManager *manager, SessionReviewEvent *out_event);
 
-/** Copies the trace frame at @p index into @p out_event when available. */
-bool session_manager_trace_get(const struct SessionManager *manager,
-                               size_t index,
-                               SessionReviewEvent *out_event);
+/**
+ * Re-applies the most recently undone grade to the current card with its
+ * original rating and review time. Grading any card normally clears the
+ * redo history.
+ */
+bool session_manager_redo(struct SessionManager *manager, SRSReviewResult *out_result);
 
-/** Clears any accumulated developer trace frames without ending the session. */
-void session_manager_trace_clear(struct SessionManager *manager);
-#endif /* HYPERRECALL_ENABLE_DEVTOOLS */
+/** Number of grades session_manager_undo() can currently revert. */
+size_t session_manager_undo_available(const struct SessionManager *manager);
+
+/** Number of undone grades session_manager_redo() can re-apply. */
+size_t session_manager_redo_available(const struct SessionManager *manager);
+
+/**
+ * Serializes the live queue into a malloc'd buffer for later resumption.
+ *
+ * The checkpoint keeps the mode, serve order, position and every queued card
+ * with its in-session state, so re-queued learning cards come back due when
+ * they were. Undo history and card user_data are not kept. Streamed sessions
+ * save the cards loaded so far plus, when the source has a save hook, the
+ * source position, so session_manager_resume_stream() can carry on paging
+ * where the session stopped. Free the buffer with free().
+ */
+bool session_manager_checkpoint(const struct SessionManager *manager,
+                                void **out_data,
+                                size_t *out_size);
+
+/**
+ * Replaces the current session with one restored from
+ * session_manager_checkpoint() output in O(remaining) time. Cards that the
+ * ownership hooks refuse are dropped. Fails on malformed or foreign data.
+ * A streamed checkpoint restored this way serves only the cards that were
+ * loaded when it was taken.
+ */
+bool session_manager_resume(struct SessionManager *manager, const void *data, size_t size);
+
+/**
+ * Returns the source position saved in a streamed session's checkpoint, for
+ * reopening its source. False when the checkpoint has none (flat sessions,
+ * sources without a save hook, or older checkpoints). @p out_state points
+ * into @p data.
+ */
+bool session_checkpoint_source_state(const void *data,
+                                     size_t size,
+                                     const void **out_state,
+                                     size_t *out_size);
+
+/**
+ * Resumes a streamed checkpoint and keeps it streaming: the restored cards
+ * are served first, then @p source, reopened at the saved position, supplies
+ * the rest. On success the session owns @p source exactly as with
+ * session_manager_begin_stream(); on failure the caller keeps it.
+ */
+bool session_manager_resume_stream(struct SessionManager *manager,
+                                   const void *data,
+                                   size_t size,
+                                   const SessionCardSource *source);
+
+/**
+ * Records every review event the session emits into @p ring (NULL stops
+ * tracing), tagged with @p source. The ring is shared and not owned; it must
+ * outlive the session or be detached first. Recording never allocates.
+ */
+void session_manager_set_trace_ring(struct SessionManager *manager,
+                                    struct HrTraceRing *ring,
+                                    uint16_t source);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,286 @@
+#include "span_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sync.h"
+
+#if defined(_MSC_VER)
+#define SPAN_THREAD_LOCAL __declspec(thread)
+#else
+#define SPAN_THREAD_LOCAL _Thread_local
+#endif
+
+/**
+ * A slot is a seqlock with one writer, the owning thread: the stamp is odd
+ * while the slot is filled and 2 * sequence + 2 once the span for that
+ * sequence is complete. The words are atomics, so an export racing the
+ * owner sees a changed stamp instead of undefined behaviour.
+ */
+typedef struct SpanSlot {
+    HrAtomicU64 stamp;
+    HrAtomicU64 name;           /* const char *, as an integer. */
+    HrAtomicU64 start_micros;
+    HrAtomicU64 duration_micros;
+} SpanSlot;
+
+typedef struct SpanRing {
+    struct SpanRing *next;
+    uint32_t tid;
+    const char *thread_name;    /* Guarded by the registry lock. */
+    size_t capacity;            /* Power of two. */
+    HrAtomicU64 written;        /* Spans completed; only the owner stores it. */
+    SpanSlot slots[];
+} SpanRing;
+
+static HrMutex g_registry_lock;
+static bool g_registry_ready;
+static SpanRing *g_rings;
+static uint32_t g_next_tid;
+static size_t g_events_per_thread;
+static uint64_t g_origin_micros;
+static HrAtomicU64 g_enabled;
+static HrAtomicU64 g_generation; /* Bumped by span_trace_shutdown() so threads drop freed rings. */
+
+static SPAN_THREAD_LOCAL SpanRing *tl_ring;
+static SPAN_THREAD_LOCAL uint64_t tl_generation;
+static SPAN_THREAD_LOCAL const char *tl_thread_name;
+
+static size_t round_up_power_of_two(size_t value)
+{
+    size_t result = 1U;
+    while (result < value) {
+        result <<= 1U;
+    }
+    return result;
+}
+
+/* The calling thread's ring, registered on its first span; NULL when allocation fails. */
+static SpanRing *span_thread_ring(void)
+{
+    const uint64_t generation = hr_atomic_u64_load(&g_generation);
+    if (tl_ring != NULL && tl_generation == generation) {
+        return tl_ring;
+    }
+
+    tl_ring = NULL;
+    hr_mutex_lock(&g_registry_lock);
+    const size_t capacity = g_events_per_thread;
+    SpanRing *ring = (capacity > 0U) ? (SpanRing *)calloc(1U, sizeof(SpanRing) + capacity * sizeof(SpanSlot)) : NULL;
+    if (ring != NULL) {
+        ring->tid = ++g_next_tid;
+        ring->thread_name = tl_thread_name;
+        ring->capacity = capacity;
+        ring->next = g_rings;
+        g_rings = ring;
+        tl_ring = ring;
+        tl_generation = generation;
+    }
+    hr_mutex_unlock(&g_registry_lock);
+    return ring;
+}
+
+bool span_trace_start(size_t events_per_thread)
+{
+    if (!g_registry_ready) {
+        if (!hr_mutex_init(&g_registry_lock)) {
+            return false;
+        }
+        hr_atomic_u64_init(&g_enabled, 0U);
+        hr_atomic_u64_init(&g_generation, 1U);
+        g_registry_ready = true;
+    }
+
+    hr_mutex_lock(&g_registry_lock);
+    /* Rings already handed out keep their size; the new one applies to threads registering later. */
+    g_events_per_thread = round_up_power_of_two(events_per_thread > 0U ? events_per_thread
+                                                                       : HR_SPAN_TRACE_DEFAULT_EVENTS);
+    if (g_rings == NULL) {
+        g_origin_micros = hr_monotonic_micros();
+    }
+    hr_mutex_unlock(&g_registry_lock);
+
+    hr_atomic_u64_store(&g_enabled, 1U);
+    return true;
+}
+
+void span_trace_stop(void)
+{
+    if (g_registry_ready) {
+        hr_atomic_u64_store(&g_enabled, 0U);
+    }
+}
+
+bool span_trace_enabled(void)
+{
+    return g_registry_ready && hr_atomic_u64_load(&g_enabled) != 0U;
+}
+
+void span_trace_name_thread(const char *name)
+{
+    tl_thread_name = name;
+    if (!g_registry_ready) {
+        return;
+    }
+
+    hr_mutex_lock(&g_registry_lock);
+    if (tl_ring != NULL && tl_generation == hr_atomic_u64_load(&g_generation)) {
+        tl_ring->thread_name = name;
+    }
+    hr_mutex_unlock(&g_registry_lock);
+}
+
+HrSpan span_trace_begin(const char *name)
+{
+    HrSpan span = {name, 0U};
+    if (g_registry_ready && hr_atomic_u64_load(&g_enabled) != 0U) {
+        const uint64_t now = hr_monotonic_micros();
+        span.start_micros = (now > 0U) ? now : 1U;
+    }
+    return span;
+}
+
+void span_trace_end(const HrSpan *span)
+{
+    if (span == NULL || span->start_micros == 0U) {
+        return;
+    }
+
+    const uint64_t now = hr_monotonic_micros();
+    SpanRing *ring = span_thread_ring();
+    if (ring == NULL) {
+        return;
+    }
+
+    const uint64_t sequence = hr_atomic_u64_load(&ring->written);
+    SpanSlot *slot = &ring->slots[sequence & (uint64_t)(ring->capacity - 1U)];
+    hr_atomic_u64_store(&slot->stamp, sequence * 2U + 1U);
+    hr_atomic_u64_store(&slot->name, (uint64_t)(uintptr_t)span->name);
+    hr_atomic_u64_store(&slot->start_micros, span->start_micros);
+    hr_atomic_u64_store(&slot->duration_micros, (now > span->start_micros) ? now - span->start_micros : 0U);
+    hr_atomic_u64_store(&slot->stamp, sequence * 2U + 2U);
+    hr_atomic_u64_store(&ring->written, sequence + 1U);
+}
+
+/* Writes @p text as a JSON string body; span and thread names are plain identifiers, but stay safe. */
+static void write_json_text(FILE *file, const char *text, size_t length)
+{
+    for (size_t i = 0; i < length && text[i] != '\0'; ++i) {
+        const unsigned char c = (unsigned char)text[i];
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+            fputc((int)c, file);
+        } else if (c < 0x20U) {
+            fprintf(file, "\\u%04x", (unsigned int)c);
+        } else {
+            fputc((int)c, file);
+        }
+    }
+}
+
+/* One ring's retained spans as "X" events; the category is the name up to its first dot. */
+static bool export_ring(FILE *file, const SpanRing *ring, bool *first_event)
+{
+    const uint64_t written = hr_atomic_u64_load(&ring->written);
+    const uint64_t start = (written > ring->capacity) ? written - ring->capacity : 0U;
+    for (uint64_t sequence = start; sequence < written; ++sequence) {
+        const SpanSlot *slot = &ring->slots[sequence & (uint64_t)(ring->capacity - 1U)];
+        const uint64_t complete = sequence * 2U + 2U;
+        if (hr_atomic_u64_load(&slot->stamp) != complete) {
+            continue; /* Overwritten by a newer lap since @c written was read. */
+        }
+        const char *name = (const char *)(uintptr_t)hr_atomic_u64_load(&slot->name);
+        const uint64_t started = hr_atomic_u64_load(&slot->start_micros);
+        const uint64_t duration = hr_atomic_u64_load(&slot->duration_micros);
+        if (hr_atomic_u64_load(&slot->stamp) != complete || name == NULL) {
+            continue;
+        }
+
+        const char *dot = strchr(name, '.');
+        const size_t category_length = (dot != NULL) ? (size_t)(dot - name) : strlen(name);
+        fputs(*first_event ? "\n" : ",\n", file);
+        *first_event = false;
+        fputs("{\"name\":\"", file);
+        write_json_text(file, name, strlen(name));
+        fputs("\",\"cat\":\"", file);
+        write_json_text(file, name, category_length);
+        fprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%llu}", (unsigned int)ring->tid,
+                (unsigned long long)((started > g_origin_micros) ? started - g_origin_micros : 0U),
+                (unsigned long long)duration);
+    }
+    return !ferror(file);
+}
+
+bool span_trace_export(const char *path)
+{
+    if (path == NULL || path[0] == '\0' || !g_registry_ready) {
+        return false;
+    }
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    bool first_event = true;
+    bool ok = fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file) >= 0;
+
+    /* The list only grows while the lock is held, so it is walked under it. */
+    hr_mutex_lock(&g_registry_lock);
+    for (const SpanRing *ring = g_rings; ring != NULL && ok; ring = ring->next) {
+        if (ring->thread_name != NULL) {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                    first_event ? "\n" : ",\n", (unsigned int)ring->tid);
+            write_json_text(file, ring->thread_name, strlen(ring->thread_name));
+            fputs("\"}}", file);
+            first_event = false;
+        }
+        ok = export_ring(file, ring, &first_event);
+    }
+    hr_mutex_unlock(&g_registry_lock);
+
+    ok = fputs("\n]}\n", file) >= 0 && ok;
+    return (fclose(file) == 0) && ok;
+}
+
+void span_trace_get_stats(HrSpanTraceStats *out_stats)
+{
+    if (out_stats == NULL) {
+        return;
+    }
+    memset(out_stats, 0, sizeof(*out_stats));
+    if (!g_registry_ready) {
+        return;
+    }
+
+    hr_mutex_lock(&g_registry_lock);
+    for (const SpanRing *ring = g_rings; ring != NULL; ring = ring->next) {
+        const uint64_t written = hr_atomic_u64_load(&ring->written);
+        out_stats->recorded += written;
+        out_stats->dropped += (written > ring->capacity) ? written - ring->capacity : 0U;
+        out_stats->threads++;
+    }
+    hr_mutex_unlock(&g_registry_lock);
+}
+
+void span_trace_shutdown(void)
+{
+    if (!g_registry_ready) {
+        return;
+    }
+
+    hr_atomic_u64_store(&g_enabled, 0U);
+    hr_mutex_lock(&g_registry_lock);
+    hr_atomic_u64_fetch_add(&g_generation, 1U);
+    SpanRing *ring = g_rings;
+    while (ring != NULL) {
+        SpanRing *next = ring->next;
+        free(ring);
+        ring = next;
+    }
+    g_rings = NULL;
+    g_next_tid = 0U;
+    hr_mutex_unlock(&g_registry_lock);
+    /* The lock stays initialised so a later span_trace_start() can reuse it. */
+}
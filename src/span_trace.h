@@ -0,0 +1,95 @@
+#ifndef HYPERRECALL_SPAN_TRACE_H
+#define HYPERRECALL_SPAN_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file span_trace.h
+ * @brief Scoped timing spans exported as Chrome/Perfetto trace JSON.
+ *
+ * Hot paths bracket their work with HR_SPAN_BEGIN()/HR_SPAN_END(). While
+ * tracing is stopped a span costs one relaxed atomic load. While it runs,
+ * each thread appends completed spans to its own ring, allocated on the
+ * thread's first span, so recording takes no lock; the oldest spans of a
+ * busy thread are overwritten. span_trace_export() writes every thread's
+ * retained spans as "X" (complete) events that chrome://tracing and
+ * ui.perfetto.dev open directly.
+ *
+ * Building with HYPERRECALL_ENABLE_TRACING=0 compiles the macros out.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef HYPERRECALL_ENABLE_TRACING
+#define HYPERRECALL_ENABLE_TRACING 1
+#endif
+
+/** Spans each thread retains when span_trace_start() is given 0. */
+#define HR_SPAN_TRACE_DEFAULT_EVENTS 16384U
+
+/** An open span; @c start_micros is 0 when tracing was stopped at its start. */
+typedef struct HrSpan {
+    const char *name;
+    uint64_t start_micros;
+} HrSpan;
+
+typedef struct HrSpanTraceStats {
+    uint64_t recorded;   /**< Spans completed since span_trace_start(). */
+    uint64_t dropped;    /**< Spans overwritten by newer ones on a full ring. */
+    size_t threads;      /**< Threads that recorded at least one span. */
+} HrSpanTraceStats;
+
+/**
+ * Starts recording, keeping the last @p events_per_thread spans of every
+ * thread that registers from now on (0 uses HR_SPAN_TRACE_DEFAULT_EVENTS).
+ * The first call must come before other threads open spans. Returns false
+ * when the registry cannot be set up.
+ */
+bool span_trace_start(size_t events_per_thread);
+
+/** Stops recording; retained spans stay available to span_trace_export(). */
+void span_trace_stop(void);
+
+bool span_trace_enabled(void);
+
+/** Names the calling thread in exported traces; @p name must outlive the trace. */
+void span_trace_name_thread(const char *name);
+
+/** Opens a span. @p name must be a string with static storage, usually a literal. */
+HrSpan span_trace_begin(const char *name);
+
+/** Closes @p span on the thread that opened it. */
+void span_trace_end(const HrSpan *span);
+
+/**
+ * Writes the retained spans of every thread to @p path as trace-event JSON,
+ * replacing the file. Safe while other threads record; spans overwritten
+ * during the copy are left out. Returns false on an I/O error.
+ */
+bool span_trace_export(const char *path);
+
+void span_trace_get_stats(HrSpanTraceStats *out_stats);
+
+/**
+ * Stops recording and frees every thread's ring. Call once worker threads
+ * have been joined; a thread that records afterwards starts a fresh ring.
+ */
+void span_trace_shutdown(void);
+
+#if HYPERRECALL_ENABLE_TRACING
+#define HR_SPAN_BEGIN(span, name) const HrSpan span = span_trace_begin(name)
+#define HR_SPAN_END(span) span_trace_end(&(span))
+#else
+#define HR_SPAN_BEGIN(span, name) ((void)0)
+#define HR_SPAN_END(span) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_SPAN_TRACE_H */
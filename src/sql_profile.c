@@ -0,0 +1,495 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "sql_profile.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sync.h"
+
+/* Original text kept for EXPLAIN; longer statements are logged without a plan. */
+#define SQL_PROFILE_SLOW_SQL_MAX 2048U
+/* Plan rows whose depth is tracked; deeper rows are printed at the last known depth. */
+#define SQL_PROFILE_PLAN_DEPTH_ROWS 64U
+
+typedef struct SqlProfileEntry {
+    HrSqlStatementStats stats;
+    uint64_t hash;
+    bool used;
+    bool plan_logged;
+} SqlProfileEntry;
+
+typedef struct SqlSlowStatement {
+    char sql[SQL_PROFILE_SLOW_SQL_MAX];
+    bool truncated;
+    uint64_t hash;
+    uint64_t micros;
+    uint64_t fullscan_steps;
+    uint64_t vm_steps;
+    uint64_t sorts;
+    time_t finished_at;
+} SqlSlowStatement;
+
+struct HrSqlProfiler {
+    HrMutex lock;
+    uint64_t slow_threshold_micros;
+    char slow_log_path[1024];
+    SqlProfileEntry entries[HR_SQL_PROFILE_MAX_STATEMENTS];
+    size_t distinct;
+    uint64_t statements;
+    uint64_t total_micros;
+    uint64_t untracked;
+    uint64_t slow;
+    uint64_t slow_dropped;
+    SqlSlowStatement slow_queue[HR_SQL_PROFILE_SLOW_QUEUE];
+    size_t slow_pending;
+    HrAtomicU64 slow_waiting; /* Mirrors slow_pending for the lock-free check. */
+};
+
+static bool is_identifier_char(char c)
+{
+    return isalnum((unsigned char)c) || c == '_' || c == '$' || (unsigned char)c >= 0x80U;
+}
+
+static bool starts_with_explain(const char *sql)
+{
+    while (isspace((unsigned char)*sql)) {
+        sql++;
+    }
+    static const char kExplain[] = "explain";
+    for (size_t i = 0; i + 1U < sizeof(kExplain); ++i) {
+        if (tolower((unsigned char)sql[i]) != kExplain[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t sql_profile_normalize(const char *sql, char *out, size_t capacity)
+{
+    if (out == NULL || capacity == 0U) {
+        return 0U;
+    }
+    size_t length = 0U;
+    bool pending_space = false;
+    const char *p = (sql != NULL) ? sql : "";
+
+    while (*p != '\0' && length + 1U < capacity) {
+        const char c = *p;
+        if (isspace((unsigned char)c)) {
+            pending_space = true;
+            p++;
+            continue;
+        }
+        if (c == '-' && p[1] == '-') {
+            while (*p != '\0' && *p != '\n') {
+                p++;
+            }
+            pending_space = true;
+            continue;
+        }
+        if (c == '/' && p[1] == '*') {
+            const char *end = strstr(p + 2, "*/");
+            p = (end != NULL) ? end + 2 : p + strlen(p);
+            pending_space = true;
+            continue;
+        }
+
+        if (pending_space && length > 0U) {
+            out[length++] = ' ';
+            pending_space = false;
+            if (length + 1U >= capacity) {
+                break;
+            }
+        }
+        pending_space = false;
+
+        /* Digits inside identifiers and numbered parameters (?1, :v2) are not literals. */
+        const bool after_identifier = length > 0U && (is_identifier_char(out[length - 1U]) || out[length - 1U] == '?');
+        if (c == '\'') {
+            /* String literal, with '' as an escaped quote. */
+            p++;
+            while (*p != '\0' && !(p[0] == '\'' && p[1] != '\'')) {
+                p += (p[0] == '\'') ? 2 : 1;
+            }
+            if (*p == '\'') {
+                p++;
+            }
+            out[length++] = '?';
+        } else if (!after_identifier && (isdigit((unsigned char)c) || (c == '.' && isdigit((unsigned char)p[1])))) {
+            /* Numeric literal, including hex and exponents. */
+            while (is_identifier_char(*p) || *p == '.' ||
+                   ((*p == '+' || *p == '-') && (p[-1] == 'e' || p[-1] == 'E'))) {
+                p++;
+            }
+            out[length++] = '?';
+        } else {
+            out[length++] = c;
+            p++;
+        }
+    }
+
+    /* A trailing space or statement separator does not make a different statement. */
+    while (length > 0U && (out[length - 1U] == ' ' || out[length - 1U] == ';')) {
+        length--;
+    }
+    out[length] = '\0';
+    return length;
+}
+
+static uint64_t hash_text(const char *text)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char *)text; *p != '\0'; ++p) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* The entry for @p hash, claiming a free slot when the shape is new; NULL once the table is full. */
+static SqlProfileEntry *find_entry(struct HrSqlProfiler *profiler, uint64_t hash, const char *normalized)
+{
+    const size_t mask = HR_SQL_PROFILE_MAX_STATEMENTS - 1U;
+    size_t index = (size_t)hash & mask;
+    for (size_t probe = 0; probe < HR_SQL_PROFILE_MAX_STATEMENTS; ++probe) {
+        SqlProfileEntry *entry = &profiler->entries[(index + probe) & mask];
+        if (!entry->used) {
+            /* Keep one slot free so lookups for unknown shapes always terminate early. */
+            if (profiler->distinct + 1U >= HR_SQL_PROFILE_MAX_STATEMENTS) {
+                return NULL;
+            }
+            memset(entry, 0, sizeof(*entry));
+            entry->used = true;
+            entry->hash = hash;
+            memcpy(entry->stats.sql, normalized, strlen(normalized) + 1U);
+            profiler->distinct++;
+            return entry;
+        }
+        if (entry->hash == hash && strcmp(entry->stats.sql, normalized) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void profile_statement(struct HrSqlProfiler *profiler, sqlite3_stmt *statement, uint64_t micros)
+{
+    const char *sql = sqlite3_sql(statement);
+    if (sql == NULL || starts_with_explain(sql)) {
+        return; /* The slow-query log's own EXPLAIN statements are not profiled. */
+    }
+
+    /* Reset so the counters cover this execution only. */
+    const uint64_t fullscan_steps = (uint64_t)sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+    const uint64_t vm_steps = (uint64_t)sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_VM_STEP, 1);
+    const uint64_t sorts = (uint64_t)sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_SORT, 1);
+
+    char normalized[HR_SQL_PROFILE_SQL_MAX];
+    sql_profile_normalize(sql, normalized, sizeof(normalized));
+    const uint64_t hash = hash_text(normalized);
+
+    hr_mutex_lock(&profiler->lock);
+    profiler->statements++;
+    profiler->total_micros += micros;
+    const bool slow = profiler->slow_threshold_micros > 0U && micros >= profiler->slow_threshold_micros;
+
+    SqlProfileEntry *entry = find_entry(profiler, hash, normalized);
+    if (entry != NULL) {
+        entry->stats.count++;
+        entry->stats.total_micros += micros;
+        entry->stats.fullscan_steps += fullscan_steps;
+        entry->stats.vm_steps += vm_steps;
+        entry->stats.sorts += sorts;
+        if (micros > entry->stats.max_micros) {
+            entry->stats.max_micros = micros;
+        }
+        entry->stats.slow_count += slow ? 1U : 0U;
+    } else {
+        profiler->untracked++;
+    }
+
+    if (slow) {
+        profiler->slow++;
+        if (profiler->slow_pending < HR_SQL_PROFILE_SLOW_QUEUE && profiler->slow_log_path[0] != '\0') {
+            SqlSlowStatement *queued = &profiler->slow_queue[profiler->slow_pending++];
+            const size_t length = strlen(sql);
+            queued->truncated = length >= sizeof(queued->sql);
+            const size_t copied = queued->truncated ? sizeof(queued->sql) - 1U : length;
+            memcpy(queued->sql, sql, copied);
+            queued->sql[copied] = '\0';
+            queued->hash = hash;
+            queued->micros = micros;
+            queued->fullscan_steps = fullscan_steps;
+            queued->vm_steps = vm_steps;
+            queued->sorts = sorts;
+            queued->finished_at = time(NULL);
+            hr_atomic_u64_store(&profiler->slow_waiting, (uint64_t)profiler->slow_pending);
+        } else {
+            profiler->slow_dropped++;
+        }
+    }
+    hr_mutex_unlock(&profiler->lock);
+}
+
+static int profile_callback(unsigned int type, void *context, void *p, void *x)
+{
+    if (type == SQLITE_TRACE_PROFILE && context != NULL && p != NULL && x != NULL) {
+        const sqlite3_int64 nanos = *(const sqlite3_int64 *)x;
+        profile_statement((struct HrSqlProfiler *)context, (sqlite3_stmt *)p,
+                          (nanos > 0) ? (uint64_t)nanos / 1000U : 0U);
+    }
+    return 0;
+}
+
+struct HrSqlProfiler *sql_profiler_create(const HrSqlProfileConfig *config)
+{
+    struct HrSqlProfiler *profiler = calloc(1U, sizeof(*profiler));
+    if (profiler == NULL) {
+        return NULL;
+    }
+    if (!hr_mutex_init(&profiler->lock)) {
+        free(profiler);
+        return NULL;
+    }
+    hr_atomic_u64_init(&profiler->slow_waiting, 0U);
+
+    if (config != NULL) {
+        profiler->slow_threshold_micros = (uint64_t)config->slow_query_ms * 1000U;
+        if (config->slow_log_path != NULL) {
+            const size_t length = strlen(config->slow_log_path);
+            if (length < sizeof(profiler->slow_log_path)) {
+                memcpy(profiler->slow_log_path, config->slow_log_path, length + 1U);
+            }
+        }
+    }
+    return profiler;
+}
+
+void sql_profiler_destroy(struct HrSqlProfiler *profiler)
+{
+    if (profiler == NULL) {
+        return;
+    }
+    hr_mutex_destroy(&profiler->lock);
+    free(profiler);
+}
+
+bool sql_profiler_attach(struct HrSqlProfiler *profiler, sqlite3 *connection)
+{
+    if (profiler == NULL || connection == NULL) {
+        return false;
+    }
+    return sqlite3_trace_v2(connection, SQLITE_TRACE_PROFILE, profile_callback, profiler) == SQLITE_OK;
+}
+
+void sql_profiler_detach(sqlite3 *connection)
+{
+    if (connection != NULL) {
+        sqlite3_trace_v2(connection, 0U, NULL, NULL);
+    }
+}
+
+void sql_profiler_set_slow_threshold(struct HrSqlProfiler *profiler, unsigned int slow_query_ms)
+{
+    if (profiler == NULL) {
+        return;
+    }
+    hr_mutex_lock(&profiler->lock);
+    profiler->slow_threshold_micros = (uint64_t)slow_query_ms * 1000U;
+    hr_mutex_unlock(&profiler->lock);
+}
+
+size_t sql_profiler_snapshot(struct HrSqlProfiler *profiler, HrSqlStatementStats *out, size_t capacity)
+{
+    if (profiler == NULL || out == NULL || capacity == 0U) {
+        return 0U;
+    }
+
+    hr_mutex_lock(&profiler->lock);
+    /* Insertion sort of the used slots by total time; the table is small and this is a devtools path. */
+    uint16_t order[HR_SQL_PROFILE_MAX_STATEMENTS];
+    size_t count = 0U;
+    for (size_t i = 0; i < HR_SQL_PROFILE_MAX_STATEMENTS; ++i) {
+        if (!profiler->entries[i].used) {
+            continue;
+        }
+        const uint64_t total = profiler->entries[i].stats.total_micros;
+        size_t position = count++;
+        while (position > 0U && profiler->entries[order[position - 1U]].stats.total_micros < total) {
+            order[position] = order[position - 1U];
+            position--;
+        }
+        order[position] = (uint16_t)i;
+    }
+
+    const size_t copied = (count < capacity) ? count : capacity;
+    for (size_t i = 0; i < copied; ++i) {
+        out[i] = profiler->entries[order[i]].stats;
+    }
+    hr_mutex_unlock(&profiler->lock);
+    return copied;
+}
+
+void sql_profiler_get_stats(struct HrSqlProfiler *profiler, HrSqlProfileStats *out_stats)
+{
+    if (out_stats == NULL) {
+        return;
+    }
+    memset(out_stats, 0, sizeof(*out_stats));
+    if (profiler == NULL) {
+        return;
+    }
+
+    hr_mutex_lock(&profiler->lock);
+    out_stats->statements = profiler->statements;
+    out_stats->total_micros = profiler->total_micros;
+    out_stats->untracked = profiler->untracked;
+    out_stats->slow = profiler->slow;
+    out_stats->slow_dropped = profiler->slow_dropped;
+    out_stats->distinct = profiler->distinct;
+    hr_mutex_unlock(&profiler->lock);
+}
+
+void sql_profiler_reset(struct HrSqlProfiler *profiler)
+{
+    if (profiler == NULL) {
+        return;
+    }
+    hr_mutex_lock(&profiler->lock);
+    memset(profiler->entries, 0, sizeof(profiler->entries));
+    profiler->distinct = 0U;
+    profiler->statements = 0U;
+    profiler->total_micros = 0U;
+    profiler->untracked = 0U;
+    profiler->slow = 0U;
+    profiler->slow_dropped = 0U;
+    hr_mutex_unlock(&profiler->lock);
+}
+
+bool sql_profiler_has_slow(struct HrSqlProfiler *profiler)
+{
+    return profiler != NULL && hr_atomic_u64_load(&profiler->slow_waiting) != 0U;
+}
+
+/* Prints the plan as an indented tree, the way the sqlite3 shell does. */
+static void write_query_plan(FILE *file, sqlite3 *connection, const char *sql)
+{
+    const char prefix[] = "EXPLAIN QUERY PLAN ";
+    const size_t length = strlen(sql);
+    char *query = malloc(sizeof(prefix) + length);
+    if (query == NULL) {
+        return;
+    }
+    memcpy(query, prefix, sizeof(prefix) - 1U);
+    memcpy(query + sizeof(prefix) - 1U, sql, length + 1U);
+
+    sqlite3_stmt *plan = NULL;
+    int rc = sqlite3_prepare_v2(connection, query, -1, &plan, NULL);
+    free(query);
+    if (rc != SQLITE_OK) {
+        fprintf(file, "  (no plan: %s)\n", sqlite3_errmsg(connection));
+        return;
+    }
+
+    int ids[SQL_PROFILE_PLAN_DEPTH_ROWS];
+    unsigned int depths[SQL_PROFILE_PLAN_DEPTH_ROWS];
+    size_t rows = 0U;
+    unsigned int depth = 0U;
+    while ((rc = sqlite3_step(plan)) == SQLITE_ROW) {
+        const int id = sqlite3_column_int(plan, 0);
+        const int parent = sqlite3_column_int(plan, 1);
+        const unsigned char *detail = sqlite3_column_text(plan, 3);
+        depth = 0U;
+        for (size_t i = 0; i < rows; ++i) {
+            if (ids[i] == parent) {
+                depth = depths[i] + 1U;
+            }
+        }
+        if (rows < SQL_PROFILE_PLAN_DEPTH_ROWS) {
+            ids[rows] = id;
+            depths[rows] = depth;
+            rows++;
+        }
+        fprintf(file, "  %*s%s\n", (int)(depth * 2U), "", detail != NULL ? (const char *)detail : "");
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(file, "  (plan incomplete: %s)\n", sqlite3_errmsg(connection));
+    }
+    sqlite3_finalize(plan);
+}
+
+size_t sql_profiler_write_slow_log(struct HrSqlProfiler *profiler, sqlite3 *connection)
+{
+    if (!sql_profiler_has_slow(profiler)) {
+        return 0U;
+    }
+
+    /* Take the queue so statements finishing while the log is written are not blocked. */
+    SqlSlowStatement *pending = malloc(sizeof(profiler->slow_queue));
+    if (pending == NULL) {
+        return 0U;
+    }
+    bool explain[HR_SQL_PROFILE_SLOW_QUEUE];
+    hr_mutex_lock(&profiler->lock);
+    const size_t count = profiler->slow_pending;
+    memcpy(pending, profiler->slow_queue, count * sizeof(*pending));
+    for (size_t i = 0; i < count; ++i) {
+        /* Each shape is explained once; untracked shapes every time. */
+        const size_t mask = HR_SQL_PROFILE_MAX_STATEMENTS - 1U;
+        explain[i] = true;
+        for (size_t probe = 0; probe < HR_SQL_PROFILE_MAX_STATEMENTS; ++probe) {
+            SqlProfileEntry *entry = &profiler->entries[((size_t)pending[i].hash + probe) & mask];
+            if (!entry->used) {
+                break;
+            }
+            if (entry->hash == pending[i].hash) {
+                explain[i] = !entry->plan_logged;
+                entry->plan_logged = true;
+                break;
+            }
+        }
+    }
+    profiler->slow_pending = 0U;
+    hr_atomic_u64_store(&profiler->slow_waiting, 0U);
+    hr_mutex_unlock(&profiler->lock);
+
+    FILE *file = fopen(profiler->slow_log_path, "a");
+    if (file == NULL) {
+        free(pending);
+        return 0U;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const SqlSlowStatement *statement = &pending[i];
+        char timestamp[32] = "";
+        struct tm components;
+#ifdef _WIN32
+        if (localtime_s(&components, &statement->finished_at) == 0) {
+#else
+        if (localtime_r(&statement->finished_at, &components) != NULL) {
+#endif
+            strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &components);
+        }
+        fprintf(file, "# %s  %.3f ms  %llu full-scan steps  %llu VM steps  %llu sorts\n%s%s\n", timestamp,
+                (double)statement->micros / 1000.0, (unsigned long long)statement->fullscan_steps,
+                (unsigned long long)statement->vm_steps, (unsigned long long)statement->sorts, statement->sql,
+                statement->truncated ? "..." : "");
+        if (statement->truncated) {
+            fputs("  (no plan: statement truncated)\n", file);
+        } else if (explain[i] && connection != NULL) {
+            write_query_plan(file, connection, statement->sql);
+        }
+        fputc('\n', file);
+    }
+
+    const bool ok = !ferror(file);
+    fclose(file);
+    free(pending);
+    return ok ? count : 0U;
+}
@@ -0,0 +1,105 @@
+#ifndef HYPERRECALL_SQL_PROFILE_H
+#define HYPERRECALL_SQL_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file sql_profile.h
+ * @brief Per-statement SQLite timings and a slow-query log, fed by sqlite3_trace_v2().
+ *
+ * Once attached to a connection, every finished statement is folded into a
+ * table keyed by its normalised text (literals replaced by ?, whitespace and
+ * comments collapsed), so the same query with different values lands in one
+ * row. Statements slower than the threshold are also queued for the slow-query
+ * log; sql_profiler_write_slow_log() appends them together with their
+ * EXPLAIN QUERY PLAN output. The trace callback never touches the connection
+ * itself, because SQLite forbids that from inside a trace hook.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sqlite3.h>
+
+/** Table slots (a power of two); shapes beyond the last free slot are only counted as untracked. */
+#define HR_SQL_PROFILE_MAX_STATEMENTS 256U
+/** Normalised text kept per statement, including the terminator. */
+#define HR_SQL_PROFILE_SQL_MAX 256U
+/** Slow statements queued between two writes of the log. */
+#define HR_SQL_PROFILE_SLOW_QUEUE 16U
+
+typedef struct HrSqlStatementStats {
+    char sql[HR_SQL_PROFILE_SQL_MAX]; /**< Normalised text, truncated if longer. */
+    uint64_t count;
+    uint64_t total_micros;
+    uint64_t max_micros;
+    uint64_t fullscan_steps;          /**< Steps taken by full table scans (not rows read through indexes). */
+    uint64_t vm_steps;                /**< Virtual machine steps, a rough measure of total work. */
+    uint64_t sorts;                   /**< Sorts no index could satisfy. */
+    uint64_t slow_count;              /**< Executions at or above the slow threshold. */
+} HrSqlStatementStats;
+
+typedef struct HrSqlProfileStats {
+    uint64_t statements;    /**< Executions profiled. */
+    uint64_t total_micros;
+    uint64_t untracked;     /**< Executions of shapes that did not fit in the table. */
+    uint64_t slow;          /**< Executions at or above the slow threshold. */
+    uint64_t slow_dropped;  /**< Slow executions lost because the queue was full. */
+    size_t distinct;        /**< Statement shapes in the table. */
+} HrSqlProfileStats;
+
+typedef struct HrSqlProfileConfig {
+    unsigned int slow_query_ms; /**< Threshold for the slow-query log (0 = no log). */
+    const char *slow_log_path;  /**< File the log is appended to; NULL disables it. */
+} HrSqlProfileConfig;
+
+struct HrSqlProfiler;
+
+struct HrSqlProfiler *sql_profiler_create(const HrSqlProfileConfig *config);
+
+/** Frees @p profiler; detach it from its connection first. */
+void sql_profiler_destroy(struct HrSqlProfiler *profiler);
+
+/** Installs the profile hook on @p connection, replacing any other trace callback. */
+bool sql_profiler_attach(struct HrSqlProfiler *profiler, sqlite3 *connection);
+
+void sql_profiler_detach(sqlite3 *connection);
+
+/** Changes the slow-query threshold for statements finishing from now on (0 = no log). */
+void sql_profiler_set_slow_threshold(struct HrSqlProfiler *profiler, unsigned int slow_query_ms);
+
+/**
+ * Copies up to @p capacity statements into @p out, most total time first,
+ * and returns how many were copied.
+ */
+size_t sql_profiler_snapshot(struct HrSqlProfiler *profiler, HrSqlStatementStats *out, size_t capacity);
+
+void sql_profiler_get_stats(struct HrSqlProfiler *profiler, HrSqlProfileStats *out_stats);
+
+/** Clears the statement table and counters; queued slow statements are kept. */
+void sql_profiler_reset(struct HrSqlProfiler *profiler);
+
+/** True when slow statements are waiting for sql_profiler_write_slow_log(); lock-free. */
+bool sql_profiler_has_slow(struct HrSqlProfiler *profiler);
+
+/**
+ * Appends the queued slow statements to the log, each with the plan SQLite
+ * picks for it on @p connection, and returns how many were written. The
+ * plan is included the first time a statement shape is logged. Must not be
+ * called from inside a trace or other SQLite callback.
+ */
+size_t sql_profiler_write_slow_log(struct HrSqlProfiler *profiler, sqlite3 *connection);
+
+/**
+ * Writes the normalised form of @p sql into @p out and returns its length;
+ * the text is truncated to fit @p capacity.
+ */
+size_t sql_profile_normalize(const char *sql, char *out, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_SQL_PROFILE_H */
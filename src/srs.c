@@ -2,9 +2,28 @@
 
 #include <math.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+#include "span_trace.h"
+
+#define SRS_SECONDS_PER_DAY 86400
+
+#if defined(_MSC_VER)
+#define SRS_ALWAYS_INLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define SRS_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define SRS_ALWAYS_INLINE inline
+#endif
+
+struct SRSLoadBalancer {
+    uint32_t *counts;   /* Reviews due per day, indexed by day number modulo capacity. */
+    size_t capacity;    /* Number of days tracked inside the circular window. */
+    int64_t base_day;   /* First day number covered by the window. */
+};
+
 static double clamp_double(double value, double min_value, double max_value)
 {
     if (value < min_value) {
@@ -58,6 +77,8 @@ void srs_default_config(SRSConfig *config)
     config->exam_override_multiplier = 0.35;
     config->topic_modifier_floor = 0.5;
     config->topic_modifier_ceiling = 2.0;
+    config->fuzz_ratio = 0.15;
+    config->fuzz_max_days = 7.0;
 }
 
 void srs_state_init(SRSState *state, const SRSConfig *config)
@@ -128,10 +149,10 @@ void srs_state_unpack(SRSState *state, const SRSPersistedState *in,
     state->topic_adjustment = (in->topic_adjustment > 0.0) ? in->topic_adjustment : 1.0;
 }
 
-static double resolve_topic_modifier(const SRSConfig *config,
-                                     const SRSState *state,
-                                     const SRSReviewContext *context,
-                                     const SRSCalibrationHooks *hooks)
+static SRS_ALWAYS_INLINE double resolve_topic_modifier(const SRSConfig *config,
+                                                       const SRSState *state,
+                                                       const SRSReviewContext *context,
+                                                       const SRSCalibrationHooks *hooks)
 {
     double modifier = 1.0;
 
@@ -157,10 +178,10 @@ static double resolve_topic_modifier(const SRSConfig *config,
     return modifier;
 }
 
-static double adjust_ease_factor(const SRSConfig *config,
-                                 const SRSState *state,
-                                 double proposed_ease,
-                                 const SRSCalibrationHooks *hooks)
+static SRS_ALWAYS_INLINE double adjust_ease_factor(const SRSConfig *config,
+                                                   const SRSState *state,
+                                                   double proposed_ease,
+                                                   const SRSCalibrationHooks *hooks)
 {
     double ease = proposed_ease;
     if (hooks != NULL && hooks->ease_hook != NULL) {
@@ -175,10 +196,10 @@ static double adjust_ease_factor(const SRSConfig *config,
     return clamp_double(ease, ease_min, ease_max);
 }
 
-static double adjust_interval_days(const SRSConfig *config,
-                                   const SRSState *state,
-                                   double proposed_days,
-                                   const SRSCalibrationHooks *hooks)
+static SRS_ALWAYS_INLINE double adjust_interval_days(const SRSConfig *config,
+                                                     const SRSState *state,
+                                                     double proposed_days,
+                                                     const SRSCalibrationHooks *hooks)
 {
     double days = proposed_days;
     if (hooks != NULL && hooks->interval_hook != NULL) {
@@ -193,9 +214,9 @@ static double adjust_interval_days(const SRSConfig *config,
     return ensure_min_days(days, (config != NULL) ? config->minimum_interval_minutes : 10.0);
 }
 
-static double apply_cram_bleed(const SRSConfig *config,
-                               SRSState *state,
-                               double interval_days)
+static SRS_ALWAYS_INLINE double apply_cram_bleed(const SRSConfig *config,
+                                                 SRSState *state,
+                                                 double interval_days)
 {
     if (state == NULL || config == NULL) {
         return interval_days;
@@ -217,9 +238,9 @@ static double apply_cram_bleed(const SRSConfig *config,
     return blended;
 }
 
-static bool is_exam_override_active(const SRSConfig *config,
-                                    const SRSReviewContext *context,
-                                    double *out_days_until_exam)
+static SRS_ALWAYS_INLINE bool is_exam_override_active(const SRSConfig *config,
+                                                      const SRSReviewContext *context,
+                                                      double *out_days_until_exam)
 {
     if (config == NULL || context == NULL) {
         return false;
@@ -238,53 +259,36 @@ static bool is_exam_override_active(const SRSConfig *config,
     return days_until >= 0.0 && days_until <= config->exam_override_window_days;
 }
 
-SRSReviewResult srs_apply_review(const SRSConfig *config,
-                                 SRSState *state,
-                                 SRSReviewRating rating,
-                                 const SRSReviewContext *context,
-                                 const SRSCalibrationHooks *hooks,
-                                 const SRSCallbacks *callbacks)
+/*
+ * Shared scheduler body. @p config must be non-NULL and @p ctx already
+ * normalised (now set, positive topic weight). Specialised entry points
+ * pass literal NULL hooks/callbacks so the hook checks fold away after
+ * inlining.
+ */
+static SRS_ALWAYS_INLINE SRSReviewResult srs_review_core(const SRSConfig *config,
+                                                         SRSState *state,
+                                                         SRSReviewRating rating,
+                                                         const SRSReviewContext *ctx,
+                                                         const SRSCalibrationHooks *hooks,
+                                                         const SRSCallbacks *callbacks)
 {
     SRSReviewResult result;
     memset(&result, 0, sizeof(result));
     result.rating = rating;
-
-    if (state == NULL) {
-        return result;
-    }
-
-    SRSConfig local_config;
-    if (config == NULL) {
-        srs_default_config(&local_config);
-        config = &local_config;
-    }
-
-    SRSReviewContext ctx;
-    if (context != NULL) {
-        ctx = *context;
-    } else {
-        memset(&ctx, 0, sizeof(ctx));
-    }
-
-    if (ctx.now == 0) {
-        ctx.now = time(NULL);
-    }
-
-    if (ctx.topic.weight <= 0.0) {
-        ctx.topic.weight = 1.0;
-    }
+    const time_t now = ctx->now;
 
     double days_until_exam = 0.0;
-    const bool exam_override = is_exam_override_active(config, &ctx, &days_until_exam);
+    const bool exam_override = is_exam_override_active(config, ctx, &days_until_exam);
     const double exam_multiplier = exam_override
                                       ? clamp_double(config->exam_override_multiplier, 0.05, 1.0)
                                       : 1.0;
 
-    const double topic_modifier = resolve_topic_modifier(config, state, &ctx, hooks);
+    const double topic_modifier = resolve_topic_modifier(config, state, ctx, hooks);
     state->topic_adjustment = topic_modifier;
 
     const double previous_interval_days = state->interval_days;
     result.previous_interval_days = previous_interval_days;
+    result.previous_ease_factor = state->ease_factor;
 
     double ease = state->ease_factor;
     double interval_days = state->interval_days;
@@ -297,7 +301,7 @@ SRSReviewResult srs_apply_review(const SRSConfig *config,
         interval_minutes = config->cram_initial_interval_minutes;
     }
 
-    bool used_cram = ctx.cram_session || rating == SRS_RESPONSE_CRAM;
+    bool used_cram = ctx->cram_session || rating == SRS_RESPONSE_CRAM;
 
     if (used_cram) {
         switch (rating) {
@@ -385,13 +389,13 @@ SRSReviewResult srs_apply_review(const SRSConfig *config,
     interval_days = ensure_min_days(interval_days, config->minimum_interval_minutes);
     interval_minutes = interval_days * 1440.0;
 
-    const time_t due_time = compute_due_time(ctx.now, interval_minutes);
+    const time_t due_time = compute_due_time(now, interval_minutes);
     state->interval_days = interval_days;
     state->due = due_time;
-    state->last_review = ctx.now;
+    state->last_review = now;
     state->version = SRS_STATE_VERSION;
 
-    result.review_time = ctx.now;
+    result.review_time = now;
     result.due = due_time;
     result.interval_days = interval_days;
     result.interval_minutes = interval_minutes;
@@ -405,7 +409,7 @@ SRSReviewResult srs_apply_review(const SRSConfig *config,
     if (callbacks != NULL) {
         SRSReviewEvent event;
         event.state = state;
-        event.context = ctx;
+        event.context = *ctx;
         event.result = result;
 
         if (callbacks->session_callback != NULL) {
@@ -418,3 +422,276 @@ SRSReviewResult srs_apply_review(const SRSConfig *config,
 
     return result;
 }
+
+SRSReviewResult srs_apply_review(const SRSConfig *config,
+                                 SRSState *state,
+                                 SRSReviewRating rating,
+                                 const SRSReviewContext *context,
+                                 const SRSCalibrationHooks *hooks,
+                                 const SRSCallbacks *callbacks)
+{
+    if (state == NULL) {
+        SRSReviewResult result;
+        memset(&result, 0, sizeof(result));
+        result.rating = rating;
+        return result;
+    }
+
+    SRSConfig local_config;
+    if (config == NULL) {
+        srs_default_config(&local_config);
+        config = &local_config;
+    }
+
+    SRSReviewContext ctx;
+    if (context != NULL) {
+        ctx = *context;
+    } else {
+        memset(&ctx, 0, sizeof(ctx));
+    }
+
+    if (ctx.now == 0) {
+        ctx.now = time(NULL);
+    }
+
+    if (ctx.topic.weight <= 0.0) {
+        ctx.topic.weight = 1.0;
+    }
+
+    HR_SPAN_BEGIN(span, "srs.review");
+    const SRSReviewResult result = srs_review_core(config, state, rating, &ctx, hooks, callbacks);
+    HR_SPAN_END(span);
+    return result;
+}
+
+#define SRS_DEFINE_REVIEW_VARIANT(name, hooks_arg, callbacks_arg)                        \
+    static SRSReviewResult name(const SRSConfig *config,                                  \
+                                SRSState *state,                                          \
+                                SRSReviewRating rating,                                   \
+                                const SRSReviewContext *context,                          \
+                                const SRSCalibrationHooks *hooks,                         \
+                                const SRSCallbacks *callbacks)                            \
+    {                                                                                     \
+        (void)hooks;                                                                      \
+        (void)callbacks;                                                                  \
+        HR_SPAN_BEGIN(span, "srs.review");                                                \
+        const SRSReviewResult result =                                                    \
+            srs_review_core(config, state, rating, context, hooks_arg, callbacks_arg);    \
+        HR_SPAN_END(span);                                                                \
+        return result;                                                                    \
+    }
+
+SRS_DEFINE_REVIEW_VARIANT(srs_review_plain, NULL, NULL)
+SRS_DEFINE_REVIEW_VARIANT(srs_review_with_hooks, hooks, NULL)
+SRS_DEFINE_REVIEW_VARIANT(srs_review_with_callbacks, NULL, callbacks)
+SRS_DEFINE_REVIEW_VARIANT(srs_review_with_all, hooks, callbacks)
+
+#undef SRS_DEFINE_REVIEW_VARIANT
+
+srs_review_fn srs_select_review_fn(const SRSCalibrationHooks *hooks,
+                                   const SRSCallbacks *callbacks)
+{
+    const bool has_hooks = hooks != NULL &&
+                           (hooks->ease_hook != NULL || hooks->interval_hook != NULL || hooks->topic_hook != NULL);
+    const bool has_callbacks = callbacks != NULL &&
+                               (callbacks->session_callback != NULL || callbacks->analytics_callback != NULL);
+
+    if (has_hooks) {
+        return has_callbacks ? srs_review_with_all : srs_review_with_hooks;
+    }
+    return has_callbacks ? srs_review_with_callbacks : srs_review_plain;
+}
+
+double srs_recall_probability(const SRSState *state, time_t now)
+{
+    if (state == NULL || state->last_review <= 0) {
+        return 0.0;
+    }
+
+    const double interval_days = (state->interval_days > 0.0) ? state->interval_days : 1.0;
+    double elapsed_days = difftime(now, state->last_review) / (double)SRS_SECONDS_PER_DAY;
+    if (elapsed_days < 0.0) {
+        elapsed_days = 0.0;
+    }
+
+    return exp(log(SRS_TARGET_RECALL) * elapsed_days / interval_days);
+}
+
+static int64_t load_balancer_day(time_t timestamp)
+{
+    const int64_t seconds = (int64_t)timestamp;
+    int64_t day = seconds / SRS_SECONDS_PER_DAY;
+    if (seconds < 0 && (seconds % SRS_SECONDS_PER_DAY) != 0) {
+        day -= 1;
+    }
+    return day;
+}
+
+static uint32_t *load_balancer_slot(const SRSLoadBalancer *balancer, int64_t day)
+{
+    if (balancer == NULL || balancer->counts == NULL) {
+        return NULL;
+    }
+
+    if (day < balancer->base_day || day >= balancer->base_day + (int64_t)balancer->capacity) {
+        return NULL;
+    }
+
+    return &balancer->counts[(size_t)(day % (int64_t)balancer->capacity)];
+}
+
+static void load_balancer_advance(SRSLoadBalancer *balancer, int64_t today)
+{
+    if (balancer == NULL || today <= balancer->base_day) {
+        return;
+    }
+
+    const int64_t shift = today - balancer->base_day;
+    if (shift >= (int64_t)balancer->capacity) {
+        memset(balancer->counts, 0, balancer->capacity * sizeof(uint32_t));
+    } else {
+        /* Days that fell out of the window become the newest days at the far end. */
+        for (int64_t day = balancer->base_day; day < today; ++day) {
+            balancer->counts[(size_t)(day % (int64_t)balancer->capacity)] = 0u;
+        }
+    }
+    balancer->base_day = today;
+}
+
+SRSLoadBalancer *srs_load_balancer_create(size_t horizon_days)
+{
+    if (horizon_days == 0u) {
+        return NULL;
+    }
+
+    SRSLoadBalancer *balancer = (SRSLoadBalancer *)calloc(1u, sizeof(SRSLoadBalancer));
+    if (balancer == NULL) {
+        return NULL;
+    }
+
+    balancer->counts = (uint32_t *)calloc(horizon_days, sizeof(uint32_t));
+    if (balancer->counts == NULL) {
+        free(balancer);
+        return NULL;
+    }
+
+    balancer->capacity = horizon_days;
+    balancer->base_day = load_balancer_day(time(NULL));
+    return balancer;
+}
+
+void srs_load_balancer_destroy(SRSLoadBalancer *balancer)
+{
+    if (balancer == NULL) {
+        return;
+    }
+
+    free(balancer->counts);
+    free(balancer);
+}
+
+void srs_load_balancer_reset(SRSLoadBalancer *balancer, time_t now)
+{
+    if (balancer == NULL) {
+        return;
+    }
+
+    memset(balancer->counts, 0, balancer->capacity * sizeof(uint32_t));
+    balancer->base_day = load_balancer_day(now != 0 ? now : time(NULL));
+}
+
+void srs_load_balancer_roll(SRSLoadBalancer *balancer, time_t now)
+{
+    load_balancer_advance(balancer, load_balancer_day(now));
+}
+
+void srs_load_balancer_add(SRSLoadBalancer *balancer, time_t due, uint32_t count)
+{
+    uint32_t *slot = load_balancer_slot(balancer, load_balancer_day(due));
+    if (slot == NULL) {
+        return;
+    }
+
+    *slot = (UINT32_MAX - *slot < count) ? UINT32_MAX : (*slot + count);
+}
+
+void srs_load_balancer_remove(SRSLoadBalancer *balancer, time_t due)
+{
+    uint32_t *slot = load_balancer_slot(balancer, load_balancer_day(due));
+    if (slot != NULL && *slot > 0u) {
+        *slot -= 1u;
+    }
+}
+
+uint32_t srs_load_balancer_load(const SRSLoadBalancer *balancer, time_t day)
+{
+    const uint32_t *slot = load_balancer_slot(balancer, load_balancer_day(day));
+    return (slot != NULL) ? *slot : 0u;
+}
+
+bool srs_load_balancer_apply(SRSLoadBalancer *balancer,
+                             const SRSConfig *config,
+                             time_t previous_due,
+                             SRSState *state,
+                             SRSReviewResult *result)
+{
+    if (balancer == NULL || state == NULL) {
+        return false;
+    }
+
+    const time_t review_time = (result != NULL && result->review_time != 0) ? result->review_time
+                                                                            : state->last_review;
+    const int64_t today = load_balancer_day(review_time != 0 ? review_time : time(NULL));
+    load_balancer_advance(balancer, today);
+
+    if (previous_due > 0) {
+        srs_load_balancer_remove(balancer, previous_due);
+    }
+
+    const double ratio = (config != NULL) ? config->fuzz_ratio : 0.15;
+    const double max_days = (config != NULL) ? config->fuzz_max_days : 7.0;
+
+    double window_days = state->interval_days * clamp_double(ratio, 0.0, 1.0);
+    if (window_days > max_days) {
+        window_days = max_days;
+    }
+    const int64_t window = (state->mode == SRS_MODE_MASTERY && window_days >= 1.0)
+                               ? (int64_t)floor(window_days)
+                               : 0;
+
+    const int64_t target_day = load_balancer_day(state->due);
+    int64_t best_day = target_day;
+
+    if (window > 0) {
+        uint32_t best_load = UINT32_MAX;
+        int64_t best_distance = INT64_MAX;
+        for (int64_t day = target_day - window; day <= target_day + window; ++day) {
+            /* Never pull a card back onto the review day itself. */
+            if (day <= today) {
+                continue;
+            }
+            const uint32_t *slot = load_balancer_slot(balancer, day);
+            const uint32_t load = (slot != NULL) ? *slot : 0u;
+            const int64_t distance = (day > target_day) ? (day - target_day) : (target_day - day);
+            if (load < best_load || (load == best_load && distance < best_distance)) {
+                best_load = load;
+                best_distance = distance;
+                best_day = day;
+            }
+        }
+    }
+
+    const int64_t shift_days = best_day - target_day;
+    if (shift_days != 0) {
+        state->due += (time_t)(shift_days * SRS_SECONDS_PER_DAY);
+        state->interval_days += (double)shift_days;
+        if (result != NULL) {
+            result->due = state->due;
+            result->interval_days = state->interval_days;
+            result->interval_minutes = state->interval_days * 1440.0;
+        }
+    }
+
+    srs_load_balancer_add(balancer, state->due, 1u);
+    return shift_days != 0;
+}
@@ -18,6 +18,9 @@ extern "C" {
 /** Version tag stored with persisted SRS state. */
 #define SRS_STATE_VERSION 1u
 
+/** Recall probability the mastery intervals are tuned to hit on the due date. */
+#define SRS_TARGET_RECALL 0.9
+
 /** Possible learner feedback ratings for a review. */
 typedef enum SRSReviewRating {
     SRS_RESPONSE_FAIL = 0,  /**< The learner could not recall the prompt. */
@@ -57,6 +60,8 @@ typedef struct SRSConfig {
     double exam_override_multiplier;      /**< Compression factor during exam week. */
     double topic_modifier_floor;          /**< Minimum topic multiplier allowed. */
     double topic_modifier_ceiling;        /**< Maximum topic multiplier allowed. */
+    double fuzz_ratio;                    /**< Fraction of the interval the load balancer may shift. */
+    double fuzz_max_days;                 /**< Absolute cap on load-balancer shifts in days. */
 } SRSConfig;
 
 /**
@@ -112,6 +117,7 @@ typedef struct SRSReviewResult {
     time_t review_time;        /**< Timestamp when the review occurred. */
     time_t due;                /**< Computed due date for the next review. */
     double previous_interval_days; /**< Interval before the update (days). */
+    double previous_ease_factor;   /**< Ease factor the review started from. */
     double interval_days;      /**< New mastery interval in days. */
     double interval_minutes;   /**< New interval in minutes (cram friendly). */
     double topic_modifier;     /**< Multiplier applied from topic adjustments. */
@@ -167,6 +173,14 @@ typedef struct SRSCallbacks {
     void *analytics_user_data;
 } SRSCallbacks;
 
+/**
+ * Per-day histogram of scheduled reviews used to smooth future workload.
+ *
+ * Days are indexed by UTC day number inside a circular window that starts at
+ * the most recent review day, so updates and lookups are O(1).
+ */
+typedef struct SRSLoadBalancer SRSLoadBalancer;
+
 void srs_default_config(SRSConfig *config);
 void srs_state_init(SRSState *state, const SRSConfig *config);
 void srs_state_pack(const SRSState *state, SRSPersistedState *out);
@@ -179,6 +193,73 @@ SRSReviewResult srs_apply_review(const SRSConfig *config,
                                  const SRSCalibrationHooks *hooks,
                                  const SRSCallbacks *callbacks);
 
+/**
+ * Scheduler entry point with the same signature as srs_apply_review().
+ *
+ * Variants returned by srs_select_review_fn() skip the defensive work done by
+ * srs_apply_review(): @p config and @p state must be non-NULL, @p context must be non-NULL
+ * with @c now set and a positive topic weight, and the hooks/callbacks must be
+ * the ones the variant was selected for.
+ */
+typedef SRSReviewResult (*srs_review_fn)(const SRSConfig *config,
+                                         SRSState *state,
+                                         SRSReviewRating rating,
+                                         const SRSReviewContext *context,
+                                         const SRSCalibrationHooks *hooks,
+                                         const SRSCallbacks *callbacks);
+
+/**
+ * Picks the scheduler variant specialised for the supplied hooks/callbacks.
+ *
+ * Intended to be resolved once per session or batch; variants compiled for
+ * NULL hooks/callbacks carry no per-review hook or callback checks.
+ */
+srs_review_fn srs_select_review_fn(const SRSCalibrationHooks *hooks,
+                                   const SRSCallbacks *callbacks);
+
+/**
+ * Estimates the probability that @p state can still be recalled at @p now.
+ *
+ * Memory is modelled as exponential decay calibrated so that recall equals
+ * SRS_TARGET_RECALL exactly when a full interval has elapsed. Cards that have
+ * never been reviewed report 0.
+ */
+double srs_recall_probability(const SRSState *state, time_t now);
+
+/** Allocates a load balancer tracking @p horizon_days days ahead of today. */
+SRSLoadBalancer *srs_load_balancer_create(size_t horizon_days);
+
+/** Releases the histogram owned by the load balancer. */
+void srs_load_balancer_destroy(SRSLoadBalancer *balancer);
+
+/** Clears all tracked days and anchors the window at the day containing @p now. */
+void srs_load_balancer_reset(SRSLoadBalancer *balancer, time_t now);
+
+/** Moves the window forward to the day containing @p now, dropping the days that have passed. */
+void srs_load_balancer_roll(SRSLoadBalancer *balancer, time_t now);
+
+/** Records @p count reviews due at @p due (ignored outside the tracked window). */
+void srs_load_balancer_add(SRSLoadBalancer *balancer, time_t due, uint32_t count);
+
+/** Forgets one review previously recorded at @p due. */
+void srs_load_balancer_remove(SRSLoadBalancer *balancer, time_t due);
+
+/** Returns the number of reviews currently scheduled on the day containing @p day. */
+uint32_t srs_load_balancer_load(const SRSLoadBalancer *balancer, time_t day);
+
+/**
+ * Moves the freshly computed due date in @p state onto the least-loaded day
+ * within the fuzz window allowed by @p config, updating @p result to match.
+ *
+ * @p previous_due is the card's due date before the review and is removed
+ * from the histogram. Returns true when the due date was shifted.
+ */
+bool srs_load_balancer_apply(SRSLoadBalancer *balancer,
+                             const SRSConfig *config,
+                             time_t previous_due,
+                             SRSState *state,
+                             SRSReviewResult *result);
+
 #ifdef __cplusplus
 }
 #endif
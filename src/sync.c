@@ -0,0 +1,272 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "sync.h"
+
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+
+static DWORD WINAPI hr_thread_trampoline(LPVOID param)
+{
+    HrThread *thread = (HrThread *)param;
+    thread->fn(thread->user_data);
+    return 0;
+}
+
+bool hr_thread_start(HrThread *thread, HrThreadFn fn, void *user_data)
+{
+    if (thread == NULL || fn == NULL) {
+        return false;
+    }
+
+    memset(thread, 0, sizeof(*thread));
+    thread->fn = fn;
+    thread->user_data = user_data;
+    thread->handle = CreateThread(NULL, 0, hr_thread_trampoline, thread, 0, NULL);
+    thread->started = (thread->handle != NULL);
+    return thread->started;
+}
+
+void hr_thread_join(HrThread *thread)
+{
+    if (thread == NULL || !thread->started) {
+        return;
+    }
+
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    thread->handle = NULL;
+    thread->started = false;
+}
+
+bool hr_mutex_init(HrMutex *mutex)
+{
+    if (mutex == NULL) {
+        return false;
+    }
+    InitializeSRWLock(&mutex->lock);
+    return true;
+}
+
+void hr_mutex_destroy(HrMutex *mutex)
+{
+    (void)mutex; /* SRW locks hold no resources. */
+}
+
+void hr_mutex_lock(HrMutex *mutex)
+{
+    AcquireSRWLockExclusive(&mutex->lock);
+}
+
+void hr_mutex_unlock(HrMutex *mutex)
+{
+    ReleaseSRWLockExclusive(&mutex->lock);
+}
+
+bool hr_cond_init(HrCond *cond)
+{
+    if (cond == NULL) {
+        return false;
+    }
+    InitializeConditionVariable(&cond->cond);
+    return true;
+}
+
+void hr_cond_destroy(HrCond *cond)
+{
+    (void)cond;
+}
+
+void hr_cond_wait(HrCond *cond, HrMutex *mutex)
+{
+    SleepConditionVariableSRW(&cond->cond, &mutex->lock, INFINITE, 0);
+}
+
+bool hr_cond_wait_timeout(HrCond *cond, HrMutex *mutex, uint32_t timeout_ms)
+{
+    return SleepConditionVariableSRW(&cond->cond, &mutex->lock, (DWORD)timeout_ms, 0) != 0;
+}
+
+void hr_cond_signal(HrCond *cond)
+{
+    WakeConditionVariable(&cond->cond);
+}
+
+void hr_cond_broadcast(HrCond *cond)
+{
+    WakeAllConditionVariable(&cond->cond);
+}
+
+void hr_atomic_u64_init(HrAtomicU64 *atomic, uint64_t value)
+{
+    atomic->value = (LONG64)value;
+}
+
+uint64_t hr_atomic_u64_load(const HrAtomicU64 *atomic)
+{
+    /* Interlocked operations are full barriers; a no-op exchange reads without tearing. */
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64 *)&atomic->value, 0, 0);
+}
+
+void hr_atomic_u64_store(HrAtomicU64 *atomic, uint64_t value)
+{
+    InterlockedExchange64(&atomic->value, (LONG64)value);
+}
+
+uint64_t hr_atomic_u64_fetch_add(HrAtomicU64 *atomic, uint64_t delta)
+{
+    return (uint64_t)InterlockedExchangeAdd64(&atomic->value, (LONG64)delta);
+}
+
+bool hr_atomic_u64_compare_exchange(HrAtomicU64 *atomic, uint64_t *expected, uint64_t desired)
+{
+    const LONG64 previous = InterlockedCompareExchange64(&atomic->value, (LONG64)desired, (LONG64)*expected);
+    if ((uint64_t)previous == *expected) {
+        return true;
+    }
+    *expected = (uint64_t)previous;
+    return false;
+}
+
+uint64_t hr_monotonic_micros(void)
+{
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    /* Split to keep counter * 1e6 from overflowing on long uptimes. */
+    const uint64_t ticks = (uint64_t)counter.QuadPart;
+    const uint64_t rate = (uint64_t)frequency.QuadPart;
+    return (ticks / rate) * 1000000U + (ticks % rate) * 1000000U / rate;
+}
+
+#else
+
+static void *hr_thread_trampoline(void *param)
+{
+    HrThread *thread = (HrThread *)param;
+    thread->fn(thread->user_data);
+    return NULL;
+}
+
+bool hr_thread_start(HrThread *thread, HrThreadFn fn, void *user_data)
+{
+    if (thread == NULL || fn == NULL) {
+        return false;
+    }
+
+    memset(thread, 0, sizeof(*thread));
+    thread->fn = fn;
+    thread->user_data = user_data;
+    thread->started = (pthread_create(&thread->handle, NULL, hr_thread_trampoline, thread) == 0);
+    return thread->started;
+}
+
+void hr_thread_join(HrThread *thread)
+{
+    if (thread == NULL || !thread->started) {
+        return;
+    }
+
+    pthread_join(thread->handle, NULL);
+    thread->started = false;
+}
+
+bool hr_mutex_init(HrMutex *mutex)
+{
+    return mutex != NULL && pthread_mutex_init(&mutex->lock, NULL) == 0;
+}
+
+void hr_mutex_destroy(HrMutex *mutex)
+{
+    if (mutex != NULL) {
+        pthread_mutex_destroy(&mutex->lock);
+    }
+}
+
+void hr_mutex_lock(HrMutex *mutex)
+{
+    pthread_mutex_lock(&mutex->lock);
+}
+
+void hr_mutex_unlock(HrMutex *mutex)
+{
+    pthread_mutex_unlock(&mutex->lock);
+}
+
+bool hr_cond_init(HrCond *cond)
+{
+    return cond != NULL && pthread_cond_init(&cond->cond, NULL) == 0;
+}
+
+void hr_cond_destroy(HrCond *cond)
+{
+    if (cond != NULL) {
+        pthread_cond_destroy(&cond->cond);
+    }
+}
+
+void hr_cond_wait(HrCond *cond, HrMutex *mutex)
+{
+    pthread_cond_wait(&cond->cond, &mutex->lock);
+}
+
+bool hr_cond_wait_timeout(HrCond *cond, HrMutex *mutex, uint32_t timeout_ms)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += (time_t)(timeout_ms / 1000U);
+    deadline.tv_nsec += (long)(timeout_ms % 1000U) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return pthread_cond_timedwait(&cond->cond, &mutex->lock, &deadline) == 0;
+}
+
+void hr_cond_signal(HrCond *cond)
+{
+    pthread_cond_signal(&cond->cond);
+}
+
+void hr_cond_broadcast(HrCond *cond)
+{
+    pthread_cond_broadcast(&cond->cond);
+}
+
+void hr_atomic_u64_init(HrAtomicU64 *atomic, uint64_t value)
+{
+    atomic_init(&atomic->value, value);
+}
+
+uint64_t hr_atomic_u64_load(const HrAtomicU64 *atomic)
+{
+    return atomic_load_explicit((_Atomic uint64_t *)&atomic->value, memory_order_acquire);
+}
+
+void hr_atomic_u64_store(HrAtomicU64 *atomic, uint64_t value)
+{
+    atomic_store_explicit(&atomic->value, value, memory_order_release);
+}
+
+uint64_t hr_atomic_u64_fetch_add(HrAtomicU64 *atomic, uint64_t delta)
+{
+    return atomic_fetch_add(&atomic->value, delta);
+}
+
+bool hr_atomic_u64_compare_exchange(HrAtomicU64 *atomic, uint64_t *expected, uint64_t desired)
+{
+    return atomic_compare_exchange_strong(&atomic->value, expected, desired);
+}
+
+uint64_t hr_monotonic_micros(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000U + (uint64_t)now.tv_nsec / 1000U;
+}
+
+#endif
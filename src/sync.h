@@ -0,0 +1,124 @@
+#ifndef HYPERRECALL_SYNC_H
+#define HYPERRECALL_SYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file sync.h
+ * @brief Minimal threads, mutexes, condition variables, atomics and a monotonic clock over pthreads or Win32.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+
+/** Entry point run on a worker thread. */
+typedef void (*HrThreadFn)(void *user_data);
+
+/** Joinable worker thread. */
+typedef struct HrThread {
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    HrThreadFn fn;
+    void *user_data;
+    bool started;
+} HrThread;
+
+/** Non-recursive mutex. */
+typedef struct HrMutex {
+#if defined(_WIN32)
+    SRWLOCK lock;
+#else
+    pthread_mutex_t lock;
+#endif
+} HrMutex;
+
+/** Condition variable used together with an HrMutex. */
+typedef struct HrCond {
+#if defined(_WIN32)
+    CONDITION_VARIABLE cond;
+#else
+    pthread_cond_t cond;
+#endif
+} HrCond;
+
+/** 64-bit counter shared between threads without a lock. */
+typedef struct HrAtomicU64 {
+#if defined(_WIN32)
+    volatile LONG64 value;
+#else
+    _Atomic uint64_t value;
+#endif
+} HrAtomicU64;
+
+/**
+ * Starts @p fn on a new thread. The HrThread must stay at a stable address
+ * until hr_thread_join() returns.
+ */
+bool hr_thread_start(HrThread *thread, HrThreadFn fn, void *user_data);
+
+/** Waits for a thread started with hr_thread_start(); no-op when it never started. */
+void hr_thread_join(HrThread *thread);
+
+bool hr_mutex_init(HrMutex *mutex);
+
+void hr_mutex_destroy(HrMutex *mutex);
+
+void hr_mutex_lock(HrMutex *mutex);
+
+void hr_mutex_unlock(HrMutex *mutex);
+
+bool hr_cond_init(HrCond *cond);
+
+void hr_cond_destroy(HrCond *cond);
+
+/** Atomically releases @p mutex and waits; the mutex is held again on return. */
+void hr_cond_wait(HrCond *cond, HrMutex *mutex);
+
+/** Like hr_cond_wait() but gives up after @p timeout_ms. Returns false on timeout. */
+bool hr_cond_wait_timeout(HrCond *cond, HrMutex *mutex, uint32_t timeout_ms);
+
+void hr_cond_signal(HrCond *cond);
+
+void hr_cond_broadcast(HrCond *cond);
+
+/** Sets the initial value; not synchronized, call before the atomic is shared. */
+void hr_atomic_u64_init(HrAtomicU64 *atomic, uint64_t value);
+
+/** Load with acquire ordering. */
+uint64_t hr_atomic_u64_load(const HrAtomicU64 *atomic);
+
+/** Store with release ordering. */
+void hr_atomic_u64_store(HrAtomicU64 *atomic, uint64_t value);
+
+/** Adds @p delta and returns the previous value (sequentially consistent). */
+uint64_t hr_atomic_u64_fetch_add(HrAtomicU64 *atomic, uint64_t delta);
+
+/**
+ * Replaces the value with @p desired if it still equals @p *expected. On
+ * failure @p *expected receives the current value.
+ */
+bool hr_atomic_u64_compare_exchange(HrAtomicU64 *atomic, uint64_t *expected, uint64_t desired);
+
+/** Microseconds since an arbitrary fixed point; unaffected by wall-clock changes. */
+uint64_t hr_monotonic_micros(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_SYNC_H */
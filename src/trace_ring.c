@@ -0,0 +1,331 @@
+#include "trace_ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sync.h"
+
+/* Data words stored per slot; the sequence lives in the slot stamp. */
+#define TRACE_RING_WORDS 9U
+
+/**
+ * A slot is a small seqlock: the stamp is odd while a writer fills it and
+ * 2 * sequence + 2 once the record for that sequence is complete. The words
+ * are atomics too, so a reader racing a writer sees a changed stamp instead
+ * of undefined behaviour.
+ */
+typedef struct TraceSlot {
+    HrAtomicU64 stamp;
+    HrAtomicU64 words[TRACE_RING_WORDS];
+} TraceSlot;
+
+struct HrTraceRing {
+    TraceSlot *slots;
+    size_t capacity;
+    uint64_t mask;
+    HrAtomicU64 head;       /* Next sequence to hand out. */
+    HrAtomicU64 floor;      /* First sequence still visible after trace_ring_clear(). */
+    HrAtomicU64 collisions; /* Records dropped because their slot was busy. */
+};
+
+static uint64_t trace_double_bits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double trace_bits_double(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void trace_encode(const HrTraceRecord *record, uint64_t words[TRACE_RING_WORDS])
+{
+    words[0] = record->card_id;
+    words[1] = (uint64_t)record->review_id;
+    words[2] = (uint64_t)record->review_time;
+    words[3] = (uint64_t)record->due;
+    words[4] = trace_double_bits(record->previous_interval_days);
+    words[5] = trace_double_bits(record->interval_days);
+    words[6] = trace_double_bits(record->ease_factor);
+    words[7] = (uint64_t)record->queue_position | ((uint64_t)record->remaining << 32);
+    words[8] = (uint64_t)record->source | ((uint64_t)record->mode << 16) | ((uint64_t)record->rating << 24) |
+               ((uint64_t)record->flags << 32);
+}
+
+static void trace_decode(uint64_t sequence, const uint64_t words[TRACE_RING_WORDS], HrTraceRecord *out_record)
+{
+    out_record->sequence = sequence;
+    out_record->card_id = words[0];
+    out_record->review_id = (int64_t)words[1];
+    out_record->review_time = (int64_t)words[2];
+    out_record->due = (int64_t)words[3];
+    out_record->previous_interval_days = trace_bits_double(words[4]);
+    out_record->interval_days = trace_bits_double(words[5]);
+    out_record->ease_factor = trace_bits_double(words[6]);
+    out_record->queue_position = (uint32_t)(words[7] & 0xFFFFFFFFu);
+    out_record->remaining = (uint32_t)(words[7] >> 32);
+    out_record->source = (uint16_t)(words[8] & 0xFFFFu);
+    out_record->mode = (uint8_t)((words[8] >> 16) & 0xFFu);
+    out_record->rating = (uint8_t)((words[8] >> 24) & 0xFFu);
+    out_record->flags = (uint8_t)((words[8] >> 32) & 0xFFu);
+}
+
+struct HrTraceRing *trace_ring_create(size_t capacity)
+{
+    if (capacity == 0u) {
+        capacity = HR_TRACE_RING_DEFAULT_CAPACITY;
+    }
+
+    size_t rounded = 1u;
+    while (rounded < capacity) {
+        if (rounded > ((size_t)-1) / 2u) {
+            return NULL;
+        }
+        rounded *= 2u;
+    }
+
+    struct HrTraceRing *ring = (struct HrTraceRing *)calloc(1u, sizeof(struct HrTraceRing));
+    if (ring == NULL) {
+        return NULL;
+    }
+
+    ring->slots = (TraceSlot *)calloc(rounded, sizeof(TraceSlot));
+    if (ring->slots == NULL) {
+        free(ring);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < rounded; ++i) {
+        hr_atomic_u64_init(&ring->slots[i].stamp, 0u);
+        for (size_t w = 0; w < TRACE_RING_WORDS; ++w) {
+            hr_atomic_u64_init(&ring->slots[i].words[w], 0u);
+        }
+    }
+    ring->capacity = rounded;
+    ring->mask = (uint64_t)rounded - 1u;
+    hr_atomic_u64_init(&ring->head, 0u);
+    hr_atomic_u64_init(&ring->floor, 0u);
+    hr_atomic_u64_init(&ring->collisions, 0u);
+    return ring;
+}
+
+void trace_ring_destroy(struct HrTraceRing *ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+
+    free(ring->slots);
+    free(ring);
+}
+
+size_t trace_ring_capacity(const struct HrTraceRing *ring)
+{
+    return (ring != NULL) ? ring->capacity : 0u;
+}
+
+void trace_ring_record(struct HrTraceRing *ring, const HrTraceRecord *record)
+{
+    if (ring == NULL || record == NULL) {
+        return;
+    }
+
+    const uint64_t sequence = hr_atomic_u64_fetch_add(&ring->head, 1u);
+    TraceSlot *slot = &ring->slots[sequence & ring->mask];
+    const uint64_t writing = sequence * 2u + 1u;
+
+    /* Claim the slot unless another writer holds it or already stored something newer. */
+    uint64_t expected = hr_atomic_u64_load(&slot->stamp);
+    do {
+        if ((expected & 1u) != 0u || expected >= writing) {
+            hr_atomic_u64_fetch_add(&ring->collisions, 1u);
+            return;
+        }
+    } while (!hr_atomic_u64_compare_exchange(&slot->stamp, &expected, writing));
+
+    uint64_t words[TRACE_RING_WORDS];
+    trace_encode(record, words);
+    for (size_t w = 0; w < TRACE_RING_WORDS; ++w) {
+        hr_atomic_u64_store(&slot->words[w], words[w]);
+    }
+    hr_atomic_u64_store(&slot->stamp, writing + 1u);
+}
+
+uint64_t trace_ring_total(const struct HrTraceRing *ring)
+{
+    if (ring == NULL) {
+        return 0u;
+    }
+
+    const uint64_t head = hr_atomic_u64_load(&ring->head);
+    const uint64_t floor = hr_atomic_u64_load(&ring->floor);
+    return (head > floor) ? head - floor : 0u;
+}
+
+size_t trace_ring_snapshot(const struct HrTraceRing *ring, HrTraceRecord *out_records, size_t capacity)
+{
+    if (ring == NULL || out_records == NULL || capacity == 0u) {
+        return 0u;
+    }
+
+    const uint64_t head = hr_atomic_u64_load(&ring->head);
+    uint64_t start = hr_atomic_u64_load(&ring->floor);
+    if (head - start > (uint64_t)ring->capacity || start > head) {
+        start = (head > (uint64_t)ring->capacity) ? head - (uint64_t)ring->capacity : 0u;
+    }
+
+    size_t copied = 0u;
+    for (uint64_t sequence = start; sequence < head && copied < capacity; ++sequence) {
+        const TraceSlot *slot = &ring->slots[sequence & ring->mask];
+        const uint64_t complete = sequence * 2u + 2u;
+        if (hr_atomic_u64_load(&slot->stamp) != complete) {
+            continue; /* Still being written, or already overwritten by a newer lap. */
+        }
+
+        uint64_t words[TRACE_RING_WORDS];
+        for (size_t w = 0; w < TRACE_RING_WORDS; ++w) {
+            words[w] = hr_atomic_u64_load(&slot->words[w]);
+        }
+        if (hr_atomic_u64_load(&slot->stamp) != complete) {
+            continue;
+        }
+
+        trace_decode(sequence, words, &out_records[copied]);
+        ++copied;
+    }
+    return copied;
+}
+
+void trace_ring_clear(struct HrTraceRing *ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+
+    hr_atomic_u64_store(&ring->floor, hr_atomic_u64_load(&ring->head));
+}
+
+static void trace_put_u32(unsigned char *out, uint32_t value)
+{
+    for (size_t i = 0; i < 4u; ++i) {
+        out[i] = (unsigned char)((value >> (8u * i)) & 0xFFu);
+    }
+}
+
+static void trace_put_u64(unsigned char *out, uint64_t value)
+{
+    for (size_t i = 0; i < 8u; ++i) {
+        out[i] = (unsigned char)((value >> (8u * i)) & 0xFFu);
+    }
+}
+
+static uint32_t trace_get_u32(const unsigned char *in)
+{
+    uint32_t value = 0u;
+    for (size_t i = 0; i < 4u; ++i) {
+        value |= (uint32_t)in[i] << (8u * i);
+    }
+    return value;
+}
+
+static uint64_t trace_get_u64(const unsigned char *in)
+{
+    uint64_t value = 0u;
+    for (size_t i = 0; i < 8u; ++i) {
+        value |= (uint64_t)in[i] << (8u * i);
+    }
+    return value;
+}
+
+bool trace_ring_dump(const struct HrTraceRing *ring, const char *path)
+{
+    if (ring == NULL || path == NULL || path[0] == '\0') {
+        return false;
+    }
+
+    HrTraceRecord *records = (HrTraceRecord *)malloc(ring->capacity * sizeof(HrTraceRecord));
+    if (records == NULL) {
+        return false;
+    }
+    const uint64_t total = trace_ring_total(ring);
+    const size_t count = trace_ring_snapshot(ring, records, ring->capacity);
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        free(records);
+        return false;
+    }
+
+    unsigned char header[HR_TRACE_FILE_HEADER_BYTES];
+    memcpy(header, HR_TRACE_FILE_MAGIC, 4u);
+    trace_put_u32(header + 4, HR_TRACE_FILE_VERSION);
+    trace_put_u32(header + 8, HR_TRACE_FILE_RECORD_BYTES);
+    trace_put_u32(header + 12, 0u);
+    trace_put_u64(header + 16, (uint64_t)count);
+    trace_put_u64(header + 24, (total > count) ? total - count : 0u);
+    bool ok = fwrite(header, sizeof(header), 1u, file) == 1u;
+
+    for (size_t i = 0; ok && i < count; ++i) {
+        uint64_t words[TRACE_RING_WORDS];
+        trace_encode(&records[i], words);
+
+        unsigned char bytes[HR_TRACE_FILE_RECORD_BYTES];
+        trace_put_u64(bytes, records[i].sequence);
+        for (size_t w = 0; w < TRACE_RING_WORDS; ++w) {
+            trace_put_u64(bytes + 8u * (w + 1u), words[w]);
+        }
+        ok = fwrite(bytes, sizeof(bytes), 1u, file) == 1u;
+    }
+
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    free(records);
+    return ok;
+}
+
+bool trace_file_read_header(FILE *file, HrTraceFileHeader *out_header)
+{
+    if (file == NULL || out_header == NULL) {
+        return false;
+    }
+
+    unsigned char header[HR_TRACE_FILE_HEADER_BYTES];
+    if (fread(header, sizeof(header), 1u, file) != 1u || memcmp(header, HR_TRACE_FILE_MAGIC, 4u) != 0) {
+        return false;
+    }
+
+    out_header->version = trace_get_u32(header + 4);
+    out_header->record_bytes = trace_get_u32(header + 8);
+    out_header->record_count = trace_get_u64(header + 16);
+    out_header->dropped = trace_get_u64(header + 24);
+    /* Later versions may append fields to a record, never reorder them. */
+    return out_header->version >= 1u && out_header->record_bytes >= HR_TRACE_FILE_RECORD_BYTES;
+}
+
+bool trace_file_read_record(FILE *file, const HrTraceFileHeader *header, HrTraceRecord *out_record)
+{
+    if (file == NULL || header == NULL || out_record == NULL) {
+        return false;
+    }
+
+    unsigned char bytes[HR_TRACE_FILE_RECORD_BYTES];
+    if (fread(bytes, sizeof(bytes), 1u, file) != 1u) {
+        return false;
+    }
+    if (header->record_bytes > HR_TRACE_FILE_RECORD_BYTES &&
+        fseek(file, (long)(header->record_bytes - HR_TRACE_FILE_RECORD_BYTES), SEEK_CUR) != 0) {
+        return false;
+    }
+
+    uint64_t words[TRACE_RING_WORDS];
+    for (size_t w = 0; w < TRACE_RING_WORDS; ++w) {
+        words[w] = trace_get_u64(bytes + 8u * (w + 1u));
+    }
+    trace_decode(trace_get_u64(bytes), words, out_record);
+    return true;
+}
@@ -0,0 +1,112 @@
+#ifndef HYPERRECALL_TRACE_RING_H
+#define HYPERRECALL_TRACE_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file trace_ring.h
+ * @brief Fixed-capacity review trace shared by sessions, dumped to a binary file.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** Records kept by a ring created with a capacity of 0. */
+#define HR_TRACE_RING_DEFAULT_CAPACITY 4096U
+
+/** Trace file identification; see trace_ring_dump() for the layout. */
+#define HR_TRACE_FILE_MAGIC "HRTR"
+#define HR_TRACE_FILE_VERSION 1U
+#define HR_TRACE_FILE_HEADER_BYTES 32U
+#define HR_TRACE_FILE_RECORD_BYTES 80U
+
+/** Flag bits stored in HrTraceRecord::flags. */
+#define HR_TRACE_FLAG_SIMULATED 0x01U
+#define HR_TRACE_FLAG_FIRST_REVIEW 0x02U
+#define HR_TRACE_FLAG_REQUEUED 0x04U
+#define HR_TRACE_FLAG_UNDONE 0x08U
+#define HR_TRACE_FLAG_USED_CRAM 0x10U
+
+/** One traced review, flattened so it can be copied without allocating. */
+typedef struct HrTraceRecord {
+    uint64_t sequence;              /**< Position in the ring's lifetime, assigned on record. */
+    uint64_t card_id;
+    int64_t review_id;              /**< Review log row (0 when none was written). */
+    int64_t review_time;            /**< UTC seconds. */
+    int64_t due;                    /**< UTC seconds. */
+    double previous_interval_days;
+    double interval_days;
+    double ease_factor;
+    uint32_t queue_position;        /**< Saturates at UINT32_MAX. */
+    uint32_t remaining;             /**< Saturates at UINT32_MAX. */
+    uint16_t source;                /**< Caller-chosen tag, e.g. which session emitted it. */
+    uint8_t mode;                   /**< SessionMode. */
+    uint8_t rating;                 /**< SRSReviewRating. */
+    uint8_t flags;                  /**< HR_TRACE_FLAG_* bits. */
+} HrTraceRecord;
+
+/** Header of a trace file. */
+typedef struct HrTraceFileHeader {
+    uint32_t version;
+    uint32_t record_bytes;
+    uint64_t record_count;
+    uint64_t dropped;               /**< Records overwritten or lost to collisions before the dump. */
+} HrTraceFileHeader;
+
+struct HrTraceRing;
+
+/**
+ * Creates a ring holding the last @p capacity records (rounded up to a power
+ * of two). All memory is allocated here; recording never allocates.
+ */
+struct HrTraceRing *trace_ring_create(size_t capacity);
+
+void trace_ring_destroy(struct HrTraceRing *ring);
+
+/** Number of records the ring retains. */
+size_t trace_ring_capacity(const struct HrTraceRing *ring);
+
+/**
+ * Appends @p record, overwriting the oldest entry once the ring is full. Safe
+ * to call from any number of threads at once without locking; a writer that
+ * would collide with a concurrent write to the same slot drops its record
+ * instead of waiting. @p record->sequence is ignored.
+ */
+void trace_ring_record(struct HrTraceRing *ring, const HrTraceRecord *record);
+
+/** Records appended since creation or the last trace_ring_clear(). */
+uint64_t trace_ring_total(const struct HrTraceRing *ring);
+
+/**
+ * Copies up to @p capacity retained records, oldest first, into @p out_records
+ * and returns how many were copied. Records being overwritten while the copy
+ * runs are skipped rather than returned torn. May run alongside writers.
+ */
+size_t trace_ring_snapshot(const struct HrTraceRing *ring, HrTraceRecord *out_records, size_t capacity);
+
+/** Forgets the retained records without touching the storage. */
+void trace_ring_clear(struct HrTraceRing *ring);
+
+/**
+ * Writes the retained records to @p path, replacing the file.
+ *
+ * The file is little-endian: a 32-byte header ("HRTR", version, record size,
+ * record count, dropped count) followed by fixed-size records, oldest first.
+ */
+bool trace_ring_dump(const struct HrTraceRing *ring, const char *path);
+
+/** Reads and validates a trace file header. */
+bool trace_file_read_header(FILE *file, HrTraceFileHeader *out_header);
+
+/** Reads the next record written by trace_ring_dump(); false at end of file. */
+bool trace_file_read_record(FILE *file, const HrTraceFileHeader *header, HrTraceRecord *out_record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERRECALL_TRACE_RING_H */
@@ -23,6 +23,8 @@ extern "C" {
 
 struct ImportExportContext;
 struct AnalyticsHandle;
+struct HrStudyPlanner;
+struct HrPrefetcher;
 
 /**
  * Enumerates the high level screen groupings shown by the UI.
@@ -33,11 +35,22 @@ typedef enum UiScreenId {
     UI_SCREEN_LIBRARY = 2,
 } UiScreenId;
 
+/** Study actions that can be bound to a key. */
+typedef enum UiStudyAction {
+    UI_STUDY_ACTION_REVEAL = 0,
+    UI_STUDY_ACTION_AGAIN,
+    UI_STUDY_ACTION_HARD,
+    UI_STUDY_ACTION_GOOD,
+    UI_STUDY_ACTION_EASY,
+    UI_STUDY_ACTION_COUNT
+} UiStudyAction;
+
 /**
  * Describes configuration flags used to control UI behaviour.
  */
 typedef struct UiConfig {
     bool enable_devtools; /**< Enables developer overlays and trace viewers. */
+    const char *study_hotkeys[UI_STUDY_ACTION_COUNT]; /**< Key sequences (NULL = built-in default); copied. */
 } UiConfig;
 
 /** Forward declaration for the UI context. */
@@ -63,6 +76,12 @@ void ui_attach_analytics(UiContext *ui, struct AnalyticsHandle *analytics);
 /** Provides the database handle used for topic/card listings. */
 void ui_attach_database(UiContext *ui, DatabaseHandle *database);
 
+/** Provides the planner used to build quota-limited study queues. */
+void ui_attach_planner(UiContext *ui, struct HrStudyPlanner *planner);
+
+/** Provides the prefetcher that warms upcoming cards during study sessions. */
+void ui_attach_prefetcher(UiContext *ui, struct HrPrefetcher *prefetcher);
+
 /** Provides an import/export context for deck interactions (optional). */
 void ui_attach_import_export(UiContext *ui, struct ImportExportContext *io_context);
 
@@ -0,0 +1,84 @@
+/*
+ * Regression test for the per-card exam time limit: a card left on screen
+ * past its limit is expired unanswered and its limit charged to the clocks.
+ * Also checks that exam_peek() follows the paper as cards are closed.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "exam.h"
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                                            \
+        }                                                                        \
+    } while (0)
+
+#define CARD_COUNT 4u
+
+int main(void)
+{
+    SessionCardSpec cards[CARD_COUNT];
+    memset(cards, 0, sizeof(cards));
+    for (size_t i = 0; i < CARD_COUNT; ++i) {
+        cards[i].card_id = i + 1u;
+    }
+
+    HrExamConfig config;
+    memset(&config, 0, sizeof(config));
+    config.card_time_limit_ms = 1000u;
+    config.section_time_limit_ms = 2500u;
+    struct HrExam *exam = exam_create(&config, cards, CARD_COUNT, 0);
+    CHECK(exam != NULL);
+
+    HrExamQuestion question;
+    CHECK(exam_current(exam, &question));
+    CHECK(question.card_time_limit_ms == 1000u);
+    CHECK(question.section_time_left_ms == 2500u);
+
+    uint64_t upcoming[CARD_COUNT + 1u];
+    CHECK(exam_peek(exam, upcoming, 3u) == 3u);
+    CHECK(upcoming[0] == 1u && upcoming[1] == 2u && upcoming[2] == 3u);
+
+    /* Card 1 is answered in time, card 2 runs out its limit. */
+    CHECK(exam_answer(exam, SRS_RESPONSE_GOOD, 400u));
+    CHECK(exam_expire_card(exam));
+    CHECK(exam_current(exam, &question));
+    CHECK(question.card_id == 3u);
+    CHECK(question.section_time_left_ms == 1100u);
+
+    /* Expiring card 3 leaves 100ms on the section clock, which card 4 overruns. */
+    CHECK(exam_expire_card(exam));
+    CHECK(exam_current(exam, &question));
+    CHECK(question.section_time_left_ms == 100u);
+    CHECK(exam_peek(exam, upcoming, CARD_COUNT + 1u) == 1u);
+    CHECK(upcoming[0] == 4u);
+    CHECK(exam_answer(exam, SRS_RESPONSE_GOOD, 200u));
+    CHECK(exam_finished(exam));
+    CHECK(!exam_expire_card(exam));
+    CHECK(exam_peek(exam, upcoming, CARD_COUNT + 1u) == 0u);
+
+    HrExamReport report;
+    CHECK(exam_report(exam, &report));
+    CHECK(report.answered == 1u);
+    CHECK(report.correct == 1u);
+    CHECK(report.timed_out == 2u);
+    CHECK(report.unanswered == 1u);
+    CHECK(report.median_latency_ms == 400u);
+    exam_report_release(&report);
+    exam_destroy(exam);
+
+    /* Untimed cards never expire. */
+    config.card_time_limit_ms = 0u;
+    exam = exam_create(&config, cards, CARD_COUNT, 0);
+    CHECK(exam != NULL);
+    CHECK(!exam_expire_card(exam));
+    CHECK(exam_current(exam, &question));
+    CHECK(question.position == 0u);
+    exam_destroy(exam);
+
+    printf("exam_test: ok\n");
+    return 0;
+}
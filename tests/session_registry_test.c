@@ -0,0 +1,67 @@
+/*
+ * Regression test for card ownership when one session queues the same card
+ * twice: the claim must hold until the last copy leaves the queue.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "session_registry.h"
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                                            \
+        }                                                                        \
+    } while (0)
+
+static void test_spec(SessionCardSpec *spec, uint64_t card_id)
+{
+    memset(spec, 0, sizeof(*spec));
+    spec->card_id = card_id;
+    spec->has_state = true;
+    spec->state.version = SRS_STATE_VERSION;
+    spec->state.mode = SRS_MODE_MASTERY;
+    spec->state.ease_factor = 2.5;
+    spec->state.interval_days = 10.0;
+    spec->state.topic_adjustment = 1.0;
+    spec->state.due = 1000;
+}
+
+int main(void)
+{
+    struct HrSessionRegistry *registry = session_registry_create(NULL);
+    CHECK(registry != NULL);
+    struct SessionManager *first = session_registry_open(registry);
+    struct SessionManager *second = session_registry_open(registry);
+    CHECK(first != NULL && second != NULL);
+
+    SessionCardSpec cards[2];
+    test_spec(&cards[0], 7u);
+    test_spec(&cards[1], 7u);
+    CHECK(session_manager_begin_ordered(first, SESSION_MODE_MASTERY, cards, 2u));
+    CHECK(session_registry_owner(registry, 7u) == first);
+    CHECK(session_registry_claimed(registry, first) == 1u);
+
+    SRSReviewContext context;
+    memset(&context, 0, sizeof(context));
+    context.now = 1000;
+
+    /* The first copy leaves the queue; the second still holds the card. */
+    CHECK(session_manager_grade(first, SRS_RESPONSE_GOOD, &context, NULL));
+    CHECK(session_manager_remaining(first) == 1u);
+    CHECK(session_registry_owner(registry, 7u) == first);
+
+    (void)session_manager_begin(second, SESSION_MODE_MASTERY, cards, 1u);
+    CHECK(session_manager_current(second) == NULL);
+
+    CHECK(session_manager_grade(first, SRS_RESPONSE_GOOD, &context, NULL));
+    CHECK(session_registry_owner(registry, 7u) == NULL);
+    CHECK(session_registry_claimed(registry, first) == 0u);
+
+    CHECK(session_manager_begin(second, SESSION_MODE_MASTERY, cards, 1u));
+    CHECK(session_registry_owner(registry, 7u) == second);
+
+    session_registry_destroy(registry);
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Regression test for undoing grades in a streamed session after the
+ * graded card's queue slot was recycled by a refill.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "sessions.h"
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                                            \
+        }                                                                        \
+    } while (0)
+
+#define CARD_COUNT 6u
+
+typedef struct TestSource {
+    size_t next;
+} TestSource;
+
+/* Card i is due at i * 100000000, so the stream serves them in id order. */
+static size_t test_fetch(void *user_data, SessionCardSpec *out_cards, size_t capacity)
+{
+    TestSource *source = (TestSource *)user_data;
+    size_t produced = 0u;
+    while (produced < capacity && source->next < CARD_COUNT) {
+        SessionCardSpec *spec = &out_cards[produced++];
+        memset(spec, 0, sizeof(*spec));
+        spec->card_id = ++source->next;
+        spec->has_state = true;
+        spec->state.version = SRS_STATE_VERSION;
+        spec->state.mode = SRS_MODE_MASTERY;
+        spec->state.ease_factor = 2.5;
+        spec->state.interval_days = 10.0;
+        spec->state.topic_adjustment = 1.0;
+        spec->state.due = (time_t)spec->card_id * 100000000;
+    }
+    return produced;
+}
+
+int main(void)
+{
+    struct SessionManager *manager = session_manager_create();
+    CHECK(manager != NULL);
+    session_manager_set_relearn_horizon(manager, 1100.0);
+
+    TestSource source = {0u};
+    SessionCardSource stream;
+    memset(&stream, 0, sizeof(stream));
+    stream.fetch = test_fetch;
+    stream.user_data = &source;
+    stream.page_size = 2u;
+    CHECK(session_manager_begin_stream(manager, SESSION_MODE_MASTERY, &stream));
+
+    SRSReviewContext context;
+    memset(&context, 0, sizeof(context));
+    context.now = 1000;
+
+    const SessionCard *card = session_manager_current(manager);
+    CHECK(card != NULL && card->card_id == 1u);
+    const SRSState original = card->state;
+
+    /* The failed card is re-queued ahead of card 2, then leaves the queue, freeing its slot for card 3. */
+    CHECK(session_manager_grade(manager, SRS_RESPONSE_FAIL, &context, NULL));
+    card = session_manager_current(manager);
+    CHECK(card != NULL && card->card_id == 1u);
+    CHECK(session_manager_grade(manager, SRS_RESPONSE_GOOD, &context, NULL));
+
+    CHECK(session_manager_undo(manager, NULL));
+    CHECK(session_manager_undo(manager, NULL));
+
+    card = session_manager_current(manager);
+    CHECK(card != NULL && card->card_id == 1u);
+    CHECK(card->state.due == original.due);
+    CHECK(card->state.interval_days == original.interval_days);
+
+    /* Every other card must come through with the schedule its source gave it. */
+    unsigned int seen = 0u;
+    while ((card = session_manager_current(manager)) != NULL) {
+        CHECK(card->state.due == (time_t)card->card_id * 100000000);
+        CHECK((seen & (1u << card->card_id)) == 0u);
+        seen |= 1u << card->card_id;
+        CHECK(session_manager_grade(manager, SRS_RESPONSE_EASY, &context, NULL));
+    }
+    CHECK(seen == ((1u << (CARD_COUNT + 1u)) - 2u));
+
+    session_manager_destroy(manager);
+    return 0;
+}
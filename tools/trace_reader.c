@@ -0,0 +1,138 @@
+/*
+ * Prints a review trace written by trace_ring_dump().
+ *
+ * One line per review, oldest first, plus a per-rating summary. Filters by
+ * session source or card when asked.
+ * Usage: trace_reader <file.trace> [--source N] [--card ID] [--summary]
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "trace_ring.h"
+
+#define READER_RATING_COUNT 5U
+
+static const char *reader_rating_name(uint8_t rating)
+{
+    static const char *const names[READER_RATING_COUNT] = {"fail", "hard", "good", "easy", "cram"};
+    return (rating < READER_RATING_COUNT) ? names[rating] : "?";
+}
+
+static void reader_format_time(int64_t seconds, char *buffer, size_t capacity)
+{
+    const time_t value = (time_t)seconds;
+    const struct tm *utc = gmtime(&value);
+    if (utc == NULL || strftime(buffer, capacity, "%Y-%m-%dT%H:%M:%SZ", utc) == 0U) {
+        snprintf(buffer, capacity, "%" PRId64, seconds);
+    }
+}
+
+static void reader_print_record(const HrTraceRecord *record)
+{
+    char reviewed[32];
+    char due[32];
+    reader_format_time(record->review_time, reviewed, sizeof(reviewed));
+    reader_format_time(record->due, due, sizeof(due));
+
+    printf("%8" PRIu64 "  src=%-2u card=%-8" PRIu64 " %-4s %s  ivl %.2f->%.2fd  ease %.2f  due %s  pos %" PRIu32
+           " left %" PRIu32 "%s%s%s%s%s\n",
+           record->sequence,
+           (unsigned)record->source,
+           record->card_id,
+           reader_rating_name(record->rating),
+           reviewed,
+           record->previous_interval_days,
+           record->interval_days,
+           record->ease_factor,
+           due,
+           record->queue_position,
+           record->remaining,
+           (record->flags & HR_TRACE_FLAG_FIRST_REVIEW) ? " first" : "",
+           (record->flags & HR_TRACE_FLAG_REQUEUED) ? " requeued" : "",
+           (record->flags & HR_TRACE_FLAG_UNDONE) ? " undone" : "",
+           (record->flags & HR_TRACE_FLAG_SIMULATED) ? " simulated" : "",
+           (record->flags & HR_TRACE_FLAG_USED_CRAM) ? " cram" : "");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file.trace> [--source N] [--card ID] [--summary]\n", argv[0]);
+        return 2;
+    }
+
+    bool filter_source = false;
+    unsigned long source = 0UL;
+    bool filter_card = false;
+    unsigned long long card = 0ULL;
+    bool summary_only = false;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--source") == 0 && i + 1 < argc) {
+            filter_source = true;
+            source = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--card") == 0 && i + 1 < argc) {
+            filter_card = true;
+            card = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--summary") == 0) {
+            summary_only = true;
+        } else {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    HrTraceFileHeader header;
+    if (!trace_file_read_header(file, &header)) {
+        fprintf(stderr, "%s is not a HyperRecall trace file\n", argv[1]);
+        fclose(file);
+        return 1;
+    }
+
+    uint64_t shown = 0U;
+    uint64_t per_rating[READER_RATING_COUNT] = {0};
+    uint64_t undone = 0U;
+    HrTraceRecord record;
+    uint64_t read = 0U;
+    while (read < header.record_count && trace_file_read_record(file, &header, &record)) {
+        ++read;
+        if ((filter_source && record.source != source) || (filter_card && record.card_id != card)) {
+            continue;
+        }
+        ++shown;
+        if (record.flags & HR_TRACE_FLAG_UNDONE) {
+            ++undone;
+        } else if (record.rating < READER_RATING_COUNT) {
+            ++per_rating[record.rating];
+        }
+        if (!summary_only) {
+            reader_print_record(&record);
+        }
+    }
+    fclose(file);
+
+    if (read < header.record_count) {
+        fprintf(stderr, "trace truncated: %" PRIu64 " of %" PRIu64 " records\n", read, header.record_count);
+    }
+
+    printf("%" PRIu64 " records (%" PRIu64 " shown, %" PRIu64 " dropped before the dump, format v%" PRIu32 ")\n",
+           read,
+           shown,
+           header.dropped,
+           header.version);
+    for (size_t i = 0; i < READER_RATING_COUNT; ++i) {
+        printf("  %-4s %" PRIu64 "\n", reader_rating_name((uint8_t)i), per_rating[i]);
+    }
+    printf("  undo %" PRIu64 "\n", undone);
+    return (read < header.record_count) ? 1 : 0;
+}